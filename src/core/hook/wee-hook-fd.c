@@ -24,9 +24,14 @@
 #endif
 
 #include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #include "../weechat.h"
 #include "../wee-hook.h"
@@ -36,9 +41,21 @@
 #include "../../gui/gui-chat.h"
 
 
+char *hook_fd_backend_string[HOOK_FD_NUM_BACKENDS] =
+{ "poll", "epoll" };
+int hook_fd_backend = HOOK_FD_BACKEND_POLL; /* backend used to wait on fds  */
+
 struct pollfd *hook_fd_pollfd = NULL;  /* file descriptors for poll()       */
 int hook_fd_pollfd_count = 0;          /* number of file descriptors        */
 
+#ifdef HAVE_SYS_EPOLL_H
+int hook_fd_epoll_fd = -1;             /* epoll instance (-1 if not opened) */
+struct epoll_event *hook_fd_epoll_events = NULL; /* events for epoll_wait() */
+int hook_fd_epoll_events_count = 0;    /* size of array with events         */
+int hook_fd_epoll_rebuild = 0;         /* 1 if the epoll set must be        */
+                                       /* rebuilt (stale registration)      */
+#endif /* HAVE_SYS_EPOLL_H */
+
 
 /*
  * Searches for a fd hook in list.
@@ -97,6 +114,189 @@ hook_fd_realloc_pollfd ()
     hook_fd_pollfd_count = count;
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+
+/*
+ * Reallocates the "struct epoll_event" array for epoll_wait().
+ */
+
+void
+hook_fd_realloc_epoll_events ()
+{
+    struct epoll_event *ptr_events;
+    int count;
+
+    if (hooks_count[HOOK_TYPE_FD] == hook_fd_epoll_events_count)
+        return;
+
+    count = hooks_count[HOOK_TYPE_FD];
+
+    if (count == 0)
+    {
+        if (hook_fd_epoll_events)
+        {
+            free (hook_fd_epoll_events);
+            hook_fd_epoll_events = NULL;
+        }
+    }
+    else
+    {
+        ptr_events = realloc (hook_fd_epoll_events,
+                              count * sizeof (struct epoll_event));
+        if (!ptr_events)
+            return;
+        hook_fd_epoll_events = ptr_events;
+    }
+
+    hook_fd_epoll_events_count = count;
+}
+
+/*
+ * Closes the epoll instance and frees the array of events.
+ */
+
+void
+hook_fd_epoll_close ()
+{
+    if (hook_fd_epoll_fd >= 0)
+    {
+        close (hook_fd_epoll_fd);
+        hook_fd_epoll_fd = -1;
+    }
+    if (hook_fd_epoll_events)
+    {
+        free (hook_fd_epoll_events);
+        hook_fd_epoll_events = NULL;
+    }
+    hook_fd_epoll_events_count = 0;
+    hook_fd_epoll_rebuild = 0;
+}
+
+/*
+ * Switches from epoll to poll backend (used when a file descriptor can not
+ * be watched with epoll, for example a regular file).
+ */
+
+void
+hook_fd_epoll_fallback ()
+{
+    hook_fd_epoll_close ();
+    hook_fd_backend = HOOK_FD_BACKEND_POLL;
+    hook_fd_realloc_pollfd ();
+}
+
+/*
+ * Registers a fd hook in the epoll instance.
+ *
+ * Returns:
+ *   1: OK (or fd hook flagged in error)
+ *   0: fd can not be watched with epoll
+ */
+
+int
+hook_fd_epoll_add (struct t_hook *hook)
+{
+    struct epoll_event event;
+
+    if (!hook || hook->deleted || !hook->hook_data)
+        return 1;
+
+    memset (&event, 0, sizeof (event));
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_READ)
+        event.events |= EPOLLIN;
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_WRITE)
+        event.events |= EPOLLOUT;
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_EXCEPTION)
+        event.events |= EPOLLPRI;
+    event.data.ptr = hook;
+
+    if (epoll_ctl (hook_fd_epoll_fd, EPOLL_CTL_ADD, HOOK_FD(hook, fd),
+                   &event) == 0)
+    {
+        return 1;
+    }
+
+    /*
+     * fd already in epoll set: it is a registration of a hook which was not
+     * removed from the set (removal failed or skipped), so the registration
+     * is replaced by this hook
+     */
+    if ((errno == EEXIST)
+        && (epoll_ctl (hook_fd_epoll_fd, EPOLL_CTL_MOD, HOOK_FD(hook, fd),
+                       &event) == 0))
+    {
+        return 1;
+    }
+
+    if (errno == EBADF)
+    {
+        if (HOOK_FD(hook, error) == 0)
+        {
+            HOOK_FD(hook, error) = errno;
+            gui_chat_printf (NULL,
+                             _("%sError: bad file descriptor (%d) "
+                               "used in hook_fd"),
+                             gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                             HOOK_FD(hook, fd));
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Creates the epoll instance and registers all fd hooks in it.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (poll backend must be used)
+ */
+
+int
+hook_fd_epoll_open ()
+{
+    struct t_hook *ptr_hook;
+
+    hook_fd_epoll_close ();
+
+    hook_fd_epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    if (hook_fd_epoll_fd < 0)
+        return 0;
+
+    hook_fd_realloc_epoll_events ();
+
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!hook_fd_epoll_add (ptr_hook))
+        {
+            hook_fd_epoll_close ();
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*
+ * Initializes fd hooks: chooses the backend used to wait for events on file
+ * descriptors (epoll if available, otherwise poll).
+ */
+
+void
+hook_fd_init ()
+{
+    hook_fd_backend = HOOK_FD_BACKEND_POLL;
+
+#ifdef HAVE_SYS_EPOLL_H
+    if (hook_fd_epoll_open ())
+        hook_fd_backend = HOOK_FD_BACKEND_EPOLL;
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
 /*
  * Callback called when a fd hook is added in the list of hooks.
  */
@@ -104,14 +304,27 @@ hook_fd_realloc_pollfd ()
 void
 hook_fd_add_cb (struct t_hook *hook)
 {
+#ifdef HAVE_SYS_EPOLL_H
+    if (hook_fd_backend == HOOK_FD_BACKEND_EPOLL)
+    {
+        hook_fd_realloc_epoll_events ();
+        if (!hook_fd_epoll_add (hook))
+            hook_fd_epoll_fallback ();
+        return;
+    }
+#else
     /* make C compiler happy */
     (void) hook;
+#endif /* HAVE_SYS_EPOLL_H */
 
     hook_fd_realloc_pollfd ();
 }
 
 /*
  * Callback called when a fd hook is removed from the list of hooks.
+ *
+ * Note: with epoll, the fd is removed from the epoll set as soon as the hook
+ * is unhooked (see function hook_fd_free_data).
  */
 
 void
@@ -120,6 +333,14 @@ hook_fd_remove_cb (struct t_hook *hook)
     /* make C compiler happy */
     (void) hook;
 
+#ifdef HAVE_SYS_EPOLL_H
+    if (hook_fd_backend == HOOK_FD_BACKEND_EPOLL)
+    {
+        hook_fd_realloc_epoll_events ();
+        return;
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+
     hook_fd_realloc_pollfd ();
 }
 
@@ -173,20 +394,17 @@ hook_fd (struct t_weechat_plugin *plugin, int fd, int flag_read,
 }
 
 /*
- * Executes fd hooks:
- * - poll() on fie descriptors
+ * Executes fd hooks with poll backend:
+ * - poll() on file descriptors
  * - call of hook fd callbacks if needed.
  */
 
 void
-hook_fd_exec ()
+hook_fd_exec_poll (int timeout)
 {
-    int i, num_fd, timeout, ready, found;
+    int i, num_fd, ready, found;
     struct t_hook *ptr_hook, *next_hook;
 
-    if (!weechat_hooks[HOOK_TYPE_FD])
-        return;
-
     /* build an array of "struct pollfd" for poll() */
     num_fd = 0;
     for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
@@ -220,6 +438,8 @@ hook_fd_exec ()
                     hook_fd_pollfd[num_fd].events |= POLLIN;
                 if (HOOK_FD(ptr_hook, flags) & HOOK_FD_FLAG_WRITE)
                     hook_fd_pollfd[num_fd].events |= POLLOUT;
+                if (HOOK_FD(ptr_hook, flags) & HOOK_FD_FLAG_EXCEPTION)
+                    hook_fd_pollfd[num_fd].events |= POLLPRI;
 
                 num_fd++;
             }
@@ -227,9 +447,6 @@ hook_fd_exec ()
     }
 
     /* perform the poll() */
-    timeout = hook_timer_get_time_to_next ();
-    if (hook_process_pending)
-        timeout = 0;
     ready = poll (hook_fd_pollfd, num_fd, timeout);
     if (ready <= 0)
         return;
@@ -272,6 +489,117 @@ hook_fd_exec ()
     hook_exec_end ();
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+
+/*
+ * Executes fd hooks with epoll backend:
+ * - epoll_wait() on the persistent epoll set
+ * - call of hook fd callbacks for file descriptors with activity.
+ */
+
+void
+hook_fd_exec_epoll (int timeout)
+{
+    int i, ready;
+    struct t_hook *ptr_hook, *hooks_stack[64], **hooks_ready;
+
+    if (hook_fd_epoll_rebuild)
+    {
+        if (!hook_fd_epoll_open ())
+        {
+            hook_fd_epoll_fallback ();
+            hook_fd_exec_poll (timeout);
+            return;
+        }
+    }
+
+    if (hook_fd_epoll_events_count <= 0)
+        return;
+
+    ready = epoll_wait (hook_fd_epoll_fd, hook_fd_epoll_events,
+                        hook_fd_epoll_events_count, timeout);
+    if (ready <= 0)
+        return;
+
+    /*
+     * copy pointers to hooks before calling callbacks: a callback can add a
+     * fd hook, which reallocates the array of events (or frees it if the fd
+     * can not be watched with epoll and the poll backend is used instead)
+     */
+    if (ready <= (int)(sizeof (hooks_stack) / sizeof (hooks_stack[0])))
+    {
+        hooks_ready = hooks_stack;
+    }
+    else
+    {
+        hooks_ready = malloc (ready * sizeof (*hooks_ready));
+        if (!hooks_ready)
+            return;
+    }
+    for (i = 0; i < ready; i++)
+    {
+        hooks_ready[i] = (struct t_hook *)hook_fd_epoll_events[i].data.ptr;
+    }
+
+    /*
+     * execute callbacks for file descriptors with activity; a hook unhooked
+     * by a previous callback is only flagged as deleted (not freed) until
+     * the end of the hook exec, so the pointers to hooks remain valid
+     */
+    hook_exec_start ();
+
+    for (i = 0; i < ready; i++)
+    {
+        ptr_hook = hooks_ready[i];
+        if (ptr_hook
+            && !ptr_hook->deleted
+            && !ptr_hook->running)
+        {
+            ptr_hook->running = 1;
+            (void) (HOOK_FD(ptr_hook, callback)) (
+                ptr_hook->callback_pointer,
+                ptr_hook->callback_data,
+                HOOK_FD(ptr_hook, fd));
+            ptr_hook->running = 0;
+        }
+    }
+
+    hook_exec_end ();
+
+    if (hooks_ready != hooks_stack)
+        free (hooks_ready);
+}
+
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*
+ * Executes fd hooks: waits for activity on file descriptors (or until next
+ * timer) and calls hook fd callbacks if needed.
+ */
+
+void
+hook_fd_exec ()
+{
+    int timeout;
+
+    if (!weechat_hooks[HOOK_TYPE_FD])
+        return;
+
+    timeout = hook_timer_get_time_to_next ();
+    if (hook_process_pending)
+        timeout = 0;
+
+#ifdef HAVE_SYS_EPOLL_H
+    if (hook_fd_backend == HOOK_FD_BACKEND_EPOLL)
+    {
+        hook_fd_exec_epoll (timeout);
+        return;
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+
+    hook_fd_exec_poll (timeout);
+}
+
 /*
  * Frees data in a fd hook.
  */
@@ -282,6 +610,26 @@ hook_fd_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+#ifdef HAVE_SYS_EPOLL_H
+    /*
+     * remove fd from epoll set now: the hook may be removed later from the
+     * list (if a hook exec is running), and its fd may be closed before;
+     * if the removal fails, the fd may still be registered (for example if
+     * it was closed while duplicated in another process), so the whole epoll
+     * set is rebuilt before next wait
+     */
+    if ((hook_fd_backend == HOOK_FD_BACKEND_EPOLL)
+        && (hook_fd_epoll_fd >= 0)
+        && (HOOK_FD(hook, error) == 0))
+    {
+        if (epoll_ctl (hook_fd_epoll_fd, EPOLL_CTL_DEL, HOOK_FD(hook, fd),
+                       NULL) < 0)
+        {
+            hook_fd_epoll_rebuild = 1;
+        }
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+
     free (hook->hook_data);
     hook->hook_data = NULL;
 }
@@ -30,6 +30,15 @@ struct t_infolist_item;
 #define HOOK_FD_FLAG_WRITE     (1 << 1)
 #define HOOK_FD_FLAG_EXCEPTION (1 << 2)
 
+/* backends used to wait for events on file descriptors */
+enum t_hook_fd_backend
+{
+    HOOK_FD_BACKEND_POLL = 0,          /* poll(): array rebuilt on each loop*/
+    HOOK_FD_BACKEND_EPOLL,             /* epoll: persistent registration    */
+    /* number of fd backends */
+    HOOK_FD_NUM_BACKENDS,
+};
+
 typedef int (t_hook_callback_fd)(const void *pointer, void *data, int fd);
 
 struct t_hook_fd
@@ -41,6 +50,10 @@ struct t_hook_fd
                                        /* with fd                           */
 };
 
+extern char *hook_fd_backend_string[];
+extern int hook_fd_backend;
+
+extern void hook_fd_init ();
 extern void hook_fd_add_cb (struct t_hook *hook);
 extern void hook_fd_remove_cb (struct t_hook *hook);
 extern struct t_hook *hook_fd (struct t_weechat_plugin *plugin, int fd,
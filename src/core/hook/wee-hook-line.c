@@ -37,6 +37,14 @@
 #include "../../plugins/plugin.h"
 
 
+/*
+ * index of line hooks: buffer full name => line hooks for this buffer, with
+ * index of tags (built on first line added in buffer, cleared when a line
+ * hook is added or removed)
+ */
+struct t_hashtable *hook_line_index = NULL;
+
+
 /*
  * Hooks a line added in a buffer.
  *
@@ -94,91 +102,292 @@ hook_line (struct t_weechat_plugin *plugin, const char *buffer_type,
 }
 
 /*
- * Executes a line hook and updates the line data.
+ * Clears index of line hooks.
+ *
+ * The index is freed if there is no line hook any more.
  */
 
 void
-hook_line_exec (struct t_gui_line *line)
+hook_line_index_clear ()
+{
+    if (!hook_line_index)
+        return;
+
+    if (hooks_count[HOOK_TYPE_LINE] > 0)
+    {
+        hashtable_remove_all (hook_line_index);
+    }
+    else
+    {
+        hashtable_free (hook_line_index);
+        hook_line_index = NULL;
+    }
+}
+
+/*
+ * Checks if a line hook matches a buffer (type and name).
+ *
+ * Returns:
+ *   1: hook matches buffer
+ *   0: hook does not match buffer
+ */
+
+int
+hook_line_match_buffer (struct t_hook *hook, struct t_gui_buffer *buffer)
+{
+    return (((HOOK_LINE(hook, buffer_type) == -1)
+             || ((int)(buffer->type) == (HOOK_LINE(hook, buffer_type))))
+            && string_match_list (buffer->full_name,
+                                  (const char **)HOOK_LINE(hook, buffers),
+                                  0)) ? 1 : 0;
+}
+
+/*
+ * Gets line hooks for a buffer, using the index of line hooks (the hooks
+ * are searched and added in index if the buffer is not yet in index, or if
+ * its type has changed).
+ *
+ * Returns pointer to hooks, NULL if error.
+ */
+
+struct t_hook_buffer_hooks *
+hook_line_index_get (struct t_gui_buffer *buffer)
+{
+    struct t_hook_buffer_hooks *buffer_hooks;
+    struct t_hook *ptr_hook;
+    int count;
+
+    if (!hook_line_index)
+    {
+        hook_line_index = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!hook_line_index)
+            return NULL;
+        hashtable_set_pointer (hook_line_index, "callback_free_value",
+                               &hook_buffer_hooks_free_value_cb);
+    }
+
+    buffer_hooks = hashtable_get (hook_line_index, buffer->full_name);
+    if (buffer_hooks && (buffer_hooks->buffer_type == (int)(buffer->type)))
+        return buffer_hooks;
+
+    count = 0;
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_LINE]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted && hook_line_match_buffer (ptr_hook, buffer))
+            count++;
+    }
+
+    buffer_hooks = hook_buffer_hooks_new (count);
+    if (!buffer_hooks)
+        return NULL;
+    buffer_hooks->buffer_type = buffer->type;
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_LINE]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted && hook_line_match_buffer (ptr_hook, buffer))
+        {
+            hook_buffer_hooks_add (buffer_hooks, ptr_hook,
+                                   HOOK_LINE(ptr_hook, tags_count),
+                                   HOOK_LINE(ptr_hook, tags_array));
+        }
+    }
+
+    /* too many buffers: clear the index before adding this one */
+    if (hook_line_index->items_count >= HOOK_LINE_INDEX_MAX_BUFFERS)
+        hashtable_remove_all (hook_line_index);
+
+    hashtable_set (hook_line_index, buffer->full_name, buffer_hooks);
+
+    return buffer_hooks;
+}
+
+/*
+ * Callback called when a line hook is added.
+ */
+
+void
+hook_line_add_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    hook_line_index_clear ();
+}
+
+/*
+ * Callback called when a line hook is removed.
+ */
+
+void
+hook_line_remove_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    hook_line_index_clear ();
+}
+
+/*
+ * Executes callback of a line hook (if the line matches tags of hook) and
+ * updates the line data.
+ *
+ * The hashtable sent to callback is created on first call.
+ *
+ * Returns:
+ *   1: line has been updated by callback
+ *   0: line not updated
+ *  -1: error
+ */
+
+int
+hook_line_exec_hook (struct t_hook *hook, struct t_gui_line *line,
+                     struct t_hashtable **hashtable_line)
 {
-    struct t_hook *ptr_hook, *next_hook;
     struct t_hashtable *hashtable, *hashtable2;
     char str_value[128], *str_tags;
 
+    if (HOOK_LINE(hook, tags_array)
+        && !gui_line_match_tags (line->data,
+                                 HOOK_LINE(hook, tags_count),
+                                 HOOK_LINE(hook, tags_array)))
+    {
+        return 0;
+    }
+
+    /* create the hashtable that will be sent to callback */
+    if (!*hashtable_line)
+    {
+        *hashtable_line = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_STRING,
+            NULL, NULL);
+        if (!*hashtable_line)
+            return -1;
+        hashtable_set_arena (*hashtable_line, 0);
+    }
+    hashtable = *hashtable_line;
+    HASHTABLE_SET_POINTER("buffer", line->data->buffer);
+    HASHTABLE_SET_STR("buffer_name", line->data->buffer->full_name);
+    HASHTABLE_SET_STR("buffer_type",
+                      gui_buffer_type_string[line->data->buffer->type]);
+    HASHTABLE_SET_INT("y", line->data->y);
+    HASHTABLE_SET_TIME("date", line->data->date);
+    HASHTABLE_SET_TIME("date_printed", line->data->date_printed);
+    HASHTABLE_SET_STR_NOT_NULL("str_time", line->data->str_time);
+    HASHTABLE_SET_INT("tags_count", line->data->tags_count);
+    str_tags = string_build_with_split_string (
+        (const char **)line->data->tags_array, ",");
+    HASHTABLE_SET_STR_NOT_NULL("tags", str_tags);
+    if (str_tags)
+        free (str_tags);
+    HASHTABLE_SET_INT("displayed", line->data->displayed);
+    HASHTABLE_SET_INT("notify_level", line->data->notify_level);
+    HASHTABLE_SET_INT("highlight", line->data->highlight);
+    HASHTABLE_SET_STR_NOT_NULL("prefix", line->data->prefix);
+    HASHTABLE_SET_STR_NOT_NULL("message", line->data->message);
+
+    /* run callback */
+    hook->running = 1;
+    hashtable2 = (HOOK_LINE(hook, callback))
+        (hook->callback_pointer,
+         hook->callback_data,
+         hashtable);
+    hook->running = 0;
+
+    if (!hashtable2)
+        return 0;
+
+    gui_line_hook_update (line, hashtable, hashtable2);
+    hashtable_free (hashtable2);
+
+    return 1;
+}
+
+/*
+ * Executes line hooks and updates the line data.
+ *
+ * The hooks for the buffer are read in the index of line hooks, and only
+ * hooks without tags or requiring a tag of line are checked.
+ * When a callback updates the line (which can change its buffer or tags),
+ * the next hooks are checked without the index.
+ */
+
+void
+hook_line_exec (struct t_gui_line *line)
+{
+    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook_buffer_hooks *buffer_hooks;
+    struct t_hashtable *hashtable;
+    char *candidates, candidates_static[HOOK_BUFFER_HOOKS_STATIC_SIZE];
+    int i, rc;
+
     if (!weechat_hooks[HOOK_TYPE_LINE])
         return;
 
     hashtable = NULL;
+    rc = 0;
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_LINE];
-    while (ptr_hook)
+    /* first hook to check without index (NULL = all hooks checked) */
+    next_hook = weechat_hooks[HOOK_TYPE_LINE];
+
+    buffer_hooks = hook_line_index_get (line->data->buffer);
+    candidates = NULL;
+    if (buffer_hooks)
     {
-        next_hook = ptr_hook->next_hook;
+        candidates = (buffer_hooks->count <= HOOK_BUFFER_HOOKS_STATIC_SIZE) ?
+            candidates_static : malloc (buffer_hooks->count);
+    }
 
-        if (!ptr_hook->deleted && !ptr_hook->running
-            && ((HOOK_LINE(ptr_hook, buffer_type) == -1)
-                || ((int)(line->data->buffer->type) == (HOOK_LINE(ptr_hook, buffer_type))))
-            && string_match_list (line->data->buffer->full_name,
-                                  (const char **)HOOK_LINE(ptr_hook, buffers),
-                                  0)
-            && (!HOOK_LINE(ptr_hook, tags_array)
-                || gui_line_match_tags (line->data,
-                                        HOOK_LINE(ptr_hook, tags_count),
-                                        HOOK_LINE(ptr_hook, tags_array))))
+    if (buffer_hooks && candidates)
+    {
+        next_hook = NULL;
+        hook_buffer_hooks_get_candidates (buffer_hooks, line->data,
+                                          candidates);
+        hook_buffer_hooks_use (buffer_hooks);
+        for (i = 0; i < buffer_hooks->count; i++)
         {
-            /* create the hashtable that will be sent to callback */
-            if (!hashtable)
+            ptr_hook = buffer_hooks->hooks[i];
+            if (candidates[i] && !ptr_hook->deleted && !ptr_hook->running)
             {
-                hashtable = hashtable_new (32,
-                                           WEECHAT_HASHTABLE_STRING,
-                                           WEECHAT_HASHTABLE_STRING,
-                                           NULL, NULL);
-                if (!hashtable)
-                    break;
-            }
-            HASHTABLE_SET_POINTER("buffer", line->data->buffer);
-            HASHTABLE_SET_STR("buffer_name", line->data->buffer->full_name);
-            HASHTABLE_SET_STR("buffer_type",
-                              gui_buffer_type_string[line->data->buffer->type]);
-            HASHTABLE_SET_INT("y", line->data->y);
-            HASHTABLE_SET_TIME("date", line->data->date);
-            HASHTABLE_SET_TIME("date_printed", line->data->date_printed);
-            HASHTABLE_SET_STR_NOT_NULL("str_time", line->data->str_time);
-            HASHTABLE_SET_INT("tags_count", line->data->tags_count);
-            str_tags = string_build_with_split_string (
-                (const char **)line->data->tags_array, ",");
-            HASHTABLE_SET_STR_NOT_NULL("tags", str_tags);
-            if (str_tags)
-                free (str_tags);
-            HASHTABLE_SET_INT("displayed", line->data->displayed);
-            HASHTABLE_SET_INT("notify_level", line->data->notify_level);
-            HASHTABLE_SET_INT("highlight", line->data->highlight);
-            HASHTABLE_SET_STR_NOT_NULL("prefix", line->data->prefix);
-            HASHTABLE_SET_STR_NOT_NULL("message", line->data->message);
-
-            /* run callback */
-            ptr_hook->running = 1;
-            hashtable2 = (HOOK_LINE(ptr_hook, callback))
-                (ptr_hook->callback_pointer,
-                 ptr_hook->callback_data,
-                 hashtable);
-            ptr_hook->running = 0;
-
-            if (hashtable2)
-            {
-                gui_line_hook_update (line, hashtable, hashtable2);
-                hashtable_free (hashtable2);
-                if (!line->data->buffer)
+                rc = hook_line_exec_hook (ptr_hook, line, &hashtable);
+                if (rc != 0)
+                {
+                    /* line updated: check next hooks without index */
+                    if (rc > 0)
+                        next_hook = ptr_hook->next_hook;
                     break;
+                }
             }
         }
+        hook_buffer_hooks_release (buffer_hooks);
+    }
 
+    while (next_hook && (rc >= 0) && line->data->buffer)
+    {
         ptr_hook = next_hook;
+        next_hook = ptr_hook->next_hook;
+
+        if (!ptr_hook->deleted && !ptr_hook->running
+            && hook_line_match_buffer (ptr_hook, line->data->buffer))
+        {
+            rc = hook_line_exec_hook (ptr_hook, line, &hashtable);
+        }
     }
 
     hook_exec_end ();
 
+    if (candidates && (candidates != candidates_static))
+        free (candidates);
     if (hashtable)
         hashtable_free (hashtable);
 }
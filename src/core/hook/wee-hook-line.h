@@ -27,6 +27,9 @@ struct t_gui_line;
 
 #define HOOK_LINE(hook, var) (((struct t_hook_line *)hook->hook_data)->var)
 
+/* max number of buffers in index (the index is cleared when it is full) */
+#define HOOK_LINE_INDEX_MAX_BUFFERS 1024
+
 typedef struct t_hashtable *(t_hook_callback_line)(const void *pointer,
                                                    void *data,
                                                    struct t_hashtable *line);
@@ -43,6 +46,8 @@ struct t_hook_line
     char ***tags_array;                /* tags selected (NULL = any)        */
 };
 
+extern struct t_hashtable *hook_line_index;
+
 extern struct t_hook *hook_line (struct t_weechat_plugin *plugin,
                                  const char *buffer_type,
                                  const char *buffer_name,
@@ -51,6 +56,8 @@ extern struct t_hook *hook_line (struct t_weechat_plugin *plugin,
                                  const void *callback_pointer,
                                  void *callback_data);
 extern void hook_line_exec (struct t_gui_line *line);
+extern void hook_line_add_cb (struct t_hook *hook);
+extern void hook_line_remove_cb (struct t_hook *hook);
 extern void hook_line_free_data (struct t_hook *hook);
 extern int hook_line_add_to_infolist (struct t_infolist_item *item,
                                       struct t_hook *hook);
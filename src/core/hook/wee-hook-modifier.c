@@ -27,12 +27,96 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../wee-hashtable.h"
 #include "../wee-hook.h"
 #include "../wee-infolist.h"
 #include "../wee-log.h"
 #include "../wee-string.h"
+#include "../../plugins/plugin.h"
 
 
+/*
+ * registry of modifiers: name of modifier (case is ignored) => number of
+ * modifier hooks with this name
+ */
+struct t_hashtable *hook_modifier_registry = NULL;
+
+
+/*
+ * Adds a modifier hook in registry.
+ */
+
+void
+hook_modifier_registry_add (const char *modifier)
+{
+    int *ptr_count, count;
+
+    if (!hook_modifier_registry)
+    {
+        hook_modifier_registry = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_INTEGER,
+            &hook_hash_key_nocase_cb,
+            &hook_keycmp_nocase_cb);
+        if (!hook_modifier_registry)
+            return;
+    }
+
+    ptr_count = hashtable_get (hook_modifier_registry, modifier);
+    count = (ptr_count) ? *ptr_count + 1 : 1;
+    hashtable_set (hook_modifier_registry, modifier, &count);
+}
+
+/*
+ * Removes a modifier hook from registry.
+ *
+ * The registry is freed if there is no modifier any more.
+ */
+
+void
+hook_modifier_registry_remove (const char *modifier)
+{
+    int *ptr_count;
+
+    if (!hook_modifier_registry)
+        return;
+
+    ptr_count = hashtable_get (hook_modifier_registry, modifier);
+    if (!ptr_count)
+        return;
+
+    if (*ptr_count > 1)
+        (*ptr_count)--;
+    else
+        hashtable_remove (hook_modifier_registry, modifier);
+
+    if (hook_modifier_registry->items_count == 0)
+    {
+        hashtable_free (hook_modifier_registry);
+        hook_modifier_registry = NULL;
+    }
+}
+
+/*
+ * Checks if a modifier has hooks: this can be used to skip the build of
+ * arguments for function hook_modifier_exec.
+ *
+ * Returns:
+ *   1: modifier has at least one hook
+ *   0: modifier has no hooks
+ */
+
+int
+hook_modifier_has_hooks (const char *modifier)
+{
+    if (!modifier || !modifier[0] || !hook_modifier_registry)
+        return 0;
+
+    return (hashtable_has_key (hook_modifier_registry, modifier)) ? 1 : 0;
+}
+
 /*
  * Hooks a modifier.
  *
@@ -73,6 +157,9 @@ hook_modifier (struct t_weechat_plugin *plugin, const char *modifier,
 
     hook_add_to_list (new_hook);
 
+    if (new_hook_modifier->modifier)
+        hook_modifier_registry_add (new_hook_modifier->modifier);
+
     return new_hook;
 }
 
@@ -95,6 +182,10 @@ hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
     if (!modifier || !modifier[0] || !string)
         return NULL;
 
+    /* no hook for this modifier: string is not changed */
+    if (!hook_modifier_has_hooks (modifier))
+        return strdup (string);
+
     new_msg = NULL;
     message_modified = strdup (string);
     if (!message_modified)
@@ -157,6 +248,7 @@ hook_modifier_free_data (struct t_hook *hook)
 
     if (HOOK_MODIFIER(hook, modifier))
     {
+        hook_modifier_registry_remove (HOOK_MODIFIER(hook, modifier));
         free (HOOK_MODIFIER(hook, modifier));
         HOOK_MODIFIER(hook, modifier) = NULL;
     }
@@ -22,6 +22,7 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_hashtable;
 
 #define HOOK_MODIFIER(hook, var) (((struct t_hook_modifier *)hook->hook_data)->var)
 
@@ -36,11 +37,14 @@ struct t_hook_modifier
     char *modifier;                     /* name of modifier                 */
 };
 
+extern struct t_hashtable *hook_modifier_registry;
+
 extern struct t_hook *hook_modifier (struct t_weechat_plugin *plugin,
                                      const char *modifier,
                                      t_hook_callback_modifier *callback,
                                      const void *callback_pointer,
                                      void *callback_data);
+extern int hook_modifier_has_hooks (const char *modifier);
 extern char *hook_modifier_exec (struct t_weechat_plugin *plugin,
                                  const char *modifier,
                                  const char *modifier_data,
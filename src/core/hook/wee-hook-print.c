@@ -27,12 +27,22 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../wee-hashtable.h"
 #include "../wee-hook.h"
 #include "../wee-infolist.h"
 #include "../wee-log.h"
 #include "../wee-string.h"
 #include "../../gui/gui-color.h"
 #include "../../gui/gui-line.h"
+#include "../../plugins/plugin.h"
+
+
+/*
+ * index of print hooks: buffer => print hooks for this buffer, with index of
+ * tags (built on first message printed in buffer, cleared when a print hook
+ * is added or removed)
+ */
+struct t_hashtable *hook_print_index = NULL;
 
 
 /*
@@ -81,14 +91,220 @@ hook_print (struct t_weechat_plugin *plugin, struct t_gui_buffer *buffer,
 }
 
 /*
- * Executes a print hook.
+ * Clears index of print hooks.
+ *
+ * The index is freed if there is no print hook any more.
+ */
+
+void
+hook_print_index_clear ()
+{
+    if (!hook_print_index)
+        return;
+
+    if (hooks_count[HOOK_TYPE_PRINT] > 0)
+    {
+        hashtable_remove_all (hook_print_index);
+    }
+    else
+    {
+        hashtable_free (hook_print_index);
+        hook_print_index = NULL;
+    }
+}
+
+/*
+ * Gets print hooks for a buffer, using the index of print hooks (the hooks
+ * are searched and added in index if the buffer is not yet in index).
+ *
+ * Returns pointer to hooks, NULL if error.
+ */
+
+struct t_hook_buffer_hooks *
+hook_print_index_get (struct t_gui_buffer *buffer)
+{
+    struct t_hook_buffer_hooks *buffer_hooks;
+    struct t_hook *ptr_hook;
+    int count;
+
+    if (!hook_print_index)
+    {
+        hook_print_index = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!hook_print_index)
+            return NULL;
+        hashtable_set_pointer (hook_print_index, "callback_free_value",
+                               &hook_buffer_hooks_free_value_cb);
+    }
+
+    buffer_hooks = hashtable_get (hook_print_index, buffer);
+    if (buffer_hooks)
+        return buffer_hooks;
+
+    count = 0;
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_PRINT]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted
+            && (!HOOK_PRINT(ptr_hook, buffer)
+                || (buffer == HOOK_PRINT(ptr_hook, buffer))))
+        {
+            count++;
+        }
+    }
+
+    buffer_hooks = hook_buffer_hooks_new (count);
+    if (!buffer_hooks)
+        return NULL;
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_PRINT]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted
+            && (!HOOK_PRINT(ptr_hook, buffer)
+                || (buffer == HOOK_PRINT(ptr_hook, buffer))))
+        {
+            hook_buffer_hooks_add (buffer_hooks, ptr_hook,
+                                   HOOK_PRINT(ptr_hook, tags_count),
+                                   HOOK_PRINT(ptr_hook, tags_array));
+        }
+    }
+
+    /* too many buffers: clear the index before adding this one */
+    if (hook_print_index->items_count >= HOOK_PRINT_INDEX_MAX_BUFFERS)
+        hashtable_remove_all (hook_print_index);
+
+    hashtable_set (hook_print_index, buffer, buffer_hooks);
+
+    return buffer_hooks;
+}
+
+/*
+ * Callback called when a print hook is added.
+ */
+
+void
+hook_print_add_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    hook_print_index_clear ();
+}
+
+/*
+ * Callback called when a print hook is removed.
+ */
+
+void
+hook_print_remove_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    hook_print_index_clear ();
+}
+
+/*
+ * Removes colors from prefix and message of a line (only on first call: the
+ * strings without colors are then used for all hooks).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hook_print_decode_colors (struct t_gui_line *line, int *colors_decoded,
+                          char **prefix_no_color, char **message_no_color)
+{
+    if (*colors_decoded)
+        return (*message_no_color) ? 1 : 0;
+
+    *colors_decoded = 1;
+
+    *prefix_no_color = (line->data->prefix) ?
+        gui_color_decode (line->data->prefix, NULL) : NULL;
+    *message_no_color = gui_color_decode (line->data->message, NULL);
+
+    return (*message_no_color) ? 1 : 0;
+}
+
+/*
+ * Executes callback of a print hook if the line matches the tags and the
+ * message of hook (the buffer is not checked).
+ *
+ * The colors are removed from prefix and message only if needed (hook with a
+ * message or hook with colors stripped).
+ */
+
+void
+hook_print_exec_hook (struct t_hook *hook, struct t_gui_buffer *buffer,
+                      struct t_gui_line *line, int *colors_decoded,
+                      char **prefix_no_color, char **message_no_color)
+{
+    if (HOOK_PRINT(hook, tags_array)
+        && !gui_line_match_tags (line->data,
+                                 HOOK_PRINT(hook, tags_count),
+                                 HOOK_PRINT(hook, tags_array)))
+    {
+        return;
+    }
+
+    if (HOOK_PRINT(hook, message) && HOOK_PRINT(hook, message)[0])
+    {
+        if (!hook_print_decode_colors (line, colors_decoded,
+                                       prefix_no_color, message_no_color))
+        {
+            return;
+        }
+        if (!string_strcasestr (*prefix_no_color, HOOK_PRINT(hook, message))
+            && !string_strcasestr (*message_no_color, HOOK_PRINT(hook, message)))
+        {
+            return;
+        }
+    }
+
+    if (HOOK_PRINT(hook, strip_colors)
+        && !hook_print_decode_colors (line, colors_decoded,
+                                      prefix_no_color, message_no_color))
+    {
+        return;
+    }
+
+    /* run callback */
+    hook->running = 1;
+    (void) (HOOK_PRINT(hook, callback))
+        (hook->callback_pointer,
+         hook->callback_data,
+         buffer,
+         line->data->date,
+         line->data->tags_count,
+         (const char **)line->data->tags_array,
+         (int)line->data->displayed, (int)line->data->highlight,
+         (HOOK_PRINT(hook, strip_colors)) ? *prefix_no_color : line->data->prefix,
+         (HOOK_PRINT(hook, strip_colors)) ? *message_no_color : line->data->message);
+    hook->running = 0;
+}
+
+/*
+ * Executes print hooks for a line.
+ *
+ * The hooks for the buffer are read in the index of print hooks, and only
+ * hooks without tags or requiring a tag of line are checked.
  */
 
 void
 hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
 {
     struct t_hook *ptr_hook, *next_hook;
-    char *prefix_no_color, *message_no_color;
+    struct t_hook_buffer_hooks *buffer_hooks;
+    char *prefix_no_color, *message_no_color, *candidates;
+    char candidates_static[HOOK_BUFFER_HOOKS_STATIC_SIZE];
+    int colors_decoded, i;
 
     if (!weechat_hooks[HOOK_TYPE_PRINT])
         return;
@@ -96,55 +312,59 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
     if (!line->data->message || !line->data->message[0])
         return;
 
-    prefix_no_color = (line->data->prefix) ?
-        gui_color_decode (line->data->prefix, NULL) : NULL;
-
-    message_no_color = gui_color_decode (line->data->message, NULL);
-    if (!message_no_color)
-    {
-        if (prefix_no_color)
-            free (prefix_no_color);
-        return;
-    }
+    prefix_no_color = NULL;
+    message_no_color = NULL;
+    colors_decoded = 0;
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_PRINT];
-    while (ptr_hook)
+    buffer_hooks = hook_print_index_get (buffer);
+    candidates = NULL;
+    if (buffer_hooks)
     {
-        next_hook = ptr_hook->next_hook;
+        candidates = (buffer_hooks->count <= HOOK_BUFFER_HOOKS_STATIC_SIZE) ?
+            candidates_static : malloc (buffer_hooks->count);
+    }
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (!HOOK_PRINT(ptr_hook, buffer)
-                || (buffer == HOOK_PRINT(ptr_hook, buffer)))
-            && (!HOOK_PRINT(ptr_hook, message)
-                || !HOOK_PRINT(ptr_hook, message)[0]
-                || string_strcasestr (prefix_no_color, HOOK_PRINT(ptr_hook, message))
-                || string_strcasestr (message_no_color, HOOK_PRINT(ptr_hook, message)))
-            && (!HOOK_PRINT(ptr_hook, tags_array)
-                || gui_line_match_tags (line->data,
-                                        HOOK_PRINT(ptr_hook, tags_count),
-                                        HOOK_PRINT(ptr_hook, tags_array))))
+    if (buffer_hooks && candidates)
+    {
+        hook_buffer_hooks_get_candidates (buffer_hooks, line->data,
+                                          candidates);
+        hook_buffer_hooks_use (buffer_hooks);
+        for (i = 0; i < buffer_hooks->count; i++)
         {
-            /* run callback */
-            ptr_hook->running = 1;
-            (void) (HOOK_PRINT(ptr_hook, callback))
-                (ptr_hook->callback_pointer,
-                 ptr_hook->callback_data,
-                 buffer,
-                 line->data->date,
-                 line->data->tags_count,
-                 (const char **)line->data->tags_array,
-                 (int)line->data->displayed, (int)line->data->highlight,
-                 (HOOK_PRINT(ptr_hook, strip_colors)) ? prefix_no_color : line->data->prefix,
-                 (HOOK_PRINT(ptr_hook, strip_colors)) ? message_no_color : line->data->message);
-            ptr_hook->running = 0;
+            ptr_hook = buffer_hooks->hooks[i];
+            if (candidates[i] && !ptr_hook->deleted && !ptr_hook->running)
+            {
+                hook_print_exec_hook (ptr_hook, buffer, line, &colors_decoded,
+                                      &prefix_no_color, &message_no_color);
+            }
         }
+        hook_buffer_hooks_release (buffer_hooks);
+    }
+    else
+    {
+        /* not enough memory for index: check all print hooks */
+        ptr_hook = weechat_hooks[HOOK_TYPE_PRINT];
+        while (ptr_hook)
+        {
+            next_hook = ptr_hook->next_hook;
 
-        ptr_hook = next_hook;
+            if (!ptr_hook->deleted
+                && !ptr_hook->running
+                && (!HOOK_PRINT(ptr_hook, buffer)
+                    || (buffer == HOOK_PRINT(ptr_hook, buffer))))
+            {
+                hook_print_exec_hook (ptr_hook, buffer, line, &colors_decoded,
+                                      &prefix_no_color, &message_no_color);
+            }
+
+            ptr_hook = next_hook;
+        }
     }
 
+    if (candidates && (candidates != candidates_static))
+        free (candidates);
     if (prefix_no_color)
         free (prefix_no_color);
     if (message_no_color)
@@ -26,9 +26,13 @@ struct t_weechat_plugin;
 struct t_infolist_item;
 struct t_gui_buffer;
 struct t_gui_line;
+struct t_hashtable;
 
 #define HOOK_PRINT(hook, var) (((struct t_hook_print *)hook->hook_data)->var)
 
+/* max number of buffers in index (the index is cleared when it is full) */
+#define HOOK_PRINT_INDEX_MAX_BUFFERS 1024
+
 typedef int (t_hook_callback_print)(const void *pointer, void *data,
                                     struct t_gui_buffer *buffer,
                                     time_t date, int tags_count,
@@ -46,6 +50,8 @@ struct t_hook_print
     int strip_colors;                  /* strip colors in msg for callback? */
 };
 
+extern struct t_hashtable *hook_print_index;
+
 extern struct t_hook *hook_print (struct t_weechat_plugin *plugin,
                                   struct t_gui_buffer *buffer,
                                   const char *tags, const char *message,
@@ -55,6 +61,8 @@ extern struct t_hook *hook_print (struct t_weechat_plugin *plugin,
                                   void *callback_data);
 extern void hook_print_exec (struct t_gui_buffer *buffer,
                              struct t_gui_line *line);
+extern void hook_print_add_cb (struct t_hook *hook);
+extern void hook_print_remove_cb (struct t_hook *hook);
 extern void hook_print_free_data (struct t_hook *hook);
 extern int hook_print_add_to_infolist (struct t_infolist_item *item,
                                        struct t_hook *hook);
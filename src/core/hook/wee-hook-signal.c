@@ -27,6 +27,7 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../wee-hashtable.h"
 #include "../wee-hook.h"
 #include "../wee-infolist.h"
 #include "../wee-log.h"
@@ -34,6 +35,14 @@
 #include "../../plugins/plugin.h"
 
 
+/*
+ * index of signal hooks: signal sent => hooks matching this signal
+ * (built on first send of a signal, cleared when a signal hook is added or
+ * removed)
+ */
+struct t_hashtable *hook_signal_index = NULL;
+
+
 /*
  * Hooks a signal.
  *
@@ -77,43 +86,244 @@ hook_signal (struct t_weechat_plugin *plugin, const char *signal,
     return new_hook;
 }
 
+/*
+ * Frees hooks of a signal in index (callback called when the signal is
+ * removed from index).
+ *
+ * If the hooks are being called (signal sent), they are freed later by
+ * function hook_signal_send.
+ */
+
+void
+hook_signal_index_free_value_cb (struct t_hashtable *hashtable,
+                                 const void *key, void *value)
+{
+    struct t_hook_signal_hooks *signal_hooks;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    signal_hooks = (struct t_hook_signal_hooks *)value;
+
+    if (signal_hooks->used > 0)
+        signal_hooks->removed = 1;
+    else
+        free (signal_hooks);
+}
+
+/*
+ * Clears index of signal hooks.
+ *
+ * The index is freed if there is no signal hook any more.
+ */
+
+void
+hook_signal_index_clear ()
+{
+    if (!hook_signal_index)
+        return;
+
+    if (hooks_count[HOOK_TYPE_SIGNAL] > 0)
+    {
+        hashtable_remove_all (hook_signal_index);
+    }
+    else
+    {
+        hashtable_free (hook_signal_index);
+        hook_signal_index = NULL;
+    }
+}
+
+/*
+ * Gets hooks matching a signal, using the index of signal hooks (the hooks
+ * are searched and added in index if the signal is not yet in index).
+ *
+ * Returns pointer to hooks, NULL if error.
+ */
+
+struct t_hook_signal_hooks *
+hook_signal_index_get (const char *signal)
+{
+    struct t_hook_signal_hooks *signal_hooks;
+    struct t_hook *ptr_hook;
+    int count;
+
+    if (!signal)
+        return NULL;
+
+    if (!hook_signal_index)
+    {
+        hook_signal_index = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            64,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!hook_signal_index)
+            return NULL;
+        hashtable_set_pointer (hook_signal_index, "callback_free_value",
+                               &hook_signal_index_free_value_cb);
+    }
+
+    signal_hooks = hashtable_get (hook_signal_index, signal);
+    if (signal_hooks)
+        return signal_hooks;
+
+    count = 0;
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_SIGNAL]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted
+            && string_match (signal, HOOK_SIGNAL(ptr_hook, signal), 0))
+        {
+            count++;
+        }
+    }
+
+    signal_hooks = malloc (sizeof (*signal_hooks) +
+                           (count * sizeof (signal_hooks->hooks[0])));
+    if (!signal_hooks)
+        return NULL;
+    signal_hooks->count = 0;
+    signal_hooks->hooks = (struct t_hook **)(signal_hooks + 1);
+    signal_hooks->used = 0;
+    signal_hooks->removed = 0;
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_SIGNAL];
+         ptr_hook && (signal_hooks->count < count);
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted
+            && string_match (signal, HOOK_SIGNAL(ptr_hook, signal), 0))
+        {
+            signal_hooks->hooks[signal_hooks->count] = ptr_hook;
+            signal_hooks->count++;
+        }
+    }
+
+    /* too many signals sent: clear the index before adding this one */
+    if (hook_signal_index->items_count >= HOOK_SIGNAL_INDEX_MAX_SIGNALS)
+        hashtable_remove_all (hook_signal_index);
+
+    if (!hashtable_set (hook_signal_index, signal, signal_hooks))
+    {
+        free (signal_hooks);
+        return NULL;
+    }
+
+    return signal_hooks;
+}
+
+/*
+ * Callback called when a signal hook is added.
+ */
+
+void
+hook_signal_add_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    hook_signal_index_clear ();
+}
+
+/*
+ * Callback called when a signal hook is removed.
+ */
+
+void
+hook_signal_remove_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    hook_signal_index_clear ();
+}
+
+/*
+ * Executes callback of a signal hook.
+ *
+ * Returns return code of callback.
+ */
+
+int
+hook_signal_exec (struct t_hook *hook, const char *signal,
+                  const char *type_data, void *signal_data)
+{
+    int rc;
+
+    hook->running = 1;
+    rc = (HOOK_SIGNAL(hook, callback))
+        (hook->callback_pointer,
+         hook->callback_data,
+         signal,
+         type_data,
+         signal_data);
+    hook->running = 0;
+
+    return rc;
+}
+
 /*
  * Sends a signal.
+ *
+ * The hooks matching the signal are read in the index of signal hooks, so
+ * the masks of all signal hooks are compared only on first send of a signal.
  */
 
 int
 hook_signal_send (const char *signal, const char *type_data, void *signal_data)
 {
     struct t_hook *ptr_hook, *next_hook;
-    int rc;
+    struct t_hook_signal_hooks *signal_hooks;
+    int rc, i;
 
     rc = WEECHAT_RC_OK;
 
+    if (!signal)
+        return rc;
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_SIGNAL];
-    while (ptr_hook)
+    signal_hooks = hook_signal_index_get (signal);
+    if (signal_hooks)
     {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_match (signal, HOOK_SIGNAL(ptr_hook, signal), 0)))
+        signal_hooks->used++;
+        for (i = 0; i < signal_hooks->count; i++)
         {
-            ptr_hook->running = 1;
-            rc = (HOOK_SIGNAL(ptr_hook, callback))
-                (ptr_hook->callback_pointer,
-                 ptr_hook->callback_data,
-                 signal,
-                 type_data,
-                 signal_data);
-            ptr_hook->running = 0;
-
-            if (rc == WEECHAT_RC_OK_EAT)
-                break;
+            ptr_hook = signal_hooks->hooks[i];
+            if (!ptr_hook->deleted && !ptr_hook->running)
+            {
+                rc = hook_signal_exec (ptr_hook, signal, type_data,
+                                       signal_data);
+                if (rc == WEECHAT_RC_OK_EAT)
+                    break;
+            }
+        }
+        signal_hooks->used--;
+        if (signal_hooks->removed && (signal_hooks->used == 0))
+            free (signal_hooks);
+    }
+    else
+    {
+        /* not enough memory for index: check all signal hooks */
+        ptr_hook = weechat_hooks[HOOK_TYPE_SIGNAL];
+        while (ptr_hook)
+        {
+            next_hook = ptr_hook->next_hook;
+
+            if (!ptr_hook->deleted
+                && !ptr_hook->running
+                && (string_match (signal, HOOK_SIGNAL(ptr_hook, signal), 0)))
+            {
+                rc = hook_signal_exec (ptr_hook, signal, type_data,
+                                       signal_data);
+                if (rc == WEECHAT_RC_OK_EAT)
+                    break;
+            }
+
+            ptr_hook = next_hook;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
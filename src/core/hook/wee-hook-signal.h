@@ -22,9 +22,13 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_hashtable;
 
 #define HOOK_SIGNAL(hook, var) (((struct t_hook_signal *)hook->hook_data)->var)
 
+/* max number of signals in index (the index is cleared when it is full) */
+#define HOOK_SIGNAL_INDEX_MAX_SIGNALS 1024
+
 typedef int (t_hook_callback_signal)(const void *pointer, void *data,
                                      const char *signal, const char *type_data,
                                      void *signal_data);
@@ -36,6 +40,17 @@ struct t_hook_signal
                                        /* with "*", "*" == any signal)      */
 };
 
+struct t_hook_signal_hooks
+{
+    int count;                         /* number of hooks matching signal   */
+    struct t_hook **hooks;             /* hooks (sorted like the hooks list)*/
+    int used;                          /* > 0 if hooks are being called     */
+    int removed;                       /* 1 if removed from index: it will  */
+                                       /* be freed when it is not used      */
+};
+
+extern struct t_hashtable *hook_signal_index;
+
 extern struct t_hook *hook_signal (struct t_weechat_plugin *plugin,
                                    const char *signal,
                                    t_hook_callback_signal *callback,
@@ -43,6 +58,8 @@ extern struct t_hook *hook_signal (struct t_weechat_plugin *plugin,
                                    void *callback_data);
 extern int hook_signal_send (const char *signal, const char *type_data,
                              void *signal_data);
+extern void hook_signal_add_cb (struct t_hook *hook);
+extern void hook_signal_remove_cb (struct t_hook *hook);
 extern void hook_signal_free_data (struct t_hook *hook);
 extern int hook_signal_add_to_infolist (struct t_infolist_item *item,
                                         struct t_hook *hook);
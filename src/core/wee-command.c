@@ -1884,6 +1884,12 @@ COMMAND_CALLBACK(debug)
         return WEECHAT_RC_OK;
     }
 
+    if (string_strcasecmp (argv[1], "display") == 0)
+    {
+        debug_display ();
+        return WEECHAT_RC_OK;
+    }
+
     if (string_strcasecmp (argv[1], "set") == 0)
     {
         COMMAND_MIN_ARGS(4, "set");
@@ -2162,7 +2168,7 @@ COMMAND_CALLBACK(filter)
                 if (!buffer->filter)
                 {
                     buffer->filter = 1;
-                    gui_filter_buffer (buffer, NULL);
+                    gui_filter_buffer_check (buffer, 0);
                     (void) hook_signal_send (
                         "buffer_filters_enabled",
                         WEECHAT_HOOK_SIGNAL_POINTER, buffer);
@@ -2220,7 +2226,7 @@ COMMAND_CALLBACK(filter)
                 if (buffer->filter)
                 {
                     buffer->filter = 0;
-                    gui_filter_buffer (buffer, NULL);
+                    gui_filter_buffer_check (buffer, 0);
                     (void) hook_signal_send (
                         "buffer_filters_disabled",
                         WEECHAT_HOOK_SIGNAL_POINTER, buffer);
@@ -2276,7 +2282,7 @@ COMMAND_CALLBACK(filter)
             {
                 /* toggle filters in buffer */
                 buffer->filter ^= 1;
-                gui_filter_buffer (buffer, NULL);
+                gui_filter_buffer_check (buffer, 0);
                 (void) hook_signal_send (
                     (buffer->filter) ?
                     "buffer_filters_enabled" : "buffer_filters_disabled",
@@ -7257,7 +7263,7 @@ command_init ()
         N_("list"
            " || set <plugin> <level>"
            " || dump [<plugin>]"
-           " || buffer|color|infolists|memory|tags|term|windows"
+           " || buffer|color|display|infolists|memory|tags|term|windows"
            " || mouse|cursor [verbose]"
            " || hdata [free]"
            " || time <command>"),
@@ -7271,6 +7277,8 @@ command_init ()
            "    color: display infos about current color pairs\n"
            "   cursor: toggle debug for cursor mode\n"
            "     dirs: display directories\n"
+           "  display: display infos about display (cache of lines layout, "
+           "draws of chat areas and bars, updates of bar items)\n"
            "    hdata: display infos about hdata (with free: remove all hdata "
            "in memory)\n"
            "    hooks: display infos about hooks\n"
@@ -7290,6 +7298,7 @@ command_init ()
         " || color"
         " || cursor verbose"
         " || dirs"
+        " || display"
         " || hdata free"
         " || hooks"
         " || infolists"
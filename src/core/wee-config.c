@@ -567,6 +567,7 @@ config_change_buffers (const void *pointer, void *data,
     (void) data;
     (void) option;
 
+    gui_line_layout_reset_all ();
     gui_window_ask_refresh (1);
 }
 
@@ -1175,6 +1176,7 @@ config_change_tab_width (const void *pointer, void *data,
     memset (config_tab_spaces, ' ', CONFIG_INTEGER(config_look_tab_width));
     config_tab_spaces[CONFIG_INTEGER(config_look_tab_width)] = '\0';
 
+    gui_line_layout_reset_all ();
     gui_window_ask_refresh (1);
 }
 
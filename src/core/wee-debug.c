@@ -52,12 +52,14 @@
 #include "wee-util.h"
 #include "../gui/gui-bar.h"
 #include "../gui/gui-bar-item.h"
+#include "../gui/gui-bar-window.h"
 #include "../gui/gui-buffer.h"
 #include "../gui/gui-chat.h"
 #include "../gui/gui-filter.h"
 #include "../gui/gui-hotlist.h"
 #include "../gui/gui-key.h"
 #include "../gui/gui-layout.h"
+#include "../gui/gui-line.h"
 #include "../gui/gui-main.h"
 #include "../gui/gui-window.h"
 #include "../plugins/plugin.h"
@@ -411,6 +413,9 @@ debug_hooks ()
     }
     gui_chat_printf (NULL, "%17s------", "---------");
     gui_chat_printf (NULL, "%17s:%5d", "total", hooks_count_total);
+    gui_chat_printf (NULL, "");
+    gui_chat_printf (NULL, "fd hooks backend: %s",
+                     hook_fd_backend_string[hook_fd_backend]);
 }
 
 /*
@@ -594,6 +599,57 @@ debug_directories ()
     gui_chat_printf (NULL, "  locale: %s", LOCALEDIR);
 }
 
+/*
+ * Displays infos about display (cache of lines layout, draws of chat areas
+ * and bar windows, updates of bar items).
+ */
+
+void
+debug_display ()
+{
+    struct t_gui_bar_item *ptr_item;
+    unsigned long long total;
+
+    total = gui_line_layout_hits + gui_line_layout_misses;
+
+    gui_chat_printf (NULL, "");
+    gui_chat_printf (NULL, _("Display:"));
+    gui_chat_printf (NULL,
+                     _("  layout of lines: %llu found, %llu computed "
+                       "(hit rate: %.2f%%)"),
+                     gui_line_layout_hits,
+                     gui_line_layout_misses,
+                     (total > 0) ?
+                     ((double)gui_line_layout_hits * 100) / total : 0);
+    gui_chat_printf (NULL,
+                     _("  chat areas: %llu full draws, %llu draws of new "
+                       "lines only"),
+                     gui_chat_draws_full,
+                     gui_chat_draws_partial);
+    gui_chat_printf (NULL,
+                     _("  bar windows: %llu draws, %llu draws skipped "
+                       "(content unchanged)"),
+                     gui_bar_window_draws,
+                     gui_bar_window_draws_skipped);
+    gui_chat_printf (NULL,
+                     _("  bar items (updates requested, updates done, "
+                       "builds):"));
+    for (ptr_item = gui_bar_items; ptr_item; ptr_item = ptr_item->next_item)
+    {
+        if (ptr_item->updates_requested == 0)
+            continue;
+        gui_chat_printf (NULL,
+                         "    %s%s%s: %llu, %llu, %llu",
+                         (ptr_item->plugin) ?
+                         plugin_get_name (ptr_item->plugin) : "",
+                         (ptr_item->plugin) ? "/" : "",
+                         ptr_item->name,
+                         ptr_item->updates_requested,
+                         ptr_item->updates_done,
+                         ptr_item->builds);
+    }
+}
+
 /*
  * Display time elapsed between two times.
  *
@@ -140,9 +140,12 @@ eval_strstr_level (const char *string, const char *search,
 char *
 eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
 {
-    char *value, *old_value, *var_name, str_value[128], *pos;
-    const char *ptr_value, *hdata_name, *ptr_var_name;
-    int type;
+    char *value, *old_value, *var_name, str_var_name[128], str_value[128];
+    char *pos;
+    const char *ptr_value, *hdata_name;
+    void *ptr_var;
+    int type, length;
+    struct t_hdata_key key;
     struct t_hashtable *hashtable;
 
     value = NULL;
@@ -165,56 +168,69 @@ eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
      * hdata name is "window"
      */
     pos = strchr (path, '.');
-    if (pos > path)
-        var_name = string_strndup (path, pos - path);
+    length = (pos > path) ? pos - path : (int)strlen (path);
+    if (length < (int)sizeof (str_var_name))
+    {
+        memcpy (str_var_name, path, length);
+        str_var_name[length] = '\0';
+        var_name = str_var_name;
+    }
     else
-        var_name = strdup (path);
+    {
+        var_name = string_strndup (path, length);
+        if (!var_name)
+            goto end;
+    }
 
-    if (!var_name)
+    /*
+     * compile the variable (with optional index: "N|name"): it is searched
+     * only once in hdata, then its value is read with the compiled key
+     */
+    key.name = NULL;
+    if (!hdata_compile_key (hdata, var_name, &key, NULL))
         goto end;
 
-    /* search type of variable in hdata */
-    hdata_get_index_and_name (var_name, NULL, &ptr_var_name);
-    type = hdata_get_var_type (hdata, ptr_var_name);
-    if (type < 0)
+    ptr_var = hdata_key_get_value (&key, pointer);
+    if (!ptr_var)
         goto end;
+    type = key.var->type;
 
     /* build a string with the value or variable */
     switch (type)
     {
         case WEECHAT_HDATA_CHAR:
             snprintf (str_value, sizeof (str_value),
-                      "%c", hdata_char (hdata, pointer, var_name));
+                      "%c", *((char *)ptr_var));
             value = strdup (str_value);
             break;
         case WEECHAT_HDATA_INTEGER:
             snprintf (str_value, sizeof (str_value),
-                      "%d", hdata_integer (hdata, pointer, var_name));
+                      "%d", *((int *)ptr_var));
             value = strdup (str_value);
             break;
         case WEECHAT_HDATA_LONG:
             snprintf (str_value, sizeof (str_value),
-                      "%ld", hdata_long (hdata, pointer, var_name));
+                      "%ld", *((long *)ptr_var));
             value = strdup (str_value);
             break;
         case WEECHAT_HDATA_STRING:
         case WEECHAT_HDATA_SHARED_STRING:
-            ptr_value = hdata_string (hdata, pointer, var_name);
+            ptr_value = *((char **)ptr_var);
             value = (ptr_value) ? strdup (ptr_value) : NULL;
             break;
         case WEECHAT_HDATA_POINTER:
-            pointer = hdata_pointer (hdata, pointer, var_name);
+            pointer = *((void **)ptr_var);
             snprintf (str_value, sizeof (str_value),
                       "0x%lx", (unsigned long)pointer);
             value = strdup (str_value);
             break;
         case WEECHAT_HDATA_TIME:
             snprintf (str_value, sizeof (str_value),
-                      "%lld", (long long)hdata_time (hdata, pointer, var_name));
+                      "%lld", (long long)(*((time_t *)ptr_var)));
             value = strdup (str_value);
             break;
         case WEECHAT_HDATA_HASHTABLE:
-            pointer = hdata_hashtable (hdata, pointer, var_name);
+            pointer = *((struct t_hashtable **)ptr_var);
             if (pos)
             {
                 /*
@@ -266,19 +282,19 @@ eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
      */
     if ((type == WEECHAT_HDATA_POINTER) && pos)
     {
-        hdata_name = hdata_get_var_hdata (hdata, var_name);
+        hdata_name = key.var->hdata_name;
         if (!hdata_name)
             goto end;
 
         hdata = hook_hdata_get (NULL, hdata_name);
         old_value = value;
-        value = eval_hdata_get_value (hdata, pointer, (pos) ? pos + 1 : NULL);
+        value = eval_hdata_get_value (hdata, pointer, pos + 1);
         if (old_value)
             free (old_value);
     }
 
 end:
-    if (var_name)
+    if (var_name && (var_name != str_var_name))
         free (var_name);
 
     return value;
@@ -1311,6 +1327,7 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
                                   NULL);
         if (!pointers)
             return NULL;
+        hashtable_set_arena (pointers, 0);
         pointers_allocated = 1;
     }
 
@@ -41,6 +41,8 @@ char *hashtable_type_string[HASHTABLE_NUM_TYPES] =
 { WEECHAT_HASHTABLE_INTEGER, WEECHAT_HASHTABLE_STRING,
   WEECHAT_HASHTABLE_POINTER, WEECHAT_HASHTABLE_BUFFER,
   WEECHAT_HASHTABLE_TIME };
+char *hashtable_engine_string[HASHTABLE_NUM_ENGINES] =
+{ "chained", "open" };
 
 
 /*
@@ -177,26 +179,29 @@ hashtable_keycmp_default_cb (struct t_hashtable *hashtable,
 }
 
 /*
- * Creates a new hashtable.
+ * Creates a new hashtable using the given engine.
  *
- * The size is NOT a limit for number of items in hashtable. It is the size of
- * internal array to store hashed keys: a high value uses more memory, but has
- * better performance because this reduces the collisions of hashed keys and
- * then reduces length of linked lists.
+ * With engine "chained", the size is NOT a limit for number of items in
+ * hashtable. It is the size of internal array to store hashed keys: a high
+ * value uses more memory, but has better performance because this reduces the
+ * collisions of hashed keys and then reduces length of linked lists.
+ *
+ * With engine "open", the size is the initial size of the array of entries
+ * (rounded up to a power of 2), which is automatically enlarged when needed.
  *
  * Returns pointer to new hashtable, NULL if error.
  */
 
 struct t_hashtable *
-hashtable_new (int size,
-               const char *type_keys, const char *type_values,
-               t_hashtable_hash_key *callback_hash_key,
-               t_hashtable_keycmp *callback_keycmp)
+hashtable_new_with_engine (enum t_hashtable_engine engine, int size,
+                           const char *type_keys, const char *type_values,
+                           t_hashtable_hash_key *callback_hash_key,
+                           t_hashtable_keycmp *callback_keycmp)
 {
     struct t_hashtable *new_hashtable;
-    int i, type_keys_int, type_values_int;
+    int i, type_keys_int, type_values_int, size_open;
 
-    if (size <= 0)
+    if ((size <= 0) || (engine < 0) || (engine >= HASHTABLE_NUM_ENGINES))
         return NULL;
 
     type_keys_int = hashtable_get_type (type_keys);
@@ -213,21 +218,47 @@ hashtable_new (int size,
     new_hashtable = malloc (sizeof (*new_hashtable));
     if (new_hashtable)
     {
-        new_hashtable->size = size;
+        new_hashtable->engine = engine;
         new_hashtable->type_keys = type_keys_int;
         new_hashtable->type_values = type_values_int;
-        new_hashtable->htable = malloc (size * sizeof (*(new_hashtable->htable)));
+        new_hashtable->htable = NULL;
+        new_hashtable->entries = NULL;
         new_hashtable->keys_values = NULL;
-        if (!new_hashtable->htable)
+        if (engine == HASHTABLE_ENGINE_OPEN)
         {
-            free (new_hashtable);
-            return NULL;
+            size_open = HASHTABLE_OPEN_MIN_SIZE;
+            while ((size_open < size) && (size_open < (1 << 30)))
+            {
+                size_open *= 2;
+            }
+            new_hashtable->size = size_open;
+            new_hashtable->entries = calloc (size_open,
+                                             sizeof (*(new_hashtable->entries)));
+            if (!new_hashtable->entries)
+            {
+                free (new_hashtable);
+                return NULL;
+            }
         }
-        for (i = 0; i < size; i++)
+        else
         {
-            new_hashtable->htable[i] = NULL;
+            new_hashtable->size = size;
+            new_hashtable->htable = malloc (size * sizeof (*(new_hashtable->htable)));
+            if (!new_hashtable->htable)
+            {
+                free (new_hashtable);
+                return NULL;
+            }
+            for (i = 0; i < size; i++)
+            {
+                new_hashtable->htable[i] = NULL;
+            }
         }
+        new_hashtable->deleted_count = 0;
+        new_hashtable->map_running = 0;
         new_hashtable->items_count = 0;
+        new_hashtable->arena_block_size = 0;
+        new_hashtable->arena = NULL;
 
         new_hashtable->callback_hash_key = (callback_hash_key) ?
             callback_hash_key : &hashtable_hash_key_default_cb;
@@ -240,21 +271,133 @@ hashtable_new (int size,
     return new_hashtable;
 }
 
+/*
+ * Creates a new hashtable (with default engine: "chained").
+ *
+ * The size is NOT a limit for number of items in hashtable. It is the size of
+ * internal array to store hashed keys: a high value uses more memory, but has
+ * better performance because this reduces the collisions of hashed keys and
+ * then reduces length of linked lists.
+ *
+ * Returns pointer to new hashtable, NULL if error.
+ */
+
+struct t_hashtable *
+hashtable_new (int size,
+               const char *type_keys, const char *type_values,
+               t_hashtable_hash_key *callback_hash_key,
+               t_hashtable_keycmp *callback_keycmp)
+{
+    return hashtable_new_with_engine (HASHTABLE_ENGINE_CHAINED, size,
+                                      type_keys, type_values,
+                                      callback_hash_key, callback_keycmp);
+}
+
+/*
+ * Allocates memory in the arena of a hashtable.
+ *
+ * Returns pointer to allocated memory, NULL if error.
+ */
+
+void *
+hashtable_arena_alloc (struct t_hashtable *hashtable, int size)
+{
+    struct t_hashtable_arena_block *ptr_block, *new_block;
+    int header_size, block_size;
+    char *ptr_data;
+
+    header_size = (sizeof (*new_block) + HASHTABLE_ARENA_ALIGN - 1)
+        & ~(HASHTABLE_ARENA_ALIGN - 1);
+    size = (size + HASHTABLE_ARENA_ALIGN - 1) & ~(HASHTABLE_ARENA_ALIGN - 1);
+
+    ptr_block = hashtable->arena;
+    if (!ptr_block || (ptr_block->used + size > ptr_block->size))
+    {
+        block_size = (size > hashtable->arena_block_size) ?
+            size : hashtable->arena_block_size;
+        new_block = malloc (header_size + block_size);
+        if (!new_block)
+            return NULL;
+        new_block->size = block_size;
+        new_block->used = 0;
+        new_block->next_block = hashtable->arena;
+        hashtable->arena = new_block;
+        ptr_block = new_block;
+    }
+
+    ptr_data = (char *)ptr_block + header_size + ptr_block->used;
+    ptr_block->used += size;
+
+    return ptr_data;
+}
+
+/*
+ * Releases memory allocated in the arena of a hashtable.
+ *
+ * If keep_first_block == 1, the current block is kept (and emptied) so that
+ * it can be reused for next items.
+ */
+
+void
+hashtable_arena_release (struct t_hashtable *hashtable, int keep_first_block)
+{
+    struct t_hashtable_arena_block *ptr_block, *next_block;
+
+    if (!hashtable->arena)
+        return;
+
+    ptr_block = (keep_first_block) ?
+        hashtable->arena->next_block : hashtable->arena;
+    while (ptr_block)
+    {
+        next_block = ptr_block->next_block;
+        free (ptr_block);
+        ptr_block = next_block;
+    }
+
+    if (keep_first_block)
+    {
+        hashtable->arena->used = 0;
+        hashtable->arena->next_block = NULL;
+    }
+    else
+    {
+        hashtable->arena = NULL;
+    }
+}
+
+/*
+ * Allocates memory for an item, a key or a value: in the arena if the
+ * hashtable uses one, otherwise with malloc.
+ *
+ * Returns pointer to allocated memory, NULL if error.
+ */
+
+void *
+hashtable_malloc (struct t_hashtable *hashtable, int size)
+{
+    return (hashtable->arena_block_size > 0) ?
+        hashtable_arena_alloc (hashtable, size) : malloc (size);
+}
+
 /*
  * Allocates space for a key or value.
  */
 
 void
-hashtable_alloc_type (enum t_hashtable_type type,
+hashtable_alloc_type (struct t_hashtable *hashtable,
+                      enum t_hashtable_type type,
                       const void *value, int size_value,
                       void **pointer, int *size)
 {
+    int length;
+
     switch (type)
     {
         case HASHTABLE_INTEGER:
             if (value)
             {
-                *pointer = malloc (sizeof (int));
+                *pointer = hashtable_malloc (hashtable, sizeof (int));
                 if (*pointer)
                     *((int *)(*pointer)) = *((int *)value);
             }
@@ -263,7 +406,15 @@ hashtable_alloc_type (enum t_hashtable_type type,
             *size = (*pointer) ? sizeof (int) : 0;
             break;
         case HASHTABLE_STRING:
-            *pointer = (value) ? strdup ((const char *)value) : NULL;
+            if (value)
+            {
+                length = strlen ((const char *)value) + 1;
+                *pointer = hashtable_malloc (hashtable, length);
+                if (*pointer)
+                    memcpy (*pointer, value, length);
+            }
+            else
+                *pointer = NULL;
             *size = (*pointer) ? strlen (*pointer) + 1 : 0;
             break;
         case HASHTABLE_POINTER:
@@ -273,7 +424,7 @@ hashtable_alloc_type (enum t_hashtable_type type,
         case HASHTABLE_BUFFER:
             if (value && (size_value > 0))
             {
-                *pointer = malloc (size_value);
+                *pointer = hashtable_malloc (hashtable, size_value);
                 if (*pointer)
                     memcpy (*pointer, value, size_value);
             }
@@ -284,7 +435,7 @@ hashtable_alloc_type (enum t_hashtable_type type,
         case HASHTABLE_TIME:
             if (value)
             {
-                *pointer = malloc (sizeof (time_t));
+                *pointer = hashtable_malloc (hashtable, sizeof (time_t));
                 if (*pointer)
                     *((time_t *)(*pointer)) = *((time_t *)value);
             }
@@ -305,12 +456,19 @@ void
 hashtable_free_key (struct t_hashtable *hashtable,
                     struct t_hashtable_item *item)
 {
+    /* key stored inside the entry ("open" engine): nothing to free */
+    if ((hashtable->engine == HASHTABLE_ENGINE_OPEN)
+        && (item->key == ((struct t_hashtable_entry *)item)->key_inline))
+    {
+        return;
+    }
+
     if (hashtable->callback_free_key)
     {
         (void) (hashtable->callback_free_key) (hashtable,
                                                item->key);
     }
-    else
+    else if (hashtable->arena_block_size == 0)
     {
         switch (hashtable->type_keys)
         {
@@ -343,7 +501,7 @@ hashtable_free_value (struct t_hashtable *hashtable,
                                                  item->key,
                                                  item->value);
     }
-    else
+    else if (hashtable->arena_block_size == 0)
     {
         switch (hashtable->type_values)
         {
@@ -362,6 +520,240 @@ hashtable_free_value (struct t_hashtable *hashtable,
     }
 }
 
+/*
+ * Returns the first index to probe for a hash in a hashtable with engine
+ * "open" (size must be a power of 2).
+ *
+ * The hash is mixed first: the low bits of some hash functions (like djb2)
+ * are not well distributed, which would create long sequences of entries
+ * with linear probing.
+ */
+
+int
+hashtable_open_index (unsigned long long hash, int size)
+{
+    hash *= 0x9E3779B97F4A7C15ULL;
+    hash ^= hash >> 32;
+    return (int)(hash & (unsigned long long)(size - 1));
+}
+
+/*
+ * Searches for a key in a hashtable with engine "open".
+ *
+ * If index_free is not NULL, it is set with the index of the first entry that
+ * can be used to store the key if it is not found (-1 if the array is full).
+ *
+ * Returns index of entry with the key, -1 if the key is not found.
+ */
+
+int
+hashtable_open_search (struct t_hashtable *hashtable, const void *key,
+                       unsigned long long hash, int *index_free)
+{
+    struct t_hashtable_entry *ptr_entry;
+    int i, index, first_free;
+
+    first_free = -1;
+    index = hashtable_open_index (hash, hashtable->size);
+
+    for (i = 0; i < hashtable->size; i++)
+    {
+        ptr_entry = &hashtable->entries[index];
+        if (ptr_entry->state == HASHTABLE_ENTRY_EMPTY)
+        {
+            if (first_free < 0)
+                first_free = index;
+            break;
+        }
+        if (ptr_entry->state == HASHTABLE_ENTRY_DELETED)
+        {
+            if (first_free < 0)
+                first_free = index;
+        }
+        else if ((ptr_entry->hash == hash)
+                 && (hashtable->callback_keycmp (hashtable, key,
+                                                 ptr_entry->item.key) == 0))
+        {
+            if (index_free)
+                *index_free = first_free;
+            return index;
+        }
+        index = (index + 1) & (hashtable->size - 1);
+    }
+
+    if (index_free)
+        *index_free = first_free;
+
+    return -1;
+}
+
+/*
+ * Resizes the array of entries in a hashtable with engine "open" (new_size
+ * must be a power of 2); deleted entries are removed.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hashtable_open_resize (struct t_hashtable *hashtable, int new_size)
+{
+    struct t_hashtable_entry *new_entries, *ptr_old, *ptr_new;
+    int i, index;
+
+    if (new_size < hashtable->items_count + 1)
+        return 0;
+
+    new_entries = calloc (new_size, sizeof (*new_entries));
+    if (!new_entries)
+        return 0;
+
+    for (i = 0; i < hashtable->size; i++)
+    {
+        ptr_old = &hashtable->entries[i];
+        if (ptr_old->state != HASHTABLE_ENTRY_USED)
+            continue;
+        index = hashtable_open_index (ptr_old->hash, new_size);
+        while (new_entries[index].state != HASHTABLE_ENTRY_EMPTY)
+        {
+            index = (index + 1) & (new_size - 1);
+        }
+        ptr_new = &new_entries[index];
+        memcpy (ptr_new, ptr_old, sizeof (*ptr_new));
+        if (ptr_old->item.key == ptr_old->key_inline)
+            ptr_new->item.key = ptr_new->key_inline;
+    }
+
+    free (hashtable->entries);
+    hashtable->entries = new_entries;
+    hashtable->size = new_size;
+    hashtable->deleted_count = 0;
+
+    return 1;
+}
+
+/*
+ * Sets value for a key in hashtable with engine "open".
+ *
+ * Returns pointer to item created/updated, NULL if error.
+ */
+
+struct t_hashtable_item *
+hashtable_open_set (struct t_hashtable *hashtable,
+                    const void *key, int key_size,
+                    const void *value, int value_size)
+{
+    struct t_hashtable_entry *ptr_entry;
+    unsigned long long hash;
+    int index, index_free, new_size, length;
+
+    hash = hashtable->callback_hash_key (hashtable, key);
+
+    /* replace value if item is already in hashtable */
+    index = hashtable_open_search (hashtable, key, hash, &index_free);
+    if (index >= 0)
+    {
+        ptr_entry = &hashtable->entries[index];
+        hashtable_free_value (hashtable, &ptr_entry->item);
+        hashtable_alloc_type (hashtable, hashtable->type_values,
+                              value, value_size,
+                              &ptr_entry->item.value,
+                              &ptr_entry->item.value_size);
+        return &ptr_entry->item;
+    }
+
+    /*
+     * enlarge the array (or just remove deleted entries) if the load factor
+     * is too high; this is not done during a map, because the callback is
+     * allowed to add items
+     */
+    if (!hashtable->map_running
+        && ((hashtable->items_count + hashtable->deleted_count + 1) * 100 >
+            hashtable->size * HASHTABLE_OPEN_MAX_LOAD))
+    {
+        new_size = hashtable->size;
+        if ((hashtable->items_count + 1) * 200 >
+            hashtable->size * HASHTABLE_OPEN_MAX_LOAD)
+        {
+            new_size *= 2;
+        }
+        if (hashtable_open_resize (hashtable, new_size))
+            hashtable_open_search (hashtable, key, hash, &index_free);
+    }
+
+    if (index_free < 0)
+        return NULL;
+
+    ptr_entry = &hashtable->entries[index_free];
+    if (ptr_entry->state == HASHTABLE_ENTRY_DELETED)
+        hashtable->deleted_count--;
+
+    /* set key (small strings are stored in the entry) and value */
+    if ((hashtable->type_keys == HASHTABLE_STRING)
+        && !hashtable->callback_free_key
+        && ((length = strlen ((const char *)key)) < HASHTABLE_OPEN_KEY_INLINE_SIZE))
+    {
+        memcpy (ptr_entry->key_inline, key, length + 1);
+        ptr_entry->item.key = ptr_entry->key_inline;
+        ptr_entry->item.key_size = length + 1;
+    }
+    else
+    {
+        hashtable_alloc_type (hashtable, hashtable->type_keys,
+                              key, key_size,
+                              &ptr_entry->item.key,
+                              &ptr_entry->item.key_size);
+    }
+    hashtable_alloc_type (hashtable, hashtable->type_values,
+                          value, value_size,
+                          &ptr_entry->item.value, &ptr_entry->item.value_size);
+    ptr_entry->item.prev_item = NULL;
+    ptr_entry->item.next_item = NULL;
+    ptr_entry->hash = hash;
+    ptr_entry->state = HASHTABLE_ENTRY_USED;
+
+    hashtable->items_count++;
+
+    return &ptr_entry->item;
+}
+
+/*
+ * Gets next item in hashtable (used to iterate over all items, in no
+ * particular order).
+ *
+ * Argument "index" is the current index in internal array, it must be
+ * initialized to -1 and "item" to NULL to get first item.
+ *
+ * Returns pointer to next item, NULL if there are no more items.
+ */
+
+struct t_hashtable_item *
+hashtable_next_item (struct t_hashtable *hashtable, int *index,
+                     struct t_hashtable_item *item)
+{
+    if (hashtable->engine == HASHTABLE_ENGINE_OPEN)
+    {
+        for ((*index)++; *index < hashtable->size; (*index)++)
+        {
+            if (hashtable->entries[*index].state == HASHTABLE_ENTRY_USED)
+                return &hashtable->entries[*index].item;
+        }
+        return NULL;
+    }
+
+    if (item && item->next_item)
+        return item->next_item;
+
+    for ((*index)++; *index < hashtable->size; (*index)++)
+    {
+        if (hashtable->htable[*index])
+            return hashtable->htable[*index];
+    }
+
+    return NULL;
+}
+
 /*
  * Sets value for a key in hashtable.
  *
@@ -385,6 +777,12 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
         return NULL;
     }
 
+    if (hashtable->engine == HASHTABLE_ENGINE_OPEN)
+    {
+        return hashtable_open_set (hashtable, key, key_size,
+                                   value, value_size);
+    }
+
     /* search position for item in hashtable */
     hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
     pos_item = NULL;
@@ -400,22 +798,22 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
     if (ptr_item && (hashtable->callback_keycmp (hashtable, key, ptr_item->key) == 0))
     {
         hashtable_free_value (hashtable, ptr_item);
-        hashtable_alloc_type (hashtable->type_values,
+        hashtable_alloc_type (hashtable, hashtable->type_values,
                               value, value_size,
                               &ptr_item->value, &ptr_item->value_size);
         return ptr_item;
     }
 
     /* create new item */
-    new_item = malloc (sizeof (*new_item));
+    new_item = hashtable_malloc (hashtable, sizeof (*new_item));
     if (!new_item)
         return NULL;
 
     /* set key and value */
-    hashtable_alloc_type (hashtable->type_keys,
+    hashtable_alloc_type (hashtable, hashtable->type_keys,
                           key, key_size,
                           &new_item->key, &new_item->key_size);
-    hashtable_alloc_type (hashtable->type_values,
+    hashtable_alloc_type (hashtable, hashtable->type_values,
                           value, value_size,
                           &new_item->value, &new_item->value_size);
 
@@ -473,10 +871,22 @@ hashtable_get_item (struct t_hashtable *hashtable, const void *key,
 {
     unsigned long long key_hash;
     struct t_hashtable_item *ptr_item;
+    int index;
 
     if (!hashtable || !key)
         return NULL;
 
+    if (hashtable->engine == HASHTABLE_ENGINE_OPEN)
+    {
+        index = hashtable_open_search (hashtable, key,
+                                       hashtable->callback_hash_key (hashtable,
+                                                                     key),
+                                       NULL);
+        if (hash)
+            *hash = (index >= 0) ? (unsigned long long)index : 0;
+        return (index >= 0) ? &hashtable->entries[index].item : NULL;
+    }
+
     key_hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
     if (hash)
         *hash = key_hash;
@@ -574,27 +984,39 @@ hashtable_map (struct t_hashtable *hashtable,
                t_hashtable_map *callback_map,
                void *callback_map_data)
 {
-    int i;
+    int index;
     struct t_hashtable_item *ptr_item, *ptr_next_item;
 
     if (!hashtable)
         return;
 
-    for (i = 0; i < hashtable->size; i++)
-    {
-        ptr_item = hashtable->htable[i];
-        while (ptr_item)
-        {
-            ptr_next_item = ptr_item->next_item;
+    hashtable->map_running++;
 
-            (void) (callback_map) (callback_map_data,
-                                   hashtable,
-                                   ptr_item->key,
-                                   ptr_item->value);
-
-            ptr_item = ptr_next_item;
-        }
+    index = -1;
+    ptr_item = hashtable_next_item (hashtable, &index, NULL);
+    while (ptr_item)
+    {
+        /*
+         * with engine "chained", next item is read before the callback
+         * (the callback can remove current item); with engine "open", items
+         * are not moved during map, so next item is read after the callback
+         * (the callback can remove any item)
+         */
+        ptr_next_item = (hashtable->engine == HASHTABLE_ENGINE_CHAINED) ?
+            hashtable_next_item (hashtable, &index, ptr_item) : NULL;
+
+        (void) (callback_map) (callback_map_data,
+                               hashtable,
+                               ptr_item->key,
+                               ptr_item->value);
+
+        if (hashtable->engine == HASHTABLE_ENGINE_OPEN)
+            ptr_next_item = hashtable_next_item (hashtable, &index, NULL);
+
+        ptr_item = ptr_next_item;
     }
+
+    hashtable->map_running--;
 }
 
 /*
@@ -606,7 +1028,7 @@ hashtable_map_string (struct t_hashtable *hashtable,
                       t_hashtable_map_string *callback_map,
                       void *callback_map_data)
 {
-    int i;
+    int index;
     struct t_hashtable_item *ptr_item, *ptr_next_item;
     const char *str_key, *str_value;
     char *key, *value;
@@ -614,34 +1036,41 @@ hashtable_map_string (struct t_hashtable *hashtable,
     if (!hashtable)
         return;
 
-    for (i = 0; i < hashtable->size; i++)
+    hashtable->map_running++;
+
+    index = -1;
+    ptr_item = hashtable_next_item (hashtable, &index, NULL);
+    while (ptr_item)
     {
-        ptr_item = hashtable->htable[i];
-        while (ptr_item)
-        {
-            ptr_next_item = ptr_item->next_item;
+        /* see comment in function hashtable_map */
+        ptr_next_item = (hashtable->engine == HASHTABLE_ENGINE_CHAINED) ?
+            hashtable_next_item (hashtable, &index, ptr_item) : NULL;
 
-            str_key = hashtable_to_string (hashtable->type_keys,
-                                           ptr_item->key);
-            key = (str_key) ? strdup (str_key) : NULL;
+        str_key = hashtable_to_string (hashtable->type_keys,
+                                       ptr_item->key);
+        key = (str_key) ? strdup (str_key) : NULL;
 
-            str_value = hashtable_to_string (hashtable->type_values,
-                                             ptr_item->value);
-            value = (str_value) ? strdup (str_value) : NULL;
+        str_value = hashtable_to_string (hashtable->type_values,
+                                         ptr_item->value);
+        value = (str_value) ? strdup (str_value) : NULL;
 
-            (void) (callback_map) (callback_map_data,
-                                   hashtable,
-                                   key,
-                                   value);
+        (void) (callback_map) (callback_map_data,
+                               hashtable,
+                               key,
+                               value);
 
-            if (key)
-                free (key);
-            if (value)
-                free (value);
+        if (key)
+            free (key);
+        if (value)
+            free (value);
 
-            ptr_item = ptr_next_item;
-        }
+        if (hashtable->engine == HASHTABLE_ENGINE_OPEN)
+            ptr_next_item = hashtable_next_item (hashtable, &index, NULL);
+
+        ptr_item = ptr_next_item;
     }
+
+    hashtable->map_running--;
 }
 
 /*
@@ -675,11 +1104,13 @@ hashtable_dup (struct t_hashtable *hashtable)
 {
     struct t_hashtable *new_hashtable;
 
-    new_hashtable = hashtable_new (hashtable->size,
-                                   hashtable_type_string[hashtable->type_keys],
-                                   hashtable_type_string[hashtable->type_values],
-                                   hashtable->callback_hash_key,
-                                   hashtable->callback_keycmp);
+    new_hashtable = hashtable_new_with_engine (
+        hashtable->engine,
+        hashtable->size,
+        hashtable_type_string[hashtable->type_keys],
+        hashtable_type_string[hashtable->type_values],
+        hashtable->callback_hash_key,
+        hashtable->callback_keycmp);
     if (new_hashtable)
     {
         new_hashtable->callback_free_key = hashtable->callback_free_key;
@@ -995,7 +1426,9 @@ hashtable_get_string (struct t_hashtable *hashtable, const char *property)
 {
     if (hashtable && property)
     {
-        if (string_strcasecmp (property, "type_keys") == 0)
+        if (string_strcasecmp (property, "engine") == 0)
+            return hashtable_engine_string[hashtable->engine];
+        else if (string_strcasecmp (property, "type_keys") == 0)
             return hashtable_type_string[hashtable->type_keys];
         else if (string_strcasecmp (property, "type_values") == 0)
             return hashtable_type_string[hashtable->type_values];
@@ -1014,6 +1447,34 @@ hashtable_get_string (struct t_hashtable *hashtable, const char *property)
     return NULL;
 }
 
+/*
+ * Uses an arena to allocate items, keys and values of hashtable (must be
+ * called when the hashtable is empty).
+ *
+ * The memory allocated in arena is released when all items are removed
+ * (function hashtable_remove_all) or when the hashtable is freed; memory of
+ * items removed or values replaced is NOT released before.
+ *
+ * If block_size is <= 0, a default size is used.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hashtable_set_arena (struct t_hashtable *hashtable, int block_size)
+{
+    if (!hashtable || (hashtable->items_count > 0))
+        return 0;
+
+    hashtable_arena_release (hashtable, 0);
+    hashtable->arena_block_size = (block_size > 0) ?
+        block_size : HASHTABLE_ARENA_BLOCK_SIZE;
+
+    return 1;
+}
+
 /*
  * Sets a hashtable property (pointer).
  */
@@ -1044,7 +1505,7 @@ hashtable_add_to_infolist (struct t_hashtable *hashtable,
                            struct t_infolist_item *infolist_item,
                            const char *prefix)
 {
-    int i, item_number;
+    int index, item_number;
     struct t_hashtable_item *ptr_item;
     char option_name[128];
 
@@ -1052,52 +1513,50 @@ hashtable_add_to_infolist (struct t_hashtable *hashtable,
         return 0;
 
     item_number = 0;
-    for (i = 0; i < hashtable->size; i++)
+    index = -1;
+    for (ptr_item = hashtable_next_item (hashtable, &index, NULL); ptr_item;
+         ptr_item = hashtable_next_item (hashtable, &index, ptr_item))
     {
-        for (ptr_item = hashtable->htable[i]; ptr_item;
-             ptr_item = ptr_item->next_item)
+        snprintf (option_name, sizeof (option_name),
+                  "%s_name_%05d", prefix, item_number);
+        if (!infolist_new_var_string (infolist_item, option_name,
+                                      hashtable_to_string (hashtable->type_keys,
+                                                           ptr_item->key)))
+            return 0;
+        snprintf (option_name, sizeof (option_name),
+                  "%s_value_%05d", prefix, item_number);
+        switch (hashtable->type_values)
         {
-            snprintf (option_name, sizeof (option_name),
-                      "%s_name_%05d", prefix, item_number);
-            if (!infolist_new_var_string (infolist_item, option_name,
-                                          hashtable_to_string (hashtable->type_keys,
-                                                               ptr_item->key)))
-                return 0;
-            snprintf (option_name, sizeof (option_name),
-                      "%s_value_%05d", prefix, item_number);
-            switch (hashtable->type_values)
-            {
-                case HASHTABLE_INTEGER:
-                    if (!infolist_new_var_integer (infolist_item, option_name,
-                                                   *((int *)ptr_item->value)))
-                        return 0;
-                    break;
-                case HASHTABLE_STRING:
-                    if (!infolist_new_var_string (infolist_item, option_name,
-                                                  (const char *)ptr_item->value))
-                        return 0;
-                    break;
-                case HASHTABLE_POINTER:
-                    if (!infolist_new_var_pointer (infolist_item, option_name,
-                                                   ptr_item->value))
-                        return 0;
-                    break;
-                case HASHTABLE_BUFFER:
-                    if (!infolist_new_var_buffer (infolist_item, option_name,
-                                                  ptr_item->value,
-                                                  ptr_item->value_size))
-                        return 0;
-                    break;
-                case HASHTABLE_TIME:
-                    if (!infolist_new_var_time (infolist_item, option_name,
-                                                *((time_t *)ptr_item->value)))
-                        return 0;
-                    break;
-                case HASHTABLE_NUM_TYPES:
-                    break;
-            }
-            item_number++;
+            case HASHTABLE_INTEGER:
+                if (!infolist_new_var_integer (infolist_item, option_name,
+                                               *((int *)ptr_item->value)))
+                    return 0;
+                break;
+            case HASHTABLE_STRING:
+                if (!infolist_new_var_string (infolist_item, option_name,
+                                              (const char *)ptr_item->value))
+                    return 0;
+                break;
+            case HASHTABLE_POINTER:
+                if (!infolist_new_var_pointer (infolist_item, option_name,
+                                               ptr_item->value))
+                    return 0;
+                break;
+            case HASHTABLE_BUFFER:
+                if (!infolist_new_var_buffer (infolist_item, option_name,
+                                              ptr_item->value,
+                                              ptr_item->value_size))
+                    return 0;
+                break;
+            case HASHTABLE_TIME:
+                if (!infolist_new_var_time (infolist_item, option_name,
+                                            *((time_t *)ptr_item->value)))
+                    return 0;
+                break;
+            case HASHTABLE_NUM_TYPES:
+                break;
         }
+        item_number++;
     }
     return 1;
 }
@@ -1196,6 +1655,9 @@ hashtable_remove_item (struct t_hashtable *hashtable,
                        struct t_hashtable_item *item,
                        unsigned long long hash)
 {
+    struct t_hashtable_entry *ptr_entry;
+    int next_index;
+
     if (!hashtable || !item)
         return;
 
@@ -1203,6 +1665,29 @@ hashtable_remove_item (struct t_hashtable *hashtable,
     hashtable_free_value (hashtable, item);
     hashtable_free_key (hashtable, item);
 
+    if (hashtable->engine == HASHTABLE_ENGINE_OPEN)
+    {
+        /*
+         * mark entry as deleted (tombstone), or as empty if next entry is
+         * empty (then no search can go through this entry)
+         */
+        ptr_entry = (struct t_hashtable_entry *)item;
+        next_index = ((int)(ptr_entry - hashtable->entries) + 1)
+            & (hashtable->size - 1);
+        memset (&ptr_entry->item, 0, sizeof (ptr_entry->item));
+        if (hashtable->entries[next_index].state == HASHTABLE_ENTRY_EMPTY)
+        {
+            ptr_entry->state = HASHTABLE_ENTRY_EMPTY;
+        }
+        else
+        {
+            ptr_entry->state = HASHTABLE_ENTRY_DELETED;
+            hashtable->deleted_count++;
+        }
+        hashtable->items_count--;
+        return;
+    }
+
     /* remove item from list */
     if (item->prev_item)
         (item->prev_item)->next_item = item->next_item;
@@ -1211,7 +1696,8 @@ hashtable_remove_item (struct t_hashtable *hashtable,
     if (hashtable->htable[hash] == item)
         hashtable->htable[hash] = item->next_item;
 
-    free (item);
+    if (hashtable->arena_block_size == 0)
+        free (item);
 
     hashtable->items_count--;
 }
@@ -1246,13 +1732,34 @@ hashtable_remove_all (struct t_hashtable *hashtable)
     if (!hashtable)
         return;
 
-    for (i = 0; i < hashtable->size; i++)
+    if (hashtable->engine == HASHTABLE_ENGINE_OPEN)
+    {
+        for (i = 0; i < hashtable->size; i++)
+        {
+            if (hashtable->entries[i].state == HASHTABLE_ENTRY_USED)
+            {
+                hashtable_free_value (hashtable, &hashtable->entries[i].item);
+                hashtable_free_key (hashtable, &hashtable->entries[i].item);
+            }
+        }
+        memset (hashtable->entries, 0,
+                hashtable->size * sizeof (*(hashtable->entries)));
+        hashtable->items_count = 0;
+        hashtable->deleted_count = 0;
+    }
+    else
     {
-        while (hashtable->htable[i])
+        for (i = 0; i < hashtable->size; i++)
         {
-            hashtable_remove_item (hashtable, hashtable->htable[i], i);
+            while (hashtable->htable[i])
+            {
+                hashtable_remove_item (hashtable, hashtable->htable[i], i);
+            }
         }
     }
+
+    /* all items are removed: the arena can be reused */
+    hashtable_arena_release (hashtable, 1);
 }
 
 /*
@@ -1266,12 +1773,71 @@ hashtable_free (struct t_hashtable *hashtable)
         return;
 
     hashtable_remove_all (hashtable);
-    free (hashtable->htable);
+    hashtable_arena_release (hashtable, 0);
+    if (hashtable->htable)
+        free (hashtable->htable);
+    if (hashtable->entries)
+        free (hashtable->entries);
     if (hashtable->keys_values)
         free (hashtable->keys_values);
     free (hashtable);
 }
 
+/*
+ * Prints an item of hashtable in WeeChat log file (usually for crash dump).
+ */
+
+void
+hashtable_print_log_item (struct t_hashtable *hashtable,
+                          struct t_hashtable_item *ptr_item)
+{
+    log_printf ("    [item 0x%lx]", ptr_item);
+    switch (hashtable->type_keys)
+    {
+        case HASHTABLE_INTEGER:
+            log_printf ("      key (integer). . . : %d", *((int *)ptr_item->key));
+            break;
+        case HASHTABLE_STRING:
+            log_printf ("      key (string) . . . : '%s'", (char *)ptr_item->key);
+            break;
+        case HASHTABLE_POINTER:
+            log_printf ("      key (pointer). . . : 0x%lx", ptr_item->key);
+            break;
+        case HASHTABLE_BUFFER:
+            log_printf ("      key (buffer) . . . : 0x%lx", ptr_item->key);
+            break;
+        case HASHTABLE_TIME:
+            log_printf ("      key (time) . . . . : %lld", (long long)(*((time_t *)ptr_item->key)));
+            break;
+        case HASHTABLE_NUM_TYPES:
+            break;
+    }
+    log_printf ("      key_size . . . . . : %d", ptr_item->key_size);
+    switch (hashtable->type_values)
+    {
+        case HASHTABLE_INTEGER:
+            log_printf ("      value (integer). . : %d", *((int *)ptr_item->value));
+            break;
+        case HASHTABLE_STRING:
+            log_printf ("      value (string) . . : '%s'", (char *)ptr_item->value);
+            break;
+        case HASHTABLE_POINTER:
+            log_printf ("      value (pointer). . : 0x%lx", ptr_item->value);
+            break;
+        case HASHTABLE_BUFFER:
+            log_printf ("      value (buffer) . . : 0x%lx", ptr_item->value);
+            break;
+        case HASHTABLE_TIME:
+            log_printf ("      value (time) . . . : %lld", (long long)(*((time_t *)ptr_item->value)));
+            break;
+        case HASHTABLE_NUM_TYPES:
+            break;
+    }
+    log_printf ("      value_size . . . . : %d",    ptr_item->value_size);
+    log_printf ("      prev_item. . . . . : 0x%lx", ptr_item->prev_item);
+    log_printf ("      next_item. . . . . : 0x%lx", ptr_item->next_item);
+}
+
 /*
  * Prints hashtable in WeeChat log file (usually for crash dump).
  */
@@ -1284,9 +1850,17 @@ hashtable_print_log (struct t_hashtable *hashtable, const char *name)
 
     log_printf ("");
     log_printf ("[hashtable %s (addr:0x%lx)]", name, hashtable);
+    log_printf ("  engine . . . . . . . . : %d (%s)",
+                hashtable->engine,
+                hashtable_engine_string[hashtable->engine]);
     log_printf ("  size . . . . . . . . . : %d",    hashtable->size);
     log_printf ("  htable . . . . . . . . : 0x%lx", hashtable->htable);
+    log_printf ("  entries. . . . . . . . : 0x%lx", hashtable->entries);
     log_printf ("  items_count. . . . . . : %d",    hashtable->items_count);
+    log_printf ("  deleted_count. . . . . : %d",    hashtable->deleted_count);
+    log_printf ("  map_running. . . . . . : %d",    hashtable->map_running);
+    log_printf ("  arena_block_size . . . : %d",    hashtable->arena_block_size);
+    log_printf ("  arena. . . . . . . . . : 0x%lx", hashtable->arena);
     log_printf ("  type_keys. . . . . . . : %d (%s)",
                 hashtable->type_keys,
                 hashtable_type_string[hashtable->type_keys]);
@@ -1299,57 +1873,27 @@ hashtable_print_log (struct t_hashtable *hashtable, const char *name)
     log_printf ("  callback_free_value. . : 0x%lx", hashtable->callback_free_value);
     log_printf ("  keys_values. . . . . . : '%s'",  hashtable->keys_values);
 
+    if (hashtable->engine == HASHTABLE_ENGINE_OPEN)
+    {
+        for (i = 0; i < hashtable->size; i++)
+        {
+            if (hashtable->entries[i].state != HASHTABLE_ENTRY_USED)
+                continue;
+            log_printf ("  entries[%06d]. . . . : hash: %llu",
+                        i, hashtable->entries[i].hash);
+            hashtable_print_log_item (hashtable,
+                                      &hashtable->entries[i].item);
+        }
+        return;
+    }
+
     for (i = 0; i < hashtable->size; i++)
     {
         log_printf ("  htable[%06d] . . . . : 0x%lx", i, hashtable->htable[i]);
         for (ptr_item = hashtable->htable[i]; ptr_item;
              ptr_item = ptr_item->next_item)
         {
-            log_printf ("    [item 0x%lx]", hashtable->htable);
-            switch (hashtable->type_keys)
-            {
-                case HASHTABLE_INTEGER:
-                    log_printf ("      key (integer). . . : %d", *((int *)ptr_item->key));
-                    break;
-                case HASHTABLE_STRING:
-                    log_printf ("      key (string) . . . : '%s'", (char *)ptr_item->key);
-                    break;
-                case HASHTABLE_POINTER:
-                    log_printf ("      key (pointer). . . : 0x%lx", ptr_item->key);
-                    break;
-                case HASHTABLE_BUFFER:
-                    log_printf ("      key (buffer) . . . : 0x%lx", ptr_item->key);
-                    break;
-                case HASHTABLE_TIME:
-                    log_printf ("      key (time) . . . . : %lld", (long long)(*((time_t *)ptr_item->key)));
-                    break;
-                case HASHTABLE_NUM_TYPES:
-                    break;
-            }
-            log_printf ("      key_size . . . . . : %d", ptr_item->key_size);
-            switch (hashtable->type_values)
-            {
-                case HASHTABLE_INTEGER:
-                    log_printf ("      value (integer). . : %d", *((int *)ptr_item->value));
-                    break;
-                case HASHTABLE_STRING:
-                    log_printf ("      value (string) . . : '%s'", (char *)ptr_item->value);
-                    break;
-                case HASHTABLE_POINTER:
-                    log_printf ("      value (pointer). . : 0x%lx", ptr_item->value);
-                    break;
-                case HASHTABLE_BUFFER:
-                    log_printf ("      value (buffer) . . : 0x%lx", ptr_item->value);
-                    break;
-                case HASHTABLE_TIME:
-                    log_printf ("      value (time) . . . : %lld", (long long)(*((time_t *)ptr_item->value)));
-                    break;
-                case HASHTABLE_NUM_TYPES:
-                    break;
-            }
-            log_printf ("      value_size . . . . : %d",    ptr_item->value_size);
-            log_printf ("      prev_item. . . . . : 0x%lx", ptr_item->prev_item);
-            log_printf ("      next_item. . . . . : 0x%lx", ptr_item->next_item);
+            hashtable_print_log_item (hashtable, ptr_item);
         }
     }
 }
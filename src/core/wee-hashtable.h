@@ -96,6 +96,23 @@ typedef void (t_hashtable_map_string)(void *data,
  * +-----+
  * |   7 | --> "weechat"
  * +-----+
+ *
+ * This is the default engine ("chained"). Another engine is available
+ * ("open"): items are stored directly in a flat array of entries (open
+ * addressing with linear probing), small string keys are stored inside the
+ * entry (no allocation), and the array is automatically resized when the
+ * load factor becomes too high (the size given on creation is then only
+ * the initial size).
+ *
+ * With the "open" engine, pointers to items may change when items are added
+ * (resize of array), so a pointer to an item must not be kept after another
+ * item has been added in the hashtable.
+ *
+ * With any engine, an arena can be used (see function hashtable_set_arena):
+ * items, keys and values are then allocated in large blocks of memory, which
+ * are released all at once when all items are removed or when the hashtable
+ * is freed (memory of removed/replaced items is not reused before). This is
+ * designed for short-lived hashtables, built and freed in a single callback.
  */
 
 enum t_hashtable_type
@@ -109,6 +126,32 @@ enum t_hashtable_type
     HASHTABLE_NUM_TYPES,
 };
 
+enum t_hashtable_engine
+{
+    HASHTABLE_ENGINE_CHAINED = 0,      /* sorted linked lists in buckets    */
+    HASHTABLE_ENGINE_OPEN,             /* open addressing, auto-resize      */
+    /* number of hashtable engines */
+    HASHTABLE_NUM_ENGINES,
+};
+
+/* "open" engine: max length + 1 of a string key stored inside the entry */
+#define HASHTABLE_OPEN_KEY_INLINE_SIZE 24
+
+/* "open" engine: minimum size and max load factor (in percent) */
+#define HASHTABLE_OPEN_MIN_SIZE        8
+#define HASHTABLE_OPEN_MAX_LOAD        75
+
+/* arena: default size of blocks and alignment of allocations */
+#define HASHTABLE_ARENA_BLOCK_SIZE     2048
+#define HASHTABLE_ARENA_ALIGN          8
+
+enum t_hashtable_entry_state
+{
+    HASHTABLE_ENTRY_EMPTY = 0,         /* entry never used                  */
+    HASHTABLE_ENTRY_USED,              /* entry contains an item            */
+    HASHTABLE_ENTRY_DELETED,           /* item removed (tombstone)          */
+};
+
 struct t_hashtable_item
 {
     void *key;                          /* item key                         */
@@ -119,12 +162,38 @@ struct t_hashtable_item
     struct t_hashtable_item *next_item; /* link to next item                */
 };
 
+struct t_hashtable_entry
+{
+    struct t_hashtable_item item;      /* item (must be first), prev/next   */
+                                       /* links are not used                */
+    unsigned long long hash;           /* hash of key (not modulo size)     */
+    enum t_hashtable_entry_state state; /* empty/used/deleted               */
+    char key_inline[HASHTABLE_OPEN_KEY_INLINE_SIZE]; /* small string key    */
+};
+
+struct t_hashtable_arena_block
+{
+    int size;                          /* size of data in block             */
+    int used;                          /* bytes used in block               */
+    struct t_hashtable_arena_block *next_block; /* link to next block       */
+    /* data follows the block header */
+};
+
 struct t_hashtable
 {
+    enum t_hashtable_engine engine;    /* engine used to store items        */
     int size;                          /* hashtable size                    */
     struct t_hashtable_item **htable;  /* table to map hashes with linked   */
-                                       /* lists                             */
+                                       /* lists ("chained" engine)          */
+    struct t_hashtable_entry *entries; /* array of entries ("open" engine)  */
+    int deleted_count;                 /* number of deleted entries         */
+                                       /* ("open" engine)                   */
+    int map_running;                   /* > 0 if a map is running (the      */
+                                       /* array is not resized during map)  */
     int items_count;                   /* number of items in hashtable      */
+    int arena_block_size;              /* > 0 if an arena is used: size of  */
+                                       /* blocks allocated                  */
+    struct t_hashtable_arena_block *arena; /* blocks (first is current one) */
 
     /* type for keys and values */
     enum t_hashtable_type type_keys;   /* type for keys: int/str/pointer    */
@@ -141,7 +210,15 @@ struct t_hashtable
                                        /* never asked)                      */
 };
 
+extern char *hashtable_engine_string[];
+
 extern unsigned long long hashtable_hash_key_djb2 (const char *string);
+extern struct t_hashtable *hashtable_new_with_engine (enum t_hashtable_engine engine,
+                                                      int size,
+                                                      const char *type_keys,
+                                                      const char *type_values,
+                                                      t_hashtable_hash_key *hash_key_cb,
+                                                      t_hashtable_keycmp *keycmp_cb);
 extern struct t_hashtable *hashtable_new (int size,
                                           const char *type_keys,
                                           const char *type_values,
@@ -172,6 +249,8 @@ extern int hashtable_get_integer (struct t_hashtable *hashtable,
                                   const char *property);
 extern const char *hashtable_get_string (struct t_hashtable *hashtable,
                                          const char *property);
+extern int hashtable_set_arena (struct t_hashtable *hashtable,
+                                int block_size);
 extern void hashtable_set_pointer (struct t_hashtable *hashtable,
                                    const char *property,
                                    void *pointer);
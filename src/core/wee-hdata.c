@@ -115,17 +115,21 @@ hdata_new (struct t_weechat_plugin *plugin, const char *hdata_name,
         new_hdata->plugin = plugin;
         new_hdata->var_prev = (var_prev) ? strdup (var_prev) : NULL;
         new_hdata->var_next = (var_next) ? strdup (var_next) : NULL;
-        new_hdata->hash_var = hashtable_new (32,
-                                             WEECHAT_HASHTABLE_STRING,
-                                             WEECHAT_HASHTABLE_POINTER,
-                                             NULL,
-                                             NULL);
+        new_hdata->hash_var = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL,
+            NULL);
         new_hdata->hash_var->callback_free_value = &hdata_free_var;
-        new_hdata->hash_list = hashtable_new (32,
-                                              WEECHAT_HASHTABLE_STRING,
-                                              WEECHAT_HASHTABLE_POINTER,
-                                              NULL,
-                                              NULL);
+        new_hdata->hash_list = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL,
+            NULL);
         new_hdata->hash_list->callback_free_value = &hdata_free_list;
         hashtable_set (weechat_hdata, hdata_name, new_hdata);
         new_hdata->create_allowed = create_allowed;
@@ -687,6 +691,226 @@ hdata_get_index_and_name (const char *name, int *index, const char **ptr_name)
     }
 }
 
+/*
+ * Compiles a key (variable name, which can contain an index, see function
+ * hdata_get_index_and_name): searches the variable in hdata and sets index
+ * and variable in key (the name of key is not set).
+ *
+ * If ptr_name is not NULL, it is set to the name of variable in "name"
+ * (without index).
+ *
+ * Returns:
+ *   1: variable found in hdata
+ *   0: unknown variable (key->var is NULL)
+ */
+
+int
+hdata_compile_key (struct t_hdata *hdata, const char *name,
+                   struct t_hdata_key *key, const char **ptr_name)
+{
+    const char *ptr_var_name;
+
+    hdata_get_index_and_name (name, &key->index, &ptr_var_name);
+    key->var = (hdata && ptr_var_name) ?
+        hashtable_get (hdata->hash_var, ptr_var_name) : NULL;
+
+    if (ptr_name)
+        *ptr_name = ptr_var_name;
+
+    return (key->var) ? 1 : 0;
+}
+
+/*
+ * Compiles a list of keys (variable names separated by commas, each name can
+ * contain an index, see function hdata_get_index_and_name): the variables
+ * are searched only once, so that values can then be read for many objects
+ * without any lookup in hashtable.
+ *
+ * Empty keys are ignored (for example "a,,b" is the same as "a,b").
+ *
+ * Note: only variables of this hdata are compiled, a key can not be a path
+ * to a variable in another hdata (like "buffer.name").
+ *
+ * Note: compiled keys refer to variables of hdata, so they must be freed
+ * (by calling function hdata_free_compiled_keys) before hdata is freed.
+ *
+ * Returns pointer to compiled keys, NULL if error.
+ */
+
+struct t_hdata_keys *
+hdata_compile_keys (struct t_hdata *hdata, const char *keys, int *num_keys)
+{
+    struct t_hdata_keys *new_keys;
+    struct t_hdata_key *new_array;
+    const char *ptr_keys, *pos, *ptr_name;
+    char *key;
+    int length;
+
+    if (num_keys)
+        *num_keys = 0;
+
+    if (!hdata || !keys)
+        return NULL;
+
+    new_keys = malloc (sizeof (*new_keys));
+    if (!new_keys)
+        return NULL;
+    new_keys->num_keys = 0;
+    new_keys->keys = NULL;
+
+    ptr_keys = keys;
+    while (ptr_keys[0])
+    {
+        while (ptr_keys[0] == ',')
+        {
+            ptr_keys++;
+        }
+        if (!ptr_keys[0])
+            break;
+        pos = ptr_keys;
+        while (pos[0] && (pos[0] != ','))
+        {
+            pos++;
+        }
+        length = pos - ptr_keys;
+        new_array = realloc (new_keys->keys,
+                             (new_keys->num_keys + 1) * sizeof (*new_array));
+        if (!new_array)
+            goto error;
+        new_keys->keys = new_array;
+        key = string_strndup (ptr_keys, length);
+        if (!key)
+            goto error;
+        hdata_compile_key (hdata, key, &new_array[new_keys->num_keys],
+                           &ptr_name);
+        new_array[new_keys->num_keys].name = strdup (ptr_name);
+        free (key);
+        new_keys->num_keys++;
+        if (!new_array[new_keys->num_keys - 1].name)
+            goto error;
+        ptr_keys = pos;
+    }
+
+    if (num_keys)
+        *num_keys = new_keys->num_keys;
+
+    return new_keys;
+
+error:
+    hdata_free_compiled_keys (new_keys);
+    return NULL;
+}
+
+/*
+ * Gets info about a compiled key (number is the position of key in list,
+ * starting at 0): name (without index), index (-1 if no index), type, offset
+ * and array size of variable.
+ *
+ * Returns:
+ *   1: key found and it is a variable of hdata
+ *   0: key not found or unknown variable
+ */
+
+int
+hdata_get_compiled_key (struct t_hdata_keys *keys, int number,
+                        const char **name, int *index, int *type,
+                        int *offset, const char **array_size)
+{
+    struct t_hdata_key *ptr_key;
+
+    if (name)
+        *name = NULL;
+    if (index)
+        *index = -1;
+    if (type)
+        *type = -1;
+    if (offset)
+        *offset = -1;
+    if (array_size)
+        *array_size = NULL;
+
+    if (!keys || (number < 0) || (number >= keys->num_keys))
+        return 0;
+
+    ptr_key = &keys->keys[number];
+    if (name)
+        *name = ptr_key->name;
+    if (index)
+        *index = ptr_key->index;
+    if (!ptr_key->var)
+        return 0;
+
+    if (type)
+        *type = ptr_key->var->type;
+    if (offset)
+        *offset = ptr_key->var->offset;
+    if (array_size)
+        *array_size = ptr_key->var->array_size;
+
+    return 1;
+}
+
+/*
+ * Frees compiled keys.
+ */
+
+void
+hdata_free_compiled_keys (struct t_hdata_keys *keys)
+{
+    int i;
+
+    if (!keys)
+        return;
+
+    for (i = 0; i < keys->num_keys; i++)
+    {
+        if (keys->keys[i].name)
+            free (keys->keys[i].name);
+    }
+    if (keys->keys)
+        free (keys->keys);
+    free (keys);
+}
+
+/*
+ * Gets pointer to the value of a compiled key in an object (with the index
+ * of key if the variable is an array, like the functions hdata_char,
+ * hdata_integer, ...).
+ *
+ * Returns pointer to value, NULL if error.
+ */
+
+void *
+hdata_key_get_value (struct t_hdata_key *key, void *pointer)
+{
+    if (!key || !key->var || (key->var->offset < 0) || !pointer)
+        return NULL;
+
+    if (key->var->array_size && (key->index >= 0))
+    {
+        switch (key->var->type)
+        {
+            case WEECHAT_HDATA_CHAR:
+                return &((*((char **)(pointer + key->var->offset)))[key->index]);
+            case WEECHAT_HDATA_INTEGER:
+                return &(((int *)(pointer + key->var->offset))[key->index]);
+            case WEECHAT_HDATA_LONG:
+                return &(((long *)(pointer + key->var->offset))[key->index]);
+            case WEECHAT_HDATA_STRING:
+            case WEECHAT_HDATA_SHARED_STRING:
+                return &((*((char ***)(pointer + key->var->offset)))[key->index]);
+            case WEECHAT_HDATA_POINTER:
+                return &((*((void ***)(pointer + key->var->offset)))[key->index]);
+            case WEECHAT_HDATA_TIME:
+                return &(((time_t *)(pointer + key->var->offset))[key->index]);
+            case WEECHAT_HDATA_HASHTABLE:
+                return &((*((struct t_hashtable ***)(pointer + key->var->offset)))[key->index]);
+        }
+    }
+
+    return pointer + key->var->offset;
+}
+
 /*
  * Gets char value of a variable in hdata.
  */
@@ -1316,11 +1540,12 @@ hdata_print_log ()
 void
 hdata_init ()
 {
-    weechat_hdata = hashtable_new (32,
-                                   WEECHAT_HASHTABLE_STRING,
-                                   WEECHAT_HASHTABLE_POINTER,
-                                   NULL,
-                                   NULL);
+    weechat_hdata = hashtable_new_with_engine (HASHTABLE_ENGINE_OPEN,
+                                               32,
+                                               WEECHAT_HASHTABLE_STRING,
+                                               WEECHAT_HASHTABLE_POINTER,
+                                               NULL,
+                                               NULL);
 }
 
 /*
@@ -27,6 +27,7 @@
     hdata_new_var (hdata, #__name, offsetof (__struct, __name),         \
                    WEECHAT_HDATA_##__type, __update_allowed,            \
                    __array_size, __hdata_name)
+
 #define HDATA_LIST(__name, __flags)                                     \
     hdata_new_list (hdata, #__name, &(__name), __flags);
 
@@ -39,6 +40,19 @@ struct t_hdata_var
     char *hdata_name;                  /* hdata name                        */
 };
 
+struct t_hdata_key
+{
+    char *name;                        /* name of variable (without index)  */
+    int index;                         /* index in array (-1 if no index)   */
+    struct t_hdata_var *var;           /* variable (NULL if not found)      */
+};
+
+struct t_hdata_keys
+{
+    int num_keys;                      /* number of keys                    */
+    struct t_hdata_key *keys;          /* keys (with variables resolved)    */
+};
+
 struct t_hdata_list
 {
     void *pointer;                     /* list pointer                      */
@@ -112,6 +126,16 @@ extern void *hdata_search (struct t_hdata *hdata, void *pointer,
                            const char *search, int move);
 extern void hdata_get_index_and_name (const char *name, int *index,
                                       const char **ptr_name);
+extern int hdata_compile_key (struct t_hdata *hdata, const char *name,
+                              struct t_hdata_key *key, const char **ptr_name);
+extern struct t_hdata_keys *hdata_compile_keys (struct t_hdata *hdata,
+                                                const char *keys,
+                                                int *num_keys);
+extern int hdata_get_compiled_key (struct t_hdata_keys *keys, int number,
+                                   const char **name, int *index, int *type,
+                                   int *offset, const char **array_size);
+extern void hdata_free_compiled_keys (struct t_hdata_keys *keys);
+extern void *hdata_key_get_value (struct t_hdata_key *key, void *pointer);
 extern char hdata_char (struct t_hdata *hdata, void *pointer,
                         const char *name);
 extern int hdata_integer (struct t_hdata *hdata, void *pointer,
@@ -38,6 +38,7 @@
 #include "wee-string.h"
 #include "wee-util.h"
 #include "../gui/gui-chat.h"
+#include "../gui/gui-line.h"
 #include "../plugins/plugin.h"
 
 
@@ -56,11 +57,13 @@ int hook_socketpair_ok = 0;            /* 1 if socketpair() is OK           */
 
 /* hook callbacks */
 t_callback_hook *hook_callback_add[HOOK_NUM_TYPES] =
-{ NULL, NULL, NULL, &hook_fd_add_cb, NULL, NULL, NULL, NULL, NULL, NULL,
-  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+{ NULL, NULL, NULL, &hook_fd_add_cb, NULL, NULL, &hook_line_add_cb,
+  &hook_print_add_cb, &hook_signal_add_cb, NULL, NULL, NULL, NULL, NULL, NULL,
+  NULL, NULL, NULL };
 t_callback_hook *hook_callback_remove[HOOK_NUM_TYPES] =
-{ NULL, NULL, NULL, &hook_fd_remove_cb, NULL, NULL, NULL, NULL, NULL, NULL,
-  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+{ NULL, NULL, NULL, &hook_fd_remove_cb, NULL, NULL, &hook_line_remove_cb,
+  &hook_print_remove_cb, &hook_signal_remove_cb, NULL, NULL, NULL, NULL, NULL,
+  NULL, NULL, NULL, NULL };
 t_callback_hook *hook_callback_free_data[HOOK_NUM_TYPES] =
 { &hook_command_free_data, &hook_command_run_free_data,
   &hook_timer_free_data, &hook_fd_free_data,
@@ -112,6 +115,9 @@ hook_init ()
     hooks_count_total = 0;
     hook_last_system_time = time (NULL);
 
+    /* choose the backend used to wait for events on file descriptors */
+    hook_fd_init ();
+
     /*
      * Set a flag to 0 if socketpair() function is not available.
      *
@@ -458,6 +464,326 @@ hook_exec_end ()
         hook_remove_deleted ();
 }
 
+/*
+ * Hashes a name (case is ignored, like in function string_strcasecmp, which
+ * converts only chars A-Z to lower case).
+ */
+
+unsigned long long
+hook_hash_key_nocase_cb (struct t_hashtable *hashtable, const void *key)
+{
+    const char *ptr_key;
+    unsigned long long hash;
+    unsigned char c;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    /* variant of djb2 hash */
+    hash = 5381;
+    for (ptr_key = (const char *)key; ptr_key[0]; ptr_key++)
+    {
+        c = (unsigned char)ptr_key[0];
+        if ((c >= 'A') && (c <= 'Z'))
+            c += ('a' - 'A');
+        hash ^= (hash << 5) + (hash >> 2) + (int)c;
+    }
+
+    return hash;
+}
+
+/*
+ * Compares two names (case is ignored).
+ */
+
+int
+hook_keycmp_nocase_cb (struct t_hashtable *hashtable,
+                       const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return string_strcasecmp ((const char *)key1, (const char *)key2);
+}
+
+/*
+ * Creates a list of hooks for a buffer (used by print and line hooks), with
+ * room for "count" hooks.
+ *
+ * Returns pointer to new list, NULL if error.
+ */
+
+struct t_hook_buffer_hooks *
+hook_buffer_hooks_new (int count)
+{
+    struct t_hook_buffer_hooks *buffer_hooks;
+
+    buffer_hooks = malloc (sizeof (*buffer_hooks) +
+                           (count * sizeof (buffer_hooks->hooks[0])) +
+                           (count * sizeof (buffer_hooks->not_indexed[0])));
+    if (!buffer_hooks)
+        return NULL;
+
+    buffer_hooks->count = 0;
+    buffer_hooks->size = count;
+    buffer_hooks->hooks = (struct t_hook **)(buffer_hooks + 1);
+    buffer_hooks->not_indexed = (char *)(buffer_hooks->hooks + count);
+    buffer_hooks->tags_index = NULL;
+    buffer_hooks->buffer_type = -1;
+    buffer_hooks->used = 0;
+    buffer_hooks->removed = 0;
+
+    return buffer_hooks;
+}
+
+/*
+ * Frees positions of hooks in index of tags (callback called when a tag is
+ * removed from index).
+ */
+
+void
+hook_buffer_hooks_free_positions_cb (struct t_hashtable *hashtable,
+                                     const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    free (value);
+}
+
+/*
+ * Adds a tag required by a hook in the index of tags.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hook_buffer_hooks_index_tag (struct t_hook_buffer_hooks *buffer_hooks,
+                             const char *tag, int position)
+{
+    struct t_hook_tag_positions *tag_positions;
+
+    if (!buffer_hooks->tags_index)
+    {
+        buffer_hooks->tags_index = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            &hook_hash_key_nocase_cb,
+            &hook_keycmp_nocase_cb);
+        if (!buffer_hooks->tags_index)
+            return 0;
+        hashtable_set_pointer (buffer_hooks->tags_index,
+                               "callback_free_value",
+                               &hook_buffer_hooks_free_positions_cb);
+    }
+
+    tag_positions = hashtable_get (buffer_hooks->tags_index, tag);
+    if (!tag_positions)
+    {
+        /* a tag is at most in all hooks of the list */
+        tag_positions = malloc (
+            sizeof (*tag_positions) +
+            (buffer_hooks->size * sizeof (tag_positions->positions[0])));
+        if (!tag_positions)
+            return 0;
+        tag_positions->count = 0;
+        tag_positions->positions = (int *)(tag_positions + 1);
+        if (!hashtable_set (buffer_hooks->tags_index, tag, tag_positions))
+        {
+            free (tag_positions);
+            return 0;
+        }
+    }
+
+    /* same tag required twice by the hook (in two groups of tags)? */
+    if ((tag_positions->count > 0)
+        && (tag_positions->positions[tag_positions->count - 1] == position))
+    {
+        return 1;
+    }
+
+    tag_positions->positions[tag_positions->count] = position;
+    tag_positions->count++;
+
+    return 1;
+}
+
+/*
+ * Adds a hook at the end of a list of hooks for a buffer.
+ *
+ * If the hook has tags, and if each group of tags (separated by commas)
+ * contains at least one tag without wildcard or negation, the hook can be
+ * called only for lines with one of these tags: the hook is added in index of
+ * tags with one of these tags for each group. Other hooks are checked for all
+ * lines.
+ */
+
+void
+hook_buffer_hooks_add (struct t_hook_buffer_hooks *buffer_hooks,
+                       struct t_hook *hook, int tags_count, char ***tags_array)
+{
+    int position, i, j, indexed;
+    const char **required_tags;
+
+    if (buffer_hooks->count >= buffer_hooks->size)
+        return;
+
+    position = buffer_hooks->count;
+    buffer_hooks->hooks[position] = hook;
+    buffer_hooks->not_indexed[position] = 1;
+    buffer_hooks->count++;
+
+    if (!tags_array || (tags_count <= 0))
+        return;
+
+    required_tags = malloc (tags_count * sizeof (*required_tags));
+    if (!required_tags)
+        return;
+
+    indexed = 1;
+    for (i = 0; i < tags_count; i++)
+    {
+        required_tags[i] = NULL;
+        for (j = 0; tags_array[i][j]; j++)
+        {
+            if ((tags_array[i][j][0] != '!')
+                && !strchr (tags_array[i][j], '*'))
+            {
+                required_tags[i] = tags_array[i][j];
+                break;
+            }
+        }
+        if (!required_tags[i])
+        {
+            indexed = 0;
+            break;
+        }
+    }
+
+    if (indexed)
+    {
+        for (i = 0; i < tags_count; i++)
+        {
+            if (!hook_buffer_hooks_index_tag (buffer_hooks, required_tags[i],
+                                              position))
+            {
+                break;
+            }
+        }
+        /* on error, the hook stays not indexed (checked for all lines) */
+        if (i == tags_count)
+            buffer_hooks->not_indexed[position] = 0;
+    }
+
+    free (required_tags);
+}
+
+/*
+ * Sets the hooks (positions in list) that may be called for a line, in array
+ * "candidates" (which must have room for all hooks of the list): the hooks
+ * without tags or not indexed, and the hooks which require a tag of the line.
+ *
+ * The conditions of hooks must still be checked for the candidates.
+ */
+
+void
+hook_buffer_hooks_get_candidates (struct t_hook_buffer_hooks *buffer_hooks,
+                                  struct t_gui_line_data *line_data,
+                                  char *candidates)
+{
+    struct t_hook_tag_positions *tag_positions;
+    int i, j;
+
+    memcpy (candidates, buffer_hooks->not_indexed, buffer_hooks->count);
+
+    if (!buffer_hooks->tags_index)
+        return;
+
+    for (i = 0; i < line_data->tags_count; i++)
+    {
+        tag_positions = hashtable_get (buffer_hooks->tags_index,
+                                       line_data->tags_array[i]);
+        if (tag_positions)
+        {
+            for (j = 0; j < tag_positions->count; j++)
+            {
+                candidates[tag_positions->positions[j]] = 1;
+            }
+        }
+    }
+}
+
+/*
+ * Frees a list of hooks for a buffer.
+ *
+ * If the hooks are being called, the list is freed later by function
+ * hook_buffer_hooks_release.
+ */
+
+void
+hook_buffer_hooks_free (struct t_hook_buffer_hooks *buffer_hooks)
+{
+    if (!buffer_hooks)
+        return;
+
+    if (buffer_hooks->used > 0)
+    {
+        buffer_hooks->removed = 1;
+        return;
+    }
+
+    if (buffer_hooks->tags_index)
+        hashtable_free (buffer_hooks->tags_index);
+    free (buffer_hooks);
+}
+
+/*
+ * Frees a list of hooks for a buffer (callback called when the list is
+ * removed from an index of hooks).
+ */
+
+void
+hook_buffer_hooks_free_value_cb (struct t_hashtable *hashtable,
+                                 const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    hook_buffer_hooks_free ((struct t_hook_buffer_hooks *)value);
+}
+
+/*
+ * Marks a list of hooks for a buffer as used (hooks are being called).
+ */
+
+void
+hook_buffer_hooks_use (struct t_hook_buffer_hooks *buffer_hooks)
+{
+    buffer_hooks->used++;
+}
+
+/*
+ * Releases a list of hooks for a buffer (end of call of hooks): the list is
+ * freed if it has been removed from index while hooks were called.
+ */
+
+void
+hook_buffer_hooks_release (struct t_hook_buffer_hooks *buffer_hooks)
+{
+    buffer_hooks->used--;
+    if (buffer_hooks->removed && (buffer_hooks->used == 0))
+    {
+        buffer_hooks->removed = 0;
+        hook_buffer_hooks_free (buffer_hooks);
+    }
+}
+
 /*
  * Sets a hook property (string).
  */
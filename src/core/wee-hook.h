@@ -43,6 +43,7 @@ struct t_hook;
 struct t_gui_bar;
 struct t_gui_buffer;
 struct t_gui_line;
+struct t_gui_line_data;
 struct t_gui_completion;
 struct t_gui_window;
 struct t_weelist;
@@ -108,6 +109,38 @@ struct t_hook
     struct t_hook *next_hook;          /* link to next hook                 */
 };
 
+/*
+ * max number of hooks for which the array of candidates is on the stack when
+ * print/line hooks are executed (bigger arrays are allocated)
+ */
+#define HOOK_BUFFER_HOOKS_STATIC_SIZE 256
+
+/*
+ * hooks selected for a buffer (print and line hooks), with an index of tags
+ * required by hooks
+ */
+
+struct t_hook_buffer_hooks
+{
+    int count;                         /* number of hooks                   */
+    int size;                          /* max number of hooks in list       */
+    struct t_hook **hooks;             /* hooks (sorted like the hooks list)*/
+    char *not_indexed;                 /* 1 for hooks not in tags index     */
+                                       /* (they are checked for all lines)  */
+    struct t_hashtable *tags_index;    /* tag => positions of hooks         */
+                                       /* requiring this tag                */
+    int buffer_type;                   /* buffer type (for line hooks)      */
+    int used;                          /* > 0 if hooks are being called     */
+    int removed;                       /* 1 if removed from index: it will  */
+                                       /* be freed when it is not used      */
+};
+
+struct t_hook_tag_positions
+{
+    int count;                         /* number of hooks requiring the tag */
+    int *positions;                    /* positions of hooks in list        */
+};
+
 /* hook variables */
 
 extern char *hook_type_string[];
@@ -130,6 +163,22 @@ extern void hook_init_data (struct t_hook *hook,
 extern int hook_valid (struct t_hook *hook);
 extern void hook_exec_start ();
 extern void hook_exec_end ();
+extern unsigned long long hook_hash_key_nocase_cb (struct t_hashtable *hashtable,
+                                                   const void *key);
+extern int hook_keycmp_nocase_cb (struct t_hashtable *hashtable,
+                                  const void *key1, const void *key2);
+extern struct t_hook_buffer_hooks *hook_buffer_hooks_new (int count);
+extern void hook_buffer_hooks_add (struct t_hook_buffer_hooks *buffer_hooks,
+                                   struct t_hook *hook, int tags_count,
+                                   char ***tags_array);
+extern void hook_buffer_hooks_get_candidates (struct t_hook_buffer_hooks *buffer_hooks,
+                                              struct t_gui_line_data *line_data,
+                                              char *candidates);
+extern void hook_buffer_hooks_free (struct t_hook_buffer_hooks *buffer_hooks);
+extern void hook_buffer_hooks_free_value_cb (struct t_hashtable *hashtable,
+                                             const void *key, void *value);
+extern void hook_buffer_hooks_use (struct t_hook_buffer_hooks *buffer_hooks);
+extern void hook_buffer_hooks_release (struct t_hook_buffer_hooks *buffer_hooks);
 extern void hook_set (struct t_hook *hook, const char *property,
                       const char *value);
 extern void unhook (struct t_hook *hook);
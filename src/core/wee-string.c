@@ -63,6 +63,7 @@
                     c - '0')
 
 struct t_hashtable *string_hashtable_shared = NULL;
+string_shared_id_t string_shared_last_id = 0;
 
 
 /*
@@ -3613,7 +3614,7 @@ string_replace_with_callback (const char *string,
 
 /*
  * Hashes a shared string.
- * The string starts after the reference count, which is skipped.
+ * The string starts after the reference count and id, which are skipped.
  *
  * Returns the hash of the shared string (variant of djb2).
  */
@@ -3625,12 +3626,12 @@ string_shared_hash_key (struct t_hashtable *hashtable,
     /* make C compiler happy */
     (void) hashtable;
 
-    return hashtable_hash_key_djb2 (((const char *)key) + sizeof (string_shared_count_t));
+    return hashtable_hash_key_djb2 (((const char *)key) + STRING_SHARED_HEADER_SIZE);
 }
 
 /*
  * Compares two shared strings.
- * Each string starts after the reference count, which is skipped.
+ * Each string starts after the reference count and id, which are skipped.
  *
  * Returns:
  *   < 0: key1 < key2
@@ -3645,8 +3646,8 @@ string_shared_keycmp (struct t_hashtable *hashtable,
     /* make C compiler happy */
     (void) hashtable;
 
-    return strcmp (((const char *)key1) + sizeof (string_shared_count_t),
-                   ((const char *)key2) + sizeof (string_shared_count_t));
+    return strcmp (((const char *)key1) + STRING_SHARED_HEADER_SIZE,
+                   ((const char *)key2) + STRING_SHARED_HEADER_SIZE);
 }
 
 /*
@@ -3666,12 +3667,16 @@ string_shared_free_key (struct t_hashtable *hashtable, void *key)
  * Gets a pointer to a shared string.
  *
  * A shared string is an entry in the hashtable "string_hashtable_shared", with:
- * - key: reference count (unsigned integer on 32 bits) + string
+ * - key: reference count (unsigned integer on 32 bits) + unique id (unsigned
+ *   integer on 32 bits) + string
  * - value: NULL pointer (not used)
  *
  * The initial reference count is set to 1 and is incremented each time this
  * function is called for a same string (string content, not the pointer).
  *
+ * The id is given when the string is added in the hashtable; it is never
+ * reused for another string (see function string_shared_get_id).
+ *
  * Returns the pointer to the shared string (start of string in key, after the
  * reference count), NULL if error.
  * The string returned has exactly same content as string received in argument,
@@ -3694,26 +3699,29 @@ string_shared_get (const char *string)
     if (!string_hashtable_shared)
     {
         /*
-         * use large htable inside hashtable to prevent too many collisions,
-         * which would slow down search of a string in the hashtable
+         * use engine "open" (the array grows with the number of strings),
+         * to prevent too many collisions, which would slow down search of a
+         * string in the hashtable
          */
-        string_hashtable_shared = hashtable_new (1024,
-                                                 WEECHAT_HASHTABLE_POINTER,
-                                                 WEECHAT_HASHTABLE_POINTER,
-                                                 &string_shared_hash_key,
-                                                 &string_shared_keycmp);
+        string_hashtable_shared = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            1024,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            &string_shared_hash_key,
+            &string_shared_keycmp);
         if (!string_hashtable_shared)
             return NULL;
 
         string_hashtable_shared->callback_free_key = &string_shared_free_key;
     }
 
-    length = sizeof (string_shared_count_t) + strlen (string) + 1;
+    length = STRING_SHARED_HEADER_SIZE + strlen (string) + 1;
     key = malloc (length);
     if (!key)
         return NULL;
     *((string_shared_count_t *)key) = 1;
-    strcpy (key + sizeof (string_shared_count_t), string);
+    strcpy (key + STRING_SHARED_HEADER_SIZE, string);
 
     ptr_item = hashtable_get_item (string_hashtable_shared, key, NULL);
     if (ptr_item)
@@ -3727,14 +3735,39 @@ string_shared_get (const char *string)
     }
     else
     {
-        /* add the shared string in the hashtable */
+        /* add the shared string in the hashtable, with a new id */
+        string_shared_last_id++;
+        if (string_shared_last_id == 0)
+            string_shared_last_id++;
+        *((string_shared_id_t *)(key + sizeof (string_shared_count_t))) =
+            string_shared_last_id;
         ptr_item = hashtable_set (string_hashtable_shared, key, NULL);
         if (!ptr_item)
             free (key);
     }
 
     return (ptr_item) ?
-        ((const char *)ptr_item->key) + sizeof (string_shared_count_t) : NULL;
+        ((const char *)ptr_item->key) + STRING_SHARED_HEADER_SIZE : NULL;
+}
+
+/*
+ * Gets the unique id of a shared string (the string MUST have been returned
+ * by function string_shared_get).
+ *
+ * The id can be used as an "atom" for the string: two shared strings with
+ * same content have same id, and the id of a freed string is not reused by
+ * another string (except after 2^32 - 1 strings have been created).
+ *
+ * Returns the id of shared string, 0 if the string is NULL.
+ */
+
+string_shared_id_t
+string_shared_get_id (const char *string)
+{
+    if (!string)
+        return 0;
+
+    return *((string_shared_id_t *)(string - sizeof (string_shared_id_t)));
 }
 
 /*
@@ -3753,7 +3786,7 @@ string_shared_free (const char *string)
     if (!string)
         return;
 
-    ptr_count = (string_shared_count_t *)(string - sizeof (string_shared_count_t));
+    ptr_count = (string_shared_count_t *)(string - STRING_SHARED_HEADER_SIZE);
 
     (*ptr_count)--;
 
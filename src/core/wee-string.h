@@ -25,6 +25,11 @@
 #include <regex.h>
 
 typedef uint32_t string_shared_count_t;
+typedef uint32_t string_shared_id_t;
+
+/* a shared string is: reference count + unique id + string */
+#define STRING_SHARED_HEADER_SIZE                                       \
+    (sizeof (string_shared_count_t) + sizeof (string_shared_id_t))
 
 typedef uint32_t string_dyn_size_t;
 struct t_string_dyn
@@ -127,6 +132,7 @@ extern char *string_replace_with_callback (const char *string,
                                            void *callback_data,
                                            int *errors);
 extern const char *string_shared_get (const char *string);
+extern string_shared_id_t string_shared_get_id (const char *string);
 extern void string_shared_free (const char *string);
 extern char **string_dyn_alloc (int size_alloc);
 extern int string_dyn_copy (char **string, const char *new_string);
@@ -65,11 +65,33 @@ gui_bar_window_objects_init (struct t_gui_bar_window *bar_window)
         bar_window->gui_objects = new_objects;
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar = NULL;
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator = NULL;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->content = NULL;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->x = -1;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->y = -1;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->width = 0;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->height = 0;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->scroll_x = 0;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->scroll_y = 0;
         return 1;
     }
     return 0;
 }
 
+/*
+ * Frees content drawn in a bar window (next draw of bar window will be a full
+ * draw).
+ */
+
+void
+gui_bar_window_objects_content_free (struct t_gui_bar_window *bar_window)
+{
+    if (GUI_BAR_WINDOW_OBJECTS(bar_window)->content)
+    {
+        free (GUI_BAR_WINDOW_OBJECTS(bar_window)->content);
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->content = NULL;
+    }
+}
+
 /*
  * Frees Curses windows for a bar window.
  */
@@ -90,6 +112,7 @@ gui_bar_window_objects_free (struct t_gui_bar_window *bar_window)
         delwin (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator = NULL;
     }
+    gui_bar_window_objects_content_free (bar_window);
 }
 
 /*
@@ -115,6 +138,7 @@ gui_bar_window_create_win (struct t_gui_bar_window *bar_window)
         delwin (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator = NULL;
     }
+    gui_bar_window_objects_content_free (bar_window);
 
     if ((bar_window->x >= 0) && (bar_window->y >= 0))
     {
@@ -454,6 +478,31 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                   GUI_COLOR_BAR_MOVE_CURSOR_CHAR);
     }
 
+    content = gui_bar_window_content_get_with_filling (bar_window, window);
+    if (content)
+        utf8_normalize (content, '?');
+
+    /*
+     * nothing to draw if content, position, size and scroll are the same as
+     * last draw (except if cursor is moved in bar window, like input bar)
+     */
+    if (content
+        && GUI_BAR_WINDOW_OBJECTS(bar_window)->content
+        && (bar_window->cursor_x < 0) && (bar_window->cursor_y < 0)
+        && (GUI_BAR_WINDOW_OBJECTS(bar_window)->x == bar_window->x)
+        && (GUI_BAR_WINDOW_OBJECTS(bar_window)->y == bar_window->y)
+        && (GUI_BAR_WINDOW_OBJECTS(bar_window)->width == bar_window->width)
+        && (GUI_BAR_WINDOW_OBJECTS(bar_window)->height == bar_window->height)
+        && (GUI_BAR_WINDOW_OBJECTS(bar_window)->scroll_x == bar_window->scroll_x)
+        && (GUI_BAR_WINDOW_OBJECTS(bar_window)->scroll_y == bar_window->scroll_y)
+        && (strcmp (GUI_BAR_WINDOW_OBJECTS(bar_window)->content, content) == 0))
+    {
+        gui_bar_window_draws_skipped++;
+        free (content);
+        return;
+    }
+    gui_bar_window_draws++;
+
     /*
      * these values will be overwritten later (by gui_bar_window_print_string)
      * if cursor has to move somewhere in bar window
@@ -471,10 +520,10 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
 
     filling = gui_bar_get_filling (bar_window->bar);
 
-    content = gui_bar_window_content_get_with_filling (bar_window, window);
+    gui_bar_window_objects_content_free (bar_window);
+
     if (content)
     {
-        utf8_normalize (content, '?');
         if ((filling == GUI_BAR_FILLING_HORIZONTAL)
             && (bar_window->scroll_x > 0))
         {
@@ -736,7 +785,6 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
         }
         if (items)
             string_free_split (items);
-        free (content);
     }
     else
     {
@@ -808,6 +856,15 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
         wnoutrefresh (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
     }
 
+    /* save content drawn */
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->content = content;
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->x = bar_window->x;
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->y = bar_window->y;
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->width = bar_window->width;
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->height = bar_window->height;
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->scroll_x = bar_window->scroll_x;
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->scroll_y = bar_window->scroll_y;
+
     refresh ();
 }
 
@@ -821,4 +878,11 @@ gui_bar_window_objects_print_log (struct t_gui_bar_window *bar_window)
     log_printf ("    bar window specific objects for Curses:");
     log_printf ("      win_bar. . . . . . . : 0x%lx", GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar);
     log_printf ("      win_separator. . . . : 0x%lx", GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
+    log_printf ("      content. . . . . . . : '%s'",  GUI_BAR_WINDOW_OBJECTS(bar_window)->content);
+    log_printf ("      x. . . . . . . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->x);
+    log_printf ("      y. . . . . . . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->y);
+    log_printf ("      width. . . . . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->width);
+    log_printf ("      height . . . . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->height);
+    log_printf ("      scroll_x . . . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->scroll_x);
+    log_printf ("      scroll_y . . . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->scroll_y);
 }
@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <limits.h>
 
 #include "../../core/weechat.h"
 #include "../../core/wee-config.h"
@@ -1289,6 +1290,48 @@ gui_chat_display_time_to_prefix (struct t_gui_window *window,
         free (ptr_prefix);
 }
 
+/*
+ * Builds the layout of message in a line (without number of lines): the
+ * number of lines used by message depends only on these values.
+ *
+ * Returns:
+ *   1: layout OK
+ *   0: layout can not be used (values too big)
+ */
+
+int
+gui_chat_line_layout_build (struct t_gui_window *window,
+                            struct t_gui_line *line, int first_line,
+                            struct t_gui_line_layout *layout)
+{
+    int width, align_first, align_next, align_word;
+
+    width = gui_chat_get_real_width (window);
+    align_first = gui_line_get_align (window->buffer, line, 1, first_line);
+    align_next = (first_line) ?
+        gui_line_get_align (window->buffer, line, 1, 0) : align_first;
+    align_word = gui_line_get_align (window->buffer, line, 0, 0);
+
+    if ((width <= 0) || (width > SHRT_MAX)
+        || (window->win_chat_cursor_x < 0)
+        || (window->win_chat_cursor_x > SHRT_MAX)
+        || (align_first < 0) || (align_first > SHRT_MAX)
+        || (align_next < 0) || (align_next > SHRT_MAX)
+        || (align_word < 0) || (align_word > SHRT_MAX))
+    {
+        return 0;
+    }
+
+    layout->width = width;
+    layout->x = window->win_chat_cursor_x;
+    layout->align_first = align_first;
+    layout->align_next = align_next;
+    layout->align_word = align_word;
+    layout->lines = 0;
+
+    return 1;
+}
+
 /*
  * Displays a line in the chat window.
  *
@@ -1307,10 +1350,11 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     int num_lines, x, y, pre_lines_displayed, lines_displayed, line_align;
     int read_marker_x, read_marker_y;
     int word_start_offset, word_end_offset;
-    int word_length_with_spaces, word_length;
+    int word_length_with_spaces, word_length, use_layout, layout_lines;
     char *message_with_tags, *message_with_search;
     const char *ptr_data, *ptr_end_offset, *ptr_style, *next_char;
     struct t_gui_line *ptr_prev_line, *ptr_next_line;
+    struct t_gui_line_layout layout;
     struct tm local_time, local_time2;
     struct timeval tv_time;
     time_t seconds, *ptr_time;
@@ -1416,6 +1460,33 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     message_with_tags = NULL;
     message_with_search = NULL;
 
+    /*
+     * when simulating, use the number of lines of message computed in a
+     * previous simulation, if the layout of message is the same
+     */
+    use_layout = 0;
+    layout_lines = lines_displayed;
+    if (simulate && (count == 0) && !gui_chat_display_tags
+        && (lines_displayed == pre_lines_displayed))
+    {
+        use_layout = gui_chat_line_layout_build (window, line,
+                                                 (lines_displayed == 0) ? 1 : 0,
+                                                 &layout);
+        if (use_layout
+            && (layout.width == line->data->layout.width)
+            && (layout.x == line->data->layout.x)
+            && (layout.align_first == line->data->layout.align_first)
+            && (layout.align_next == line->data->layout.align_next)
+            && (layout.align_word == line->data->layout.align_word))
+        {
+            gui_line_layout_hits++;
+            lines_displayed += line->data->layout.lines;
+            window->win_chat_cursor_x = 0;
+            window->win_chat_cursor_y += line->data->layout.lines;
+            goto end_message;
+        }
+    }
+
     if (line->data->message && line->data->message[0])
     {
         message_with_tags = (gui_chat_display_tags) ?
@@ -1536,6 +1607,19 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
                                    &lines_displayed, simulate);
     }
 
+    /* save layout of message for next simulations */
+    if (use_layout)
+    {
+        gui_line_layout_misses++;
+        layout_lines = lines_displayed - layout_lines;
+        if ((window->win_chat_cursor_x == 0) && (layout_lines <= SHRT_MAX))
+        {
+            layout.lines = layout_lines;
+            line->data->layout = layout;
+        }
+    }
+
+end_message:
     if (message_with_tags)
         free (message_with_tags);
     if (message_with_search)
@@ -1840,6 +1924,8 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
                                       (-1) * (window->win_chat_height - 1));
     }
 
+    GUI_WINDOW_OBJECTS(window)->chat_next_y = -1;
+
     if (!ptr_line)
         return;
 
@@ -1908,6 +1994,23 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
                                  WEECHAT_HOOK_SIGNAL_POINTER, window);
     }
 
+    /*
+     * save state of chat area if all lines were displayed up to the end of
+     * buffer: next lines added can then be drawn without a full draw
+     */
+    if (!ptr_line && !window->scroll->start_line && !window->scroll->scrolling
+        && (window->win_chat_cursor_y <= window->win_chat_height))
+    {
+        GUI_WINDOW_OBJECTS(window)->chat_next_y = window->win_chat_cursor_y;
+        GUI_WINDOW_OBJECTS(window)->chat_lines = window->buffer->lines;
+        GUI_WINDOW_OBJECTS(window)->chat_width = window->win_chat_width;
+        GUI_WINDOW_OBJECTS(window)->chat_height = window->win_chat_height;
+        GUI_WINDOW_OBJECTS(window)->chat_prefix_max_length =
+            window->buffer->lines->prefix_max_length;
+        GUI_WINDOW_OBJECTS(window)->chat_buffer_max_length =
+            window->buffer->lines->buffer_max_length;
+    }
+
     /* cursor is below end line of chat window? */
     if (window->win_chat_cursor_y > window->win_chat_height - 1)
     {
@@ -1916,6 +2019,155 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     }
 }
 
+/*
+ * Checks if the day of two dates is the same.
+ *
+ * Returns:
+ *   1: same day
+ *   0: different days
+ */
+
+int
+gui_chat_is_same_day (time_t date1, time_t date2)
+{
+    struct tm local_time1, local_time2;
+
+    localtime_r (&date1, &local_time1);
+    localtime_r (&date2, &local_time2);
+
+    return ((local_time1.tm_mday == local_time2.tm_mday)
+            && (local_time1.tm_mon == local_time2.tm_mon)
+            && (local_time1.tm_year == local_time2.tm_year)) ? 1 : 0;
+}
+
+/*
+ * Draws only the lines added at the end of a formatted buffer since the last
+ * draw of chat area: the chat area is scrolled up if needed and the new lines
+ * are drawn at bottom, other lines are not drawn again.
+ *
+ * Returns:
+ *   1: new lines drawn
+ *   0: chat area must be fully drawn
+ */
+
+int
+gui_chat_draw_formatted_buffer_lines_added (struct t_gui_window *window)
+{
+    struct t_gui_window_curses_objects *ptr_objects;
+    struct t_gui_line *ptr_last_line, *ptr_line;
+    struct timeval tv_time;
+    int next_y, rows, shift, i;
+
+    ptr_objects = GUI_WINDOW_OBJECTS(window);
+    next_y = ptr_objects->chat_next_y;
+
+    if ((next_y <= 0)
+        || (next_y > window->win_chat_height)
+        || window->scroll->start_line
+        || (window->buffer->text_search != GUI_TEXT_SEARCH_DISABLED)
+        || (ptr_objects->chat_lines != window->buffer->lines)
+        || (ptr_objects->chat_width != window->win_chat_width)
+        || (ptr_objects->chat_height != window->win_chat_height)
+        || (ptr_objects->chat_prefix_max_length != window->buffer->lines->prefix_max_length)
+        || (ptr_objects->chat_buffer_max_length != window->buffer->lines->buffer_max_length)
+        || !window->coords
+        || (window->coords_size != window->win_chat_height))
+    {
+        return 0;
+    }
+
+    /* the prefix of last line displayed can depend on next line */
+    if (CONFIG_STRING(config_look_prefix_same_nick_middle)
+        && CONFIG_STRING(config_look_prefix_same_nick_middle)[0])
+    {
+        return 0;
+    }
+
+    /*
+     * last line displayed: it must not change with the new lines (no read
+     * marker or day change message to display after this line)
+     */
+    ptr_last_line = window->coords[next_y - 1].line;
+    if (!ptr_last_line
+        || gui_chat_marker_for_line (window->buffer, ptr_last_line))
+    {
+        return 0;
+    }
+    if (CONFIG_BOOLEAN(config_look_day_change) && window->buffer->day_change)
+    {
+        if (ptr_last_line->data->date == 0)
+            return 0;
+        gettimeofday (&tv_time, NULL);
+        if (!gui_chat_is_same_day (ptr_last_line->data->date, tv_time.tv_sec))
+            return 0;
+        ptr_line = gui_line_get_next_displayed (ptr_last_line);
+        while (ptr_line && (ptr_line->data->date == 0))
+        {
+            ptr_line = gui_line_get_next_displayed (ptr_line);
+        }
+        if (ptr_line
+            && !gui_chat_is_same_day (ptr_last_line->data->date,
+                                      ptr_line->data->date))
+        {
+            return 0;
+        }
+    }
+
+    /* count rows of new lines, full draw if they fill the chat area */
+    rows = 0;
+    ptr_line = gui_line_get_next_displayed (ptr_last_line);
+    while (ptr_line)
+    {
+        rows += gui_chat_display_line (window, ptr_line, 0, 1);
+        if (rows >= window->win_chat_height)
+            return 0;
+        ptr_line = gui_line_get_next_displayed (ptr_line);
+    }
+
+    /* scroll up the chat area to make room for the new lines */
+    shift = next_y + rows - window->win_chat_height;
+    if (shift > 0)
+    {
+        scrollok (ptr_objects->win_chat, TRUE);
+        wscrl (ptr_objects->win_chat, shift);
+        scrollok (ptr_objects->win_chat, FALSE);
+        memmove (window->coords, window->coords + shift,
+                 (window->coords_size - shift) * sizeof (window->coords[0]));
+        for (i = window->coords_size - shift; i < window->coords_size; i++)
+        {
+            gui_window_coords_init_line (window, i);
+        }
+        next_y -= shift;
+        window->scroll->first_line_displayed = 0;
+    }
+
+    gui_chat_reset_style (window, NULL, 0, 1,
+                          GUI_COLOR_CHAT_INACTIVE_WINDOW,
+                          GUI_COLOR_CHAT_INACTIVE_BUFFER,
+                          GUI_COLOR_CHAT);
+
+    /* display new lines */
+    window->win_chat_cursor_x = 0;
+    window->win_chat_cursor_y = next_y;
+    ptr_line = gui_line_get_next_displayed (ptr_last_line);
+    while (ptr_line && (window->win_chat_cursor_y <= window->win_chat_height - 1))
+    {
+        gui_chat_display_line (window, ptr_line, 0, 0);
+        ptr_line = gui_line_get_next_displayed (ptr_line);
+    }
+
+    ptr_objects->chat_next_y = window->win_chat_cursor_y;
+
+    /* cursor is below end line of chat window? */
+    if (window->win_chat_cursor_y > window->win_chat_height - 1)
+    {
+        window->win_chat_cursor_x = 0;
+        window->win_chat_cursor_y = window->win_chat_height - 1;
+    }
+
+    return 1;
+}
+
 /*
  * Draws chat window for a free buffer.
  */
@@ -2133,6 +2385,21 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
             && (ptr_win->win_chat_x >= 0) && (ptr_win->win_chat_y >= 0)
             && (GUI_WINDOW_OBJECTS(ptr_win)->win_chat))
         {
+            /* only lines added at end of buffer? then draw only these lines */
+            if (!clear_chat
+                && !buffer->chat_refresh_needed
+                && buffer->chat_lines_added
+                && (ptr_win->buffer->type == GUI_BUFFER_TYPE_FORMATTED)
+                && (ptr_win->win_chat_height >= 2)
+                && gui_chat_draw_formatted_buffer_lines_added (ptr_win))
+            {
+                gui_chat_draws_partial++;
+                wnoutrefresh (GUI_WINDOW_OBJECTS(ptr_win)->win_chat);
+                continue;
+            }
+
+            gui_chat_draws_full++;
+
             gui_window_coords_alloc (ptr_win);
 
             gui_chat_reset_style (ptr_win, NULL, 0, 1,
@@ -2186,4 +2453,5 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
 
 end:
     buffer->chat_refresh_needed = 0;
+    buffer->chat_lines_added = 0;
 }
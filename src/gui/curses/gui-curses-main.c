@@ -352,6 +352,9 @@ gui_main_refreshes ()
         gui_color_buffer_refresh_needed = 0;
     }
 
+    /* update bar items (updates asked since last refresh) */
+    gui_bar_item_process_updates ();
+
     /* compute max length for prefix/buffer if needed */
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
@@ -417,7 +420,7 @@ gui_main_refreshes ()
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
-        if (ptr_buffer->chat_refresh_needed)
+        if (ptr_buffer->chat_refresh_needed || ptr_buffer->chat_lines_added)
         {
             gui_chat_draw (ptr_buffer,
                            (ptr_buffer->chat_refresh_needed) > 1 ? 1 : 0);
@@ -426,6 +429,12 @@ gui_main_refreshes ()
 
     if (!gui_window_bare_display)
     {
+        /*
+         * update bar items again (updates asked during draw of chat areas,
+         * for example item "scroll" on signal "window_scrolled")
+         */
+        gui_bar_item_process_updates ();
+
         /* refresh bars if needed */
         for (ptr_bar = gui_bars; ptr_bar; ptr_bar = ptr_bar->next_bar)
         {
@@ -594,6 +603,9 @@ gui_main_end (int clean_exit)
         /* free some variables used for chat area */
         gui_chat_end ();
 
+        /* free some variables used for lines */
+        gui_line_end ();
+
         /* free some variables used for nicklist */
         gui_nicklist_end ();
 
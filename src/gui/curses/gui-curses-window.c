@@ -134,6 +134,12 @@ gui_window_objects_init (struct t_gui_window *window)
         GUI_WINDOW_OBJECTS(window)->win_chat = NULL;
         GUI_WINDOW_OBJECTS(window)->win_separator_horiz = NULL;
         GUI_WINDOW_OBJECTS(window)->win_separator_vertic = NULL;
+        GUI_WINDOW_OBJECTS(window)->chat_next_y = -1;
+        GUI_WINDOW_OBJECTS(window)->chat_lines = NULL;
+        GUI_WINDOW_OBJECTS(window)->chat_width = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_height = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_prefix_max_length = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_buffer_max_length = 0;
         return 1;
     }
     return 0;
@@ -154,6 +160,7 @@ gui_window_objects_free (struct t_gui_window *window, int free_separators)
         delwin (GUI_WINDOW_OBJECTS(window)->win_chat);
         GUI_WINDOW_OBJECTS(window)->win_chat = NULL;
     }
+    GUI_WINDOW_OBJECTS(window)->chat_next_y = -1;
     if (free_separators)
     {
         if  (GUI_WINDOW_OBJECTS(window)->win_separator_horiz)
@@ -2626,4 +2633,10 @@ gui_window_objects_print_log (struct t_gui_window *window)
     log_printf ("    win_chat. . . . . . . : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_chat);
     log_printf ("    win_separator_horiz . : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_separator_horiz);
     log_printf ("    win_separator_vertic. : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_separator_vertic);
+    log_printf ("    chat_next_y . . . . . : %d",    GUI_WINDOW_OBJECTS(window)->chat_next_y);
+    log_printf ("    chat_lines. . . . . . : 0x%lx", GUI_WINDOW_OBJECTS(window)->chat_lines);
+    log_printf ("    chat_width. . . . . . : %d",    GUI_WINDOW_OBJECTS(window)->chat_width);
+    log_printf ("    chat_height . . . . . : %d",    GUI_WINDOW_OBJECTS(window)->chat_height);
+    log_printf ("    chat_prefix_max_length: %d",    GUI_WINDOW_OBJECTS(window)->chat_prefix_max_length);
+    log_printf ("    chat_buffer_max_length: %d",    GUI_WINDOW_OBJECTS(window)->chat_buffer_max_length);
 }
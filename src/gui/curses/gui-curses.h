@@ -37,6 +37,7 @@
 
 struct t_gui_buffer;
 struct t_gui_line;
+struct t_gui_lines;
 struct t_gui_window;
 struct t_gui_bar_window;
 
@@ -68,12 +69,24 @@ struct t_gui_window_curses_objects
     WINDOW *win_chat;               /* chat window (example: channel)       */
     WINDOW *win_separator_horiz;    /* horizontal separator (optional)      */
     WINDOW *win_separator_vertic;   /* vertical separator (optional)        */
+    /* state of chat area after last draw, used to draw only added lines    */
+    int chat_next_y;                /* y for next line (-1 = full draw)     */
+    struct t_gui_lines *chat_lines; /* lines displayed                      */
+    int chat_width;                 /* width of chat area                   */
+    int chat_height;                /* height of chat area                  */
+    int chat_prefix_max_length;     /* max length of prefix in lines        */
+    int chat_buffer_max_length;     /* max length of buffer name in lines   */
 };
 
 struct t_gui_bar_window_curses_objects
 {
     WINDOW *win_bar;                /* bar Curses window                    */
     WINDOW *win_separator;          /* separator (optional)                 */
+    /* content drawn, the bar window is not drawn again if it is unchanged  */
+    char *content;                  /* content drawn (NULL = not drawn)     */
+    int x, y;                       /* position of bar window               */
+    int width, height;              /* size of bar window                   */
+    int scroll_x, scroll_y;         /* scroll in bar window                 */
 };
 
 extern int gui_term_cols, gui_term_lines;
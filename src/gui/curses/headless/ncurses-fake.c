@@ -19,6 +19,9 @@
  * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
+#include <stdarg.h>
+
 #include "ncurses-fake.h"
 
 
@@ -27,6 +30,30 @@ WINDOW _stdscr = { 0, 0, 24, 79, 0, 0 };
 WINDOW *stdscr = &_stdscr;
 chtype acs_map[256];
 
+/* number of cells written (to measure the cost of screen refreshes) */
+unsigned long long ncurses_fake_cells_written = 0;
+
+
+/*
+ * Adds number of cells written for a string (one cell per UTF-8 char) to
+ * counter "ncurses_fake_cells_written". If n >= 0, at most n bytes are read.
+ */
+
+void
+ncurses_fake_count_cells (const char *str, int n)
+{
+    if (!str)
+        return;
+
+    while (str[0] && (n != 0))
+    {
+        if (((unsigned char)str[0] & 0xC0) != 0x80)
+            ncurses_fake_cells_written++;
+        str++;
+        if (n > 0)
+            n--;
+    }
+}
 
 WINDOW *
 initscr ()
@@ -142,7 +169,8 @@ int
 waddstr (WINDOW *win, const char *str)
 {
     (void) win;
-    (void) str;
+
+    ncurses_fake_count_cells (str, -1);
 
     return OK;
 }
@@ -151,8 +179,8 @@ int
 waddnstr (WINDOW *win, const char *str, int n)
 {
     (void) win;
-    (void) str;
-    (void) n;
+
+    ncurses_fake_count_cells (str, n);
 
     return OK;
 }
@@ -162,7 +190,8 @@ mvaddstr (int y, int x, const char *str)
 {
     (void) y;
     (void) x;
-    (void) str;
+
+    ncurses_fake_count_cells (str, -1);
 
     return OK;
 }
@@ -173,7 +202,8 @@ mvwaddstr (WINDOW *win, int y, int x, const char *str)
     (void) win;
     (void) y;
     (void) x;
-    (void) str;
+
+    ncurses_fake_count_cells (str, -1);
 
     return OK;
 }
@@ -219,10 +249,18 @@ wclrtoeol (WINDOW *win)
 int
 mvwprintw (WINDOW *win, int y, int x, const char *fmt, ...)
 {
+    va_list args;
+    char str[4096];
+
     (void) win;
     (void) y;
     (void) x;
-    (void) fmt;
+
+    va_start (args, fmt);
+    vsnprintf (str, sizeof (str), fmt, args);
+    va_end (args);
+
+    ncurses_fake_count_cells (str, -1);
 
     return OK;
 }
@@ -366,7 +404,9 @@ whline (WINDOW *win, chtype ch, int n)
 {
     (void) win;
     (void) ch;
-    (void) n;
+
+    if (n > 0)
+        ncurses_fake_cells_written += n;
 }
 
 void
@@ -374,7 +414,9 @@ wvline (WINDOW *win, chtype ch, int n)
 {
     (void) win;
     (void) ch;
-    (void) n;
+
+    if (n > 0)
+        ncurses_fake_cells_written += n;
 }
 
 int
@@ -384,7 +426,9 @@ mvwhline (WINDOW *win, int y, int x, chtype ch, int n)
     (void) y;
     (void) x;
     (void) ch;
-    (void) n;
+
+    if (n > 0)
+        ncurses_fake_cells_written += n;
 
     return OK;
 }
@@ -396,7 +440,9 @@ mvwvline (WINDOW *win, int y, int x, chtype ch, int n)
     (void) y;
     (void) x;
     (void) ch;
-    (void) n;
+
+    if (n > 0)
+        ncurses_fake_cells_written += n;
 
     return OK;
 }
@@ -450,3 +496,21 @@ wgetch (WINDOW *win)
 
     return OK;
 }
+
+int
+scrollok (WINDOW *win, bool bf)
+{
+    (void) win;
+    (void) bf;
+
+    return OK;
+}
+
+int
+wscrl (WINDOW *win, int n)
+{
+    (void) win;
+    (void) n;
+
+    return OK;
+}
@@ -80,6 +80,9 @@ typedef struct _cchar_t cchar_t;
 
 extern WINDOW *stdscr;
 extern chtype acs_map[];
+extern unsigned long long ncurses_fake_cells_written;
+
+extern void ncurses_fake_count_cells (const char *str, int n);
 
 extern WINDOW *initscr ();
 extern int endwin ();
@@ -132,5 +135,7 @@ extern int use_default_colors ();
 extern int resizeterm ();
 extern int getch ();
 extern int wgetch (WINDOW *win);
+extern int scrollok (WINDOW *win, bool bf);
+extern int wscrl (WINDOW *win, int n);
 
 #endif /* WEECHAT_NCURSES_FAKE_H */
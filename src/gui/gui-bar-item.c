@@ -80,6 +80,7 @@ char *gui_bar_items_default_for_bars[][2] =
 };
 struct t_gui_bar_item_hook *gui_bar_item_hooks = NULL;
 struct t_hook *gui_bar_item_timer = NULL;
+int gui_bar_item_updates_pending = 0;   /* updates of items to process     */
 
 
 /*
@@ -396,6 +397,7 @@ gui_bar_item_get_value (struct t_gui_bar *bar, struct t_gui_window *window,
                                                     bar->items_name[item][subitem]);
         if (ptr_item && ptr_item->build_callback)
         {
+            ptr_item->builds++;
             item_value = (ptr_item->build_callback) (
                 ptr_item->build_callback_pointer,
                 ptr_item->build_callback_data,
@@ -554,6 +556,10 @@ gui_bar_item_new (struct t_weechat_plugin *plugin, const char *name,
         new_bar_item->build_callback = build_callback;
         new_bar_item->build_callback_pointer = build_callback_pointer;
         new_bar_item->build_callback_data = build_callback_data;
+        new_bar_item->update_pending = 0;
+        new_bar_item->updates_requested = 0;
+        new_bar_item->updates_done = 0;
+        new_bar_item->builds = 0;
 
         /* add bar item to bar items queue */
         new_bar_item->prev_item = last_gui_bar_item;
@@ -572,11 +578,12 @@ gui_bar_item_new (struct t_weechat_plugin *plugin, const char *name,
 }
 
 /*
- * Updates an item on all bars displayed on screen.
+ * Updates an item on all bars displayed on screen: asks refresh of item in
+ * bar windows and checks conditions of bars.
  */
 
 void
-gui_bar_item_update (const char *item_name)
+gui_bar_item_update_bars (const char *item_name)
 {
     struct t_gui_bar *ptr_bar;
     struct t_gui_window *ptr_window;
@@ -663,6 +670,78 @@ gui_bar_item_update (const char *item_name)
     }
 }
 
+/*
+ * Asks update of an item on all bars displayed on screen.
+ *
+ * The update is done in the next refresh of screen (see function
+ * gui_main_refreshes), so that many updates of the same item between two
+ * refreshes are done only once.
+ *
+ * If no item is found with this name, the bars are updated immediately.
+ */
+
+void
+gui_bar_item_update (const char *item_name)
+{
+    struct t_gui_bar_item *ptr_item;
+    int item_found;
+
+    if (!item_name)
+        return;
+
+    item_found = 0;
+    for (ptr_item = gui_bar_items; ptr_item; ptr_item = ptr_item->next_item)
+    {
+        if (strcmp (ptr_item->name, item_name) == 0)
+        {
+            ptr_item->updates_requested++;
+            ptr_item->update_pending = 1;
+            item_found = 1;
+        }
+    }
+
+    if (item_found)
+        gui_bar_item_updates_pending = 1;
+    else
+        gui_bar_item_update_bars (item_name);
+}
+
+/*
+ * Updates all items with an update pending (this function is called once
+ * before each refresh of screen).
+ */
+
+void
+gui_bar_item_process_updates ()
+{
+    struct t_gui_bar_item *ptr_item, *ptr_item2;
+
+    if (!gui_bar_item_updates_pending)
+        return;
+
+    gui_bar_item_updates_pending = 0;
+
+    for (ptr_item = gui_bar_items; ptr_item; ptr_item = ptr_item->next_item)
+    {
+        if (!ptr_item->update_pending)
+            continue;
+
+        /* items with same name (in other plugins) are updated at same time */
+        for (ptr_item2 = ptr_item; ptr_item2;
+             ptr_item2 = ptr_item2->next_item)
+        {
+            if (ptr_item2->update_pending
+                && (strcmp (ptr_item2->name, ptr_item->name) == 0))
+            {
+                ptr_item2->update_pending = 0;
+                ptr_item2->updates_done++;
+            }
+        }
+
+        gui_bar_item_update_bars (ptr_item->name);
+    }
+}
+
 /*
  * Deletes a bar item.
  */
@@ -674,7 +753,7 @@ gui_bar_item_free (struct t_gui_bar_item *item)
         return;
 
     /* force refresh of bars displaying this bar item */
-    gui_bar_item_update (item->name);
+    gui_bar_item_update_bars (item->name);
 
     /* remove bar item from bar items list */
     if (item->prev_item)
@@ -1656,6 +1735,49 @@ gui_bar_item_buffer_title_cb (const void *pointer, void *data,
     return (buffer->title) ? strdup (buffer->title) : NULL;
 }
 
+/*
+ * Adds color of a nick/group in nicklist: the color is a color name or the
+ * name of a color option (like "weechat.color.nicklist_away").
+ *
+ * The color code of the last color added is kept in "last_color_code" (for
+ * pointer "last_color"): nick colors are shared strings, so consecutive nicks
+ * with same color (very common in nicklist) don't need to compute the color
+ * code again.
+ */
+
+void
+gui_bar_item_nicklist_add_color (char **nicklist, const char *color,
+                                 const char **last_color,
+                                 char *last_color_code, int size)
+{
+    struct t_config_option *ptr_option;
+
+    if (color != *last_color)
+    {
+        last_color_code[0] = '\0';
+        if (strchr (color, '.'))
+        {
+            config_file_search_with_string (color, NULL, NULL, &ptr_option,
+                                            NULL);
+            if (ptr_option)
+            {
+                snprintf (last_color_code, size, "%s",
+                          gui_color_get_custom (
+                              gui_color_get_name (
+                                  CONFIG_COLOR(ptr_option))));
+            }
+        }
+        else
+        {
+            snprintf (last_color_code, size, "%s",
+                      gui_color_get_custom (color));
+        }
+        *last_color = color;
+    }
+
+    string_dyn_concat (nicklist, last_color_code);
+}
+
 /*
  * Bar item with nicklist.
  */
@@ -1669,8 +1791,9 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
 {
     struct t_gui_nick_group *ptr_group;
     struct t_gui_nick *ptr_nick;
-    struct t_config_option *ptr_option;
     char **nicklist, *str_nicklist;
+    const char *last_prefix_color, *last_color;
+    char prefix_color_code[96], color_code[96];
     int i;
 
     /* make C compiler happy */
@@ -1687,6 +1810,9 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
     if (!nicklist)
         return NULL;
 
+    last_prefix_color = NULL;
+    last_color = NULL;
+
     ptr_group = NULL;
     ptr_nick = NULL;
     gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
@@ -1711,51 +1837,18 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
                 }
                 if (ptr_nick->prefix_color)
                 {
-                    if (strchr (ptr_nick->prefix_color, '.'))
-                    {
-                        config_file_search_with_string (ptr_nick->prefix_color,
-                                                        NULL, NULL, &ptr_option,
-                                                            NULL);
-                        if (ptr_option)
-                        {
-                            string_dyn_concat (
-                                nicklist,
-                                gui_color_get_custom (
-                                    gui_color_get_name (
-                                        CONFIG_COLOR(ptr_option))));
-                        }
-                    }
-                    else
-                    {
-                        string_dyn_concat (nicklist,
-                                           gui_color_get_custom (
-                                               ptr_nick->prefix_color));
-                    }
+                    gui_bar_item_nicklist_add_color (
+                        nicklist, ptr_nick->prefix_color,
+                        &last_prefix_color, prefix_color_code,
+                        sizeof (prefix_color_code));
                 }
                 if (ptr_nick->prefix)
                     string_dyn_concat (nicklist, ptr_nick->prefix);
                 if (ptr_nick->color)
                 {
-                    if (strchr (ptr_nick->color, '.'))
-                    {
-                        config_file_search_with_string (ptr_nick->color,
-                                                        NULL, NULL, &ptr_option,
-                                                        NULL);
-                        if (ptr_option)
-                        {
-                            string_dyn_concat (
-                                nicklist,
-                                gui_color_get_custom (
-                                    gui_color_get_name (
-                                        CONFIG_COLOR(ptr_option))));
-                        }
-                    }
-                    else
-                    {
-                        string_dyn_concat (nicklist,
-                                           gui_color_get_custom (
-                                               ptr_nick->color));
-                    }
+                    gui_bar_item_nicklist_add_color (
+                        nicklist, ptr_nick->color,
+                        &last_color, color_code, sizeof (color_code));
                 }
                 string_dyn_concat (nicklist, ptr_nick->name);
             }
@@ -1767,26 +1860,9 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
                 }
                 if (ptr_group->color)
                 {
-                    if (strchr (ptr_group->color, '.'))
-                    {
-                        config_file_search_with_string (ptr_group->color,
-                                                        NULL, NULL, &ptr_option,
-                                                        NULL);
-                        if (ptr_option)
-                        {
-                            string_dyn_concat (
-                                nicklist,
-                                gui_color_get_custom (
-                                    gui_color_get_name (
-                                        CONFIG_COLOR(ptr_option))));
-                        }
-                    }
-                    else
-                    {
-                        string_dyn_concat (nicklist,
-                                           gui_color_get_custom (
-                                               ptr_group->color));
-                    }
+                    gui_bar_item_nicklist_add_color (
+                        nicklist, ptr_group->color,
+                        &last_color, color_code, sizeof (color_code));
                 }
                 string_dyn_concat (nicklist,
                                    gui_nicklist_get_group_start (
@@ -2057,6 +2133,46 @@ gui_bar_item_signal_cb (const void *pointer, void *data,
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Callback for signals "nicklist_*": asks update of nicklist item, only if
+ * the buffer is displayed in a window.
+ */
+
+int
+gui_bar_item_nicklist_signal_cb (const void *pointer, void *data,
+                                 const char *signal,
+                                 const char *type_data, void *signal_data)
+{
+    struct t_gui_buffer *ptr_buffer;
+    unsigned long value;
+    int rc;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+    (void) type_data;
+
+    /* signal data is: "0x123abc,nick" (pointer to buffer and nick/group) */
+    if (signal_data)
+    {
+        rc = sscanf ((const char *)signal_data, "%lx", &value);
+        if ((rc != EOF) && (rc != 0))
+        {
+            ptr_buffer = (struct t_gui_buffer *)value;
+            if (gui_buffer_valid (ptr_buffer)
+                && (ptr_buffer->num_displayed == 0))
+            {
+                return WEECHAT_RC_OK;
+            }
+        }
+    }
+
+    gui_bar_item_update (gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]);
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Hooks a signal to update bar items.
  */
@@ -2084,6 +2200,7 @@ gui_bar_item_hook_signal (const char *signal, const char *item)
 void
 gui_bar_item_init ()
 {
+    struct t_gui_bar_item_hook *bar_item_hook;
     char name[128];
 
     /* input paste */
@@ -2301,8 +2418,15 @@ gui_bar_item_init ()
     gui_bar_item_new (NULL,
                       gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST],
                       &gui_bar_item_buffer_nicklist_cb, NULL, NULL);
-    gui_bar_item_hook_signal ("nicklist_*",
-                              gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]);
+    bar_item_hook = malloc (sizeof (*bar_item_hook));
+    if (bar_item_hook)
+    {
+        bar_item_hook->hook = hook_signal (NULL, "nicklist_*",
+                                           &gui_bar_item_nicklist_signal_cb,
+                                           NULL, NULL);
+        bar_item_hook->next_hook = gui_bar_item_hooks;
+        gui_bar_item_hooks = bar_item_hook;
+    }
     gui_bar_item_hook_signal ("window_switch",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]);
     gui_bar_item_hook_signal ("buffer_switch",
@@ -2385,6 +2509,7 @@ gui_bar_item_hdata_bar_item_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_bar_item, build_callback, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_item, build_callback_pointer, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_item, build_callback_data, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_bar_item, update_pending, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_item, prev_item, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_bar_item, next_item, POINTER, 0, NULL, hdata_name);
         HDATA_LIST(gui_bar_items, WEECHAT_HDATA_LIST_CHECK_POINTERS);
@@ -2447,6 +2572,10 @@ gui_bar_item_print_log ()
         log_printf ("  build_callback . . . . : 0x%lx", ptr_item->build_callback);
         log_printf ("  build_callback_pointer : 0x%lx", ptr_item->build_callback_pointer);
         log_printf ("  build_callback_data. . : 0x%lx", ptr_item->build_callback_data);
+        log_printf ("  update_pending . . . . : %d",    ptr_item->update_pending);
+        log_printf ("  updates_requested. . . : %llu",  ptr_item->updates_requested);
+        log_printf ("  updates_done . . . . . : %llu",  ptr_item->updates_done);
+        log_printf ("  builds . . . . . . . . : %llu",  ptr_item->builds);
         log_printf ("  prev_item. . . . . . . : 0x%lx", ptr_item->prev_item);
         log_printf ("  next_item. . . . . . . : 0x%lx", ptr_item->next_item);
     }
@@ -65,6 +65,13 @@ struct t_gui_bar_item
                                      /* callback called for building item   */
     const void *build_callback_pointer; /* pointer for callback             */
     void *build_callback_data;          /* data for callback                */
+    int update_pending;              /* 1 if update asked (done in next     */
+                                     /* refresh of screen)                  */
+    unsigned long long updates_requested; /* number of updates asked        */
+    unsigned long long updates_done; /* number of updates done (updates    */
+                                     /* asked between 2 refreshes are done  */
+                                     /* only once)                          */
+    unsigned long long builds;       /* number of calls to build callback   */
     struct t_gui_bar_item *prev_item; /* link to previous bar item          */
     struct t_gui_bar_item *next_item; /* link to next bar item              */
 };
@@ -81,6 +88,7 @@ extern struct t_gui_bar_item *gui_bar_items;
 extern struct t_gui_bar_item *last_gui_bar_item;
 extern char *gui_bar_item_names[];
 extern char *gui_bar_items_default_for_bars[][2];
+extern int gui_bar_item_updates_pending;
 
 /* functions */
 
@@ -110,6 +118,7 @@ extern struct t_gui_bar_item *gui_bar_item_new (struct t_weechat_plugin *plugin,
                                                 const void *build_callback_pointer,
                                                 void *build_callback_data);
 extern void gui_bar_item_update (const char *name);
+extern void gui_bar_item_process_updates ();
 extern void gui_bar_item_free (struct t_gui_bar_item *item);
 extern void gui_bar_item_free_all ();
 extern void gui_bar_item_free_all_plugin (struct t_weechat_plugin *plugin);
@@ -45,6 +45,11 @@
 #include "gui-window.h"
 
 
+unsigned long long gui_bar_window_draws = 0;   /* number of bar windows drawn */
+unsigned long long gui_bar_window_draws_skipped = 0; /* draws skipped       */
+                                               /* (content unchanged)       */
+
+
 /*
  * Checks if a bar window pointer is valid.
  *
@@ -63,6 +63,11 @@ struct t_gui_bar_window
                                               /* (only for non-root bars)   */
 };
 
+/* variables */
+
+extern unsigned long long gui_bar_window_draws;
+extern unsigned long long gui_bar_window_draws_skipped;
+
 /* functions */
 
 extern int gui_bar_window_valid (struct t_gui_bar_window *bar_window);
@@ -339,6 +339,7 @@ gui_bar_check_conditions (struct t_gui_bar *bar,
                                   NULL, NULL);
         if (pointers)
         {
+            hashtable_set_arena (pointers, 0);
             hashtable_set (pointers, "window", window);
             if (window)
                 hashtable_set (pointers, "buffer", window->buffer);
@@ -349,6 +350,7 @@ gui_bar_check_conditions (struct t_gui_bar *bar,
                                     NULL, NULL);
         if (extra_vars)
         {
+            hashtable_set_arena (extra_vars, 0);
             hashtable_set (extra_vars, "active",
                            (gui_current_window && (gui_current_window == window)) ? "1" : "0");
             hashtable_set (extra_vars, "inactive",
@@ -361,7 +363,10 @@ gui_bar_check_conditions (struct t_gui_bar *bar,
                                  WEECHAT_HASHTABLE_STRING,
                                  NULL, NULL);
         if (options)
+        {
+            hashtable_set_arena (options, 0);
             hashtable_set (options, "type", "condition");
+        }
 
         result = eval_expression (conditions, pointers, extra_vars, options);
 
@@ -92,7 +92,8 @@ char *gui_buffer_properties_get_integer[] =
   "prefix_max_length", "time_for_each_line", "nicklist",
   "nicklist_case_sensitive", "nicklist_max_length", "nicklist_display_groups",
   "nicklist_count", "nicklist_groups_count", "nicklist_nicks_count",
-  "nicklist_visible_count", "input", "input_get_unknown_commands",
+  "nicklist_visible_count", "nicklist_bulk", "nickcmp_case_range", "input",
+  "input_get_unknown_commands",
   "input_get_empty", "input_size", "input_length", "input_pos",
   "input_1st_display", "num_history", "text_search", "text_search_exact",
   "text_search_regex", "text_search_where", "text_search_found",
@@ -112,7 +113,9 @@ char *gui_buffer_properties_set[] =
 { "hotlist", "unread", "display", "hidden", "print_hooks_enabled", "day_change",
   "clear", "filter", "number", "name", "short_name", "type", "notify", "title",
   "time_for_each_line", "nicklist", "nicklist_case_sensitive",
-  "nicklist_display_groups", "highlight_words", "highlight_words_add",
+  "nicklist_display_groups", "nicklist_bulk", "nickcmp_case_range",
+  "highlight_words",
+  "highlight_words_add",
   "highlight_words_del", "highlight_regex", "highlight_tags_restrict",
   "highlight_tags", "hotlist_max_level_nicks", "hotlist_max_level_nicks_add",
   "hotlist_max_level_nicks_del", "input", "input_pos",
@@ -719,6 +722,7 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     new_buffer->lines = new_buffer->own_lines;
     new_buffer->time_for_each_line = 1;
     new_buffer->chat_refresh_needed = 2;
+    new_buffer->chat_lines_added = 0;
 
     /* nicklist */
     new_buffer->nicklist = 0;
@@ -730,9 +734,12 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     new_buffer->nicklist_groups_count = 0;
     new_buffer->nicklist_nicks_count = 0;
     new_buffer->nicklist_visible_count = 0;
+    new_buffer->nicklist_bulk = 0;
+    new_buffer->nicklist_nicks_index = NULL;
     new_buffer->nickcmp_callback = NULL;
     new_buffer->nickcmp_callback_pointer = NULL;
     new_buffer->nickcmp_callback_data = NULL;
+    new_buffer->nickcmp_case_range = -1;
     gui_nicklist_add_group (new_buffer, NULL, "root", NULL, 0);
 
     /* input */
@@ -1173,6 +1180,10 @@ gui_buffer_get_integer (struct t_gui_buffer *buffer, const char *property)
         return buffer->nicklist_nicks_count;
     else if (string_strcasecmp (property, "nicklist_visible_count") == 0)
         return buffer->nicklist_visible_count;
+    else if (string_strcasecmp (property, "nicklist_bulk") == 0)
+        return buffer->nicklist_bulk;
+    else if (string_strcasecmp (property, "nickcmp_case_range") == 0)
+        return buffer->nickcmp_case_range;
     else if (string_strcasecmp (property, "input") == 0)
         return buffer->input;
     else if (string_strcasecmp (property, "input_get_unknown_commands") == 0)
@@ -1284,6 +1295,20 @@ gui_buffer_ask_chat_refresh (struct t_gui_buffer *buffer, int refresh)
         buffer->chat_refresh_needed = refresh;
 }
 
+/*
+ * Sets flag "chat_lines_added": lines have been added at the end of buffer,
+ * so the GUI can draw only these lines if nothing else has changed.
+ */
+
+void
+gui_buffer_ask_chat_refresh_lines_added (struct t_gui_buffer *buffer)
+{
+    if (!buffer)
+        return;
+
+    buffer->chat_lines_added = 1;
+}
+
 /*
  * Sets name for a buffer.
  */
@@ -1291,14 +1316,23 @@ gui_buffer_ask_chat_refresh (struct t_gui_buffer *buffer, int refresh)
 void
 gui_buffer_set_name (struct t_gui_buffer *buffer, const char *name)
 {
+    char *old_full_name;
+
     if (!buffer || !name || !name[0])
         return;
 
     if (buffer->name)
         free (buffer->name);
     buffer->name = strdup (name);
+    old_full_name = buffer->full_name;
+    buffer->full_name = NULL;
     gui_buffer_build_full_name (buffer);
 
+    /* filters matching the buffer may have changed */
+    gui_filter_buffer_renamed (buffer, old_full_name);
+    if (old_full_name)
+        free (old_full_name);
+
     gui_buffer_local_var_add (buffer, "name", name);
 
     (void) hook_signal_send ("buffer_renamed",
@@ -1431,6 +1465,29 @@ gui_buffer_set_nicklist_display_groups (struct t_gui_buffer *buffer,
     gui_window_ask_refresh (1);
 }
 
+/*
+ * Sets flag "nicklist_bulk" for a buffer.
+ *
+ * In bulk mode, nicks added are not sorted and no nicklist signal is sent;
+ * when bulk mode is disabled, all nicks are sorted at once and a single
+ * signal "nicklist_changed" is sent.
+ */
+
+void
+gui_buffer_set_nicklist_bulk (struct t_gui_buffer *buffer, int bulk)
+{
+    if (!buffer)
+        return;
+
+    bulk = (bulk) ? 1 : 0;
+    if (bulk == buffer->nicklist_bulk)
+        return;
+
+    buffer->nicklist_bulk = bulk;
+    if (!bulk)
+        gui_nicklist_bulk_end (buffer);
+}
+
 /*
  * Sets highlight words for a buffer.
  */
@@ -1994,7 +2051,7 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
         if (error && !error[0])
         {
             buffer->filter = (number) ? 1 : 0;
-            gui_filter_buffer (buffer, NULL);
+            gui_filter_buffer_check (buffer, 0);
         }
     }
     else if (string_strcasecmp (property, "number") == 0)
@@ -2077,6 +2134,23 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
         if (error && !error[0])
             gui_buffer_set_nicklist_display_groups (buffer, number);
     }
+    else if (string_strcasecmp (property, "nicklist_bulk") == 0)
+    {
+        error = NULL;
+        number = strtol (value, &error, 10);
+        if (error && !error[0])
+            gui_buffer_set_nicklist_bulk (buffer, number);
+    }
+    else if (string_strcasecmp (property, "nickcmp_case_range") == 0)
+    {
+        error = NULL;
+        number = strtol (value, &error, 10);
+        if (error && !error[0])
+        {
+            buffer->nickcmp_case_range = ((number >= 0) && (number <= 30)) ?
+                number : -1;
+        }
+    }
     else if (string_strcasecmp (property, "highlight_words") == 0)
     {
         gui_buffer_set_highlight_words (buffer, value);
@@ -2837,10 +2911,8 @@ gui_buffer_close (struct t_gui_buffer *buffer)
 
     /* free all lines */
     gui_line_free_all (buffer);
-    if (buffer->own_lines)
-        free (buffer->own_lines);
-    if (buffer->mixed_lines)
-        free (buffer->mixed_lines);
+    gui_lines_free (buffer->own_lines);
+    gui_lines_free (buffer->mixed_lines);
 
     /* free some data */
     gui_buffer_undo_free_all (buffer);
@@ -4236,9 +4308,11 @@ gui_buffer_hdata_buffer_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_buffer, nicklist_groups_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_nicks_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_visible_count, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_bulk, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback_pointer, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback_data, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nickcmp_case_range, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, input, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, input_callback, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, input_callback_pointer, POINTER, 0, NULL, NULL);
@@ -4435,6 +4509,8 @@ gui_buffer_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!infolist_new_var_integer (ptr_item, "nicklist_visible_count", buffer->nicklist_visible_count))
         return 0;
+    if (!infolist_new_var_integer (ptr_item, "nicklist_bulk", buffer->nicklist_bulk))
+        return 0;
     if (!infolist_new_var_string (ptr_item, "title", buffer->title))
         return 0;
     if (!infolist_new_var_integer (ptr_item, "input", buffer->input))
@@ -4639,6 +4715,7 @@ gui_buffer_print_log ()
         log_printf ("  lines . . . . . . . . . : 0x%lx", ptr_buffer->lines);
         log_printf ("  time_for_each_line. . . : %d",    ptr_buffer->time_for_each_line);
         log_printf ("  chat_refresh_needed . . : %d",    ptr_buffer->chat_refresh_needed);
+        log_printf ("  chat_lines_added. . . . : %d",    ptr_buffer->chat_lines_added);
         log_printf ("  nicklist. . . . . . . . : %d",    ptr_buffer->nicklist);
         log_printf ("  nicklist_case_sensitive : %d",    ptr_buffer->nicklist_case_sensitive);
         log_printf ("  nicklist_root . . . . . : 0x%lx", ptr_buffer->nicklist_root);
@@ -4648,9 +4725,12 @@ gui_buffer_print_log ()
         log_printf ("  nicklist_groups_count . : %d",    ptr_buffer->nicklist_groups_count);
         log_printf ("  nicklist_nicks_count. . : %d",    ptr_buffer->nicklist_nicks_count);
         log_printf ("  nicklist_visible_count. : %d",    ptr_buffer->nicklist_visible_count);
+        log_printf ("  nicklist_bulk . . . . . : %d",    ptr_buffer->nicklist_bulk);
+        log_printf ("  nicklist_nicks_index. . : 0x%lx", ptr_buffer->nicklist_nicks_index);
         log_printf ("  nickcmp_callback. . . . : 0x%lx", ptr_buffer->nickcmp_callback);
         log_printf ("  nickcmp_callback_pointer: 0x%lx", ptr_buffer->nickcmp_callback_pointer);
         log_printf ("  nickcmp_callback_data . : 0x%lx", ptr_buffer->nickcmp_callback_data);
+        log_printf ("  nickcmp_case_range. . . : %d",    ptr_buffer->nickcmp_case_range);
         log_printf ("  input . . . . . . . . . : %d",    ptr_buffer->input);
         log_printf ("  input_callback. . . . . : 0x%lx", ptr_buffer->input_callback);
         log_printf ("  input_callback_pointer. : 0x%lx", ptr_buffer->input_callback_pointer);
@@ -124,6 +124,8 @@ struct t_gui_buffer
     int time_for_each_line;            /* time is displayed for each line?  */
     int chat_refresh_needed;           /* refresh for chat is needed ?      */
                                        /* (1=refresh, 2=erase+refresh)      */
+    int chat_lines_added;              /* lines added at end of buffer      */
+                                       /* (only new lines must be drawn)    */
 
     /* nicklist */
     int nicklist;                      /* = 1 if nicklist is enabled        */
@@ -135,6 +137,10 @@ struct t_gui_buffer
     int nicklist_groups_count;         /* number of groups                  */
     int nicklist_nicks_count;          /* number of nicks                   */
     int nicklist_visible_count;        /* number of nicks/groups to display */
+    int nicklist_bulk;                 /* bulk mode: nicks not sorted and   */
+                                       /* no signal sent (until bulk end)   */
+    struct t_hashtable *nicklist_nicks_index; /* nicks by name (case is    */
+                                       /* ignored)                          */
     int (*nickcmp_callback)(const void *pointer, /* called to compare nicks */
                             void *data,          /* (search in nicklist)    */
                             struct t_gui_buffer *buffer,
@@ -142,6 +148,9 @@ struct t_gui_buffer
                             const char *nick2);
     const void *nickcmp_callback_pointer; /* pointer for callback           */
     void *nickcmp_callback_data;       /* data for callback                 */
+    int nickcmp_case_range;            /* callback ignores case only for    */
+                                       /* chars "A" to "A"+range-1 (-1 if   */
+                                       /* unknown: no index used to search) */
 
     /* input */
     int input;                         /* = 1 if input is enabled           */
@@ -284,6 +293,7 @@ extern void *gui_buffer_get_pointer (struct t_gui_buffer *buffer,
                                      const char *property);
 extern void gui_buffer_ask_chat_refresh (struct t_gui_buffer *buffer,
                                          int refresh);
+extern void gui_buffer_ask_chat_refresh_lines_added (struct t_gui_buffer *buffer);
 extern void gui_buffer_set_title (struct t_gui_buffer *buffer,
                                   const char *new_title);
 extern void gui_buffer_set_highlight_words (struct t_gui_buffer *buffer,
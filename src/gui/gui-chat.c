@@ -57,6 +57,8 @@ struct t_gui_buffer *gui_chat_mute_buffer = NULL; /* mute buffer            */
 int gui_chat_display_tags = 0;                  /* display tags?            */
 char **gui_chat_lines_waiting_buffer = NULL;    /* lines waiting for core   */
                                                 /* buffer                   */
+unsigned long long gui_chat_draws_full = 0;     /* chat area fully drawn    */
+unsigned long long gui_chat_draws_partial = 0;  /* only added lines drawn   */
 
 
 /*
@@ -385,17 +387,19 @@ gui_chat_get_word_info (struct t_gui_window *window,
 }
 
 /*
- * Gets time string, for display (with colors).
+ * Gets time string, for display (with colors), in a buffer.
  *
- * Note: result must be freed after use.
+ * Returns pointer to "buffer" if the time string fits in it, a newly
+ * allocated string if it is too long (it must then be freed after use),
+ * or NULL if there is no time to display.
  */
 
 char *
-gui_chat_get_time_string (time_t date)
+gui_chat_get_time_string_buffer (time_t date, char *buffer, int size)
 {
     char text_time[128], text_time2[(128*3)+16], text_time_char[2];
     char *text_with_color;
-    int i, time_first_digit, time_last_digit, last_color;
+    int i, time_first_digit, time_last_digit, last_color, length;
     struct tm *local_time;
 
     if (date == 0)
@@ -419,7 +423,14 @@ gui_chat_get_time_string (time_t date)
         if (text_with_color)
         {
             if (strcmp (text_time, text_with_color) != 0)
-                return text_with_color;
+            {
+                length = strlen (text_with_color);
+                if (length >= size)
+                    return text_with_color;
+                memcpy (buffer, text_with_color, length + 1);
+                free (text_with_color);
+                return buffer;
+            }
             free (text_with_color);
         }
     }
@@ -491,7 +502,27 @@ gui_chat_get_time_string (time_t date)
         i++;
     }
 
-    return strdup (text_time2);
+    length = strlen (text_time2);
+    if (length >= size)
+        return strdup (text_time2);
+    memcpy (buffer, text_time2, length + 1);
+    return buffer;
+}
+
+/*
+ * Gets time string, for display (with colors).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_chat_get_time_string (time_t date)
+{
+    char buffer[GUI_CHAT_TIME_STRING_SIZE], *str_time;
+
+    str_time = gui_chat_get_time_string_buffer (date, buffer, sizeof (buffer));
+
+    return (str_time == buffer) ? strdup (buffer) : str_time;
 }
 
 /*
@@ -541,8 +572,8 @@ gui_chat_change_time_format ()
         {
             if (ptr_line->data->date != 0)
             {
-                if (ptr_line->data->str_time)
-                    free (ptr_line->data->str_time);
+                gui_line_data_free_string (ptr_line->data,
+                                           ptr_line->data->str_time);
                 ptr_line->data->str_time = gui_chat_get_time_string (ptr_line->data->date);
             }
         }
@@ -737,18 +768,21 @@ gui_chat_printf_date_tags_internal (struct t_gui_buffer *buffer,
         goto no_print;
 
     /* call modifier for message printed ("weechat_print") */
-    length_data = strlen (gui_buffer_get_plugin_name (new_line->data->buffer)) +
-        1 +
-        strlen (new_line->data->buffer->name) +
-        1 +
-        ((tags) ? strlen (tags) : 0) +
-        1;
-    modifier_data = malloc (length_data);
-    length_str = ((new_line->data->prefix && new_line->data->prefix[0]) ? strlen (new_line->data->prefix) : 1) +
-        1 +
-        (new_line->data->message ? strlen (new_line->data->message) : 0) +
-        1;
-    string = malloc (length_str);
+    if (hook_modifier_has_hooks ("weechat_print"))
+    {
+        length_data = strlen (gui_buffer_get_plugin_name (new_line->data->buffer)) +
+            1 +
+            strlen (new_line->data->buffer->name) +
+            1 +
+            ((tags) ? strlen (tags) : 0) +
+            1;
+        modifier_data = malloc (length_data);
+        length_str = ((new_line->data->prefix && new_line->data->prefix[0]) ? strlen (new_line->data->prefix) : 1) +
+            1 +
+            (new_line->data->message ? strlen (new_line->data->message) : 0) +
+            1;
+        string = malloc (length_str);
+    }
     if (modifier_data && string)
     {
         snprintf (modifier_data, length_data,
@@ -831,8 +865,8 @@ gui_chat_printf_date_tags_internal (struct t_gui_buffer *buffer,
                 }
                 new_line->data->prefix_length = gui_chat_strlen_screen (
                     new_line->data->prefix);
-                if (new_line->data->message)
-                    free (new_line->data->message);
+                gui_line_data_free_string (new_line->data,
+                                           new_line->data->message);
                 new_line->data->message = strdup (ptr_msg);
             }
         }
@@ -845,7 +879,7 @@ gui_chat_printf_date_tags_internal (struct t_gui_buffer *buffer,
     if (new_line->data->buffer && new_line->data->buffer->print_hooks_enabled)
         hook_print_exec (new_line->data->buffer, new_line);
 
-    gui_buffer_ask_chat_refresh (new_line->data->buffer, 1);
+    gui_buffer_ask_chat_refresh_lines_added (new_line->data->buffer);
 
     if (string)
         free (string);
@@ -859,8 +893,7 @@ gui_chat_printf_date_tags_internal (struct t_gui_buffer *buffer,
 no_print:
     if (new_line)
     {
-        gui_line_free_data (new_line);
-        free (new_line);
+        gui_line_free_line (new_line);
     }
     if (string)
         free (string);
@@ -1034,8 +1067,7 @@ gui_chat_printf_y (struct t_gui_buffer *buffer, int y, const char *message, ...)
 
     if (!new_line->data->buffer)
     {
-        gui_line_free_data (new_line);
-        free (new_line);
+        gui_line_free_line (new_line);
         goto end;
     }
 
@@ -1073,8 +1105,7 @@ gui_chat_printf_y (struct t_gui_buffer *buffer, int y, const char *message, ...)
         else
         {
             string_fprintf (stdout, "%s\n", new_line->data->message);
-            gui_line_free_data (new_line);
-            free (new_line);
+            gui_line_free_line (new_line);
         }
     }
     else if (gui_init_ok)
@@ -33,6 +33,9 @@ struct t_gui_line;
 
 #define GUI_CHAT_TAG_NO_HIGHLIGHT "no_highlight"
 
+/* size of buffer for time string built without allocation */
+#define GUI_CHAT_TIME_STRING_SIZE 512
+
 #define GUI_CHAT_PREFIX_ERROR_DEFAULT   "=!="
 #define GUI_CHAT_PREFIX_NETWORK_DEFAULT "--"
 #define GUI_CHAT_PREFIX_ACTION_DEFAULT  " *"
@@ -63,6 +66,8 @@ extern int gui_chat_time_length;
 extern int gui_chat_mute;
 extern struct t_gui_buffer *gui_chat_mute_buffer;
 extern int gui_chat_display_tags;
+extern unsigned long long gui_chat_draws_full;
+extern unsigned long long gui_chat_draws_partial;
 
 /* chat functions */
 
@@ -81,6 +86,8 @@ extern void gui_chat_get_word_info (struct t_gui_window *window,
                                     int *word_end_offset,
                                     int *word_length_with_spaces,
                                     int *word_length);
+extern char *gui_chat_get_time_string_buffer (time_t date, char *buffer,
+                                              int size);
 extern char *gui_chat_get_time_string (time_t date);
 extern int gui_chat_get_time_length ();
 extern void gui_chat_change_time_format ();
@@ -46,10 +46,99 @@
 struct t_gui_filter *gui_filters = NULL;           /* first filter          */
 struct t_gui_filter *last_gui_filter = NULL;       /* last filter           */
 int gui_filters_enabled = 1;                       /* filters enabled?      */
+struct t_hook *gui_filter_timer = NULL;            /* timer to filter lines */
 
 
 /*
- * Checks if a line must be displayed or not (filtered).
+ * Checks if a filter matches a line (tags and regex); the state of filter
+ * (enabled or not) and buffers of filter are not checked.
+ *
+ * Returns:
+ *   1: filter matches line (line must be hidden)
+ *   0: filter does not match line
+ */
+
+int
+gui_filter_match_line (struct t_gui_filter *filter,
+                       struct t_gui_line_data *line_data)
+{
+    int rc;
+
+    if ((strcmp (filter->tags, "*") != 0)
+        && !gui_line_match_tags (line_data,
+                                 filter->tags_count,
+                                 filter->tags_array))
+    {
+        return 0;
+    }
+
+    /* check line with regex */
+    rc = 1;
+    if (!filter->regex_prefix && !filter->regex_message)
+        rc = 0;
+    if (gui_line_match_regex (line_data,
+                              filter->regex_prefix,
+                              filter->regex_message))
+    {
+        rc = 0;
+    }
+    if (filter->regex && (filter->regex[0] == '!'))
+        rc ^= 1;
+
+    return (rc == 0) ? 1 : 0;
+}
+
+/*
+ * Gets the mask of filters enabled for a buffer full name (bits with index of
+ * filters).
+ *
+ * If an enabled filter without index matches the buffer, the variable
+ * "filter_no_index" is set to 1 (these filters must be checked on each line,
+ * without using bits in lines).
+ */
+
+unsigned int
+gui_filter_get_mask_full_name (const char *full_name, int *filter_no_index)
+{
+    struct t_gui_filter *ptr_filter;
+    unsigned int mask;
+
+    mask = 0;
+    *filter_no_index = 0;
+
+    for (ptr_filter = gui_filters; ptr_filter;
+         ptr_filter = ptr_filter->next_filter)
+    {
+        if (ptr_filter->enabled
+            && string_match_list (full_name,
+                                  (const char **)ptr_filter->buffers,
+                                  0))
+        {
+            if (ptr_filter->index >= 0)
+                mask |= 1U << ptr_filter->index;
+            else
+                *filter_no_index = 1;
+        }
+    }
+
+    return mask;
+}
+
+/*
+ * Gets the mask of filters enabled for a buffer (bits with index of filters).
+ *
+ * See function gui_filter_get_mask_full_name for variable "filter_no_index".
+ */
+
+unsigned int
+gui_filter_get_mask (struct t_gui_buffer *buffer, int *filter_no_index)
+{
+    return gui_filter_get_mask_full_name (buffer->full_name, filter_no_index);
+}
+
+/*
+ * Checks filters in "mask_check" on a line (bits are updated in line), then
+ * checks if a line must be displayed or not, using bits of filters in "mask".
  *
  * Returns:
  *   1: line must be displayed (not filtered)
@@ -57,48 +146,57 @@ int gui_filters_enabled = 1;                       /* filters enabled?      */
  */
 
 int
-gui_filter_check_line (struct t_gui_line_data *line_data)
+gui_filter_check_line_mask (struct t_gui_line_data *line_data,
+                            unsigned int mask, unsigned int mask_check,
+                            int filter_no_index)
 {
     struct t_gui_filter *ptr_filter;
-    int rc;
+    unsigned int bit;
+
+    if (gui_line_has_tag_no_filter (line_data))
+    {
+        line_data->filters_matched = 0;
+        return 1;
+    }
+
+    if (mask_check)
+    {
+        for (ptr_filter = gui_filters; ptr_filter;
+             ptr_filter = ptr_filter->next_filter)
+        {
+            if (ptr_filter->index < 0)
+                continue;
+            bit = 1U << ptr_filter->index;
+            if (mask_check & bit)
+            {
+                if (gui_filter_match_line (ptr_filter, line_data))
+                    line_data->filters_matched |= bit;
+                else
+                    line_data->filters_matched &= ~bit;
+            }
+        }
+    }
 
     /* line is always displayed if filters are disabled (globally or in buffer) */
     if (!gui_filters_enabled || !line_data->buffer->filter)
         return 1;
 
-    if (gui_line_has_tag_no_filter (line_data))
-        return 1;
+    if (line_data->filters_matched & mask)
+        return 0;
 
-    for (ptr_filter = gui_filters; ptr_filter;
-         ptr_filter = ptr_filter->next_filter)
+    if (filter_no_index)
     {
-        if (ptr_filter->enabled)
+        for (ptr_filter = gui_filters; ptr_filter;
+             ptr_filter = ptr_filter->next_filter)
         {
-            /* check buffer */
-            if (string_match_list (line_data->buffer->full_name,
-                                   (const char **)ptr_filter->buffers,
-                                   0))
+            if (ptr_filter->enabled
+                && (ptr_filter->index < 0)
+                && string_match_list (line_data->buffer->full_name,
+                                      (const char **)ptr_filter->buffers,
+                                      0)
+                && gui_filter_match_line (ptr_filter, line_data))
             {
-                if ((strcmp (ptr_filter->tags, "*") == 0)
-                    || (gui_line_match_tags (line_data,
-                                             ptr_filter->tags_count,
-                                             ptr_filter->tags_array)))
-                {
-                    /* check line with regex */
-                    rc = 1;
-                    if (!ptr_filter->regex_prefix && !ptr_filter->regex_message)
-                        rc = 0;
-                    if (gui_line_match_regex (line_data,
-                                              ptr_filter->regex_prefix,
-                                              ptr_filter->regex_message))
-                    {
-                        rc = 0;
-                    }
-                    if (ptr_filter->regex && (ptr_filter->regex[0] == '!'))
-                        rc ^= 1;
-                    if (rc == 0)
-                        return 0;
-                }
+                return 0;
             }
         }
     }
@@ -108,53 +206,42 @@ gui_filter_check_line (struct t_gui_line_data *line_data)
 }
 
 /*
- * Filters a buffer, using message filters.
+ * Checks if a line must be displayed or not (filtered); all enabled filters
+ * are checked.
  *
- * If line_data is NULL, filters all lines in buffer.
- * If line_data is not NULL, filters only this line_data.
+ * Returns:
+ *   1: line must be displayed (not filtered)
+ *   0: line must be hidden (filtered)
  */
 
-void
-gui_filter_buffer (struct t_gui_buffer *buffer,
-                   struct t_gui_line_data *line_data)
+int
+gui_filter_check_line (struct t_gui_line_data *line_data)
 {
-    struct t_gui_line *ptr_line;
-    struct t_gui_line_data *ptr_line_data;
-    struct t_gui_window *ptr_window;
-    int lines_changed, line_displayed, lines_hidden;
-
-    lines_changed = 0;
-    lines_hidden = buffer->lines->lines_hidden;
-
-    ptr_line = buffer->lines->first_line;
-    while (ptr_line || line_data)
-    {
-        ptr_line_data = (line_data) ? line_data : ptr_line->data;
+    unsigned int mask;
+    int filter_no_index;
 
-        line_displayed = gui_filter_check_line (ptr_line_data);
+    mask = gui_filter_get_mask (line_data->buffer, &filter_no_index);
 
-        if (ptr_line_data->displayed != line_displayed)
-        {
-            lines_changed = 1;
-            lines_hidden += (line_displayed) ? -1 : 1;
-        }
-
-        ptr_line_data->displayed = line_displayed;
+    return gui_filter_check_line_mask (line_data, mask, mask,
+                                       filter_no_index);
+}
 
-        if (line_data)
-            break;
+/*
+ * Refreshes a buffer after filtering of lines.
+ */
 
-        ptr_line = ptr_line->next_line;
-    }
+void
+gui_filter_buffer_refresh (struct t_gui_buffer *buffer,
+                           struct t_gui_lines *lines,
+                           int lines_changed, int lines_hidden)
+{
+    struct t_gui_window *ptr_window;
 
-    if (line_data)
-        line_data->buffer->lines->prefix_max_length_refresh = 1;
-    else
-        buffer->lines->prefix_max_length_refresh = 1;
+    lines->prefix_max_length_refresh = 1;
 
-    if (buffer->lines->lines_hidden != lines_hidden)
+    if (lines->lines_hidden != lines_hidden)
     {
-        buffer->lines->lines_hidden = lines_hidden;
+        lines->lines_hidden = lines_hidden;
         (void) hook_signal_send ("buffer_lines_hidden",
                                  WEECHAT_HOOK_SIGNAL_POINTER, buffer);
     }
@@ -184,17 +271,238 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
     }
 }
 
+/*
+ * Filters lines of a buffer, backwards from "line" (or last line if "line"
+ * is NULL); only filters in "mask_check" are checked on lines.
+ *
+ * If max_lines > 0, at most max_lines lines are filtered.
+ *
+ * Returns pointer to next line to filter, NULL if all lines have been
+ * filtered.
+ */
+
+struct t_gui_line *
+gui_filter_buffer_lines (struct t_gui_buffer *buffer,
+                         struct t_gui_lines *lines,
+                         struct t_gui_line *line,
+                         unsigned int mask_check,
+                         int max_lines)
+{
+    struct t_gui_line *ptr_line;
+    struct t_gui_line_data *ptr_line_data;
+    struct t_gui_buffer *ptr_buffer;
+    unsigned int mask;
+    int lines_changed, line_displayed, lines_hidden, filter_no_index, count;
+
+    lines_changed = 0;
+    lines_hidden = lines->lines_hidden;
+
+    ptr_buffer = NULL;
+    mask = 0;
+    filter_no_index = 0;
+    count = 0;
+
+    ptr_line = (line) ? line : lines->last_line;
+    while (ptr_line && ((max_lines <= 0) || (count < max_lines)))
+    {
+        ptr_line_data = ptr_line->data;
+
+        /* mixed lines (merged buffers): get mask for each buffer */
+        if (ptr_line_data->buffer != ptr_buffer)
+        {
+            ptr_buffer = ptr_line_data->buffer;
+            mask = gui_filter_get_mask (ptr_buffer, &filter_no_index);
+        }
+
+        line_displayed = gui_filter_check_line_mask (ptr_line_data,
+                                                     mask,
+                                                     mask & mask_check,
+                                                     filter_no_index);
+
+        if (ptr_line_data->displayed != line_displayed)
+        {
+            lines_changed = 1;
+            lines_hidden += (line_displayed) ? -1 : 1;
+        }
+
+        ptr_line_data->displayed = line_displayed;
+
+        ptr_line = ptr_line->prev_line;
+        count++;
+    }
+
+    gui_filter_buffer_refresh (buffer, lines, lines_changed, lines_hidden);
+
+    return ptr_line;
+}
+
+/*
+ * Callback for timer used to filter big buffers by batches of lines.
+ */
+
+int
+gui_filter_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_lines *ptr_lines;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    /* filter a batch of lines in the first buffer with pending filtering */
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        ptr_lines = ptr_buffer->own_lines;
+        if (ptr_lines && ptr_lines->filter_line)
+        {
+            ptr_lines->filter_line = gui_filter_buffer_lines (
+                ptr_buffer,
+                ptr_lines,
+                ptr_lines->filter_line,
+                ptr_lines->filter_mask_check,
+                GUI_FILTER_BATCH_LINES);
+            if (!ptr_lines->filter_line)
+                ptr_lines->filter_mask_check = 0;
+            return WEECHAT_RC_OK;
+        }
+    }
+
+    /* no more lines to filter */
+    if (gui_filter_timer)
+    {
+        unhook (gui_filter_timer);
+        gui_filter_timer = NULL;
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Filters all lines of a buffer, checking filters in "mask_check" on lines
+ * (0 = no filter checked, only bits in lines are used; GUI_FILTER_MASK_ALL =
+ * all filters are checked).
+ *
+ * If the buffer is not merged and has many lines, the last lines are filtered
+ * immediately and other lines are filtered later by a timer.
+ */
+
+void
+gui_filter_buffer_check (struct t_gui_buffer *buffer, unsigned int mask_check)
+{
+    struct t_gui_lines *ptr_lines;
+    struct t_gui_line *ptr_next_line;
+    int batch;
+
+    ptr_lines = buffer->own_lines;
+
+    /* merge with filtering in progress (restart from last line) */
+    if (ptr_lines->filter_line)
+    {
+        mask_check |= ptr_lines->filter_mask_check;
+        ptr_lines->filter_line = NULL;
+        ptr_lines->filter_mask_check = 0;
+    }
+
+    batch = (mask_check && (buffer->lines == buffer->own_lines)) ? 1 : 0;
+
+    ptr_next_line = gui_filter_buffer_lines (
+        buffer,
+        buffer->lines,
+        NULL,
+        mask_check,
+        (batch) ? GUI_FILTER_BATCH_LINES : 0);
+
+    if (ptr_next_line)
+    {
+        ptr_lines->filter_line = ptr_next_line;
+        ptr_lines->filter_mask_check = mask_check;
+        if (!gui_filter_timer)
+        {
+            gui_filter_timer = hook_timer (NULL, 1, 0, 0,
+                                           &gui_filter_timer_cb, NULL, NULL);
+        }
+    }
+}
+
+/*
+ * Filters a buffer, using message filters.
+ *
+ * If line_data is NULL, filters all lines in buffer.
+ * If line_data is not NULL, filters only this line_data.
+ */
+
+void
+gui_filter_buffer (struct t_gui_buffer *buffer,
+                   struct t_gui_line_data *line_data)
+{
+    int line_displayed, lines_hidden;
+
+    if (!line_data)
+    {
+        gui_filter_buffer_check (buffer, GUI_FILTER_MASK_ALL);
+        return;
+    }
+
+    lines_hidden = line_data->buffer->lines->lines_hidden;
+
+    line_displayed = gui_filter_check_line (line_data);
+
+    if (line_data->displayed != line_displayed)
+        lines_hidden += (line_displayed) ? -1 : 1;
+
+    gui_filter_buffer_refresh (buffer, line_data->buffer->lines,
+                               line_data->displayed != line_displayed,
+                               lines_hidden);
+
+    line_data->displayed = line_displayed;
+}
+
+/*
+ * Filters a buffer after its full name has changed: bits in lines are
+ * computed for the filters matching the buffer only with its new name (they
+ * may be missing or outdated in lines).
+ */
+
+void
+gui_filter_buffer_renamed (struct t_gui_buffer *buffer,
+                           const char *old_full_name)
+{
+    unsigned int mask_old, mask_new;
+    int filter_no_index_old, filter_no_index_new;
+
+    if (!buffer || !buffer->own_lines)
+        return;
+
+    mask_old = gui_filter_get_mask_full_name (
+        (old_full_name) ? old_full_name : "", &filter_no_index_old);
+    mask_new = gui_filter_get_mask (buffer, &filter_no_index_new);
+
+    if ((mask_old != mask_new) || filter_no_index_old || filter_no_index_new)
+        gui_filter_buffer_check (buffer, mask_new & ~mask_old);
+}
+
 /*
  * Filters all buffers, using message filters.
  *
- * If filter is NULL, filters all buffers.
- * If filter is not NULL, filters only buffers matched by this filter.
+ * If filter is NULL, filters all buffers (all filters are checked on lines).
+ * If filter is not NULL, filters only buffers matched by this filter, and
+ * checks only this filter on lines (if the filter is disabled, no filter is
+ * checked).
  */
 
 void
 gui_filter_all_buffers (struct t_gui_filter *filter)
 {
     struct t_gui_buffer *ptr_buffer;
+    unsigned int mask_check;
+
+    if (!filter || (filter->index < 0))
+        mask_check = GUI_FILTER_MASK_ALL;
+    else
+        mask_check = (filter->enabled) ? 1U << filter->index : 0;
 
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
@@ -203,11 +511,28 @@ gui_filter_all_buffers (struct t_gui_filter *filter)
             || string_match_list (ptr_buffer->full_name,
                                   (const char **)filter->buffers, 0))
         {
-            gui_filter_buffer (ptr_buffer, NULL);
+            gui_filter_buffer_check (ptr_buffer, mask_check);
         }
     }
 }
 
+/*
+ * Filters all buffers without checking filters on lines (only the bits of
+ * filters in lines are used).
+ */
+
+void
+gui_filter_all_buffers_displayed ()
+{
+    struct t_gui_buffer *ptr_buffer;
+
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        gui_filter_buffer_check (ptr_buffer, 0);
+    }
+}
+
 /*
  * Enables message filtering.
  */
@@ -218,7 +543,7 @@ gui_filter_global_enable ()
     if (!gui_filters_enabled)
     {
         gui_filters_enabled = 1;
-        gui_filter_all_buffers (NULL);
+        gui_filter_all_buffers_displayed ();
         (void) hook_signal_send ("filters_enabled",
                                  WEECHAT_HOOK_SIGNAL_STRING, NULL);
     }
@@ -234,7 +559,7 @@ gui_filter_global_disable ()
     if (gui_filters_enabled)
     {
         gui_filters_enabled = 0;
-        gui_filter_all_buffers (NULL);
+        gui_filter_all_buffers_displayed ();
         (void) hook_signal_send ("filters_disabled",
                                  WEECHAT_HOOK_SIGNAL_STRING, NULL);
     }
@@ -262,6 +587,38 @@ gui_filter_search_by_name (const char *name)
     return NULL;
 }
 
+/*
+ * Gets a free index for a new filter.
+ *
+ * Returns the index (0 to GUI_FILTER_MAX_INDEX - 1), -1 if all indexes are
+ * used by filters.
+ */
+
+int
+gui_filter_get_free_index ()
+{
+    struct t_gui_filter *ptr_filter;
+    unsigned int used;
+    int i;
+
+    used = 0;
+    for (ptr_filter = gui_filters; ptr_filter;
+         ptr_filter = ptr_filter->next_filter)
+    {
+        if (ptr_filter->index >= 0)
+            used |= 1U << ptr_filter->index;
+    }
+
+    for (i = 0; i < GUI_FILTER_MAX_INDEX; i++)
+    {
+        if (!(used & (1U << i)))
+            return i;
+    }
+
+    /* all indexes are used */
+    return -1;
+}
+
 /*
  * Displays an error when a new filter is created.
  */
@@ -410,6 +767,7 @@ gui_filter_new (int enabled, const char *name, const char *buffer_name,
         new_filter->regex = strdup (regex);
         new_filter->regex_prefix = regex1;
         new_filter->regex_message = regex2;
+        new_filter->index = gui_filter_get_free_index ();
 
         /* add filter to filters list */
         new_filter->prev_filter = last_gui_filter;
@@ -461,12 +819,32 @@ gui_filter_rename (struct t_gui_filter *filter, const char *new_name)
 void
 gui_filter_free (struct t_gui_filter *filter)
 {
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_line *ptr_line;
+    unsigned int bit;
+
     if (!filter)
         return;
 
     (void) hook_signal_send ("filter_removing",
                              WEECHAT_HOOK_SIGNAL_POINTER, filter);
 
+    /* clear bit of filter in lines (the index may be used by a new filter) */
+    if (filter->index >= 0)
+    {
+        bit = 1U << filter->index;
+        for (ptr_buffer = gui_buffers; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            ptr_buffer->own_lines->filter_mask_check &= ~bit;
+            for (ptr_line = ptr_buffer->own_lines->first_line; ptr_line;
+                 ptr_line = ptr_line->next_line)
+            {
+                ptr_line->data->filters_matched &= ~bit;
+            }
+        }
+    }
+
     /* free data */
     if (filter->name)
         free (filter->name);
@@ -548,6 +926,7 @@ gui_filter_hdata_filter_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_filter, regex, STRING, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_filter, regex_prefix, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_filter, regex_message, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_filter, index, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_filter, prev_filter, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_filter, next_filter, POINTER, 0, NULL, hdata_name);
         HDATA_LIST(gui_filters, WEECHAT_HDATA_LIST_CHECK_POINTERS);
@@ -641,6 +1020,7 @@ gui_filter_print_log ()
         log_printf ("  regex. . . . . . . . . : '%s'",  ptr_filter->regex);
         log_printf ("  regex_prefix . . . . . : 0x%lx", ptr_filter->regex_prefix);
         log_printf ("  regex_message. . . . . : 0x%lx", ptr_filter->regex_message);
+        log_printf ("  index. . . . . . . . . : %d",    ptr_filter->index);
         log_printf ("  prev_filter. . . . . . : 0x%lx", ptr_filter->prev_filter);
         log_printf ("  next_filter. . . . . . : 0x%lx", ptr_filter->next_filter);
     }
@@ -24,8 +24,25 @@
 
 #define GUI_FILTER_TAG_NO_FILTER "no_filter"
 
+/*
+ * filters have an index (if there are less than GUI_FILTER_MAX_INDEX
+ * filters), each line has bits for filters matching the line: when a filter
+ * is enabled, only this filter is checked on lines, and when a filter is
+ * disabled, lines are not checked at all (bits are used)
+ */
+#define GUI_FILTER_MAX_INDEX   32
+#define GUI_FILTER_MASK_ALL    0xFFFFFFFF
+
+/*
+ * filtering of big buffers is made by batches of lines (starting from last
+ * line), next batches are done with a timer
+ */
+#define GUI_FILTER_BATCH_LINES 8192
+
 /* filter structures */
 
+struct t_gui_buffer;
+struct t_gui_lines;
 struct t_gui_line_data;
 
 struct t_gui_filter
@@ -41,6 +58,8 @@ struct t_gui_filter
     char *regex;                       /* regex                             */
     regex_t *regex_prefix;             /* regex for line prefix             */
     regex_t *regex_message;            /* regex for line message            */
+    int index;                         /* bit for filter in lines (-1 if    */
+                                       /* filter has no index)              */
     struct t_gui_filter *prev_filter;  /* link to previous filter           */
     struct t_gui_filter *next_filter;  /* link to next filter               */
 };
@@ -53,9 +72,15 @@ extern int gui_filters_enabled;
 
 /* filter functions */
 
+extern int gui_filter_match_line (struct t_gui_filter *filter,
+                                  struct t_gui_line_data *line_data);
 extern int gui_filter_check_line (struct t_gui_line_data *line_data);
+extern void gui_filter_buffer_check (struct t_gui_buffer *buffer,
+                                     unsigned int mask_check);
 extern void gui_filter_buffer (struct t_gui_buffer *buffer,
                                struct t_gui_line_data *line_data);
+extern void gui_filter_buffer_renamed (struct t_gui_buffer *buffer,
+                                       const char *old_full_name);
 extern void gui_filter_all_buffers (struct t_gui_filter *filter);
 extern void gui_filter_global_enable ();
 extern void gui_filter_global_disable ();
@@ -47,6 +47,155 @@
 #include "gui-window.h"
 
 
+struct t_hashtable *gui_line_tags_match_cache = NULL;
+                                       /* cache for matching of tags       */
+unsigned long long gui_line_layout_hits = 0;  /* layout of lines found      */
+unsigned long long gui_line_layout_misses = 0; /* layout of lines computed  */
+
+
+/*
+ * Allocates a new chunk for lines.
+ *
+ * Returns pointer to new chunk, NULL if error.
+ */
+
+struct t_gui_line_chunk *
+gui_line_chunk_new (int size)
+{
+    struct t_gui_line_chunk *new_chunk;
+
+    new_chunk = malloc (sizeof (*new_chunk) + size);
+    if (!new_chunk)
+        return NULL;
+
+    new_chunk->size = size;
+    new_chunk->used = 0;
+    new_chunk->lines_count = 0;
+    new_chunk->current = 0;
+
+    return new_chunk;
+}
+
+/*
+ * Sets the current chunk used to allocate new lines (the previous current
+ * chunk is freed if it does not contain any line).
+ */
+
+void
+gui_line_chunk_set_current (struct t_gui_lines *lines,
+                            struct t_gui_line_chunk *chunk)
+{
+    if (lines->current_chunk)
+    {
+        lines->current_chunk->current = 0;
+        if (lines->current_chunk->lines_count == 0)
+            free (lines->current_chunk);
+    }
+
+    lines->current_chunk = chunk;
+    if (chunk)
+        chunk->current = 1;
+}
+
+/*
+ * Allocates memory for a line in a chunk (a new chunk is allocated if the
+ * current chunk is full).
+ *
+ * Returns pointer to memory allocated, NULL if error.
+ */
+
+void *
+gui_line_chunk_alloc (struct t_gui_lines *lines, int size,
+                      struct t_gui_line_chunk **chunk)
+{
+    struct t_gui_line_chunk *ptr_chunk;
+    void *ptr_data;
+
+    size = (size + GUI_LINE_CHUNK_ALIGN - 1) & ~(GUI_LINE_CHUNK_ALIGN - 1);
+
+    if (size > GUI_LINE_CHUNK_SIZE / 4)
+    {
+        /* big line: use a chunk only for this line */
+        ptr_chunk = gui_line_chunk_new (size);
+        if (!ptr_chunk)
+            return NULL;
+    }
+    else
+    {
+        ptr_chunk = lines->current_chunk;
+        if (!ptr_chunk || (ptr_chunk->used + size > ptr_chunk->size))
+        {
+            ptr_chunk = gui_line_chunk_new (GUI_LINE_CHUNK_SIZE);
+            if (!ptr_chunk)
+                return NULL;
+            gui_line_chunk_set_current (lines, ptr_chunk);
+        }
+    }
+
+    ptr_data = GUI_LINE_CHUNK_DATA(ptr_chunk) + ptr_chunk->used;
+    ptr_chunk->used += size;
+    ptr_chunk->lines_count++;
+
+    *chunk = ptr_chunk;
+
+    return ptr_data;
+}
+
+/*
+ * Releases a line in a chunk: the chunk is freed when it does not contain any
+ * line (or emptied if it is the current chunk of a buffer).
+ */
+
+void
+gui_line_chunk_release (struct t_gui_line_chunk *chunk)
+{
+    chunk->lines_count--;
+    if (chunk->lines_count > 0)
+        return;
+
+    if (chunk->current)
+        chunk->used = 0;
+    else
+        free (chunk);
+}
+
+/*
+ * Checks if a pointer (string or tags array of line data) is stored in the
+ * chunk of line data.
+ *
+ * Returns:
+ *   1: pointer is in chunk (it must not be freed)
+ *   0: pointer is not in chunk
+ */
+
+int
+gui_line_data_in_chunk (struct t_gui_line_data *line_data,
+                        const void *pointer)
+{
+    const char *ptr_data;
+
+    if (!line_data->chunk || !pointer)
+        return 0;
+
+    ptr_data = GUI_LINE_CHUNK_DATA(line_data->chunk);
+
+    return (((const char *)pointer >= ptr_data)
+            && ((const char *)pointer < ptr_data + line_data->chunk->size)) ?
+        1 : 0;
+}
+
+/*
+ * Frees a string of line data (message or time), if it is not stored in the
+ * chunk of line data.
+ */
+
+void
+gui_line_data_free_string (struct t_gui_line_data *line_data, char *string)
+{
+    if (string && !gui_line_data_in_chunk (line_data, string))
+        free (string);
+}
+
 /*
  * Allocates structure "t_gui_lines" and initializes it.
  *
@@ -71,6 +220,9 @@ gui_lines_alloc ()
         new_lines->buffer_max_length_refresh = 0;
         new_lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
         new_lines->prefix_max_length_refresh = 0;
+        new_lines->current_chunk = NULL;
+        new_lines->filter_line = NULL;
+        new_lines->filter_mask_check = 0;
     }
 
     return new_lines;
@@ -86,6 +238,8 @@ gui_lines_free (struct t_gui_lines *lines)
     if (!lines)
         return;
 
+    gui_line_chunk_set_current (lines, NULL);
+
     free (lines);
 }
 
@@ -115,12 +269,24 @@ gui_line_tags_alloc (struct t_gui_line_data *line_data, const char *tags)
 void
 gui_line_tags_free (struct t_gui_line_data *line_data)
 {
+    int i;
+
     if (!line_data)
         return;
 
     if (line_data->tags_array)
     {
-        string_free_split_shared (line_data->tags_array);
+        if (gui_line_data_in_chunk (line_data, line_data->tags_array))
+        {
+            for (i = 0; line_data->tags_array[i]; i++)
+            {
+                string_shared_free (line_data->tags_array[i]);
+            }
+        }
+        else
+        {
+            string_free_split_shared (line_data->tags_array);
+        }
         line_data->tags_count = 0;
         line_data->tags_array = NULL;
     }
@@ -630,9 +796,98 @@ gui_line_has_tag_no_filter (struct t_gui_line_data *line_data)
     return 0;
 }
 
+/*
+ * Hashes a key of the cache for matching of tags (ids of tag and mask).
+ */
+
+unsigned long long
+gui_line_tags_match_cache_hash_key_cb (struct t_hashtable *hashtable,
+                                       const void *key)
+{
+    const string_shared_id_t *ptr_ids;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    ptr_ids = (const string_shared_id_t *)key;
+
+    return (((unsigned long long)ptr_ids[0]) << 32) | ptr_ids[1];
+}
+
+/*
+ * Compares two keys of the cache for matching of tags.
+ */
+
+int
+gui_line_tags_match_cache_keycmp_cb (struct t_hashtable *hashtable,
+                                     const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return memcmp (key1, key2, 2 * sizeof (string_shared_id_t));
+}
+
+/*
+ * Checks if a tag of line matches a mask, which is a tag of a list of tags
+ * (like tags of a filter), a leading "!" in mask is ignored.
+ *
+ * Both tag and mask must be shared strings: the result is stored in cache
+ * with the ids of the shared strings, so a tag is compared only once with
+ * each mask (including masks with wildcards), next checks are a simple
+ * lookup in the cache.
+ *
+ * Returns:
+ *   1: tag matches mask
+ *   0: tag does not match mask
+ */
+
+int
+gui_line_match_tag (const char *tag, const char *mask)
+{
+    string_shared_id_t ids[2];
+    const char *ptr_mask;
+    int *ptr_match, match;
+
+    ptr_mask = ((mask[0] == '!') && mask[1]) ? mask + 1 : mask;
+
+    if (!gui_line_tags_match_cache)
+    {
+        gui_line_tags_match_cache = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            256,
+            WEECHAT_HASHTABLE_BUFFER,
+            WEECHAT_HASHTABLE_INTEGER,
+            &gui_line_tags_match_cache_hash_key_cb,
+            &gui_line_tags_match_cache_keycmp_cb);
+        if (!gui_line_tags_match_cache)
+            return string_match (tag, ptr_mask, 0);
+        hashtable_set_arena (gui_line_tags_match_cache, 0);
+    }
+
+    ids[0] = string_shared_get_id (tag);
+    ids[1] = string_shared_get_id (mask);
+
+    ptr_match = hashtable_get (gui_line_tags_match_cache, ids);
+    if (ptr_match)
+        return *ptr_match;
+
+    match = string_match (tag, ptr_mask, 0);
+
+    if (gui_line_tags_match_cache->items_count >= GUI_LINE_TAGS_MATCH_CACHE_SIZE)
+        hashtable_remove_all (gui_line_tags_match_cache);
+    hashtable_set_with_size (gui_line_tags_match_cache,
+                             ids, sizeof (ids), &match, sizeof (match));
+
+    return match;
+}
+
 /*
  * Checks if line matches tags.
  *
+ * The tags of line and tags in tags_array must be shared strings (tags_array
+ * is built with function string_split_tags).
+ *
  * Returns:
  *   1: line matches tags
  *   0: line does not match tags
@@ -672,7 +927,8 @@ gui_line_match_tags (struct t_gui_line_data *line_data,
             {
                 for (k = 0; k < line_data->tags_count; k++)
                 {
-                    if (string_match (line_data->tags_array[k], ptr_tag, 0))
+                    if (gui_line_match_tag (line_data->tags_array[k],
+                                            tags_array[i][j]))
                     {
                         tag_found = 1;
                         break;
@@ -1015,6 +1271,43 @@ gui_line_add_to_list (struct t_gui_lines *lines,
     lines->lines_count++;
 }
 
+/*
+ * Resets layout of message in a line (it will be computed again on next
+ * display).
+ *
+ * This must be called when something displayed in the line is changed
+ * (date, prefix or message).
+ */
+
+void
+gui_line_layout_reset (struct t_gui_line_data *line_data)
+{
+    memset (&line_data->layout, 0, sizeof (line_data->layout));
+}
+
+/*
+ * Resets layout of message in all lines of all buffers.
+ *
+ * This is called when an option used to display lines is changed.
+ */
+
+void
+gui_line_layout_reset_all ()
+{
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_line *ptr_line;
+
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        for (ptr_line = ptr_buffer->own_lines->first_line; ptr_line;
+             ptr_line = ptr_line->next_line)
+        {
+            gui_line_layout_reset (ptr_line->data);
+        }
+    }
+}
+
 /*
  * Frees data in a line.
  */
@@ -1022,18 +1315,60 @@ gui_line_add_to_list (struct t_gui_lines *lines,
 void
 gui_line_free_data (struct t_gui_line *line)
 {
-    if (line->data->str_time)
-        free (line->data->str_time);
+    gui_line_data_free_string (line->data, line->data->str_time);
     gui_line_tags_free (line->data);
     if (line->data->prefix)
         string_shared_free (line->data->prefix);
-    if (line->data->message)
-        free (line->data->message);
-    free (line->data);
+    gui_line_data_free_string (line->data, line->data->message);
+
+    /*
+     * if the line is stored in the same chunk as its data, the chunk is
+     * released when the line is freed (see function gui_line_free_line)
+     */
+    if (!line->data->chunk)
+        free (line->data);
+    else if (!gui_line_data_in_chunk (line->data, line))
+        gui_line_chunk_release (line->data->chunk);
 
     line->data = NULL;
 }
 
+/*
+ * Gets the chunk where a line is stored (with its data).
+ *
+ * Returns pointer to chunk, NULL if the line is allocated with malloc.
+ */
+
+struct t_gui_line_chunk *
+gui_line_get_chunk (struct t_gui_line *line)
+{
+    return (line->data && gui_line_data_in_chunk (line->data, line)) ?
+        line->data->chunk : NULL;
+}
+
+/*
+ * Frees a line which is not in a list of lines (data and line).
+ */
+
+void
+gui_line_free_line (struct t_gui_line *line)
+{
+    struct t_gui_line_chunk *ptr_chunk;
+
+    if (!line)
+        return;
+
+    ptr_chunk = gui_line_get_chunk (line);
+
+    if (line->data)
+        gui_line_free_data (line);
+
+    if (ptr_chunk)
+        gui_line_chunk_release (ptr_chunk);
+    else
+        free (line);
+}
+
 /*
  * Removes a line from a "t_gui_lines" structure.
  */
@@ -1046,8 +1381,11 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
 {
     struct t_gui_window *ptr_win;
     struct t_gui_window_scroll *ptr_scroll;
+    struct t_gui_line_chunk *ptr_chunk;
     int prefix_length, prefix_is_nick;
 
+    ptr_chunk = (free_data) ? gui_line_get_chunk (line) : NULL;
+
     for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
     {
         /* reset scroll for any window scroll starting with this line */
@@ -1074,8 +1412,9 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
             if (ptr_scroll->text_search_start_line == line)
                 ptr_scroll->text_search_start_line = NULL;
         }
-        /* remove line from coords */
-        gui_window_coords_remove_line (ptr_win, line);
+        /* remove line from coords, redraw chat if line was displayed */
+        if (gui_window_coords_remove_line (ptr_win, line) > 0)
+            gui_buffer_ask_chat_refresh (buffer, 1);
     }
 
     gui_line_get_prefix_for_display (line, NULL, &prefix_length, NULL,
@@ -1097,6 +1436,10 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
     if (!line->data->displayed && (lines->lines_hidden > 0))
         (lines->lines_hidden)--;
 
+    /* filtering in progress (by timer) continues on previous line */
+    if (lines->filter_line == line)
+        lines->filter_line = line->prev_line;
+
     /* free data */
     if (free_data)
         gui_line_free_data (line);
@@ -1113,7 +1456,10 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
 
     lines->lines_count--;
 
-    free (line);
+    if (ptr_chunk)
+        gui_line_chunk_release (ptr_chunk);
+    else
+        free (line);
 }
 
 /*
@@ -1302,6 +1648,155 @@ gui_line_get_highlight (struct t_gui_line *line)
     return highlight;
 }
 
+/*
+ * Returns number of tags in a string with tags separated by commas (as
+ * returned by string_split_shared (tags, ",", NULL, 0, 0, ...)).
+ */
+
+int
+gui_line_tags_count (const char *tags)
+{
+    int count;
+
+    if (!tags || !tags[0])
+        return 0;
+
+    count = 1;
+    while ((tags = strchr (tags, ',')))
+    {
+        count++;
+        tags++;
+    }
+
+    return count;
+}
+
+/*
+ * Splits tags separated by commas in an array of shared strings, which must
+ * have room for "tags_count" + 1 pointers (see function gui_line_tags_count).
+ *
+ * The result is the same as string_split_shared (tags, ",", NULL, 0, 0, ...),
+ * without temporary allocations (except for tags longer than 256 bytes).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (the array contains only NULL pointers)
+ */
+
+int
+gui_line_tags_split (const char *tags, int tags_count, char **tags_array)
+{
+    char buffer[256], *tag;
+    const char *pos;
+    int i, j, length;
+
+    for (i = 0; i < tags_count; i++)
+    {
+        pos = strchr (tags, ',');
+        length = (pos) ? pos - tags : (int)strlen (tags);
+        tag = (length < (int)sizeof (buffer)) ? buffer : malloc (length + 1);
+        if (!tag)
+            goto error;
+        memcpy (tag, tags, length);
+        tag[length] = '\0';
+        tags_array[i] = (char *)string_shared_get (tag);
+        if (tag != buffer)
+            free (tag);
+        if (!tags_array[i])
+            goto error;
+        tags = (pos) ? pos + 1 : tags + length;
+    }
+    tags_array[tags_count] = NULL;
+
+    return 1;
+
+error:
+    for (j = 0; j < i; j++)
+    {
+        string_shared_free (tags_array[j]);
+    }
+    for (j = 0; j <= tags_count; j++)
+    {
+        tags_array[j] = NULL;
+    }
+    return 0;
+}
+
+/*
+ * Allocates a new line in a formatted buffer: line, line data, tags array,
+ * time string and message are stored together in a chunk of the buffer lines,
+ * without any other allocation.
+ *
+ * Returns pointer to new line, NULL if error.
+ */
+
+struct t_gui_line *
+gui_line_new_in_chunk (struct t_gui_buffer *buffer, time_t date,
+                       const char *tags, const char *message)
+{
+    struct t_gui_line *new_line;
+    struct t_gui_line_data *new_line_data;
+    struct t_gui_line_chunk *ptr_chunk;
+    char buffer_time[GUI_CHAT_TIME_STRING_SIZE], *str_time, *ptr_string;
+    int tags_count, length_tags, length_time, length_message;
+
+    str_time = gui_chat_get_time_string_buffer (date, buffer_time,
+                                                sizeof (buffer_time));
+    tags_count = gui_line_tags_count (tags);
+
+    length_tags = (tags_count > 0) ?
+        (tags_count + 1) * sizeof (*new_line_data->tags_array) : 0;
+    length_time = (str_time) ? strlen (str_time) + 1 : 0;
+    length_message = strlen (message) + 1;
+
+    new_line = gui_line_chunk_alloc (
+        buffer->own_lines,
+        sizeof (*new_line) + sizeof (*new_line_data) + length_tags +
+        length_time + length_message,
+        &ptr_chunk);
+    if (!new_line)
+    {
+        if (str_time && (str_time != buffer_time))
+            free (str_time);
+        return NULL;
+    }
+
+    new_line_data = (struct t_gui_line_data *)(new_line + 1);
+    new_line->data = new_line_data;
+    new_line_data->chunk = ptr_chunk;
+    ptr_string = (char *)(new_line_data + 1);
+
+    /* tags array */
+    new_line_data->tags_count = 0;
+    new_line_data->tags_array = NULL;
+    if (tags_count > 0)
+    {
+        if (gui_line_tags_split (tags, tags_count, (char **)ptr_string))
+        {
+            new_line_data->tags_count = tags_count;
+            new_line_data->tags_array = (char **)ptr_string;
+        }
+        ptr_string += length_tags;
+    }
+
+    /* time string */
+    new_line_data->str_time = NULL;
+    if (str_time)
+    {
+        new_line_data->str_time = ptr_string;
+        memcpy (ptr_string, str_time, length_time);
+        ptr_string += length_time;
+        if (str_time != buffer_time)
+            free (str_time);
+    }
+
+    /* message */
+    new_line_data->message = ptr_string;
+    memcpy (ptr_string, message, length_message);
+
+    return new_line;
+}
+
 /*
  * Creates a new line for a buffer.
  */
@@ -1314,31 +1809,38 @@ gui_line_new (struct t_gui_buffer *buffer, int y, time_t date,
     struct t_gui_line *new_line;
     struct t_gui_line_data *new_line_data;
 
-    /* create new line */
-    new_line = malloc (sizeof (*new_line));
-    if (!new_line)
-        return NULL;
-
-    /* create data for line */
-    new_line_data = malloc (sizeof (*new_line_data));
-    if (!new_line_data)
+    /* create new line and data for line */
+    if (buffer->type == GUI_BUFFER_TYPE_FORMATTED)
     {
-        free (new_line);
-        return NULL;
+        new_line = gui_line_new_in_chunk (buffer, date, tags,
+                                          (message) ? message : "");
+        if (!new_line)
+            return NULL;
+    }
+    else
+    {
+        new_line = malloc (sizeof (*new_line));
+        if (!new_line)
+            return NULL;
+        new_line_data = malloc (sizeof (*new_line_data));
+        if (!new_line_data)
+        {
+            free (new_line);
+            return NULL;
+        }
+        new_line->data = new_line_data;
+        new_line->data->chunk = NULL;
+        new_line->data->message = (message) ? strdup (message) : strdup ("");
     }
-    new_line->data = new_line_data;
 
     /* fill data in new line */
     new_line->data->buffer = buffer;
-    new_line->data->message = (message) ? strdup (message) : strdup ("");
 
     if (buffer->type == GUI_BUFFER_TYPE_FORMATTED)
     {
         new_line->data->y = -1;
         new_line->data->date = date;
         new_line->data->date_printed = date_printed;
-        new_line->data->str_time = gui_chat_get_time_string (date);
-        gui_line_tags_alloc (new_line->data, tags);
         new_line->data->refresh_needed = 0;
         new_line->data->prefix = (prefix) ?
             (char *)string_shared_get (prefix) : ((date != 0) ? (char *)string_shared_get ("") : NULL);
@@ -1362,7 +1864,10 @@ gui_line_new (struct t_gui_buffer *buffer, int y, time_t date,
         new_line->data->highlight = 0;
     }
 
+    gui_line_layout_reset (new_line->data);
+
     /* set display flag (check if line is filtered or not) */
+    new_line->data->filters_matched = 0;
     new_line->data->displayed = gui_filter_check_line (new_line->data);
 
     new_line->prev_line = NULL;
@@ -1453,8 +1958,7 @@ gui_line_hook_update (struct t_gui_line *line,
         if (error && !error[0] && (value >= 0))
         {
             line->data->date = (time_t)value;
-            if (line->data->str_time)
-                free (line->data->str_time);
+            gui_line_data_free_string (line->data, line->data->str_time);
             line->data->str_time = gui_chat_get_time_string (line->data->date);
         }
     }
@@ -1472,8 +1976,7 @@ gui_line_hook_update (struct t_gui_line *line,
     ptr_value2 = hashtable_get (hashtable2, "str_time");
     if (ptr_value2 && (!ptr_value || (strcmp (ptr_value, ptr_value2) != 0)))
     {
-        if (line->data->str_time)
-            free (line->data->str_time);
+        gui_line_data_free_string (line->data, line->data->str_time);
         line->data->str_time = (ptr_value2) ? strdup (ptr_value2) : NULL;
     }
 
@@ -1526,11 +2029,12 @@ gui_line_hook_update (struct t_gui_line *line,
     ptr_value2 = hashtable_get (hashtable2, "message");
     if (ptr_value2 && (!ptr_value || (strcmp (ptr_value, ptr_value2) != 0)))
     {
-        if (line->data->message)
-            free (line->data->message);
+        gui_line_data_free_string (line->data, line->data->message);
         line->data->message = (ptr_value2) ? strdup (ptr_value2) : NULL;
     }
 
+    gui_line_layout_reset (line->data);
+
     /* if tags were updated but not notify_level, adjust notify level */
     if (tags_updated && !notify_level_updated)
         line->data->notify_level = gui_line_get_notify_level (line);
@@ -1755,8 +2259,7 @@ gui_line_clear (struct t_gui_line *line)
         string_shared_free (line->data->prefix);
     line->data->prefix = (char *)string_shared_get ("");
 
-    if (line->data->message)
-        free (line->data->message);
+    gui_line_data_free_string (line->data, line->data->message);
     line->data->message = strdup ("");
 }
 
@@ -1838,7 +2341,7 @@ gui_line_mix_buffers (struct t_gui_buffer *buffer)
     if (ptr_buffer_found->mixed_lines)
     {
         gui_line_mixed_free_all (ptr_buffer_found);
-        free (ptr_buffer_found->mixed_lines);
+        gui_lines_free (ptr_buffer_found->mixed_lines);
     }
 
     /* use new structure with mixed lines in all buffers with correct number */
@@ -1880,6 +2383,9 @@ gui_line_hdata_lines_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_lines, buffer_max_length_refresh, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, prefix_max_length, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, prefix_max_length_refresh, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, current_chunk, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, filter_line, POINTER, 0, NULL, "line");
+        HDATA_VAR(struct t_gui_lines, filter_mask_check, INTEGER, 0, NULL, NULL);
     }
     return hdata;
 }
@@ -1938,8 +2444,7 @@ gui_line_hdata_line_data_update_cb (void *data,
         if (value)
         {
             hdata_set (hdata, pointer, "date", value);
-            if (line_data->str_time)
-                free (line_data->str_time);
+            gui_line_data_free_string (line_data, line_data->str_time);
             line_data->str_time = gui_chat_get_time_string (line_data->date);
             rc++;
             update_coords = 1;
@@ -1978,7 +2483,9 @@ gui_line_hdata_line_data_update_cb (void *data,
     if (hashtable_has_key (hashtable, "message"))
     {
         value = hashtable_get (hashtable, "message");
-        hdata_set (hdata, pointer, "message", value);
+        /* message is not set with hdata_set: it may be stored in a chunk */
+        gui_line_data_free_string (line_data, line_data->message);
+        line_data->message = (value) ? strdup (value) : NULL;
         rc++;
         update_coords = 1;
     }
@@ -1987,6 +2494,7 @@ gui_line_hdata_line_data_update_cb (void *data,
     {
         if (update_coords)
         {
+            gui_line_layout_reset (line_data);
             for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
             {
                 gui_window_coords_remove_line_data (ptr_win, line_data);
@@ -2028,9 +2536,11 @@ gui_line_hdata_line_data_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_line_data, notify_level, CHAR, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, highlight, CHAR, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, refresh_needed, CHAR, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_line_data, filters_matched, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, prefix, SHARED_STRING, 1, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, prefix_length, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, message, STRING, 1, NULL, NULL);
+        HDATA_VAR(struct t_gui_line_data, chunk, POINTER, 0, NULL, NULL);
     }
     return hdata;
 }
@@ -2114,6 +2624,20 @@ gui_line_add_to_infolist (struct t_infolist *infolist,
     return 1;
 }
 
+/*
+ * Frees some variables used for lines.
+ */
+
+void
+gui_line_end ()
+{
+    if (gui_line_tags_match_cache)
+    {
+        hashtable_free (gui_line_tags_match_cache);
+        gui_line_tags_match_cache = NULL;
+    }
+}
+
 /*
  * Prints lines structure infos in WeeChat log file (usually for crash dump).
  */
@@ -2133,5 +2657,8 @@ gui_lines_print_log (struct t_gui_lines *lines)
         log_printf ("    buffer_max_length_refresh: %d",    lines->buffer_max_length_refresh);
         log_printf ("    prefix_max_length. . . . : %d",    lines->prefix_max_length);
         log_printf ("    prefix_max_length_refresh: %d",    lines->prefix_max_length_refresh);
+        log_printf ("    current_chunk. . . . . . : 0x%lx", lines->current_chunk);
+        log_printf ("    filter_line. . . . . . . : 0x%lx", lines->filter_line);
+        log_printf ("    filter_mask_check. . . . : 0x%x",  lines->filter_mask_check);
     }
 }
@@ -25,24 +25,66 @@
 
 struct t_infolist;
 
+/*
+ * lines of formatted buffers are allocated in chunks: each chunk contains
+ * many lines (line data, tags array, time string and message are stored
+ * together); a line bigger than a quarter of chunk size has its own chunk
+ */
+#define GUI_LINE_CHUNK_SIZE  16384
+#define GUI_LINE_CHUNK_ALIGN 8
+
+#define GUI_LINE_CHUNK_DATA(__chunk)                                    \
+    (((char *)(__chunk)) + sizeof (struct t_gui_line_chunk))
+
+/*
+ * result of matching between a tag of line and a tag in a list (for example
+ * tags of a filter) is cached, using ids of shared strings as key; the cache
+ * is cleared when it reaches this size
+ */
+#define GUI_LINE_TAGS_MATCH_CACHE_SIZE 16384
+
 /* line structures */
 
+struct t_gui_line_layout
+{
+    short width;                       /* width of chat (0 = no layout)     */
+    short x;                           /* start of message on first line    */
+    short align_first;                 /* alignment on first line           */
+    short align_next;                  /* alignment on next lines           */
+    short align_word;                  /* alignment for multiline words     */
+    short lines;                       /* number of lines for message       */
+};
+
+struct t_gui_line_chunk
+{
+    int size;                          /* size of data in chunk (bytes)     */
+    int used;                          /* bytes used in chunk               */
+    int lines_count;                   /* number of lines stored in chunk   */
+    int current;                       /* 1 if chunk is used for new lines  */
+};
+
 struct t_gui_line_data
 {
     struct t_gui_buffer *buffer;       /* pointer to buffer                 */
     int y;                             /* line position (for free buffer)   */
+    int tags_count;                    /* number of tags for line           */
     time_t date;                       /* date/time of line (may be past)   */
     time_t date_printed;               /* date/time when weechat print it   */
     char *str_time;                    /* time string (for display)         */
-    int tags_count;                    /* number of tags for line           */
     char **tags_array;                 /* tags for line                     */
     char displayed;                    /* 1 if line is displayed            */
     char notify_level;                 /* notify level for the line         */
     char highlight;                    /* 1 if line has highlight           */
     char refresh_needed;               /* 1 if refresh asked (free buffer)  */
+    unsigned int filters_matched;      /* filters matching line (bits with  */
+                                       /* index of filters)                 */
     char *prefix;                      /* prefix for line (may be NULL)     */
     int prefix_length;                 /* prefix length (on screen)         */
+    struct t_gui_line_layout layout;   /* layout of message (cache used to  */
+                                       /* count lines displayed)            */
     char *message;                     /* line content (after prefix)       */
+    struct t_gui_line_chunk *chunk;    /* chunk with line data (NULL if     */
+                                       /* data is allocated with malloc)    */
 };
 
 struct t_gui_line
@@ -65,12 +107,30 @@ struct t_gui_lines
     int buffer_max_length_refresh;     /* refresh asked for buffer max len. */
     int prefix_max_length;             /* max length for prefix align       */
     int prefix_max_length_refresh;     /* refresh asked for prefix max len. */
+    struct t_gui_line_chunk *current_chunk; /* chunk used for new lines     */
+    struct t_gui_line *filter_line;    /* next line to filter (backwards),  */
+                                       /* NULL if filtering is complete     */
+    unsigned int filter_mask_check;    /* filters to check in next lines    */
 };
 
+/* line variables */
+
+extern struct t_hashtable *gui_line_tags_match_cache;
+extern unsigned long long gui_line_layout_hits;
+extern unsigned long long gui_line_layout_misses;
+
 /* line functions */
 
 extern struct t_gui_lines *gui_lines_alloc ();
 extern void gui_lines_free (struct t_gui_lines *lines);
+extern int gui_line_data_in_chunk (struct t_gui_line_data *line_data,
+                                   const void *pointer);
+extern void gui_line_data_free_string (struct t_gui_line_data *line_data,
+                                       char *string);
+extern struct t_gui_line_chunk *gui_line_get_chunk (struct t_gui_line *line);
+extern int gui_line_tags_count (const char *tags);
+extern int gui_line_tags_split (const char *tags, int tags_count,
+                                char **tags_array);
 extern void gui_line_tags_alloc (struct t_gui_line_data *line_data,
                                  const char *tags);
 extern void gui_line_tags_free (struct t_gui_line_data *line_data);
@@ -91,6 +151,7 @@ extern int gui_line_match_regex (struct t_gui_line_data *line_data,
                                  regex_t *regex_prefix,
                                  regex_t *regex_message);
 extern int gui_line_has_tag_no_filter (struct t_gui_line_data *line_data);
+extern int gui_line_match_tag (const char *tag, const char *mask);
 extern int gui_line_match_tags (struct t_gui_line_data *line_data,
                                 int tags_count, char ***tags_array);
 extern const char *gui_line_search_tag_starting_with (struct t_gui_line *line,
@@ -103,7 +164,10 @@ extern void gui_line_compute_buffer_max_length (struct t_gui_buffer *buffer,
 extern void gui_line_compute_prefix_max_length (struct t_gui_lines *lines);
 extern void gui_line_mixed_free_buffer (struct t_gui_buffer *buffer);
 extern void gui_line_mixed_free_all (struct t_gui_buffer *buffer);
+extern void gui_line_layout_reset (struct t_gui_line_data *line_data);
+extern void gui_line_layout_reset_all ();
 extern void gui_line_free_data (struct t_gui_line *line);
+extern void gui_line_free_line (struct t_gui_line *line);
 extern void gui_line_free (struct t_gui_buffer *buffer,
                            struct t_gui_line *line);
 extern void gui_line_free_all (struct t_gui_buffer *buffer);
@@ -134,6 +198,7 @@ extern struct t_hdata *gui_line_hdata_line_data_cb (const void *pointer,
 extern int gui_line_add_to_infolist (struct t_infolist *infolist,
                                      struct t_gui_lines *lines,
                                      struct t_gui_line *line);
+extern void gui_line_end ();
 extern void gui_lines_print_log (struct t_gui_lines *lines);
 
 #endif /* WEECHAT_GUI_LINE_H */
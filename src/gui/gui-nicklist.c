@@ -34,6 +34,7 @@
 #include <ctype.h>
 
 #include "../core/weechat.h"
+#include "../core/wee-arraylist.h"
 #include "../core/wee-config.h"
 #include "../core/wee-hashtable.h"
 #include "../core/wee-hdata.h"
@@ -53,6 +54,9 @@ struct t_hashtable *gui_nicklist_hsignal = NULL;
 
 /*
  * Sends a signal when something has changed in nicklist.
+ *
+ * No signal is sent if the nicklist of buffer is in bulk mode (a single
+ * signal "nicklist_changed" is sent at the end of bulk mode).
  */
 
 void
@@ -62,6 +66,9 @@ gui_nicklist_send_signal (const char *signal, struct t_gui_buffer *buffer,
     char *str_args;
     int length;
 
+    if (buffer && buffer->nicklist_bulk)
+        return;
+
     if (buffer)
     {
         length = 128 + ((arguments) ? strlen (arguments) : 0) + 1 + 1;
@@ -86,6 +93,8 @@ gui_nicklist_send_signal (const char *signal, struct t_gui_buffer *buffer,
 
 /*
  * Sends a hsignal when something will change or has changed in nicklist.
+ *
+ * No hsignal is sent if the nicklist of buffer is in bulk mode.
  */
 
 void
@@ -93,6 +102,9 @@ gui_nicklist_send_hsignal (const char *signal, struct t_gui_buffer *buffer,
                            struct t_gui_nick_group *group,
                            struct t_gui_nick *nick)
 {
+    if (buffer && buffer->nicklist_bulk)
+        return;
+
     if (!gui_nicklist_hsignal)
     {
         gui_nicklist_hsignal = hashtable_new (32,
@@ -277,6 +289,7 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
     new_group->last_child = NULL;
     new_group->nicks = NULL;
     new_group->last_nick = NULL;
+    new_group->nicks_sorted = NULL;
     new_group->prev_group = NULL;
     new_group->next_group = NULL;
 
@@ -303,30 +316,100 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
 }
 
 /*
- * Searches for position of a nick (to keep nicklist sorted).
+ * Compares two nicks by name (case is ignored), to keep nicks sorted in
+ * arraylist of a group.
  */
 
-struct t_gui_nick *
-gui_nicklist_find_pos_nick (struct t_gui_nick_group *group,
-                            struct t_gui_nick *nick)
+int
+gui_nicklist_nicks_sorted_cmp_cb (void *data, struct t_arraylist *arraylist,
+                                  void *pointer1, void *pointer2)
 {
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    return string_strcasecmp (((struct t_gui_nick *)pointer1)->name,
+                              ((struct t_gui_nick *)pointer2)->name);
+}
+
+/*
+ * Adds a nick in arraylist with sorted nicks of its group.
+ *
+ * Returns the index of nick in arraylist, -1 if error.
+ */
+
+int
+gui_nicklist_nicks_sorted_add (struct t_gui_nick *nick)
+{
+    if (!nick->group->nicks_sorted)
+    {
+        nick->group->nicks_sorted = arraylist_new (
+            32, 1, 1,
+            &gui_nicklist_nicks_sorted_cmp_cb, NULL,
+            NULL, NULL);
+        if (!nick->group->nicks_sorted)
+            return -1;
+    }
+
+    return arraylist_add (nick->group->nicks_sorted, nick);
+}
+
+/*
+ * Removes a nick from arraylist with sorted nicks of its group.
+ */
+
+void
+gui_nicklist_nicks_sorted_remove (struct t_gui_nick *nick)
+{
+    int index, index_insert;
+
+    (void) arraylist_search (nick->group->nicks_sorted, nick,
+                             &index, &index_insert);
+    if (index < 0)
+        return;
+
+    /* look for the nick among the nicks with same name */
+    while ((index < index_insert)
+           && (arraylist_get (nick->group->nicks_sorted, index) != nick))
+    {
+        index++;
+    }
+    if (index < index_insert)
+        arraylist_remove (nick->group->nicks_sorted, index);
+}
+
+/*
+ * Builds the arraylists with sorted nicks of a group and its child groups,
+ * using the linked lists of nicks (which must be sorted).
+ */
+
+void
+gui_nicklist_nicks_sorted_build (struct t_gui_nick_group *group)
+{
+    struct t_gui_nick_group *ptr_group;
     struct t_gui_nick *ptr_nick;
 
-    if (!group)
-        return NULL;
+    if (group->nicks_sorted)
+        arraylist_clear (group->nicks_sorted);
 
+    /* nicks are sorted, so each nick is added at the end of arraylist */
     for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
     {
-        if (string_strcasecmp (nick->name, ptr_nick->name) < 0)
-            return ptr_nick;
+        gui_nicklist_nicks_sorted_add (ptr_nick);
     }
 
-    /* nick will be inserted at end of list */
-    return NULL;
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        gui_nicklist_nicks_sorted_build (ptr_group);
+    }
 }
 
 /*
  * Inserts nick into sorted list.
+ *
+ * The position is found with a binary search in the arraylist with sorted
+ * nicks of group.
  */
 
 void
@@ -334,10 +417,13 @@ gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
                                  struct t_gui_nick *nick)
 {
     struct t_gui_nick *pos_nick;
+    int index;
 
     if (group->nicks)
     {
-        pos_nick = gui_nicklist_find_pos_nick (group, nick);
+        index = gui_nicklist_nicks_sorted_add (nick);
+        pos_nick = (index >= 0) ?
+            arraylist_get (group->nicks_sorted, index + 1) : NULL;
 
         if (pos_nick)
         {
@@ -361,6 +447,7 @@ gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
     }
     else
     {
+        gui_nicklist_nicks_sorted_add (nick);
         nick->prev_nick = NULL;
         nick->next_nick = NULL;
         group->nicks = nick;
@@ -369,29 +456,169 @@ gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
 }
 
 /*
- * Searches for a nick in nicklist.
+ * Hashes a nick name for the index of nicks: case is ignored for chars
+ * "A" to "^" (like function string_strcasecmp_range with range 30), so that
+ * nicks equal with any IRC casemapping have the same hash.
+ */
+
+unsigned long long
+gui_nicklist_hash_key_cb (struct t_hashtable *hashtable, const void *key)
+{
+    const char *ptr_key;
+    unsigned long long hash;
+    unsigned char c;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    /* variant of djb2 hash */
+    hash = 5381;
+    for (ptr_key = (const char *)key; ptr_key[0]; ptr_key++)
+    {
+        c = (unsigned char)ptr_key[0];
+        if ((c >= 'A') && (c <= '^'))
+            c += ('a' - 'A');
+        hash ^= (hash << 5) + (hash >> 2) + (int)c;
+    }
+
+    return hash;
+}
+
+/*
+ * Compares two nick names for the index of nicks (case is ignored for chars
+ * "A" to "^", see function gui_nicklist_hash_key_cb).
+ */
+
+int
+gui_nicklist_keycmp_cb (struct t_hashtable *hashtable,
+                        const void *key1, const void *key2)
+{
+    const unsigned char *ptr_key1, *ptr_key2;
+    unsigned char c1, c2;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    ptr_key1 = (const unsigned char *)key1;
+    ptr_key2 = (const unsigned char *)key2;
+    while (1)
+    {
+        c1 = ptr_key1[0];
+        if ((c1 >= 'A') && (c1 <= '^'))
+            c1 += ('a' - 'A');
+        c2 = ptr_key2[0];
+        if ((c2 >= 'A') && (c2 <= '^'))
+            c2 += ('a' - 'A');
+        if (c1 != c2)
+            return (c1 < c2) ? -1 : 1;
+        if (!c1)
+            return 0;
+        ptr_key1++;
+        ptr_key2++;
+    }
+}
+
+/*
+ * Adds a nick in index of nicks (hashtable with nick names as keys).
+ *
+ * The value in hashtable is the first nick with this key, other nicks with
+ * same key are linked with pointer "next_nick_index".
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+gui_nicklist_index_add (struct t_gui_buffer *buffer, struct t_gui_nick *nick)
+{
+    struct t_gui_nick *ptr_nick;
+
+    if (!buffer->nicklist_nicks_index)
+    {
+        buffer->nicklist_nicks_index = hashtable_new_with_engine (
+            HASHTABLE_ENGINE_OPEN,
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            &gui_nicklist_hash_key_cb,
+            &gui_nicklist_keycmp_cb);
+        if (!buffer->nicklist_nicks_index)
+            return 0;
+    }
+
+    ptr_nick = hashtable_get (buffer->nicklist_nicks_index, nick->name);
+    if (ptr_nick)
+    {
+        nick->next_nick_index = ptr_nick->next_nick_index;
+        ptr_nick->next_nick_index = nick;
+        return 1;
+    }
+
+    nick->next_nick_index = NULL;
+    return (hashtable_set (buffer->nicklist_nicks_index,
+                           nick->name, nick)) ? 1 : 0;
+}
+
+/*
+ * Removes a nick from index of nicks.
+ */
+
+void
+gui_nicklist_index_remove (struct t_gui_buffer *buffer,
+                           struct t_gui_nick *nick)
+{
+    struct t_gui_nick *ptr_nick;
+
+    ptr_nick = hashtable_get (buffer->nicklist_nicks_index, nick->name);
+    if (!ptr_nick)
+        return;
+
+    if (ptr_nick == nick)
+    {
+        if (nick->next_nick_index)
+        {
+            hashtable_set (buffer->nicklist_nicks_index,
+                           nick->name, nick->next_nick_index);
+        }
+        else
+        {
+            hashtable_remove (buffer->nicklist_nicks_index, nick->name);
+        }
+        return;
+    }
+
+    while (ptr_nick->next_nick_index)
+    {
+        if (ptr_nick->next_nick_index == nick)
+        {
+            ptr_nick->next_nick_index = nick->next_nick_index;
+            return;
+        }
+        ptr_nick = ptr_nick->next_nick_index;
+    }
+}
+
+/*
+ * Searches for a nick in a group and its children, by a walk of nicks.
  *
  * Returns pointer to nick found, NULL if not found.
  */
 
 struct t_gui_nick *
-gui_nicklist_search_nick (struct t_gui_buffer *buffer,
-                          struct t_gui_nick_group *from_group,
-                          const char *name)
+gui_nicklist_search_nick_in_group (struct t_gui_buffer *buffer,
+                                   struct t_gui_nick_group *group,
+                                   const char *name)
 {
     struct t_gui_nick *ptr_nick;
     struct t_gui_nick_group *ptr_group;
 
-    if (!buffer && !from_group)
-        return NULL;
-
-    if (!from_group && !buffer->nicklist_root)
+    if (!group)
         return NULL;
 
-    for (ptr_nick = (from_group) ? from_group->nicks : buffer->nicklist_root->nicks;
-         ptr_nick; ptr_nick = ptr_nick->next_nick)
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
     {
-        if (buffer->nickcmp_callback)
+        if (buffer && buffer->nickcmp_callback)
         {
             if ((buffer->nickcmp_callback) (buffer->nickcmp_callback_pointer,
                                             buffer->nickcmp_callback_data,
@@ -408,10 +635,10 @@ gui_nicklist_search_nick (struct t_gui_buffer *buffer,
     }
 
     /* search nick in child groups */
-    for (ptr_group = (from_group) ? from_group->children : buffer->nicklist_root->children;
-         ptr_group; ptr_group = ptr_group->next_group)
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
     {
-        ptr_nick = gui_nicklist_search_nick (buffer, ptr_group, name);
+        ptr_nick = gui_nicklist_search_nick_in_group (buffer, ptr_group, name);
         if (ptr_nick)
             return ptr_nick;
     }
@@ -420,9 +647,79 @@ gui_nicklist_search_nick (struct t_gui_buffer *buffer,
     return NULL;
 }
 
+/*
+ * Searches for a nick in nicklist.
+ *
+ * The nick is searched in the index of nicks if the buffer has no
+ * "nickcmp_callback" or if this callback ignores case only for a range of
+ * chars included in "A" to "^" (buffer property "nickcmp_case_range", see
+ * function gui_nicklist_hash_key_cb); otherwise (or if buffer is NULL) the
+ * nick is searched by a walk of nicklist.
+ *
+ * Returns pointer to nick found, NULL if not found.
+ */
+
+struct t_gui_nick *
+gui_nicklist_search_nick (struct t_gui_buffer *buffer,
+                          struct t_gui_nick_group *from_group,
+                          const char *name)
+{
+    struct t_gui_nick *ptr_nick;
+    struct t_gui_nick_group *ptr_group;
+
+    if ((!buffer && !from_group) || !name)
+        return NULL;
+
+    if (!buffer
+        || (buffer->nickcmp_callback && (buffer->nickcmp_case_range < 0)))
+    {
+        return gui_nicklist_search_nick_in_group (
+            buffer,
+            (from_group) ? from_group : buffer->nicklist_root,
+            name);
+    }
+
+    if (!buffer->nicklist_nicks_index)
+        return NULL;
+
+    for (ptr_nick = hashtable_get (buffer->nicklist_nicks_index, name);
+         ptr_nick; ptr_nick = ptr_nick->next_nick_index)
+    {
+        if (buffer->nickcmp_callback)
+        {
+            if ((buffer->nickcmp_callback) (buffer->nickcmp_callback_pointer,
+                                            buffer->nickcmp_callback_data,
+                                            buffer,
+                                            ptr_nick->name,
+                                            name) != 0)
+                continue;
+        }
+        else
+        {
+            if (strcmp (ptr_nick->name, name) != 0)
+                continue;
+        }
+        if (!from_group)
+            return ptr_nick;
+        /* check that nick is in the group or one of its children */
+        for (ptr_group = ptr_nick->group; ptr_group;
+             ptr_group = ptr_group->parent)
+        {
+            if (ptr_group == from_group)
+                return ptr_nick;
+        }
+    }
+
+    /* nick not found */
+    return NULL;
+}
+
 /*
  * Adds a nick to nicklist.
  *
+ * If the nicklist of buffer is in bulk mode, the nick is added at the end of
+ * group (nicks are sorted at the end of bulk mode).
+ *
  * Returns pointer to new nick, NULL if error.
  */
 
@@ -435,7 +732,10 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
 {
     struct t_gui_nick *new_nick;
 
-    if (!buffer || !name || gui_nicklist_search_nick (buffer, NULL, name))
+    if (!buffer || !name)
+        return NULL;
+
+    if (gui_nicklist_search_nick (buffer, NULL, name))
         return NULL;
 
     new_nick = malloc (sizeof (*new_nick));
@@ -448,8 +748,34 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
     new_nick->prefix = (prefix) ? (char *)string_shared_get (prefix) : NULL;
     new_nick->prefix_color = (prefix_color) ? (char *)string_shared_get (prefix_color) : NULL;
     new_nick->visible = visible;
+    new_nick->next_nick_index = NULL;
 
-    gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
+    if (!gui_nicklist_index_add (buffer, new_nick))
+    {
+        string_shared_free (new_nick->name);
+        if (new_nick->color)
+            string_shared_free (new_nick->color);
+        if (new_nick->prefix)
+            string_shared_free (new_nick->prefix);
+        if (new_nick->prefix_color)
+            string_shared_free (new_nick->prefix_color);
+        free (new_nick);
+        return NULL;
+    }
+
+    if (buffer->nicklist_bulk)
+    {
+        /* add nick to the end (nicks are sorted at the end of bulk mode) */
+        new_nick->prev_nick = new_nick->group->last_nick;
+        new_nick->next_nick = NULL;
+        if (new_nick->group->last_nick)
+            new_nick->group->last_nick->next_nick = new_nick;
+        else
+            new_nick->group->nicks = new_nick;
+        new_nick->group->last_nick = new_nick;
+    }
+    else
+        gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
 
     buffer->nicklist_count++;
     buffer->nicklist_nicks_count++;
@@ -484,7 +810,9 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
     gui_nicklist_send_signal ("nicklist_nick_removing", buffer, nick_removed);
     gui_nicklist_send_hsignal ("nicklist_nick_removing", buffer, NULL, nick);
 
-    /* remove nick from list */
+    /* remove nick from index and list */
+    gui_nicklist_index_remove (buffer, nick);
+    gui_nicklist_nicks_sorted_remove (nick);
     if (nick->prev_nick)
         (nick->prev_nick)->next_nick = nick->next_nick;
     if (nick->next_nick)
@@ -545,7 +873,12 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
         gui_nicklist_remove_group (buffer, group->children);
     }
 
-    /* remove nicks from group */
+    /* remove nicks from group (sorted nicks are freed first, it's faster) */
+    if (group->nicks_sorted)
+    {
+        arraylist_free (group->nicks_sorted);
+        group->nicks_sorted = NULL;
+    }
     while (group->nicks)
     {
         gui_nicklist_remove_nick (buffer, group->nicks);
@@ -572,6 +905,11 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
     else
     {
         buffer->nicklist_root = NULL;
+        if (buffer->nicklist_nicks_index)
+        {
+            hashtable_free (buffer->nicklist_nicks_index);
+            buffer->nicklist_nicks_index = NULL;
+        }
     }
 
     /* free data */
@@ -610,7 +948,8 @@ gui_nicklist_remove_all (struct t_gui_buffer *buffer)
             gui_nicklist_remove_group (buffer, buffer->nicklist_root->children);
         }
 
-        /* remove nicks of root group */
+        /* remove nicks of root group (sorted nicks are cleared first) */
+        arraylist_clear (buffer->nicklist_root->nicks_sorted);
         while (buffer->nicklist_root->nicks)
         {
             gui_nicklist_remove_nick (buffer, buffer->nicklist_root->nicks);
@@ -618,6 +957,112 @@ gui_nicklist_remove_all (struct t_gui_buffer *buffer)
     }
 }
 
+/*
+ * Sorts nicks of a group and its child groups by name.
+ *
+ * The sort is a merge sort on the linked list, which is stable: nicks with
+ * same name keep their order, like with insertion of nicks one by one in the
+ * sorted list.
+ */
+
+void
+gui_nicklist_sort_nicks (struct t_gui_nick_group *group)
+{
+    struct t_gui_nick *list, *tail, *ptr_nick, *ptr_left, *ptr_right;
+    struct t_gui_nick_group *ptr_group;
+    int size, num_merges, left_size, right_size;
+
+    if (!group)
+        return;
+
+    list = group->nicks;
+    tail = NULL;
+    size = 1;
+    while (list)
+    {
+        ptr_left = list;
+        list = NULL;
+        tail = NULL;
+        num_merges = 0;
+        while (ptr_left)
+        {
+            num_merges++;
+
+            /* right list starts "size" nicks after left list */
+            ptr_right = ptr_left;
+            left_size = 0;
+            while ((left_size < size) && ptr_right)
+            {
+                left_size++;
+                ptr_right = ptr_right->next_nick;
+            }
+            right_size = size;
+
+            /* merge left and right lists */
+            while ((left_size > 0) || ((right_size > 0) && ptr_right))
+            {
+                if ((left_size > 0)
+                    && ((right_size == 0) || !ptr_right
+                        || (string_strcasecmp (ptr_left->name,
+                                               ptr_right->name) <= 0)))
+                {
+                    ptr_nick = ptr_left;
+                    ptr_left = ptr_left->next_nick;
+                    left_size--;
+                }
+                else
+                {
+                    ptr_nick = ptr_right;
+                    ptr_right = ptr_right->next_nick;
+                    right_size--;
+                }
+                ptr_nick->prev_nick = tail;
+                if (tail)
+                    tail->next_nick = ptr_nick;
+                else
+                    list = ptr_nick;
+                tail = ptr_nick;
+            }
+
+            ptr_left = ptr_right;
+        }
+        tail->next_nick = NULL;
+
+        if (num_merges <= 1)
+            break;
+
+        size *= 2;
+    }
+    group->nicks = list;
+    group->last_nick = tail;
+
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        gui_nicklist_sort_nicks (ptr_group);
+    }
+}
+
+/*
+ * Ends bulk mode in nicklist: sorts nicks added during bulk mode, rebuilds
+ * the arraylists with sorted nicks and sends a single signal
+ * "nicklist_changed" (and the same hsignal).
+ */
+
+void
+gui_nicklist_bulk_end (struct t_gui_buffer *buffer)
+{
+    if (!buffer || !buffer->nicklist_root)
+        return;
+
+    gui_nicklist_sort_nicks (buffer->nicklist_root);
+    gui_nicklist_nicks_sorted_build (buffer->nicklist_root);
+
+    gui_nicklist_send_signal ("nicklist_changed", buffer, NULL);
+    gui_nicklist_send_hsignal ("nicklist_changed", buffer,
+                               buffer->nicklist_root, NULL);
+}
+
 /*
  * Gets next item (group or nick) of a group/nick.
  */
@@ -1065,6 +1510,7 @@ gui_nicklist_hdata_nick_group_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_nick_group, last_child, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_nick_group, nicks, POINTER, 0, NULL, "nick");
         HDATA_VAR(struct t_gui_nick_group, last_nick, POINTER, 0, NULL, "nick");
+        HDATA_VAR(struct t_gui_nick_group, nicks_sorted, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_nick_group, prev_group, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_nick_group, next_group, POINTER, 0, NULL, hdata_name);
     }
@@ -1097,6 +1543,7 @@ gui_nicklist_hdata_nick_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_nick, visible, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_nick, prev_nick, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_nick, next_nick, POINTER, 0, NULL, hdata_name);
+        HDATA_VAR(struct t_gui_nick, next_nick_index, POINTER, 0, NULL, hdata_name);
     }
     return hdata;
 }
@@ -1283,6 +1730,10 @@ gui_nicklist_print_log (struct t_gui_nick_group *group, int indent)
               "%%-%dslast_nick . : 0x%%lx",
               (indent * 2) + 6);
     log_printf (format, " ", group->last_nick);
+    snprintf (format, sizeof (format),
+              "%%-%dsnicks_sorted: 0x%%lx",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->nicks_sorted);
     snprintf (format, sizeof (format),
               "%%-%dsprev_group. : 0x%%lx",
               (indent * 2) + 6);
@@ -1342,6 +1793,10 @@ gui_nicklist_print_log (struct t_gui_nick_group *group, int indent)
                   "%%-%dsnext_nick . . . : 0x%%lx",
                   (indent * 2) + 6);
         log_printf (format, " ", ptr_nick->next_nick);
+        snprintf (format, sizeof (format),
+                  "%%-%dsnext_nick_index : 0x%%lx",
+                  (indent * 2) + 6);
+        log_printf (format, " ", ptr_nick->next_nick_index);
     }
 }
 
@@ -22,6 +22,7 @@
 
 struct t_gui_buffer;
 struct t_infolist;
+struct t_arraylist;
 
 struct t_gui_nick_group
 {
@@ -34,6 +35,7 @@ struct t_gui_nick_group
     struct t_gui_nick_group *last_child; /* last child                      */
     struct t_gui_nick *nicks;          /* nicks for group                   */
     struct t_gui_nick *last_nick;      /* last nick for group               */
+    struct t_arraylist *nicks_sorted;  /* nicks sorted by name (index)      */
     struct t_gui_nick_group *prev_group; /* link to previous group          */
     struct t_gui_nick_group *next_group; /* link to next group              */
 };
@@ -48,6 +50,7 @@ struct t_gui_nick
     int visible;                       /* 1 if nick is displayed            */
     struct t_gui_nick *prev_nick;      /* link to previous nick             */
     struct t_gui_nick *next_nick;      /* link to next nick                 */
+    struct t_gui_nick *next_nick_index; /* next nick with same key in index */
 };
 
 /* nicklist functions */
@@ -60,6 +63,9 @@ extern struct t_gui_nick_group *gui_nicklist_add_group (struct t_gui_buffer *buf
                                                         const char *name,
                                                         const char *color,
                                                         int visible);
+extern struct t_gui_nick *gui_nicklist_search_nick_in_group (struct t_gui_buffer *buffer,
+                                                             struct t_gui_nick_group *group,
+                                                             const char *name);
 extern struct t_gui_nick *gui_nicklist_search_nick (struct t_gui_buffer *buffer,
                                                     struct t_gui_nick_group *from_group,
                                                     const char *name);
@@ -75,6 +81,8 @@ extern void gui_nicklist_remove_group (struct t_gui_buffer *buffer,
 extern void gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
                                       struct t_gui_nick *nick);
 extern void gui_nicklist_remove_all (struct t_gui_buffer *buffer);
+extern void gui_nicklist_sort_nicks (struct t_gui_nick_group *group);
+extern void gui_nicklist_bulk_end (struct t_gui_buffer *buffer);
 extern void gui_nicklist_get_next_item (struct t_gui_buffer *buffer,
                                         struct t_gui_nick_group **group,
                                         struct t_gui_nick **nick);
@@ -901,22 +901,31 @@ gui_window_coords_init_line (struct t_gui_window *window, int line)
 /*
  * Removes a line from coordinates: each time the line is found in the array
  * "coords", it is reinitialized.
+ *
+ * Returns number of coordinates reinitialized (0 if the line was not displayed
+ * in window).
  */
 
-void
+int
 gui_window_coords_remove_line (struct t_gui_window *window,
                                struct t_gui_line *line)
 {
-    int i;
+    int i, count;
 
     if (!window || !window->coords)
-        return;
+        return 0;
 
+    count = 0;
     for (i = 0; i < window->coords_size; i++)
     {
         if (window->coords[i].line == line)
+        {
             gui_window_coords_init_line (window, i);
+            count++;
+        }
     }
+
+    return count;
 }
 
 /*
@@ -307,6 +307,8 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
 
     item_index = (int)((unsigned long)pointer);
 
+    weechat_hashtable_remove_all (buflist_hashtable_extra_vars);
+
     weechat_hashtable_set (buflist_hashtable_pointers, "bar_item", item);
 
     ptr_format = buflist_config_format_buffer_eval;
@@ -662,6 +664,11 @@ buflist_bar_item_init ()
         weechat_hashtable_free (buflist_hashtable_pointers);
         return 0;
     }
+    /*
+     * variables are set for each buffer on each refresh of the bar item:
+     * use an arena, which is emptied at the beginning of each refresh
+     */
+    weechat_hashtable_set_arena (buflist_hashtable_extra_vars, 8192);
 
     buflist_hashtable_options_conditions = weechat_hashtable_new (
         32,
@@ -356,6 +356,8 @@ irc_channel_create_buffer (struct t_irc_server *server,
                                         &irc_buffer_nickcmp_cb);
             weechat_buffer_set_pointer (ptr_buffer, "nickcmp_callback_pointer",
                                         server);
+            /* any casemapping ignores case at most for chars "A" to "^" */
+            weechat_buffer_set (ptr_buffer, "nickcmp_case_range", "30");
         }
 
         /* set highlights settings on channel buffer */
@@ -479,6 +481,12 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
     new_channel->nicks_count = 0;
     new_channel->nicks = NULL;
     new_channel->last_nick = NULL;
+    /* index of nicks is useless in private buffers (at most 2 nicks) */
+    new_channel->nicks_index = (channel_type == IRC_CHANNEL_TYPE_CHANNEL) ?
+        weechat_hashtable_new (64,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_POINTER,
+                               NULL, NULL) : NULL;
     new_channel->nicks_speaking[0] = NULL;
     new_channel->nicks_speaking[1] = NULL;
     new_channel->nicks_speaking_time = NULL;
@@ -589,6 +597,48 @@ irc_channel_set_modes (struct t_irc_channel *channel, const char *modes)
     channel->modes = (modes) ? strdup (modes) : NULL;
 }
 
+/*
+ * Starts bulk mode in nicklist of a channel (used for names received on
+ * join, message 353).
+ *
+ * A bulk mode started for another channel of the same server is ended first.
+ */
+
+void
+irc_channel_nicklist_bulk_start (struct t_irc_server *server,
+                                 struct t_irc_channel *channel)
+{
+    if (!server || !channel || !channel->buffer)
+        return;
+
+    if (server->nicklist_bulk_channel == channel)
+        return;
+
+    irc_channel_nicklist_bulk_end (server);
+
+    weechat_buffer_set (channel->buffer, "nicklist_bulk", "1");
+    server->nicklist_bulk_channel = channel;
+}
+
+/*
+ * Ends bulk mode in nicklist of the channel receiving names on a server
+ * (if any): nicks are sorted and a single nicklist signal is sent.
+ */
+
+void
+irc_channel_nicklist_bulk_end (struct t_irc_server *server)
+{
+    struct t_irc_channel *ptr_channel;
+
+    if (!server || !server->nicklist_bulk_channel)
+        return;
+
+    ptr_channel = server->nicklist_bulk_channel;
+    server->nicklist_bulk_channel = NULL;
+
+    weechat_buffer_set (ptr_channel->buffer, "nicklist_bulk", "0");
+}
+
 /*
  * Checks if a string is a valid channel name.
  *
@@ -1423,6 +1473,8 @@ irc_channel_free (struct t_irc_server *server, struct t_irc_channel *channel)
     /* free linked lists */
     irc_nick_free_all (server, channel);
     irc_modelist_free_all (channel);
+    if (channel->nicks_index)
+        weechat_hashtable_free (channel->nicks_index);
 
     /* free channel data */
     if (channel->name)
@@ -1691,6 +1743,10 @@ irc_channel_print_log (struct t_irc_channel *channel)
     weechat_log_printf ("       nicks_count. . . . . . . : %d",    channel->nicks_count);
     weechat_log_printf ("       nicks. . . . . . . . . . : 0x%lx", channel->nicks);
     weechat_log_printf ("       last_nick. . . . . . . . : 0x%lx", channel->last_nick);
+    weechat_log_printf ("       nicks_index. . . . . . . : 0x%lx (%d items)",
+                        channel->nicks_index,
+                        weechat_hashtable_get_integer (channel->nicks_index,
+                                                       "items_count"));
     weechat_log_printf ("       nicks_speaking[0]. . . . : 0x%lx", channel->nicks_speaking[0]);
     weechat_log_printf ("       nicks_speaking[1]. . . . : 0x%lx", channel->nicks_speaking[1]);
     weechat_log_printf ("       nicks_speaking_time. . . : 0x%lx", channel->nicks_speaking_time);
@@ -66,6 +66,8 @@ struct t_irc_channel
     int nicks_count;                   /* # nicks on channel (0 if pv)      */
     struct t_irc_nick *nicks;          /* nicks on the channel              */
     struct t_irc_nick *last_nick;      /* last nick on the channel          */
+    struct t_hashtable *nicks_index;   /* index of nicks: key is nick in    */
+                                       /* lower case (server casemapping)   */
     struct t_weelist *nicks_speaking[2]; /* for smart completion: first     */
                                        /* list is nick speaking, second is  */
                                        /* speaking to me (highlight)        */
@@ -81,6 +83,7 @@ struct t_irc_channel
     struct t_irc_channel *next_channel; /* link to next channel             */
 };
 
+
 extern int irc_channel_valid (struct t_irc_server *server,
                               struct t_irc_channel *channel);
 extern struct t_irc_channel *irc_channel_search (struct t_irc_server *server,
@@ -108,6 +111,9 @@ extern void irc_channel_set_modes (struct t_irc_channel *channel,
 extern void irc_channel_free (struct t_irc_server *server,
                               struct t_irc_channel *channel);
 extern void irc_channel_free_all (struct t_irc_server *server);
+extern void irc_channel_nicklist_bulk_start (struct t_irc_server *server,
+                                             struct t_irc_channel *channel);
+extern void irc_channel_nicklist_bulk_end (struct t_irc_server *server);
 extern int irc_channel_is_channel (struct t_irc_server *server,
                                    const char *string);
 extern const char *irc_channel_get_auto_chantype (struct t_irc_server *server,
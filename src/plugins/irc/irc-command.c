@@ -5010,22 +5010,46 @@ irc_command_display_server (struct t_irc_server *server, int with_detail)
         if (weechat_config_option_is_null (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH]))
             weechat_printf (NULL, "  anti_flood_prio_high :   (%d %s)",
                             IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH),
-                            NG_("second", "seconds", IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH)));
+                            (IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_UNIT) == IRC_SERVER_ANTI_FLOOD_UNIT_SECONDS) ?
+                            NG_("second", "seconds", IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH)) :
+                            NG_("millisecond", "milliseconds", IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH)));
         else
             weechat_printf (NULL, "  anti_flood_prio_high : %s%d %s",
                             IRC_COLOR_CHAT_VALUE,
                             weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH]),
-                            NG_("second", "seconds", weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH])));
+                            (IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_UNIT) == IRC_SERVER_ANTI_FLOOD_UNIT_SECONDS) ?
+                            NG_("second", "seconds", weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH])) :
+                            NG_("millisecond", "milliseconds", weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH])));
         /* anti_flood_prio_low */
         if (weechat_config_option_is_null (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW]))
             weechat_printf (NULL, "  anti_flood_prio_low. :   (%d %s)",
                             IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW),
-                            NG_("second", "seconds", IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW)));
+                            (IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_UNIT) == IRC_SERVER_ANTI_FLOOD_UNIT_SECONDS) ?
+                            NG_("second", "seconds", IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW)) :
+                            NG_("millisecond", "milliseconds", IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW)));
         else
             weechat_printf (NULL, "  anti_flood_prio_low. : %s%d %s",
                             IRC_COLOR_CHAT_VALUE,
                             weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW]),
-                            NG_("second", "seconds", weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW])));
+                            (IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_UNIT) == IRC_SERVER_ANTI_FLOOD_UNIT_SECONDS) ?
+                            NG_("second", "seconds", weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW])) :
+                            NG_("millisecond", "milliseconds", weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW])));
+        /* anti_flood_burst */
+        if (weechat_config_option_is_null (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST]))
+            weechat_printf (NULL, "  anti_flood_burst . . :   (%d)",
+                            IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_BURST));
+        else
+            weechat_printf (NULL, "  anti_flood_burst . . : %s%d",
+                            IRC_COLOR_CHAT_VALUE,
+                            weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST]));
+        /* anti_flood_unit */
+        if (weechat_config_option_is_null (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_UNIT]))
+            weechat_printf (NULL, "  anti_flood_unit. . . :   ('%s')",
+                            irc_server_anti_flood_unit_string[IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_UNIT)]);
+        else
+            weechat_printf (NULL, "  anti_flood_unit. . . : %s'%s'",
+                            IRC_COLOR_CHAT_VALUE,
+                            irc_server_anti_flood_unit_string[weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_UNIT])]);
         /* away_check */
         if (weechat_config_option_is_null (server->options[IRC_SERVER_OPTION_AWAY_CHECK]))
             weechat_printf (NULL, "  away_check . . . . . :   (%d %s)",
@@ -5530,7 +5554,7 @@ IRC_COMMAND_CALLBACK(server)
                 strcpy (message, argv_eol[2]);
                 strcat (message, "\r\n");
                 irc_server_msgq_add_buffer (ptr_server, message);
-                irc_server_msgq_flush ();
+                irc_server_msgq_flush_server (ptr_server, 0);
                 free (message);
             }
         }
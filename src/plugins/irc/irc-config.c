@@ -140,6 +140,9 @@ struct t_config_option *irc_config_network_lag_reconnect;
 struct t_config_option *irc_config_network_lag_refresh_interval;
 struct t_config_option *irc_config_network_notify_check_ison;
 struct t_config_option *irc_config_network_notify_check_whois;
+struct t_config_option *irc_config_network_recv_buffer_size;
+struct t_config_option *irc_config_network_recv_max_bytes;
+struct t_config_option *irc_config_network_recv_max_messages;
 struct t_config_option *irc_config_network_sasl_fail_unavailable;
 struct t_config_option *irc_config_network_send_unknown_commands;
 struct t_config_option *irc_config_network_whois_double_nick;
@@ -2228,9 +2231,10 @@ irc_config_server_new_option (struct t_config_file *config_file,
                 config_file, section,
                 option_name, "integer",
                 N_("anti-flood for high priority queue: number of seconds "
-                   "between two user messages or commands sent to IRC server "
+                   "(or milliseconds, see option anti_flood_unit) between two "
+                   "user messages or commands sent to IRC server "
                    "(0 = no anti-flood)"),
-                NULL, 0, 60,
+                NULL, 0, 60000,
                 default_value, value,
                 null_value_allowed,
                 callback_check_value,
@@ -2246,9 +2250,49 @@ irc_config_server_new_option (struct t_config_file *config_file,
                 config_file, section,
                 option_name, "integer",
                 N_("anti-flood for low priority queue: number of seconds "
-                   "between two messages sent to IRC server (messages like "
-                   "automatic CTCP replies) (0 = no anti-flood)"),
-                NULL, 0, 60,
+                   "(or milliseconds, see option anti_flood_unit) between two "
+                   "messages sent to IRC server (messages like automatic CTCP "
+                   "replies) (0 = no anti-flood)"),
+                NULL, 0, 60000,
+                default_value, value,
+                null_value_allowed,
+                callback_check_value,
+                callback_check_value_pointer,
+                callback_check_value_data,
+                callback_change,
+                callback_change_pointer,
+                callback_change_data,
+                NULL, NULL, NULL);
+            break;
+        case IRC_SERVER_OPTION_ANTI_FLOOD_BURST:
+            new_option = weechat_config_new_option (
+                config_file, section,
+                option_name, "integer",
+                N_("anti-flood: number of messages that can be sent at once "
+                   "to IRC server before the anti-flood delays apply; the "
+                   "delays of options anti_flood_prio_high and "
+                   "anti_flood_prio_low are then used to refill the burst "
+                   "(1 = no burst: one message each delay)"),
+                NULL, 1, 100,
+                default_value, value,
+                null_value_allowed,
+                callback_check_value,
+                callback_check_value_pointer,
+                callback_check_value_data,
+                callback_change,
+                callback_change_pointer,
+                callback_change_data,
+                NULL, NULL, NULL);
+            break;
+        case IRC_SERVER_OPTION_ANTI_FLOOD_UNIT:
+            new_option = weechat_config_new_option (
+                config_file, section,
+                option_name, "integer",
+                N_("unit of options anti_flood_prio_high and "
+                   "anti_flood_prio_low: \"seconds\" or \"milliseconds\" "
+                   "(milliseconds allow a refill rate of the anti-flood burst "
+                   "faster than one message per second)"),
+                "seconds|milliseconds", 0, 0,
                 default_value, value,
                 null_value_allowed,
                 callback_check_value,
@@ -3352,6 +3396,32 @@ irc_config_init ()
         NULL, NULL, NULL,
         &irc_config_change_network_notify_check_whois, NULL, NULL,
         NULL, NULL, NULL);
+    irc_config_network_recv_buffer_size = weechat_config_new_option (
+        irc_config_file, ptr_section,
+        "recv_buffer_size", "integer",
+        N_("size of buffer used to receive data from a server (one buffer "
+           "is allocated for each connected server); a message longer than "
+           "this size is still received"),
+        NULL, 4096, 1024 * 1024, "65536", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    irc_config_network_recv_max_bytes = weechat_config_new_option (
+        irc_config_file, ptr_section,
+        "recv_max_bytes", "integer",
+        N_("maximum number of bytes read on the socket of a server before "
+           "giving hand to other servers and to the main loop "
+           "(0 = read until there is no more data available)"),
+        NULL, 0, INT_MAX, "262144", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    irc_config_network_recv_max_messages = weechat_config_new_option (
+        irc_config_file, ptr_section,
+        "recv_max_messages", "integer",
+        N_("maximum number of received messages processed for a server "
+           "before giving hand to other servers and to the main loop; "
+           "remaining messages are processed on next iterations of main "
+           "loop, in turn with other servers (0 = process all received "
+           "messages at once)"),
+        NULL, 0, INT_MAX, "100", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
     irc_config_network_sasl_fail_unavailable = weechat_config_new_option (
         irc_config_file, ptr_section,
         "sasl_fail_unavailable", "boolean",
@@ -527,6 +527,116 @@ irc_message_get_address_from_host (const char *host)
     return address;
 }
 
+/*
+ * Splits arguments of an IRC message (separated by spaces), for the callbacks
+ * of received messages.
+ *
+ * Arrays "argv" and "argv_eol" are the same as the arrays returned by
+ * function weechat_string_split with separator " " and these flags:
+ *   - argv: STRIP_LEFT + STRIP_RIGHT + COLLAPSE_SEPS
+ *   - argv_eol: STRIP_LEFT + COLLAPSE_SEPS + KEEP_EOL (+ STRIP_RIGHT if
+ *     strip_right_eol is 1)
+ *
+ * The message is copied only once in each array: the strings are stored in
+ * the same memory block as the array and the items of argv_eol share the end
+ * of the same string (so they must not be modified).
+ *
+ * Note: arrays must be freed after use with free() (and not with function
+ * weechat_string_free_split).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (or no argument: arrays are NULL)
+ */
+
+int
+irc_message_split_args (const char *message, int strip_right_eol,
+                        int *argc, char ***argv, char ***argv_eol)
+{
+    const char *ptr_msg, *ptr_end, *ptr_end_words;
+    char *ptr_string, **array_argv, **array_argv_eol;
+    int count, length, length_eol, i;
+
+    *argc = 0;
+    *argv = NULL;
+    *argv_eol = NULL;
+
+    if (!message)
+        return 0;
+
+    ptr_msg = message;
+    while (ptr_msg[0] == ' ')
+    {
+        ptr_msg++;
+    }
+    if (!ptr_msg[0])
+        return 0;
+
+    /* end of message and end of last word (trailing spaces stripped) */
+    ptr_end = ptr_msg + strlen (ptr_msg);
+    ptr_end_words = ptr_end;
+    while ((ptr_end_words > ptr_msg) && (ptr_end_words[-1] == ' '))
+    {
+        ptr_end_words--;
+    }
+    length = ptr_end_words - ptr_msg;
+    length_eol = (strip_right_eol) ? length : ptr_end - ptr_msg;
+
+    /* count words */
+    count = 1;
+    for (i = 0; i < length; i++)
+    {
+        if ((ptr_msg[i] == ' ') && (ptr_msg[i + 1] != ' '))
+            count++;
+    }
+
+    array_argv = malloc (((count + 1) * sizeof (*array_argv)) + length + 1);
+    if (!array_argv)
+        return 0;
+    array_argv_eol = malloc (((count + 1) * sizeof (*array_argv_eol)) +
+                             length_eol + 1);
+    if (!array_argv_eol)
+    {
+        free (array_argv);
+        return 0;
+    }
+
+    /* argv: words separated by '\0' */
+    ptr_string = (char *)(array_argv + count + 1);
+    memcpy (ptr_string, ptr_msg, length);
+    ptr_string[length] = '\0';
+    count = 0;
+    for (i = 0; i < length; i++)
+    {
+        if (ptr_string[i] == ' ')
+        {
+            ptr_string[i] = '\0';
+        }
+        else if ((i == 0) || (ptr_string[i - 1] == '\0'))
+        {
+            array_argv[count] = ptr_string + i;
+            count++;
+        }
+    }
+    array_argv[count] = NULL;
+
+    /* argv_eol: each item points to the same string */
+    ptr_string = (char *)(array_argv_eol + count + 1);
+    memcpy (ptr_string, ptr_msg, length_eol);
+    ptr_string[length_eol] = '\0';
+    for (i = 0; i < count; i++)
+    {
+        array_argv_eol[i] = ptr_string + (array_argv[i] - array_argv[0]);
+    }
+    array_argv_eol[count] = NULL;
+
+    *argc = count;
+    *argv = array_argv;
+    *argv_eol = array_argv_eol;
+
+    return 1;
+}
+
 /*
  * Replaces special IRC vars ($nick, $channel, $server) in a string.
  *
@@ -37,6 +37,9 @@ extern char *irc_message_convert_charset (const char *message,
                                           const char *modifier_data);
 extern const char *irc_message_get_nick_from_host (const char *host);
 extern const char *irc_message_get_address_from_host (const char *host);
+extern int irc_message_split_args (const char *message, int strip_right_eol,
+                                   int *argc, char ***argv,
+                                   char ***argv_eol);
 extern char *irc_message_replace_vars (struct t_irc_server *server,
                                        const char *channel_name,
                                        const char *string);
@@ -61,6 +61,112 @@ irc_nick_valid (struct t_irc_channel *channel, struct t_irc_nick *nick)
     return 0;
 }
 
+/*
+ * Builds the key of a nick in the index of nicks: the nick converted to lower
+ * case using the server casemapping.
+ *
+ * The key is built in "buffer" if it is large enough, otherwise it is
+ * allocated (then it must be freed after use if it is different from
+ * "buffer").
+ *
+ * Returns pointer to key, NULL if error.
+ */
+
+char *
+irc_nick_index_key (struct t_irc_server *server, const char *nickname,
+                    char *buffer, int size)
+{
+    char *key;
+    int length;
+
+    length = strlen (nickname);
+    if (length < size)
+    {
+        memcpy (buffer, nickname, length + 1);
+        key = buffer;
+    }
+    else
+    {
+        key = strdup (nickname);
+        if (!key)
+            return NULL;
+    }
+
+    irc_server_tolower (server, key);
+
+    return key;
+}
+
+/*
+ * Adds a nick in the index of nicks.
+ */
+
+void
+irc_nick_index_add (struct t_irc_server *server, struct t_irc_channel *channel,
+                    struct t_irc_nick *nick)
+{
+    char buffer[IRC_NICK_INDEX_KEY_SIZE], *key;
+
+    if (!channel->nicks_index || !nick->name)
+        return;
+
+    key = irc_nick_index_key (server, nick->name, buffer, sizeof (buffer));
+    if (!key)
+        return;
+
+    weechat_hashtable_set (channel->nicks_index, key, nick);
+
+    if (key != buffer)
+        free (key);
+}
+
+/*
+ * Removes a nick from the index of nicks.
+ */
+
+void
+irc_nick_index_remove (struct t_irc_server *server,
+                       struct t_irc_channel *channel,
+                       struct t_irc_nick *nick)
+{
+    char buffer[IRC_NICK_INDEX_KEY_SIZE], *key;
+
+    if (!channel->nicks_index || !nick->name)
+        return;
+
+    key = irc_nick_index_key (server, nick->name, buffer, sizeof (buffer));
+    if (!key)
+        return;
+
+    if (weechat_hashtable_get (channel->nicks_index, key) == nick)
+        weechat_hashtable_remove (channel->nicks_index, key);
+
+    if (key != buffer)
+        free (key);
+}
+
+/*
+ * Rebuilds the index of nicks in a channel (called when the server
+ * casemapping has changed).
+ */
+
+void
+irc_nick_index_rebuild (struct t_irc_server *server,
+                        struct t_irc_channel *channel)
+{
+    struct t_irc_nick *ptr_nick;
+
+    if (!channel || !channel->nicks_index)
+        return;
+
+    weechat_hashtable_remove_all (channel->nicks_index);
+
+    for (ptr_nick = channel->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        irc_nick_index_add (server, channel, ptr_nick);
+    }
+}
+
 /*
  * Checks if string is a valid nick string (RFC 1459).
  *
@@ -566,6 +672,8 @@ irc_nick_new (struct t_irc_server *server, struct t_irc_channel *channel,
     channel->last_nick = new_nick;
     new_nick->next_nick = NULL;
 
+    irc_nick_index_add (server, channel, new_nick);
+
     channel->nicks_count++;
 
     channel->nick_completion_reset = 1;
@@ -596,9 +704,11 @@ irc_nick_change (struct t_irc_server *server, struct t_irc_channel *channel,
         irc_channel_nick_speaking_rename (channel, nick->name, new_nick);
 
     /* change nickname */
+    irc_nick_index_remove (server, channel, nick);
     if (nick->name)
         free (nick->name);
     nick->name = strdup (new_nick);
+    irc_nick_index_add (server, channel, nick);
     if (nick->color)
         free (nick->color);
     if (nick_is_me)
@@ -660,6 +770,7 @@ irc_nick_free (struct t_irc_server *server, struct t_irc_channel *channel,
     irc_nick_nicklist_remove (server, channel, nick);
 
     /* remove nick */
+    irc_nick_index_remove (server, channel, nick);
     if (channel->last_nick == nick)
         channel->last_nick = nick->prev_nick;
     if (nick->prev_nick)
@@ -707,15 +818,25 @@ irc_nick_free_all (struct t_irc_server *server, struct t_irc_channel *channel)
     if (!channel)
         return;
 
+    /* end bulk mode started by names (if message 366 was not received) */
+    if (server && (server->nicklist_bulk_channel == channel))
+        irc_channel_nicklist_bulk_end (server);
+
+    /*
+     * remove all nicks and groups in nicklist, in bulk mode (no nicklist
+     * signal for each nick); the nicklist is cleared first so that each
+     * nick removed below is not searched in nicklist
+     */
+    weechat_buffer_set (channel->buffer, "nicklist_bulk", "1");
+    weechat_nicklist_remove_all (channel->buffer);
+    weechat_buffer_set (channel->buffer, "nicklist_bulk", "0");
+
     /* remove all nicks for the channel */
     while (channel->nicks)
     {
         irc_nick_free (server, channel, channel->nicks);
     }
 
-    /* remove all groups in nicklist */
-    weechat_nicklist_remove_all (channel->buffer);
-
     /* should be zero, but prevent any bug :D */
     channel->nicks_count = 0;
 }
@@ -731,10 +852,23 @@ irc_nick_search (struct t_irc_server *server, struct t_irc_channel *channel,
                  const char *nickname)
 {
     struct t_irc_nick *ptr_nick;
+    char buffer[IRC_NICK_INDEX_KEY_SIZE], *key;
 
     if (!channel || !nickname)
         return NULL;
 
+    if (channel->nicks_index)
+    {
+        key = irc_nick_index_key (server, nickname, buffer, sizeof (buffer));
+        if (key)
+        {
+            ptr_nick = weechat_hashtable_get (channel->nicks_index, key);
+            if (key != buffer)
+                free (key);
+            return ptr_nick;
+        }
+    }
+
     for (ptr_nick = channel->nicks; ptr_nick;
          ptr_nick = ptr_nick->next_nick)
     {
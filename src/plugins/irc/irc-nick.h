@@ -27,6 +27,9 @@
 #define IRC_NICK_GROUP_OTHER_NUMBER 999
 #define IRC_NICK_GROUP_OTHER_NAME   "..."
 
+/* max size of nick index key built without allocation */
+#define IRC_NICK_INDEX_KEY_SIZE 128
+
 struct t_irc_server;
 struct t_irc_channel;
 
@@ -79,6 +82,8 @@ extern void irc_nick_free (struct t_irc_server *server,
                            struct t_irc_nick *nick);
 extern void irc_nick_free_all (struct t_irc_server *server,
                                struct t_irc_channel *channel);
+extern void irc_nick_index_rebuild (struct t_irc_server *server,
+                                    struct t_irc_channel *channel);
 extern struct t_irc_nick *irc_nick_search (struct t_irc_server *server,
                                            struct t_irc_channel *channel,
                                            const char *nickname);
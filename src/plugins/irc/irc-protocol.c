@@ -2924,6 +2924,7 @@ IRC_PROTOCOL_CALLBACK(005)
     char *pos, *pos2, *pos_start, *error, *isupport2;
     int length_isupport, length, casemapping;
     long value;
+    struct t_irc_channel *ptr_channel;
 
     IRC_PROTOCOL_MIN_ARGS(4);
 
@@ -3001,8 +3002,15 @@ IRC_PROTOCOL_CALLBACK(005)
         if (pos2)
             pos2[0] = '\0';
         casemapping = irc_server_search_casemapping (pos);
-        if (casemapping >= 0)
+        if ((casemapping >= 0) && (casemapping != server->casemapping))
+        {
             server->casemapping = casemapping;
+            for (ptr_channel = server->channels; ptr_channel;
+                 ptr_channel = ptr_channel->next_channel)
+            {
+                irc_nick_index_rebuild (server, ptr_channel);
+            }
+        }
         if (pos2)
             pos2[0] = ' ';
     }
@@ -4778,8 +4786,8 @@ IRC_PROTOCOL_CALLBACK(352)
 IRC_PROTOCOL_CALLBACK(353)
 {
     char *pos_channel, *pos_nick, *pos_nick_orig, *pos_host, *nickname;
-    char *prefixes, *str_nicks, *color;
-    int args, i, length;
+    char *prefixes, **str_nicks, *color;
+    int args, i;
     struct t_irc_channel *ptr_channel;
 
     IRC_PROTOCOL_MIN_ARGS(5);
@@ -4800,21 +4808,20 @@ IRC_PROTOCOL_CALLBACK(353)
     ptr_channel = irc_channel_search (server, pos_channel);
     str_nicks = NULL;
 
+    /*
+     * for a channel with buffer, nicks are added in nicklist in bulk mode
+     * until the end of names (message 366): nicks are sorted only once and
+     * a single nicklist signal is sent
+     */
+    if (ptr_channel && ptr_channel->nicks)
+        irc_channel_nicklist_bulk_start (server, ptr_channel);
+
     /*
      * for a channel without buffer, prepare a string that will be built
-     * with nicks and colors (argc - args is the number of nicks)
+     * with nicks and colors
      */
     if (!ptr_channel)
-    {
-        /*
-         * prefix color (16) + nick color (16) + reset color (16) = 48 bytes
-         * added for each nick
-         */
-        length = strlen (argv_eol[args]) + ((argc - args) * (16 + 16 + 16)) + 1;
-        str_nicks = malloc (length);
-        if (str_nicks)
-            str_nicks[0] = '\0';
-    }
+        str_nicks = weechat_string_dyn_alloc (strlen (argv_eol[args]) + 1);
 
     for (i = args; i < argc; i++)
     {
@@ -4857,34 +4864,38 @@ IRC_PROTOCOL_CALLBACK(353)
             }
             else if (!ptr_channel && str_nicks)
             {
-                if (str_nicks[0])
+                if ((*str_nicks)[0])
                 {
-                    strcat (str_nicks, IRC_COLOR_RESET);
-                    strcat (str_nicks, " ");
+                    weechat_string_dyn_concat (str_nicks, IRC_COLOR_RESET);
+                    weechat_string_dyn_concat (str_nicks, " ");
                 }
                 if (prefixes)
                 {
-                    strcat (str_nicks,
-                            weechat_color (
-                                irc_nick_get_prefix_color_name (server,
-                                                                prefixes[0])));
-                    strcat (str_nicks, prefixes);
+                    weechat_string_dyn_concat (
+                        str_nicks,
+                        weechat_color (
+                            irc_nick_get_prefix_color_name (server,
+                                                            prefixes[0])));
+                    weechat_string_dyn_concat (str_nicks, prefixes);
                 }
                 if (weechat_config_boolean (irc_config_look_color_nicks_in_names))
                 {
                     if (irc_server_strcasecmp (server, nickname, server->nick) == 0)
-                        strcat (str_nicks, IRC_COLOR_CHAT_NICK_SELF);
+                    {
+                        weechat_string_dyn_concat (str_nicks,
+                                                   IRC_COLOR_CHAT_NICK_SELF);
+                    }
                     else
                     {
                         color = irc_nick_find_color (nickname);
-                        strcat (str_nicks, color);
+                        weechat_string_dyn_concat (str_nicks, color);
                         if (color)
                             free (color);
                     }
                 }
                 else
-                    strcat (str_nicks, IRC_COLOR_RESET);
-                strcat (str_nicks, nickname);
+                    weechat_string_dyn_concat (str_nicks, IRC_COLOR_RESET);
+                weechat_string_dyn_concat (str_nicks, nickname);
             }
             free (nickname);
         }
@@ -4906,12 +4917,12 @@ IRC_PROTOCOL_CALLBACK(353)
             IRC_COLOR_RESET,
             IRC_COLOR_CHAT_DELIMITERS,
             IRC_COLOR_RESET,
-            (str_nicks) ? str_nicks : "",
+            (str_nicks) ? *str_nicks : "",
             IRC_COLOR_CHAT_DELIMITERS);
     }
 
     if (str_nicks)
-        free (str_nicks);
+        weechat_string_dyn_free (str_nicks, 1);
 
     return WEECHAT_RC_OK;
 }
@@ -5071,12 +5082,16 @@ IRC_PROTOCOL_CALLBACK(366)
     struct t_infolist *infolist;
     struct t_config_option *ptr_option;
     int num_nicks, num_op, num_halfop, num_voice, num_normal, length, i;
-    char *string, str_nicks_count[2048], *color;
+    char **str_nicks, str_nicks_count[2048], *color;
     const char *prefix, *prefix_color, *nickname;
 
     IRC_PROTOCOL_MIN_ARGS(5);
 
     ptr_channel = irc_channel_search (server, argv[3]);
+
+    /* end of bulk mode in nicklist: sort nicks received in 353 messages */
+    irc_channel_nicklist_bulk_end (server);
+
     if (ptr_channel && ptr_channel->nicks)
     {
         /* display users on channel */
@@ -5086,77 +5101,72 @@ IRC_PROTOCOL_CALLBACK(366)
             infolist = weechat_infolist_get ("nicklist", ptr_channel->buffer, NULL);
             if (infolist)
             {
-                length = 0;
-                while (weechat_infolist_next (infolist))
-                {
-                    if (strcmp (weechat_infolist_string (infolist, "type"),
-                                "nick") == 0)
-                    {
-                        ptr_option = weechat_config_get (weechat_infolist_string (infolist,
-                                                                                  "prefix_color"));
-                        length +=
-                            ((ptr_option) ? strlen (weechat_color (weechat_config_string (ptr_option))) : 0) +
-                            strlen (weechat_infolist_string (infolist, "prefix")) +
-                            16 + /* nick color */
-                            strlen (weechat_infolist_string (infolist, "name")) +
-                            16 + /* reset color */
-                            1; /* space */
-                    }
-                }
-                if (length > 0)
+                str_nicks = weechat_string_dyn_alloc (1024);
+                if (str_nicks)
                 {
-                    string = malloc (length);
-                    if (string)
+                    i = 0;
+                    while (weechat_infolist_next (infolist))
                     {
-                        string[0] = '\0';
-                        i = 0;
-                        while (weechat_infolist_next (infolist))
+                        if (strcmp (weechat_infolist_string (infolist, "type"),
+                                    "nick") != 0)
+                        {
+                            continue;
+                        }
+                        if (i > 0)
                         {
-                            if (strcmp (weechat_infolist_string (infolist, "type"),
-                                        "nick") == 0)
+                            weechat_string_dyn_concat (str_nicks,
+                                                       IRC_COLOR_RESET);
+                            weechat_string_dyn_concat (str_nicks, " ");
+                        }
+                        prefix = weechat_infolist_string (infolist, "prefix");
+                        if (prefix[0] && (prefix[0] != ' '))
+                        {
+                            prefix_color = weechat_infolist_string (infolist,
+                                                                    "prefix_color");
+                            if (strchr (prefix_color, '.'))
                             {
-                                if (i > 0)
-                                {
-                                    strcat (string, IRC_COLOR_RESET);
-                                    strcat (string, " ");
-                                }
-                                prefix = weechat_infolist_string (infolist, "prefix");
-                                if (prefix[0] && (prefix[0] != ' '))
+                                ptr_option = weechat_config_get (prefix_color);
+                                if (ptr_option)
                                 {
-                                    prefix_color = weechat_infolist_string (infolist,
-                                                                            "prefix_color");
-                                    if (strchr (prefix_color, '.'))
-                                    {
-                                        ptr_option = weechat_config_get (weechat_infolist_string (infolist,
-                                                                                                  "prefix_color"));
-                                        if (ptr_option)
-                                            strcat (string, weechat_color (weechat_config_string (ptr_option)));
-                                    }
-                                    else
-                                    {
-                                        strcat (string, weechat_color (prefix_color));
-                                    }
-                                    strcat (string, prefix);
+                                    weechat_string_dyn_concat (
+                                        str_nicks,
+                                        weechat_color (
+                                            weechat_config_string (ptr_option)));
                                 }
-                                nickname = weechat_infolist_string (infolist, "name");
-                                if (weechat_config_boolean (irc_config_look_color_nicks_in_names))
-                                {
-                                    if (irc_server_strcasecmp (server, nickname, server->nick) == 0)
-                                        strcat (string, IRC_COLOR_CHAT_NICK_SELF);
-                                    else
-                                    {
-                                        color = irc_nick_find_color (nickname);
-                                        strcat (string, color);
-                                        if (color)
-                                            free (color);
-                                    }
-                                }
-                                else
-                                    strcat (string, IRC_COLOR_RESET);
-                                strcat (string, nickname);
-                                i++;
                             }
+                            else
+                            {
+                                weechat_string_dyn_concat (
+                                    str_nicks, weechat_color (prefix_color));
+                            }
+                            weechat_string_dyn_concat (str_nicks, prefix);
+                        }
+                        nickname = weechat_infolist_string (infolist, "name");
+                        if (weechat_config_boolean (irc_config_look_color_nicks_in_names))
+                        {
+                            if (irc_server_strcasecmp (server, nickname, server->nick) == 0)
+                            {
+                                weechat_string_dyn_concat (
+                                    str_nicks, IRC_COLOR_CHAT_NICK_SELF);
+                            }
+                            else
+                            {
+                                color = irc_nick_find_color (nickname);
+                                weechat_string_dyn_concat (str_nicks, color);
+                                if (color)
+                                    free (color);
+                            }
+                        }
+                        else
+                        {
+                            weechat_string_dyn_concat (str_nicks,
+                                                       IRC_COLOR_RESET);
                         }
+                        weechat_string_dyn_concat (str_nicks, nickname);
+                        i++;
+                    }
+                    if (i > 0)
+                    {
                         weechat_printf_date_tags (
                             irc_msgbuffer_get_target_buffer (
                                 server, NULL, command, "names",
@@ -5170,10 +5180,10 @@ IRC_PROTOCOL_CALLBACK(366)
                             ptr_channel->name,
                             IRC_COLOR_RESET,
                             IRC_COLOR_CHAT_DELIMITERS,
-                            string,
+                            *str_nicks,
                             IRC_COLOR_CHAT_DELIMITERS);
-                        free (string);
                     }
+                    weechat_string_dyn_free (str_nicks, 1);
                 }
                 weechat_infolist_free (infolist);
             }
@@ -6337,6 +6347,341 @@ irc_protocol_parse_time (const char *time)
     return time_value;
 }
 
+/* IRC messages handled by IRC plugin */
+struct t_irc_protocol_msg irc_protocol_messages[] =
+    { { "account", /* account (cap account-notify) */ 1, 0, &irc_protocol_cb_account },
+      { "authenticate", /* authenticate */ 1, 0, &irc_protocol_cb_authenticate },
+      { "away", /* away (cap away-notify) */ 1, 0, &irc_protocol_cb_away },
+      { "cap", /* client capability */ 1, 0, &irc_protocol_cb_cap },
+      { "chghost", /* user/host change (cap chghost) */ 1, 0, &irc_protocol_cb_chghost },
+      { "error", /* error received from IRC server */ 1, 0, &irc_protocol_cb_error },
+      { "invite", /* invite a nick on a channel */ 1, 0, &irc_protocol_cb_invite },
+      { "join", /* join a channel */ 1, 0, &irc_protocol_cb_join },
+      { "kick", /* forcibly remove a user from a channel */ 1, 1, &irc_protocol_cb_kick },
+      { "kill", /* close client-server connection */ 1, 1, &irc_protocol_cb_kill },
+      { "mode", /* change channel or user mode */ 1, 0, &irc_protocol_cb_mode },
+      { "nick", /* change current nickname */ 1, 0, &irc_protocol_cb_nick },
+      { "notice", /* send notice message to user */ 1, 1, &irc_protocol_cb_notice },
+      { "part", /* leave a channel */ 1, 1, &irc_protocol_cb_part },
+      { "ping", /* ping server */ 1, 0, &irc_protocol_cb_ping },
+      { "pong", /* answer to a ping message */ 1, 0, &irc_protocol_cb_pong },
+      { "privmsg", /* message received */ 1, 1, &irc_protocol_cb_privmsg },
+      { "quit", /* close all connections and quit */ 1, 1, &irc_protocol_cb_quit },
+      { "topic", /* get/set channel topic */ 0, 1, &irc_protocol_cb_topic },
+      { "wallops", /* send a message to all currently connected users who have "
+                      "set the 'w' user mode "
+                      "for themselves */ 1, 1, &irc_protocol_cb_wallops },
+      { "001", /* a server message */ 1, 0, &irc_protocol_cb_001 },
+      { "005", /* a server message */ 1, 0, &irc_protocol_cb_005 },
+      { "008", /* server notice mask */ 1, 0, &irc_protocol_cb_008 },
+      { "221", /* user mode string */ 1, 0, &irc_protocol_cb_221 },
+      { "223", /* whois (charset is) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "264", /* whois (is using encrypted connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "275", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "276", /* whois (has client certificate fingerprint) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "301", /* away message */ 1, 1, &irc_protocol_cb_301 },
+      { "303", /* ison */ 1, 0, &irc_protocol_cb_303 },
+      { "305", /* unaway */ 1, 0, &irc_protocol_cb_305 },
+      { "306", /* now away */ 1, 0, &irc_protocol_cb_306 },
+      { "307", /* whois (registered nick) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "310", /* whois (help mode) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "311", /* whois (user) */ 1, 0, &irc_protocol_cb_311 },
+      { "312", /* whois (server) */ 1, 0, &irc_protocol_cb_312 },
+      { "313", /* whois (operator) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "314", /* whowas */ 1, 0, &irc_protocol_cb_314 },
+      { "315", /* end of /who list */ 1, 0, &irc_protocol_cb_315 },
+      { "317", /* whois (idle) */ 1, 0, &irc_protocol_cb_317 },
+      { "318", /* whois (end) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "319", /* whois (channels) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "320", /* whois (identified user) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "321", /* /list start */ 1, 0, &irc_protocol_cb_321 },
+      { "322", /* channel (for /list) */ 1, 0, &irc_protocol_cb_322 },
+      { "323", /* end of /list */ 1, 0, &irc_protocol_cb_323 },
+      { "324", /* channel mode */ 1, 0, &irc_protocol_cb_324 },
+      { "326", /* whois (has oper privs) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "327", /* whois (host) */ 1, 0, &irc_protocol_cb_327 },
+      { "328", /* channel url */ 1, 0, &irc_protocol_cb_328 },
+      { "329", /* channel creation date */ 1, 0, &irc_protocol_cb_329 },
+      { "330", /* is logged in as */ 1, 0, &irc_protocol_cb_330_343 },
+      { "331", /* no topic for channel */ 1, 0, &irc_protocol_cb_331 },
+      { "332", /* topic of channel */ 0, 1, &irc_protocol_cb_332 },
+      { "333", /* infos about topic (nick and date changed) */ 1, 0, &irc_protocol_cb_333 },
+      { "335", /* is a bot on */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "338", /* whois (host) */ 1, 0, &irc_protocol_cb_338 },
+      { "341", /* inviting */ 1, 0, &irc_protocol_cb_341 },
+      { "343", /* is opered as */ 1, 0, &irc_protocol_cb_330_343 },
+      { "344", /* channel reop */ 1, 0, &irc_protocol_cb_344 },
+      { "345", /* end of channel reop list */ 1, 0, &irc_protocol_cb_345 },
+      { "346", /* invite list */ 1, 0, &irc_protocol_cb_346 },
+      { "347", /* end of invite list */ 1, 0, &irc_protocol_cb_347 },
+      { "348", /* channel exception list */ 1, 0, &irc_protocol_cb_348 },
+      { "349", /* end of channel exception list */ 1, 0, &irc_protocol_cb_349 },
+      { "351", /* server version */ 1, 0, &irc_protocol_cb_351 },
+      { "352", /* who */ 1, 0, &irc_protocol_cb_352 },
+      { "353", /* list of nicks on channel */ 1, 0, &irc_protocol_cb_353 },
+      { "354", /* whox */ 1, 0, &irc_protocol_cb_354 },
+      { "366", /* end of /names list */ 1, 0, &irc_protocol_cb_366 },
+      { "367", /* banlist */ 1, 0, &irc_protocol_cb_367 },
+      { "368", /* end of banlist */ 1, 0, &irc_protocol_cb_368 },
+      { "369", /* whowas (end) */ 1, 0, &irc_protocol_cb_whowas_nick_msg },
+      { "378", /* whois (connecting from) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "379", /* whois (using modes) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "401", /* no such nick/channel */ 1, 0, &irc_protocol_cb_generic_error },
+      { "402", /* no such server */ 1, 0, &irc_protocol_cb_generic_error },
+      { "403", /* no such channel */ 1, 0, &irc_protocol_cb_generic_error },
+      { "404", /* cannot send to channel */ 1, 0, &irc_protocol_cb_generic_error },
+      { "405", /* too many channels */ 1, 0, &irc_protocol_cb_generic_error },
+      { "406", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
+      { "407", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
+      { "409", /* no origin */ 1, 0, &irc_protocol_cb_generic_error },
+      { "410", /* no services */ 1, 0, &irc_protocol_cb_generic_error },
+      { "411", /* no recipient */ 1, 0, &irc_protocol_cb_generic_error },
+      { "412", /* no text to send */ 1, 0, &irc_protocol_cb_generic_error },
+      { "413", /* no toplevel */ 1, 0, &irc_protocol_cb_generic_error },
+      { "414", /* wilcard in toplevel domain */ 1, 0, &irc_protocol_cb_generic_error },
+      { "421", /* unknown command */ 1, 0, &irc_protocol_cb_generic_error },
+      { "422", /* MOTD is missing */ 1, 0, &irc_protocol_cb_generic_error },
+      { "423", /* no administrative info */ 1, 0, &irc_protocol_cb_generic_error },
+      { "424", /* file error */ 1, 0, &irc_protocol_cb_generic_error },
+      { "431", /* no nickname given */ 1, 0, &irc_protocol_cb_generic_error },
+      { "432", /* erroneous nickname */ 1, 0, &irc_protocol_cb_432 },
+      { "433", /* nickname already in use */ 1, 0, &irc_protocol_cb_433 },
+      { "436", /* nickname collision */ 1, 0, &irc_protocol_cb_generic_error },
+      { "437", /* nick/channel unavailable */ 1, 0, &irc_protocol_cb_437 },
+      { "438", /* not authorized to change nickname */ 1, 0, &irc_protocol_cb_438 },
+      { "441", /* user not in channel */ 1, 0, &irc_protocol_cb_generic_error },
+      { "442", /* not on channel */ 1, 0, &irc_protocol_cb_generic_error },
+      { "443", /* user already on channel */ 1, 0, &irc_protocol_cb_generic_error },
+      { "444", /* user not logged in */ 1, 0, &irc_protocol_cb_generic_error },
+      { "445", /* summon has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
+      { "446", /* users has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
+      { "451", /* you are not registered */ 1, 0, &irc_protocol_cb_generic_error },
+      { "461", /* not enough parameters */ 1, 0, &irc_protocol_cb_generic_error },
+      { "462", /* you may not register */ 1, 0, &irc_protocol_cb_generic_error },
+      { "463", /* your host isn't among the privileged */ 1, 0, &irc_protocol_cb_generic_error },
+      { "464", /* password incorrect */ 1, 0, &irc_protocol_cb_generic_error },
+      { "465", /* you are banned from this server */ 1, 0, &irc_protocol_cb_generic_error },
+      { "467", /* channel key already set */ 1, 0, &irc_protocol_cb_generic_error },
+      { "470", /* forwarding to another channel */ 1, 0, &irc_protocol_cb_470 },
+      { "471", /* channel is already full */ 1, 0, &irc_protocol_cb_generic_error },
+      { "472", /* unknown mode char to me */ 1, 0, &irc_protocol_cb_generic_error },
+      { "473", /* cannot join channel (invite only) */ 1, 0, &irc_protocol_cb_generic_error },
+      { "474", /* cannot join channel (banned from channel) */ 1, 0, &irc_protocol_cb_generic_error },
+      { "475", /* cannot join channel (bad channel key) */ 1, 0, &irc_protocol_cb_generic_error },
+      { "476", /* bad channel mask */ 1, 0, &irc_protocol_cb_generic_error },
+      { "477", /* channel doesn't support modes */ 1, 0, &irc_protocol_cb_generic_error },
+      { "481", /* you're not an IRC operator */ 1, 0, &irc_protocol_cb_generic_error },
+      { "482", /* you're not channel operator */ 1, 0, &irc_protocol_cb_generic_error },
+      { "483", /* you can't kill a server! */ 1, 0, &irc_protocol_cb_generic_error },
+      { "484", /* your connection is restricted! */ 1, 0, &irc_protocol_cb_generic_error },
+      { "485", /* user is immune from kick/deop */ 1, 0, &irc_protocol_cb_generic_error },
+      { "487", /* network split */ 1, 0, &irc_protocol_cb_generic_error },
+      { "491", /* no O-lines for your host */ 1, 0, &irc_protocol_cb_generic_error },
+      { "501", /* unknown mode flag */ 1, 0, &irc_protocol_cb_generic_error },
+      { "502", /* can't change mode for other users */ 1, 0, &irc_protocol_cb_generic_error },
+      { "671", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+      { "728", /* quietlist */ 1, 0, &irc_protocol_cb_728 },
+      { "729", /* end of quietlist */ 1, 0, &irc_protocol_cb_729 },
+      { "730", /* monitored nicks online */ 1, 0, &irc_protocol_cb_730 },
+      { "731", /* monitored nicks offline */ 1, 0, &irc_protocol_cb_731 },
+      { "732", /* list of monitored nicks */ 1, 0, &irc_protocol_cb_732 },
+      { "733", /* end of monitor list */ 1, 0, &irc_protocol_cb_733 },
+      { "734", /* monitor list is full */ 1, 0, &irc_protocol_cb_734 },
+      { "900", /* logged in as (SASL) */ 1, 0, &irc_protocol_cb_900 },
+      { "901", /* you are now logged in */ 1, 0, &irc_protocol_cb_901 },
+      { "902", /* SASL authentication failed (account locked/held) */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+      { "903", /* SASL authentication successful */ 1, 0, &irc_protocol_cb_sasl_end_ok },
+      { "904", /* SASL authentication failed */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+      { "905", /* SASL message too long */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+      { "906", /* SASL authentication aborted */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+      { "907", /* You have already completed SASL authentication */ 1, 0, &irc_protocol_cb_sasl_end_ok },
+      { "936", /* censored word */ 1, 0, &irc_protocol_cb_generic_error },
+      { "973", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+      { "974", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+      { "975", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+      { NULL, 0, 0, NULL }
+    };
+
+/* dispatch of messages: index of numeric commands and hash of other commands */
+int irc_protocol_messages_indexed = 0;
+struct t_irc_protocol_msg *irc_protocol_messages_numeric[IRC_PROTOCOL_NUMERIC_MAX + 1];
+struct t_irc_protocol_msg **irc_protocol_messages_hash = NULL;
+unsigned int irc_protocol_messages_hash_size = 0;
+
+
+/*
+ * Computes hash of an IRC command (case insensitive) for table
+ * "irc_protocol_messages_hash".
+ */
+
+unsigned int
+irc_protocol_hash_command (const char *command)
+{
+    unsigned int hash;
+
+    hash = 5381;
+    while (command[0])
+    {
+        hash = ((hash << 5) + hash)
+            + (unsigned char)tolower ((unsigned char)command[0]);
+        command++;
+    }
+
+    return hash & (irc_protocol_messages_hash_size - 1);
+}
+
+/*
+ * Checks if an IRC command is numeric (exactly 3 digits).
+ *
+ * Returns:
+ *   1: command is numeric
+ *   0: command is not numeric
+ */
+
+int
+irc_protocol_is_numeric_3_digits (const char *command)
+{
+    return (isdigit ((unsigned char)command[0])
+            && isdigit ((unsigned char)command[1])
+            && isdigit ((unsigned char)command[2])
+            && !command[3]) ? 1 : 0;
+}
+
+/*
+ * Builds the dispatch tables of IRC messages: numeric commands (3 digits)
+ * are indexed by their value, other commands are stored in a hash table
+ * (open addressing), sized to be at most half full.
+ *
+ * This is done only once, the first time a message is searched.
+ */
+
+void
+irc_protocol_index_messages ()
+{
+    int i, numeric, count;
+    unsigned int hash, size;
+    const char *name;
+
+    memset (irc_protocol_messages_numeric, 0,
+            sizeof (irc_protocol_messages_numeric));
+
+    /* size of hash table: power of 2, at least twice the number of commands */
+    count = 0;
+    for (i = 0; irc_protocol_messages[i].name; i++)
+    {
+        if (!irc_protocol_is_numeric_3_digits (irc_protocol_messages[i].name))
+            count++;
+    }
+    size = IRC_PROTOCOL_HASH_MIN_SIZE;
+    while (size < (unsigned int)count * 2)
+    {
+        size *= 2;
+    }
+    if (irc_protocol_messages_hash)
+        free (irc_protocol_messages_hash);
+    irc_protocol_messages_hash = calloc (size,
+                                         sizeof (*irc_protocol_messages_hash));
+    irc_protocol_messages_hash_size = (irc_protocol_messages_hash) ? size : 0;
+
+    for (i = 0; irc_protocol_messages[i].name; i++)
+    {
+        name = irc_protocol_messages[i].name;
+        if (irc_protocol_is_numeric_3_digits (name))
+        {
+            numeric = ((name[0] - '0') * 100) + ((name[1] - '0') * 10)
+                + (name[2] - '0');
+            if (!irc_protocol_messages_numeric[numeric])
+                irc_protocol_messages_numeric[numeric] = &irc_protocol_messages[i];
+        }
+        else if (irc_protocol_messages_hash)
+        {
+            /* the table is never full, so a free slot is always found */
+            hash = irc_protocol_hash_command (name);
+            while (irc_protocol_messages_hash[hash])
+            {
+                hash = (hash + 1) & (irc_protocol_messages_hash_size - 1);
+            }
+            irc_protocol_messages_hash[hash] = &irc_protocol_messages[i];
+        }
+    }
+
+    irc_protocol_messages_indexed = 1;
+}
+
+/*
+ * Searches for an IRC message (case insensitive) in the list of messages
+ * handled by IRC plugin.
+ *
+ * Returns pointer to message found, NULL if not found.
+ */
+
+struct t_irc_protocol_msg *
+irc_protocol_search_message (const char *command)
+{
+    unsigned int hash, i;
+
+    if (!command || !command[0])
+        return NULL;
+
+    if (!irc_protocol_messages_indexed)
+        irc_protocol_index_messages ();
+
+    /* numeric command (3 digits): direct access by value */
+    if (irc_protocol_is_numeric_3_digits (command))
+    {
+        return irc_protocol_messages_numeric[
+            ((command[0] - '0') * 100) + ((command[1] - '0') * 10)
+            + (command[2] - '0')];
+    }
+
+    /* hash table not allocated: linear search of message */
+    if (!irc_protocol_messages_hash)
+    {
+        for (i = 0; irc_protocol_messages[i].name; i++)
+        {
+            if (weechat_strcasecmp (irc_protocol_messages[i].name,
+                                    command) == 0)
+            {
+                return &irc_protocol_messages[i];
+            }
+        }
+        return NULL;
+    }
+
+    /* other command: search in hash table (at most one cycle) */
+    hash = irc_protocol_hash_command (command);
+    for (i = 0; i < irc_protocol_messages_hash_size; i++)
+    {
+        if (!irc_protocol_messages_hash[hash])
+            break;
+        if (weechat_strcasecmp (irc_protocol_messages_hash[hash]->name,
+                                command) == 0)
+        {
+            return irc_protocol_messages_hash[hash];
+        }
+        hash = (hash + 1) & (irc_protocol_messages_hash_size - 1);
+    }
+
+    /* message not found */
+    return NULL;
+}
+
+/*
+ * Frees dispatch tables of IRC messages.
+ */
+
+void
+irc_protocol_end ()
+{
+    if (irc_protocol_messages_hash)
+    {
+        free (irc_protocol_messages_hash);
+        irc_protocol_messages_hash = NULL;
+    }
+    irc_protocol_messages_hash_size = 0;
+    irc_protocol_messages_indexed = 0;
+}
+
 /*
  * Executes action when an IRC message is received.
  *
@@ -6349,10 +6694,11 @@ irc_protocol_recv_command (struct t_irc_server *server,
                            const char *msg_command,
                            const char *msg_channel)
 {
-    int i, cmd_found, return_code, argc, decode_color, keep_trailing_spaces;
-    int message_ignored, flags;
+    int return_code, argc, decode_color, keep_trailing_spaces;
+    int message_ignored;
     char *message_colors_decoded, *pos_space, *tags;
     struct t_irc_channel *ptr_channel;
+    struct t_irc_protocol_msg *ptr_msg;
     t_irc_recv_func *cmd_recv_func;
     const char *cmd_name, *ptr_msg_after_tags;
     time_t date;
@@ -6360,159 +6706,6 @@ irc_protocol_recv_command (struct t_irc_server *server,
     char *nick, *address, *address_color, *host, *host_no_color, *host_color;
     char **argv, **argv_eol;
     struct t_hashtable *hash_tags;
-    struct t_irc_protocol_msg irc_protocol_messages[] =
-        { { "account", /* account (cap account-notify) */ 1, 0, &irc_protocol_cb_account },
-          { "authenticate", /* authenticate */ 1, 0, &irc_protocol_cb_authenticate },
-          { "away", /* away (cap away-notify) */ 1, 0, &irc_protocol_cb_away },
-          { "cap", /* client capability */ 1, 0, &irc_protocol_cb_cap },
-          { "chghost", /* user/host change (cap chghost) */ 1, 0, &irc_protocol_cb_chghost },
-          { "error", /* error received from IRC server */ 1, 0, &irc_protocol_cb_error },
-          { "invite", /* invite a nick on a channel */ 1, 0, &irc_protocol_cb_invite },
-          { "join", /* join a channel */ 1, 0, &irc_protocol_cb_join },
-          { "kick", /* forcibly remove a user from a channel */ 1, 1, &irc_protocol_cb_kick },
-          { "kill", /* close client-server connection */ 1, 1, &irc_protocol_cb_kill },
-          { "mode", /* change channel or user mode */ 1, 0, &irc_protocol_cb_mode },
-          { "nick", /* change current nickname */ 1, 0, &irc_protocol_cb_nick },
-          { "notice", /* send notice message to user */ 1, 1, &irc_protocol_cb_notice },
-          { "part", /* leave a channel */ 1, 1, &irc_protocol_cb_part },
-          { "ping", /* ping server */ 1, 0, &irc_protocol_cb_ping },
-          { "pong", /* answer to a ping message */ 1, 0, &irc_protocol_cb_pong },
-          { "privmsg", /* message received */ 1, 1, &irc_protocol_cb_privmsg },
-          { "quit", /* close all connections and quit */ 1, 1, &irc_protocol_cb_quit },
-          { "topic", /* get/set channel topic */ 0, 1, &irc_protocol_cb_topic },
-          { "wallops", /* send a message to all currently connected users who have "
-                          "set the 'w' user mode "
-                          "for themselves */ 1, 1, &irc_protocol_cb_wallops },
-          { "001", /* a server message */ 1, 0, &irc_protocol_cb_001 },
-          { "005", /* a server message */ 1, 0, &irc_protocol_cb_005 },
-          { "008", /* server notice mask */ 1, 0, &irc_protocol_cb_008 },
-          { "221", /* user mode string */ 1, 0, &irc_protocol_cb_221 },
-          { "223", /* whois (charset is) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "264", /* whois (is using encrypted connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "275", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "276", /* whois (has client certificate fingerprint) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "301", /* away message */ 1, 1, &irc_protocol_cb_301 },
-          { "303", /* ison */ 1, 0, &irc_protocol_cb_303 },
-          { "305", /* unaway */ 1, 0, &irc_protocol_cb_305 },
-          { "306", /* now away */ 1, 0, &irc_protocol_cb_306 },
-          { "307", /* whois (registered nick) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "310", /* whois (help mode) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "311", /* whois (user) */ 1, 0, &irc_protocol_cb_311 },
-          { "312", /* whois (server) */ 1, 0, &irc_protocol_cb_312 },
-          { "313", /* whois (operator) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "314", /* whowas */ 1, 0, &irc_protocol_cb_314 },
-          { "315", /* end of /who list */ 1, 0, &irc_protocol_cb_315 },
-          { "317", /* whois (idle) */ 1, 0, &irc_protocol_cb_317 },
-          { "318", /* whois (end) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "319", /* whois (channels) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "320", /* whois (identified user) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "321", /* /list start */ 1, 0, &irc_protocol_cb_321 },
-          { "322", /* channel (for /list) */ 1, 0, &irc_protocol_cb_322 },
-          { "323", /* end of /list */ 1, 0, &irc_protocol_cb_323 },
-          { "324", /* channel mode */ 1, 0, &irc_protocol_cb_324 },
-          { "326", /* whois (has oper privs) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "327", /* whois (host) */ 1, 0, &irc_protocol_cb_327 },
-          { "328", /* channel url */ 1, 0, &irc_protocol_cb_328 },
-          { "329", /* channel creation date */ 1, 0, &irc_protocol_cb_329 },
-          { "330", /* is logged in as */ 1, 0, &irc_protocol_cb_330_343 },
-          { "331", /* no topic for channel */ 1, 0, &irc_protocol_cb_331 },
-          { "332", /* topic of channel */ 0, 1, &irc_protocol_cb_332 },
-          { "333", /* infos about topic (nick and date changed) */ 1, 0, &irc_protocol_cb_333 },
-          { "335", /* is a bot on */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "338", /* whois (host) */ 1, 0, &irc_protocol_cb_338 },
-          { "341", /* inviting */ 1, 0, &irc_protocol_cb_341 },
-          { "343", /* is opered as */ 1, 0, &irc_protocol_cb_330_343 },
-          { "344", /* channel reop */ 1, 0, &irc_protocol_cb_344 },
-          { "345", /* end of channel reop list */ 1, 0, &irc_protocol_cb_345 },
-          { "346", /* invite list */ 1, 0, &irc_protocol_cb_346 },
-          { "347", /* end of invite list */ 1, 0, &irc_protocol_cb_347 },
-          { "348", /* channel exception list */ 1, 0, &irc_protocol_cb_348 },
-          { "349", /* end of channel exception list */ 1, 0, &irc_protocol_cb_349 },
-          { "351", /* server version */ 1, 0, &irc_protocol_cb_351 },
-          { "352", /* who */ 1, 0, &irc_protocol_cb_352 },
-          { "353", /* list of nicks on channel */ 1, 0, &irc_protocol_cb_353 },
-          { "354", /* whox */ 1, 0, &irc_protocol_cb_354 },
-          { "366", /* end of /names list */ 1, 0, &irc_protocol_cb_366 },
-          { "367", /* banlist */ 1, 0, &irc_protocol_cb_367 },
-          { "368", /* end of banlist */ 1, 0, &irc_protocol_cb_368 },
-          { "369", /* whowas (end) */ 1, 0, &irc_protocol_cb_whowas_nick_msg },
-          { "378", /* whois (connecting from) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "379", /* whois (using modes) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "401", /* no such nick/channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "402", /* no such server */ 1, 0, &irc_protocol_cb_generic_error },
-          { "403", /* no such channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "404", /* cannot send to channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "405", /* too many channels */ 1, 0, &irc_protocol_cb_generic_error },
-          { "406", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
-          { "407", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
-          { "409", /* no origin */ 1, 0, &irc_protocol_cb_generic_error },
-          { "410", /* no services */ 1, 0, &irc_protocol_cb_generic_error },
-          { "411", /* no recipient */ 1, 0, &irc_protocol_cb_generic_error },
-          { "412", /* no text to send */ 1, 0, &irc_protocol_cb_generic_error },
-          { "413", /* no toplevel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "414", /* wilcard in toplevel domain */ 1, 0, &irc_protocol_cb_generic_error },
-          { "421", /* unknown command */ 1, 0, &irc_protocol_cb_generic_error },
-          { "422", /* MOTD is missing */ 1, 0, &irc_protocol_cb_generic_error },
-          { "423", /* no administrative info */ 1, 0, &irc_protocol_cb_generic_error },
-          { "424", /* file error */ 1, 0, &irc_protocol_cb_generic_error },
-          { "431", /* no nickname given */ 1, 0, &irc_protocol_cb_generic_error },
-          { "432", /* erroneous nickname */ 1, 0, &irc_protocol_cb_432 },
-          { "433", /* nickname already in use */ 1, 0, &irc_protocol_cb_433 },
-          { "436", /* nickname collision */ 1, 0, &irc_protocol_cb_generic_error },
-          { "437", /* nick/channel unavailable */ 1, 0, &irc_protocol_cb_437 },
-          { "438", /* not authorized to change nickname */ 1, 0, &irc_protocol_cb_438 },
-          { "441", /* user not in channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "442", /* not on channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "443", /* user already on channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "444", /* user not logged in */ 1, 0, &irc_protocol_cb_generic_error },
-          { "445", /* summon has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
-          { "446", /* users has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
-          { "451", /* you are not registered */ 1, 0, &irc_protocol_cb_generic_error },
-          { "461", /* not enough parameters */ 1, 0, &irc_protocol_cb_generic_error },
-          { "462", /* you may not register */ 1, 0, &irc_protocol_cb_generic_error },
-          { "463", /* your host isn't among the privileged */ 1, 0, &irc_protocol_cb_generic_error },
-          { "464", /* password incorrect */ 1, 0, &irc_protocol_cb_generic_error },
-          { "465", /* you are banned from this server */ 1, 0, &irc_protocol_cb_generic_error },
-          { "467", /* channel key already set */ 1, 0, &irc_protocol_cb_generic_error },
-          { "470", /* forwarding to another channel */ 1, 0, &irc_protocol_cb_470 },
-          { "471", /* channel is already full */ 1, 0, &irc_protocol_cb_generic_error },
-          { "472", /* unknown mode char to me */ 1, 0, &irc_protocol_cb_generic_error },
-          { "473", /* cannot join channel (invite only) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "474", /* cannot join channel (banned from channel) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "475", /* cannot join channel (bad channel key) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "476", /* bad channel mask */ 1, 0, &irc_protocol_cb_generic_error },
-          { "477", /* channel doesn't support modes */ 1, 0, &irc_protocol_cb_generic_error },
-          { "481", /* you're not an IRC operator */ 1, 0, &irc_protocol_cb_generic_error },
-          { "482", /* you're not channel operator */ 1, 0, &irc_protocol_cb_generic_error },
-          { "483", /* you can't kill a server! */ 1, 0, &irc_protocol_cb_generic_error },
-          { "484", /* your connection is restricted! */ 1, 0, &irc_protocol_cb_generic_error },
-          { "485", /* user is immune from kick/deop */ 1, 0, &irc_protocol_cb_generic_error },
-          { "487", /* network split */ 1, 0, &irc_protocol_cb_generic_error },
-          { "491", /* no O-lines for your host */ 1, 0, &irc_protocol_cb_generic_error },
-          { "501", /* unknown mode flag */ 1, 0, &irc_protocol_cb_generic_error },
-          { "502", /* can't change mode for other users */ 1, 0, &irc_protocol_cb_generic_error },
-          { "671", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "728", /* quietlist */ 1, 0, &irc_protocol_cb_728 },
-          { "729", /* end of quietlist */ 1, 0, &irc_protocol_cb_729 },
-          { "730", /* monitored nicks online */ 1, 0, &irc_protocol_cb_730 },
-          { "731", /* monitored nicks offline */ 1, 0, &irc_protocol_cb_731 },
-          { "732", /* list of monitored nicks */ 1, 0, &irc_protocol_cb_732 },
-          { "733", /* end of monitor list */ 1, 0, &irc_protocol_cb_733 },
-          { "734", /* monitor list is full */ 1, 0, &irc_protocol_cb_734 },
-          { "900", /* logged in as (SASL) */ 1, 0, &irc_protocol_cb_900 },
-          { "901", /* you are now logged in */ 1, 0, &irc_protocol_cb_901 },
-          { "902", /* SASL authentication failed (account locked/held) */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "903", /* SASL authentication successful */ 1, 0, &irc_protocol_cb_sasl_end_ok },
-          { "904", /* SASL authentication failed */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "905", /* SASL message too long */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "906", /* SASL authentication aborted */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "907", /* You have already completed SASL authentication */ 1, 0, &irc_protocol_cb_sasl_end_ok },
-          { "936", /* censored word */ 1, 0, &irc_protocol_cb_generic_error },
-          { "973", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { "974", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { "975", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { NULL, 0, 0, NULL }
-        };
 
     if (!msg_command)
         return;
@@ -6604,20 +6797,19 @@ irc_protocol_recv_command (struct t_irc_server *server,
                                 irc_message, NULL);
     }
 
+    /*
+     * end bulk mode in nicklist on any message of this server other than
+     * names (353), so that the nicklist is sorted even if message 366 is
+     * never received (messages of other servers don't end it)
+     */
+    if (server->nicklist_bulk_channel && (strcmp (msg_command, "353") != 0))
+        irc_channel_nicklist_bulk_end (server);
+
     /* look for IRC command */
-    cmd_found = -1;
-    for (i = 0; irc_protocol_messages[i].name; i++)
-    {
-        if (weechat_strcasecmp (irc_protocol_messages[i].name,
-                                msg_command) == 0)
-        {
-            cmd_found = i;
-            break;
-        }
-    }
+    ptr_msg = irc_protocol_search_message (msg_command);
 
     /* command not found */
-    if (cmd_found < 0)
+    if (!ptr_msg)
     {
         /* for numeric commands, we use default recv function */
         if (irc_protocol_is_numeric_command (msg_command))
@@ -6641,41 +6833,30 @@ irc_protocol_recv_command (struct t_irc_server *server,
     }
     else
     {
-        cmd_name = irc_protocol_messages[cmd_found].name;
-        decode_color = irc_protocol_messages[cmd_found].decode_color;
-        keep_trailing_spaces = irc_protocol_messages[cmd_found].keep_trailing_spaces;
-        cmd_recv_func = irc_protocol_messages[cmd_found].recv_function;
+        cmd_name = ptr_msg->name;
+        decode_color = ptr_msg->decode_color;
+        keep_trailing_spaces = ptr_msg->keep_trailing_spaces;
+        cmd_recv_func = ptr_msg->recv_function;
     }
 
     if (cmd_recv_func != NULL)
     {
-        if (ptr_msg_after_tags)
+        if (ptr_msg_after_tags && decode_color)
         {
-            if (decode_color)
-            {
-                message_colors_decoded = irc_color_decode (
-                    ptr_msg_after_tags,
-                    weechat_config_boolean (irc_config_network_colors_receive));
-            }
-            else
-            {
-                message_colors_decoded = strdup (ptr_msg_after_tags);
-            }
+            message_colors_decoded = irc_color_decode (
+                ptr_msg_after_tags,
+                weechat_config_boolean (irc_config_network_colors_receive));
         }
         else
             message_colors_decoded = NULL;
-        argv = weechat_string_split (message_colors_decoded, " ", NULL,
-                                     WEECHAT_STRING_SPLIT_STRIP_LEFT
-                                     | WEECHAT_STRING_SPLIT_STRIP_RIGHT
-                                     | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
-                                     0, &argc);
-        flags = WEECHAT_STRING_SPLIT_STRIP_LEFT
-            | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS
-            | WEECHAT_STRING_SPLIT_KEEP_EOL;
-        if (keep_trailing_spaces)
-            flags |= WEECHAT_STRING_SPLIT_STRIP_RIGHT;
-        argv_eol = weechat_string_split (message_colors_decoded, " ", NULL,
-                                         flags, 0, NULL);
+        /*
+         * split arguments (argv and argv_eol are built in one pass, each
+         * one with a single copy of message)
+         */
+        irc_message_split_args (
+            (decode_color) ? message_colors_decoded : ptr_msg_after_tags,
+            keep_trailing_spaces,
+            &argc, &argv, &argv_eol);
 
         return_code = (int) (cmd_recv_func) (server,
                                              date, nick, address_color,
@@ -6723,9 +6904,9 @@ end:
     if (message_colors_decoded)
         free (message_colors_decoded);
     if (argv)
-        weechat_string_free_split (argv);
+        free (argv);
     if (argv_eol)
-        weechat_string_free_split (argv_eol);
+        free (argv_eol);
     if (hash_tags)
         weechat_hashtable_free (hash_tags);
 }
@@ -75,6 +75,12 @@ typedef int (t_irc_recv_func)(struct t_irc_server *server,
                               int ignored,
                               int argc, char **argv, char **argv_eol);
 
+/* highest numeric command indexed for dispatch */
+#define IRC_PROTOCOL_NUMERIC_MAX 999
+
+/* min size of hash table for dispatch of non-numeric commands (power of 2) */
+#define IRC_PROTOCOL_HASH_MIN_SIZE 16
+
 struct t_irc_protocol_msg
 {
     char *name;                     /* IRC message name                      */
@@ -83,12 +89,18 @@ struct t_irc_protocol_msg
     t_irc_recv_func *recv_function; /* function called when msg is received  */
 };
 
+extern struct t_irc_protocol_msg irc_protocol_messages[];
+extern struct t_irc_protocol_msg **irc_protocol_messages_hash;
+extern unsigned int irc_protocol_messages_hash_size;
+
 extern const char *irc_protocol_tags (const char *command, const char *tags,
                                       const char *nick, const char *address);
 extern time_t irc_protocol_parse_time (const char *time);
+extern struct t_irc_protocol_msg *irc_protocol_search_message (const char *command);
 extern void irc_protocol_recv_command (struct t_irc_server *server,
                                        const char *irc_message,
                                        const char *msg_command,
                                        const char *msg_channel);
+extern void irc_protocol_end ();
 
 #endif /* WEECHAT_PLUGIN_IRC_PROTOCOL_H */
@@ -71,12 +71,14 @@
 struct t_irc_server *irc_servers = NULL;
 struct t_irc_server *last_irc_server = NULL;
 
-struct t_irc_message *irc_recv_msgq = NULL;
-struct t_irc_message *irc_msgq_last_msg = NULL;
+struct t_hook *irc_server_msgq_hook_timer = NULL;
 
 char *irc_server_sasl_fail_string[IRC_SERVER_NUM_SASL_FAIL] =
 { "continue", "reconnect", "disconnect" };
 
+char *irc_server_anti_flood_unit_string[IRC_SERVER_NUM_ANTI_FLOOD_UNIT] =
+{ "seconds", "milliseconds" };
+
 char *irc_server_options[IRC_SERVER_NUM_OPTIONS][2] =
 { { "addresses",            ""                        },
   { "proxy",                ""                        },
@@ -112,6 +114,8 @@ char *irc_server_options[IRC_SERVER_NUM_OPTIONS][2] =
   { "connection_timeout",   "60"                      },
   { "anti_flood_prio_high", "2"                       },
   { "anti_flood_prio_low",  "2"                       },
+  { "anti_flood_burst",     "5"                       },
+  { "anti_flood_unit",      "seconds"                 },
   { "away_check",           "0"                       },
   { "away_check_max_nicks", "25"                      },
   { "msg_kick",             ""                        },
@@ -338,6 +342,48 @@ irc_server_strncasecmp (struct t_irc_server *server,
     return rc;
 }
 
+/*
+ * Converts a string to lower case on server (in place), using the server
+ * casemapping.
+ *
+ * This is the case folding used by irc_server_strcasecmp: two strings are
+ * equal for this function if their lower case versions are identical.
+ */
+
+void
+irc_server_tolower (struct t_irc_server *server, char *string)
+{
+    int casemapping, range;
+
+    if (!string)
+        return;
+
+    casemapping = (server) ? server->casemapping : IRC_SERVER_CASEMAPPING_RFC1459;
+    switch (casemapping)
+    {
+        case IRC_SERVER_CASEMAPPING_RFC1459:
+            range = 30;
+            break;
+        case IRC_SERVER_CASEMAPPING_STRICT_RFC1459:
+            range = 29;
+            break;
+        case IRC_SERVER_CASEMAPPING_ASCII:
+            range = 26;
+            break;
+        default:
+            range = 30;
+            break;
+    }
+
+    /* bytes of UTF-8 multi-byte chars are never in the range */
+    while (string[0])
+    {
+        if ((string[0] >= 'A') && (string[0] < 'A' + range))
+            string[0] += ('a' - 'A');
+        string++;
+    }
+}
+
 /*
  * Evaluates a string using the server as context:
  * ${irc_server.xxx} and ${server} are replaced by a server option and the
@@ -1371,10 +1417,19 @@ irc_server_alloc (const char *name)
     new_server->hook_fd = NULL;
     new_server->hook_timer_connection = NULL;
     new_server->hook_timer_sasl = NULL;
+    new_server->hook_timer_anti_flood = NULL;
     new_server->is_connected = 0;
     new_server->ssl_connected = 0;
     new_server->disconnected = 0;
     new_server->unterminated_message = NULL;
+    new_server->recv_buffer = NULL;
+    new_server->recv_buffer_size = 0;
+    new_server->recv_buffer_length = 0;
+    new_server->recv_msgq = NULL;
+    new_server->last_recv_msgq = NULL;
+    new_server->recv_msgq_count = 0;
+    new_server->recv_msgq_processed = 0;
+    new_server->recv_msgq_time = 0;
     new_server->nicks_count = 0;
     new_server->nicks_array = NULL;
     new_server->nick_first_tried = 0;
@@ -1422,6 +1477,8 @@ irc_server_alloc (const char *name)
     new_server->lag_last_refresh = 0;
     new_server->cmd_list_regexp = NULL;
     new_server->last_user_message = 0;
+    new_server->anti_flood_time.tv_sec = 0;
+    new_server->anti_flood_time.tv_usec = 0;
     new_server->last_away_check = 0;
     new_server->last_data_purge = 0;
     for (i = 0; i < IRC_SERVER_NUM_OUTQUEUES_PRIO; i++)
@@ -1429,6 +1486,9 @@ irc_server_alloc (const char *name)
         new_server->outqueue[i] = NULL;
         new_server->last_outqueue[i] = NULL;
     }
+    new_server->send_buffer = NULL;
+    new_server->send_buffer_size = 0;
+    new_server->send_buffer_length = 0;
     new_server->redirects = NULL;
     new_server->last_redirect = NULL;
     new_server->notify_list = NULL;
@@ -1453,6 +1513,7 @@ irc_server_alloc (const char *name)
     new_server->buffer_as_string = NULL;
     new_server->channels = NULL;
     new_server->last_channel = NULL;
+    new_server->nicklist_bulk_channel = NULL;
 
     /* create options with null value */
     for (i = 0; i < IRC_SERVER_NUM_OPTIONS; i++)
@@ -1762,6 +1823,11 @@ irc_server_apply_command_line_options (struct t_irc_server *server,
 
 /*
  * Adds a message in out queue.
+ *
+ * The message "msg2" is the message sent to server, without final CR-LF (it
+ * is added in the queue).
+ *
+ * The structure and all strings are stored in a single allocated area.
  */
 
 void
@@ -1771,15 +1837,47 @@ irc_server_outqueue_add (struct t_irc_server *server, int priority,
                          struct t_irc_redirect *redirect)
 {
     struct t_irc_outqueue *new_outqueue;
+    int length_command, length_msg1, length_msg2, length_tags;
+    char *ptr_string;
+
+    if (!command)
+        command = "unknown";
+
+    length_command = strlen (command) + 1;
+    length_msg1 = (msg1) ? strlen (msg1) + 1 : 0;
+    length_msg2 = (msg2) ? strlen (msg2) + 2 + 1 : 0;
+    length_tags = (tags) ? strlen (tags) + 1 : 0;
 
-    new_outqueue = malloc (sizeof (*new_outqueue));
+    new_outqueue = malloc (sizeof (*new_outqueue) + length_command
+                           + length_msg1 + length_msg2 + length_tags);
     if (new_outqueue)
     {
-        new_outqueue->command = (command) ? strdup (command) : strdup ("unknown");
-        new_outqueue->message_before_mod = (msg1) ? strdup (msg1) : NULL;
-        new_outqueue->message_after_mod = (msg2) ? strdup (msg2) : NULL;
+        ptr_string = (char *)(new_outqueue + 1);
+        new_outqueue->command = ptr_string;
+        memcpy (ptr_string, command, length_command);
+        ptr_string += length_command;
+        new_outqueue->message_before_mod = NULL;
+        if (msg1)
+        {
+            new_outqueue->message_before_mod = ptr_string;
+            memcpy (ptr_string, msg1, length_msg1);
+            ptr_string += length_msg1;
+        }
+        new_outqueue->message_after_mod = NULL;
+        if (msg2)
+        {
+            new_outqueue->message_after_mod = ptr_string;
+            memcpy (ptr_string, msg2, length_msg2 - 3);
+            memcpy (ptr_string + length_msg2 - 3, "\r\n", 3);
+            ptr_string += length_msg2;
+        }
         new_outqueue->modified = modified;
-        new_outqueue->tags = (tags) ? strdup (tags) : NULL;
+        new_outqueue->tags = NULL;
+        if (tags)
+        {
+            new_outqueue->tags = ptr_string;
+            memcpy (ptr_string, tags, length_tags);
+        }
         new_outqueue->redirect = redirect;
 
         new_outqueue->prev_outqueue = server->last_outqueue[priority];
@@ -1820,15 +1918,7 @@ irc_server_outqueue_free (struct t_irc_server *server,
     if (outqueue->next_outqueue)
         (outqueue->next_outqueue)->prev_outqueue = outqueue->prev_outqueue;
 
-    /* free data */
-    if (outqueue->command)
-        free (outqueue->command);
-    if (outqueue->message_before_mod)
-        free (outqueue->message_before_mod);
-    if (outqueue->message_after_mod)
-        free (outqueue->message_after_mod);
-    if (outqueue->tags)
-        free (outqueue->tags);
+    /* free data (strings are allocated with the structure) */
     free (outqueue);
 
     /* set new head */
@@ -1903,8 +1993,15 @@ irc_server_free_data (struct t_irc_server *server)
         weechat_unhook (server->hook_timer_connection);
     if (server->hook_timer_sasl)
         weechat_unhook (server->hook_timer_sasl);
+    if (server->hook_timer_anti_flood)
+        weechat_unhook (server->hook_timer_anti_flood);
     if (server->unterminated_message)
         free (server->unterminated_message);
+    if (server->recv_buffer)
+        free (server->recv_buffer);
+    if (server->send_buffer)
+        free (server->send_buffer);
+    irc_server_msgq_free_all (server);
     if (server->nicks_array)
         weechat_string_free_split (server->nicks_array);
     if (server->nick)
@@ -2251,7 +2348,8 @@ irc_server_send_signal (struct t_irc_server *server, const char *signal,
 /*
  * Sends data to IRC server.
  *
- * Returns number of bytes sent, -1 if error.
+ * Returns number of bytes sent, 0 if nothing can be sent now (socket would
+ * block), -1 if error.
  */
 
 int
@@ -2291,6 +2389,8 @@ irc_server_send (struct t_irc_server *server, const char *buffer, int size_buf)
 #ifdef HAVE_GNUTLS
         if (server->ssl_connected)
         {
+            if ((rc == GNUTLS_E_AGAIN) || (rc == GNUTLS_E_INTERRUPTED))
+                return 0;
             weechat_printf (
                 server->buffer,
                 _("%s%s: sending data to server: error %d %s"),
@@ -2300,12 +2400,108 @@ irc_server_send (struct t_irc_server *server, const char *buffer, int size_buf)
         else
 #endif /* HAVE_GNUTLS */
         {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+                return 0;
             weechat_printf (
                 server->buffer,
                 _("%s%s: sending data to server: error %d %s"),
                 weechat_prefix ("error"), IRC_PLUGIN_NAME,
                 errno, strerror (errno));
         }
+        return -1;
+    }
+
+    return rc;
+}
+
+/*
+ * Adds a message ("length" bytes, without final CR-LF) in send buffer of
+ * server (data waiting to be sent); a CR-LF is added after the message.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+irc_server_send_buffer_add (struct t_irc_server *server, const char *message,
+                            int length)
+{
+    char *new_buffer;
+    int new_size;
+
+    if (server->send_buffer_length + length + 2 > server->send_buffer_size)
+    {
+        new_size = (server->send_buffer_size > 0) ?
+            server->send_buffer_size : 4096;
+        while (server->send_buffer_length + length + 2 > new_size)
+        {
+            new_size *= 2;
+        }
+        new_buffer = realloc (server->send_buffer, new_size);
+        if (!new_buffer)
+        {
+            weechat_printf (
+                server->buffer,
+                _("%s%s: not enough memory for sending data to server"),
+                weechat_prefix ("error"), IRC_PLUGIN_NAME);
+            return 0;
+        }
+        server->send_buffer = new_buffer;
+        server->send_buffer_size = new_size;
+    }
+
+    memcpy (server->send_buffer + server->send_buffer_length, message, length);
+    memcpy (server->send_buffer + server->send_buffer_length + length,
+            "\r\n", 2);
+    server->send_buffer_length += length + 2;
+
+    return 1;
+}
+
+/*
+ * Sends data waiting in send buffer of server: all messages added since last
+ * flush are sent at once (the data that can not be sent now is kept and sent
+ * later).
+ *
+ * Returns:
+ *   1: OK (all data sent, or some data kept for later)
+ *   0: error
+ */
+
+int
+irc_server_send_buffer_flush (struct t_irc_server *server)
+{
+    int num_sent, total_sent, rc;
+
+    if (server->send_buffer_length <= 0)
+        return 1;
+
+    rc = 1;
+    total_sent = 0;
+
+    while (total_sent < server->send_buffer_length)
+    {
+        num_sent = irc_server_send (server,
+                                    server->send_buffer + total_sent,
+                                    server->send_buffer_length - total_sent);
+        if (num_sent < 0)
+        {
+            /* error: data is discarded */
+            total_sent = server->send_buffer_length;
+            rc = 0;
+            break;
+        }
+        if (num_sent == 0)
+            break;
+        total_sent += num_sent;
+    }
+
+    server->send_buffer_length -= total_sent;
+    if (server->send_buffer_length > 0)
+    {
+        memmove (server->send_buffer, server->send_buffer + total_sent,
+                 server->send_buffer_length);
     }
 
     return rc;
@@ -2352,96 +2548,255 @@ irc_server_get_tags_to_send (const char *tags)
 }
 
 /*
- * Sends a message from out queue.
+ * Gets anti-flood delay (in milliseconds) between two messages for an
+ * outqueue priority (0 = high, 1 = low).
+ */
+
+long long
+irc_server_anti_flood_get_delay (struct t_irc_server *server, int priority)
+{
+    long long delay;
+
+    delay = (priority == 0) ?
+        IRC_SERVER_OPTION_INTEGER(server,
+                                  IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH) :
+        IRC_SERVER_OPTION_INTEGER(server,
+                                  IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW);
+
+    if (IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_UNIT)
+        == IRC_SERVER_ANTI_FLOOD_UNIT_SECONDS)
+    {
+        delay *= 1000LL;
+    }
+
+    return delay;
+}
+
+/*
+ * Returns time to wait (in milliseconds, rounded up) before a message with
+ * this outqueue priority can be sent to server, 0 if the message can be sent
+ * now.
+ *
+ * The anti-flood is a token bucket: each message sent moves the anti-flood
+ * time forward by the delay of its priority, and up to
+ * "anti_flood_burst" messages can be sent before having to wait (like the
+ * "message timer" described in RFC 1459, section 8.10).
+ */
+
+long long
+irc_server_anti_flood_wait (struct t_irc_server *server, int priority)
+{
+    struct timeval tv_now;
+    long long delay, delay_max, burst, ahead;
+
+    delay = irc_server_anti_flood_get_delay (server, priority);
+    if (delay <= 0)
+        return 0;
+
+    burst = IRC_SERVER_OPTION_INTEGER(server,
+                                      IRC_SERVER_OPTION_ANTI_FLOOD_BURST);
+    if (burst < 1)
+        burst = 1;
+
+    gettimeofday (&tv_now, NULL);
+
+    /* time of anti-flood ahead of now, in milliseconds (rounded up) */
+    ahead = weechat_util_timeval_diff (&tv_now, &(server->anti_flood_time));
+    ahead = (ahead > 0) ? (ahead + 999) / 1000 : 0;
+
+    /*
+     * anti-flood time too far in future: the system clock has been changed
+     * (now lower than before) or the delays have been reduced
+     */
+    delay_max = irc_server_anti_flood_get_delay (server, 0);
+    if (irc_server_anti_flood_get_delay (server, 1) > delay_max)
+        delay_max = irc_server_anti_flood_get_delay (server, 1);
+    if (ahead > burst * delay_max)
+    {
+        server->anti_flood_time = tv_now;
+        ahead = 0;
+    }
+
+    ahead -= (burst - 1) * delay;
+
+    return (ahead > 0) ? ahead : 0;
+}
+
+/*
+ * Updates anti-flood time after a message with this outqueue priority has
+ * been sent to server.
  */
 
 void
-irc_server_outqueue_send (struct t_irc_server *server)
+irc_server_anti_flood_sent (struct t_irc_server *server, int priority)
 {
-    time_t time_now;
-    char *pos, *tags_to_send;
-    int priority, anti_flood;
+    struct timeval tv_now;
+
+    gettimeofday (&tv_now, NULL);
+
+    if (weechat_util_timeval_cmp (&(server->anti_flood_time), &tv_now) < 0)
+        server->anti_flood_time = tv_now;
+    weechat_util_timeval_add (
+        &(server->anti_flood_time),
+        irc_server_anti_flood_get_delay (server, priority) * 1000LL);
+
+    server->last_user_message = tv_now.tv_sec;
+}
+
+/*
+ * Callback for anti-flood timer: sends messages from out queue.
+ */
+
+int
+irc_server_outqueue_timer_cb (const void *pointer, void *data,
+                              int remaining_calls)
+{
+    struct t_irc_server *server;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) remaining_calls;
+
+    server = (struct t_irc_server *)pointer;
+    if (!server)
+        return WEECHAT_RC_ERROR;
+
+    /* the timer is called only once (it is removed after this call) */
+    server->hook_timer_anti_flood = NULL;
+
+    if (server->is_connected)
+        irc_server_outqueue_send (server);
+
+    return WEECHAT_RC_OK;
+}
 
-    time_now = time (NULL);
+/*
+ * Schedules send of next message from out queue: a timer is set at the
+ * exact time when a message can be sent (according to anti-flood).
+ */
 
-    /* detect if system clock has been changed (now lower than before) */
-    if (server->last_user_message > time_now)
-        server->last_user_message = time_now;
+void
+irc_server_outqueue_schedule (struct t_irc_server *server)
+{
+    long long wait, wait_min;
+    int priority;
+
+    if (server->hook_timer_anti_flood)
+    {
+        weechat_unhook (server->hook_timer_anti_flood);
+        server->hook_timer_anti_flood = NULL;
+    }
 
+    wait_min = -1;
     for (priority = 0; priority < IRC_SERVER_NUM_OUTQUEUES_PRIO; priority++)
     {
-        switch (priority)
+        if (server->outqueue[priority])
         {
-            case 0:
-                anti_flood = IRC_SERVER_OPTION_INTEGER(
-                    server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH);
-                break;
-            default:
-                anti_flood = IRC_SERVER_OPTION_INTEGER(
-                    server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW);
-                break;
+            wait = irc_server_anti_flood_wait (server, priority);
+            if ((wait_min < 0) || (wait < wait_min))
+                wait_min = wait;
         }
-        if (server->outqueue[priority]
-            && (time_now >= server->last_user_message + anti_flood))
+    }
+    if (wait_min < 0)
+        return;
+
+    if (wait_min < 1)
+        wait_min = 1;
+
+    server->hook_timer_anti_flood = weechat_hook_timer (
+        wait_min, 0, 1,
+        &irc_server_outqueue_timer_cb, server, NULL);
+}
+
+/*
+ * Sends messages from out queue: messages with high priority are sent first,
+ * as many messages as allowed by anti-flood are sent, then the send of next
+ * messages is scheduled.
+ */
+
+void
+irc_server_outqueue_send (struct t_irc_server *server)
+{
+    char *pos, *tags_to_send;
+    int priority;
+
+    while (1)
+    {
+        /* search first queue with a message that can be sent now */
+        for (priority = 0; priority < IRC_SERVER_NUM_OUTQUEUES_PRIO;
+             priority++)
         {
-            if (server->outqueue[priority]->message_before_mod)
+            if (server->outqueue[priority]
+                && (irc_server_anti_flood_wait (server, priority) == 0))
             {
-                pos = strchr (server->outqueue[priority]->message_before_mod,
-                              '\r');
-                if (pos)
-                    pos[0] = '\0';
-                irc_raw_print (server, IRC_RAW_FLAG_SEND,
-                               server->outqueue[priority]->message_before_mod);
-                if (pos)
-                    pos[0] = '\r';
+                break;
             }
-            if (server->outqueue[priority]->message_after_mod)
-            {
-                pos = strchr (server->outqueue[priority]->message_after_mod,
-                              '\r');
-                if (pos)
-                    pos[0] = '\0';
-                irc_raw_print (server, IRC_RAW_FLAG_SEND |
-                               ((server->outqueue[priority]->modified) ? IRC_RAW_FLAG_MODIFIED : 0),
-                               server->outqueue[priority]->message_after_mod);
-                if (pos)
-                    pos[0] = '\r';
+        }
+        if (priority >= IRC_SERVER_NUM_OUTQUEUES_PRIO)
+            break;
 
-                /* send signal with command that will be sent to server */
-                irc_server_send_signal (
-                    server, "irc_out",
-                    server->outqueue[priority]->command,
-                    server->outqueue[priority]->message_after_mod,
-                    NULL);
-                tags_to_send = irc_server_get_tags_to_send (
-                    server->outqueue[priority]->tags);
-                irc_server_send_signal (
-                    server, "irc_outtags",
-                    server->outqueue[priority]->command,
-                    server->outqueue[priority]->message_after_mod,
-                    (tags_to_send) ? tags_to_send : "");
-                if (tags_to_send)
-                    free (tags_to_send);
+        if (server->outqueue[priority]->message_before_mod)
+        {
+            pos = strchr (server->outqueue[priority]->message_before_mod,
+                          '\r');
+            if (pos)
+                pos[0] = '\0';
+            irc_raw_print (server, IRC_RAW_FLAG_SEND,
+                           server->outqueue[priority]->message_before_mod);
+            if (pos)
+                pos[0] = '\r';
+        }
+        if (server->outqueue[priority]->message_after_mod)
+        {
+            pos = strchr (server->outqueue[priority]->message_after_mod,
+                          '\r');
+            if (pos)
+                pos[0] = '\0';
+            irc_raw_print (server, IRC_RAW_FLAG_SEND |
+                           ((server->outqueue[priority]->modified) ? IRC_RAW_FLAG_MODIFIED : 0),
+                           server->outqueue[priority]->message_after_mod);
+            if (pos)
+                pos[0] = '\r';
 
-                /* send command */
-                irc_server_send (
-                    server, server->outqueue[priority]->message_after_mod,
-                    strlen (server->outqueue[priority]->message_after_mod));
-                server->last_user_message = time_now;
+            /* send signal with command that will be sent to server */
+            irc_server_send_signal (
+                server, "irc_out",
+                server->outqueue[priority]->command,
+                server->outqueue[priority]->message_after_mod,
+                NULL);
+            tags_to_send = irc_server_get_tags_to_send (
+                server->outqueue[priority]->tags);
+            irc_server_send_signal (
+                server, "irc_outtags",
+                server->outqueue[priority]->command,
+                server->outqueue[priority]->message_after_mod,
+                (tags_to_send) ? tags_to_send : "");
+            if (tags_to_send)
+                free (tags_to_send);
 
-                /* start redirection if redirect is set */
-                if (server->outqueue[priority]->redirect)
-                {
-                    irc_redirect_init_command (
-                        server->outqueue[priority]->redirect,
-                        server->outqueue[priority]->message_after_mod);
-                }
+            /* send command */
+            irc_server_send_buffer_add (
+                server,
+                server->outqueue[priority]->message_after_mod,
+                strlen (server->outqueue[priority]->message_after_mod) - 2);
+            irc_server_anti_flood_sent (server, priority);
+
+            /* start redirection if redirect is set */
+            if (server->outqueue[priority]->redirect)
+            {
+                irc_redirect_init_command (
+                    server->outqueue[priority]->redirect,
+                    server->outqueue[priority]->message_after_mod);
             }
-            irc_server_outqueue_free (server, priority,
-                                      server->outqueue[priority]);
-            break;
         }
+        irc_server_outqueue_free (server, priority,
+                                  server->outqueue[priority]);
     }
+
+    /* send all messages added in send buffer */
+    irc_server_send_buffer_flush (server);
+
+    irc_server_outqueue_schedule (server);
 }
 
 /*
@@ -2464,24 +2819,23 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
                          const char *command, const char *channel,
                          const char *tags)
 {
-    static char buffer[4096];
     const char *ptr_msg, *ptr_chan_nick;
     char *new_msg, *pos, *tags_to_send, *msg_encoded;
     char str_modifier[128], modifier_data[256];
-    int rc, queue_msg, add_to_queue, first_message, anti_flood;
+    int rc, queue_msg, add_to_queue, first_message, queued;
     int pos_channel, pos_text, pos_encode;
-    time_t time_now;
     struct t_irc_redirect *ptr_redirect;
 
     rc = 1;
+    queued = 0;
 
     /* run modifier "irc_out_xxx" */
     snprintf (str_modifier, sizeof (str_modifier),
               "irc_out_%s",
               (command) ? command : "unknown");
-    new_msg = weechat_hook_modifier_exec (str_modifier,
-                                          server->name,
-                                          message);
+    new_msg = (weechat_hook_modifier_has_hooks (str_modifier)) ?
+        weechat_hook_modifier_exec (str_modifier, server->name, message) :
+        NULL;
 
     /* no changes in new message */
     if (new_msg && (strcmp (message, new_msg) == 0))
@@ -2503,7 +2857,8 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
             pos_encode = (pos_channel >= 0) ? pos_channel : pos_text;
         else
             pos_encode = pos_text;
-        if (pos_encode >= 0)
+        if ((pos_encode >= 0)
+            && weechat_hook_modifier_has_hooks ("charset_encode"))
         {
             ptr_chan_nick = (channel) ? channel : nick;
             if (ptr_chan_nick)
@@ -2535,15 +2890,6 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
             if (pos)
                 pos[0] = '\0';
 
-            snprintf (buffer, sizeof (buffer), "%s\r\n", ptr_msg);
-
-            /* anti-flood: look whether we should queue outgoing message or not */
-            time_now = time (NULL);
-
-            /* detect if system clock has been changed (now lower than before) */
-            if (server->last_user_message > time_now)
-                server->last_user_message = time_now;
-
             /* get queue from flags */
             queue_msg = 0;
             if (flags & IRC_SERVER_SEND_OUTQ_PRIO_HIGH)
@@ -2551,23 +2897,12 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
             else if (flags & IRC_SERVER_SEND_OUTQ_PRIO_LOW)
                 queue_msg = 2;
 
-            switch (queue_msg - 1)
-            {
-                case 0:
-                    anti_flood = IRC_SERVER_OPTION_INTEGER(
-                        server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH);
-                    break;
-                default:
-                    anti_flood = IRC_SERVER_OPTION_INTEGER(
-                        server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW);
-                    break;
-            }
-
+            /* anti-flood: look whether we should queue outgoing message or not */
             add_to_queue = 0;
             if ((queue_msg > 0)
                 && (server->outqueue[queue_msg - 1]
-                    || ((anti_flood > 0)
-                        && (time_now - server->last_user_message < anti_flood))))
+                    || (irc_server_anti_flood_wait (server,
+                                                    queue_msg - 1) > 0)))
             {
                 add_to_queue = queue_msg;
             }
@@ -2581,13 +2916,14 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
                 /* queue message (do not send anything now) */
                 irc_server_outqueue_add (server, add_to_queue - 1, command,
                                          (new_msg && first_message) ? message : NULL,
-                                         buffer,
+                                         ptr_msg,
                                          (new_msg) ? 1 : 0,
                                          tags_to_send,
                                          ptr_redirect);
                 /* mark redirect as "used" */
                 if (ptr_redirect)
                     ptr_redirect->assigned_to_command = 1;
+                queued = 1;
             }
             else
             {
@@ -2612,15 +2948,20 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
                                         ptr_msg,
                                         (tags_to_send) ? tags_to_send : "");
 
-                if (irc_server_send (server, buffer, strlen (buffer)) <= 0)
+                /*
+                 * add message in send buffer: it is sent with other
+                 * messages when the buffer is flushed
+                 */
+                if (!irc_server_send_buffer_add (server, ptr_msg,
+                                                 strlen (ptr_msg)))
                     rc = 0;
                 else
                 {
                     if (queue_msg > 0)
-                        server->last_user_message = time_now;
+                        irc_server_anti_flood_sent (server, queue_msg - 1);
                 }
                 if (ptr_redirect)
-                    irc_redirect_init_command (ptr_redirect, buffer);
+                    irc_redirect_init_command (ptr_redirect, ptr_msg);
             }
 
             if (tags_to_send)
@@ -2648,6 +2989,10 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
     if (new_msg)
         free (new_msg);
 
+    /* schedule send of queued messages */
+    if (queued)
+        irc_server_outqueue_schedule (server);
+
     return rc;
 }
 
@@ -2705,9 +3050,10 @@ irc_server_sendf (struct t_irc_server *server, int flags, const char *tags,
         snprintf (str_modifier, sizeof (str_modifier),
                   "irc_out1_%s",
                   (command) ? command : "unknown");
-        new_msg = weechat_hook_modifier_exec (str_modifier,
-                                              server->name,
-                                              items[i]);
+        new_msg = (weechat_hook_modifier_has_hooks (str_modifier)) ?
+            weechat_hook_modifier_exec (str_modifier, server->name,
+                                        items[i]) :
+            NULL;
 
         /* no changes in new message */
         if (new_msg && (strcmp (items[i], new_msg) == 0))
@@ -2787,6 +3133,9 @@ irc_server_sendf (struct t_irc_server *server, int flags, const char *tags,
     if (items)
         weechat_string_free_split (items);
 
+    /* send all messages added in send buffer */
+    irc_server_send_buffer_flush (server);
+
     free (vbuffer);
 
     return ret_hashtable;
@@ -2836,16 +3185,33 @@ irc_server_msgq_add_msg (struct t_irc_server *server, const char *msg)
 
     message->next_message = NULL;
 
-    if (irc_msgq_last_msg)
-    {
-        irc_msgq_last_msg->next_message = message;
-        irc_msgq_last_msg = message;
-    }
+    if (server->last_recv_msgq)
+        server->last_recv_msgq->next_message = message;
     else
+        server->recv_msgq = message;
+    server->last_recv_msgq = message;
+    server->recv_msgq_count++;
+}
+
+/*
+ * Frees all messages received from a server and not yet processed.
+ */
+
+void
+irc_server_msgq_free_all (struct t_irc_server *server)
+{
+    struct t_irc_message *ptr_message;
+
+    while (server->recv_msgq)
     {
-        irc_recv_msgq = message;
-        irc_msgq_last_msg = message;
+        ptr_message = server->recv_msgq;
+        server->recv_msgq = ptr_message->next_message;
+        if (ptr_message->data)
+            free (ptr_message->data);
+        free (ptr_message);
     }
+    server->last_recv_msgq = NULL;
+    server->recv_msgq_count = 0;
 }
 
 /*
@@ -2930,27 +3296,190 @@ irc_server_msgq_add_buffer (struct t_irc_server *server, const char *buffer)
 }
 
 /*
- * Flushes message queue.
+ * Adds complete messages found in receive buffer of server to the received
+ * messages queue.
+ *
+ * Messages are split in place in the buffer; the beginning of an unterminated
+ * message is moved at the beginning of buffer, waiting for more data.
  */
 
 void
-irc_server_msgq_flush ()
+irc_server_recv_buffer_split (struct t_irc_server *server)
+{
+    char *ptr_msg, *ptr_end, *pos_lf, *pos_cr, *ptr_src, *ptr_dst;
+
+    ptr_msg = server->recv_buffer;
+    ptr_end = server->recv_buffer + server->recv_buffer_length;
+
+    while (ptr_msg < ptr_end)
+    {
+        pos_lf = memchr (ptr_msg, '\n', ptr_end - ptr_msg);
+        if (!pos_lf)
+            break;
+
+        /* remove all '\r' in message (like irc_server_msgq_add_buffer) */
+        pos_cr = memchr (ptr_msg, '\r', pos_lf - ptr_msg);
+        if (pos_cr)
+        {
+            ptr_dst = pos_cr;
+            for (ptr_src = pos_cr + 1; ptr_src < pos_lf; ptr_src++)
+            {
+                if (ptr_src[0] != '\r')
+                {
+                    ptr_dst[0] = ptr_src[0];
+                    ptr_dst++;
+                }
+            }
+            ptr_dst[0] = '\0';
+        }
+        else
+        {
+            pos_lf[0] = '\0';
+        }
+
+        irc_server_msgq_add_msg (server, ptr_msg);
+
+        ptr_msg = pos_lf + 1;
+    }
+
+    server->recv_buffer_length = ptr_end - ptr_msg;
+    if ((server->recv_buffer_length > 0) && (ptr_msg != server->recv_buffer))
+        memmove (server->recv_buffer, ptr_msg, server->recv_buffer_length);
+}
+
+/*
+ * Moves data remaining in receive buffer of server (beginning of an
+ * unterminated message) to the unterminated message of server.
+ *
+ * This is done when the buffer is full (message longer than buffer) and
+ * before saving server for upgrade.
+ */
+
+void
+irc_server_recv_buffer_flush (struct t_irc_server *server)
+{
+    if (!server->recv_buffer || (server->recv_buffer_length <= 0))
+        return;
+
+    server->recv_buffer[server->recv_buffer_length] = '\0';
+    irc_server_msgq_add_buffer (server, server->recv_buffer);
+    server->recv_buffer_length = 0;
+}
+
+/*
+ * Allocates or resizes receive buffer of server, using size from option
+ * irc.network.recv_buffer_size.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+irc_server_recv_buffer_alloc (struct t_irc_server *server)
+{
+    char *new_buffer;
+    int size;
+
+    size = weechat_config_integer (irc_config_network_recv_buffer_size);
+
+    if (server->recv_buffer && (server->recv_buffer_size == size))
+        return 1;
+
+    /* keep current buffer if pending data does not fit in new size */
+    if (server->recv_buffer && (server->recv_buffer_length >= size))
+        return 1;
+
+    new_buffer = realloc (server->recv_buffer, size + 1);
+    if (!new_buffer)
+        return (server->recv_buffer) ? 1 : 0;
+
+    server->recv_buffer = new_buffer;
+    server->recv_buffer_size = size;
+
+    return 1;
+}
+
+/*
+ * Frees strings returned by function irc_message_parse for a received message
+ * (and sets them to NULL).
+ */
+
+void
+irc_server_msgq_free_parsed (char **nick, char **host, char **command,
+                             char **channel, char **arguments)
+{
+    if (*nick)
+    {
+        free (*nick);
+        *nick = NULL;
+    }
+    if (*host)
+    {
+        free (*host);
+        *host = NULL;
+    }
+    if (*command)
+    {
+        free (*command);
+        *command = NULL;
+    }
+    if (*channel)
+    {
+        free (*channel);
+        *channel = NULL;
+    }
+    if (*arguments)
+    {
+        free (*arguments);
+        *arguments = NULL;
+    }
+}
+
+/*
+ * Processes messages received from a server (messages in queue).
+ *
+ * At most "max_messages" messages are processed (0 = process all messages
+ * in queue).
+ */
+
+void
+irc_server_msgq_flush_server (struct t_irc_server *server, int max_messages)
 {
-    struct t_irc_message *next;
+    struct t_irc_message *ptr_message;
+    struct timeval tv_start, tv_end;
+    int count;
     char *ptr_data, *new_msg, *new_msg2, *ptr_msg, *ptr_msg2, *pos;
     char *nick, *host, *command, *channel, *arguments;
     char *msg_decoded, *msg_decoded_without_color;
     char str_modifier[128], modifier_data[256];
     int pos_channel, pos_text, pos_decode;
 
-    while (irc_recv_msgq)
+    if (!server->recv_msgq)
+        return;
+
+    gettimeofday (&tv_start, NULL);
+    count = 0;
+
+    while (server->recv_msgq
+           && ((max_messages <= 0) || (count < max_messages)))
     {
-        if (irc_recv_msgq->data)
+        /*
+         * remove message from queue before processing it: the queue can be
+         * emptied during processing (if the server is disconnected)
+         */
+        ptr_message = server->recv_msgq;
+        server->recv_msgq = ptr_message->next_message;
+        if (!server->recv_msgq)
+            server->last_recv_msgq = NULL;
+        server->recv_msgq_count--;
+
+        if (ptr_message->data)
         {
             /* read message only if connection was not lost */
-            if (irc_recv_msgq->server->sock != -1)
+            if (server->sock != -1)
             {
-                ptr_data = irc_recv_msgq->data;
+                ptr_data = ptr_message->data;
                 while (ptr_data[0] == ' ')
                 {
                     ptr_data++;
@@ -2958,22 +3487,27 @@ irc_server_msgq_flush ()
 
                 if (ptr_data[0])
                 {
-                    irc_raw_print (irc_recv_msgq->server, IRC_RAW_FLAG_RECV,
+                    irc_raw_print (server, IRC_RAW_FLAG_RECV,
                                    ptr_data);
 
-                    irc_message_parse (irc_recv_msgq->server,
-                                       ptr_data, NULL, NULL, NULL, NULL,
-                                       &command, NULL, NULL, NULL, NULL, NULL,
-                                       NULL, NULL);
+                    /*
+                     * parse message only once: it is parsed again only if it
+                     * is changed by a modifier "irc_in_xxx"
+                     */
+                    irc_message_parse (server, ptr_data,
+                                       NULL, NULL, &nick, &host,
+                                       &command, &channel, &arguments,
+                                       NULL, NULL, NULL,
+                                       &pos_channel, &pos_text);
                     snprintf (str_modifier, sizeof (str_modifier),
                               "irc_in_%s",
                               (command) ? command : "unknown");
-                    new_msg = weechat_hook_modifier_exec (
-                        str_modifier,
-                        irc_recv_msgq->server->name,
-                        ptr_data);
-                    if (command)
-                        free (command);
+                    new_msg = (weechat_hook_modifier_has_hooks (str_modifier)) ?
+                        weechat_hook_modifier_exec (
+                            str_modifier,
+                            server->name,
+                            ptr_data) :
+                        NULL;
 
                     /* no changes in new message */
                     if (new_msg && (strcmp (ptr_data, new_msg) == 0))
@@ -2997,33 +3531,43 @@ irc_server_msgq_flush ()
                             if (new_msg)
                             {
                                 irc_raw_print (
-                                    irc_recv_msgq->server,
+                                    server,
                                     IRC_RAW_FLAG_RECV | IRC_RAW_FLAG_MODIFIED,
                                     ptr_msg);
                             }
 
-                            irc_message_parse (irc_recv_msgq->server, ptr_msg,
-                                               NULL, NULL, &nick, &host,
-                                               &command, &channel, &arguments,
-                                               NULL, NULL, NULL,
-                                               &pos_channel, &pos_text);
+                            if (ptr_msg != ptr_data)
+                            {
+                                irc_server_msgq_free_parsed (&nick, &host,
+                                                             &command,
+                                                             &channel,
+                                                             &arguments);
+                                irc_message_parse (server,
+                                                   ptr_msg,
+                                                   NULL, NULL, &nick, &host,
+                                                   &command, &channel,
+                                                   &arguments,
+                                                   NULL, NULL, NULL,
+                                                   &pos_channel, &pos_text);
+                            }
 
                             msg_decoded = NULL;
                             if (weechat_config_boolean (irc_config_network_channel_encode))
                                 pos_decode = (pos_channel >= 0) ? pos_channel : pos_text;
                             else
                                 pos_decode = pos_text;
-                            if (pos_decode >= 0)
+                            if ((pos_decode >= 0)
+                                && weechat_hook_modifier_has_hooks ("charset_decode"))
                             {
                                 /* convert charset for message */
                                 if (channel
-                                    && irc_channel_is_channel (irc_recv_msgq->server,
+                                    && irc_channel_is_channel (server,
                                                                channel))
                                 {
                                     snprintf (modifier_data, sizeof (modifier_data),
                                               "%s.%s.%s",
                                               weechat_plugin->name,
-                                              irc_recv_msgq->server->name,
+                                              server->name,
                                               channel);
                                 }
                                 else
@@ -3034,7 +3578,7 @@ irc_server_msgq_flush ()
                                                   sizeof (modifier_data),
                                                   "%s.%s.%s",
                                                   weechat_plugin->name,
-                                                  irc_recv_msgq->server->name,
+                                                  server->name,
                                                   nick);
                                     }
                                     else
@@ -3043,7 +3587,7 @@ irc_server_msgq_flush ()
                                                   sizeof (modifier_data),
                                                   "%s.%s",
                                                   weechat_plugin->name,
-                                                  irc_recv_msgq->server->name);
+                                                  server->name);
                                     }
                                 }
                                 msg_decoded = irc_message_convert_charset (
@@ -3063,10 +3607,12 @@ irc_server_msgq_flush ()
                             snprintf (str_modifier, sizeof (str_modifier),
                                       "irc_in2_%s",
                                       (command) ? command : "unknown");
-                            new_msg2 = weechat_hook_modifier_exec (
-                                str_modifier,
-                                irc_recv_msgq->server->name,
-                                ptr_msg2);
+                            new_msg2 = (weechat_hook_modifier_has_hooks (str_modifier)) ?
+                                weechat_hook_modifier_exec (
+                                    str_modifier,
+                                    server->name,
+                                    ptr_msg2) :
+                                NULL;
                             if (new_msg2 && (strcmp (ptr_msg2, new_msg2) == 0))
                             {
                                 free (new_msg2);
@@ -3081,7 +3627,7 @@ irc_server_msgq_flush ()
                                     ptr_msg2 = new_msg2;
 
                                 /* parse and execute command */
-                                if (irc_redirect_message (irc_recv_msgq->server,
+                                if (irc_redirect_message (server,
                                                           ptr_msg2, command,
                                                           arguments))
                                 {
@@ -3091,7 +3637,7 @@ irc_server_msgq_flush ()
                                 {
                                     /* message not redirected, display it */
                                     irc_protocol_recv_command (
-                                        irc_recv_msgq->server,
+                                        server,
                                         ptr_msg2,
                                         command,
                                         channel);
@@ -3100,16 +3646,6 @@ irc_server_msgq_flush ()
 
                             if (new_msg2)
                                 free (new_msg2);
-                            if (nick)
-                                free (nick);
-                            if (host)
-                                free (host);
-                            if (command)
-                                free (command);
-                            if (channel)
-                                free (channel);
-                            if (arguments)
-                                free (arguments);
                             if (msg_decoded)
                                 free (msg_decoded);
                             if (msg_decoded_without_color)
@@ -3126,23 +3662,101 @@ irc_server_msgq_flush ()
                     }
                     else
                     {
-                        irc_raw_print (irc_recv_msgq->server,
+                        irc_raw_print (server,
                                        IRC_RAW_FLAG_RECV | IRC_RAW_FLAG_MODIFIED,
                                        _("(message dropped)"));
                     }
                     if (new_msg)
                         free (new_msg);
+                    irc_server_msgq_free_parsed (&nick, &host, &command,
+                                                 &channel, &arguments);
                 }
             }
-            free (irc_recv_msgq->data);
+            free (ptr_message->data);
+        }
+
+        free (ptr_message);
+        count++;
+    }
+
+    gettimeofday (&tv_end, NULL);
+    server->recv_msgq_processed += count;
+    server->recv_msgq_time += weechat_util_timeval_diff (&tv_start, &tv_end);
+}
+
+/*
+ * Callback for timer used to process messages remaining in queues of servers.
+ */
+
+int
+irc_server_msgq_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    /* the timer is called only once (it is removed after this call) */
+    irc_server_msgq_hook_timer = NULL;
+
+    irc_server_msgq_flush ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Schedules processing of messages remaining in queues of servers (on next
+ * iteration of main loop), if needed.
+ */
+
+void
+irc_server_msgq_schedule ()
+{
+    struct t_irc_server *ptr_server;
+
+    if (irc_server_msgq_hook_timer)
+        return;
+
+    for (ptr_server = irc_servers; ptr_server;
+         ptr_server = ptr_server->next_server)
+    {
+        if (ptr_server->recv_msgq)
+        {
+            irc_server_msgq_hook_timer = weechat_hook_timer (
+                1, 0, 1,
+                &irc_server_msgq_timer_cb, NULL, NULL);
+            return;
         }
+    }
+}
+
+/*
+ * Processes messages in queues of all servers: for each server, at most
+ * "irc.network.recv_max_messages" messages are processed, so that a server
+ * receiving a lot of messages does not block other servers and the main loop.
+ *
+ * If messages remain in queues, their processing is scheduled on next
+ * iteration of main loop.
+ */
+
+void
+irc_server_msgq_flush ()
+{
+    struct t_irc_server *ptr_server, *ptr_next_server;
+    int max_messages;
+
+    max_messages = weechat_config_integer (irc_config_network_recv_max_messages);
 
-        next = irc_recv_msgq->next_message;
-        free (irc_recv_msgq);
-        irc_recv_msgq = next;
-        if (!irc_recv_msgq)
-            irc_msgq_last_msg = NULL;
+    ptr_server = irc_servers;
+    while (ptr_server)
+    {
+        ptr_next_server = ptr_server->next_server;
+        if (ptr_server->recv_msgq)
+            irc_server_msgq_flush_server (ptr_server, max_messages);
+        ptr_server = ptr_next_server;
     }
+
+    irc_server_msgq_schedule ();
 }
 
 /*
@@ -3153,8 +3767,8 @@ int
 irc_server_recv_cb (const void *pointer, void *data, int fd)
 {
     struct t_irc_server *server;
-    static char buffer[4096 + 2];
-    int num_read, msgq_flush, end_recv;
+    int num_read, size_read, msgq_flush, end_recv, max_bytes, total_read;
+    int error;
 
     /* make C compiler happy */
     (void) data;
@@ -3164,26 +3778,60 @@ irc_server_recv_cb (const void *pointer, void *data, int fd)
     if (!server)
         return WEECHAT_RC_ERROR;
 
+    if (!irc_server_recv_buffer_alloc (server))
+    {
+        weechat_printf (server->buffer,
+                        _("%s%s: not enough memory for received message"),
+                        weechat_prefix ("error"), IRC_PLUGIN_NAME);
+        return WEECHAT_RC_ERROR;
+    }
+
+    max_bytes = weechat_config_integer (irc_config_network_recv_max_bytes);
+
     msgq_flush = 0;
     end_recv = 0;
+    total_read = 0;
 
-    while (!end_recv)
+    while (!end_recv && (server->sock != -1))
     {
         end_recv = 1;
 
+        size_read = server->recv_buffer_size - server->recv_buffer_length;
+
 #ifdef HAVE_GNUTLS
         if (server->ssl_connected)
-            num_read = gnutls_record_recv (server->gnutls_sess, buffer,
-                                           sizeof (buffer) - 2);
+            num_read = gnutls_record_recv (
+                server->gnutls_sess,
+                server->recv_buffer + server->recv_buffer_length,
+                size_read);
         else
 #endif /* HAVE_GNUTLS */
-            num_read = recv (server->sock, buffer, sizeof (buffer) - 2, 0);
+            num_read = recv (server->sock,
+                             server->recv_buffer + server->recv_buffer_length,
+                             size_read, 0);
 
         if (num_read > 0)
         {
-            buffer[num_read] = '\0';
-            irc_server_msgq_add_buffer (server, buffer);
+            server->recv_buffer_length += num_read;
+            irc_server_recv_buffer_split (server);
+            if (server->recv_buffer_length >= server->recv_buffer_size)
+            {
+                /* buffer full without end of message: flush it */
+                irc_server_recv_buffer_flush (server);
+            }
             msgq_flush = 1;  /* the flush will be done after the loop */
+            total_read += num_read;
+            /*
+             * if the read has filled the buffer, there are probably more
+             * data waiting on socket: go on with recv (if the max number
+             * of bytes is not yet reached, so that other servers are not
+             * blocked)
+             */
+            if ((num_read == size_read)
+                && ((max_bytes == 0) || (total_read < max_bytes)))
+            {
+                end_recv = 0;
+            }
 #ifdef HAVE_GNUTLS
             if (server->ssl_connected
                 && (gnutls_record_check_pending (server->gnutls_sess) > 0))
@@ -3205,6 +3853,14 @@ irc_server_recv_cb (const void *pointer, void *data, int fd)
                     || ((num_read != GNUTLS_E_AGAIN)
                         && (num_read != GNUTLS_E_INTERRUPTED)))
                 {
+                    /*
+                     * process messages received before the end of
+                     * connection (for example the reason of an ERROR or a
+                     * KILL), which may close the connection
+                     */
+                    irc_server_msgq_flush_server (server, 0);
+                    if (server->sock == -1)
+                        break;
                     weechat_printf (
                         server->buffer,
                         _("%s%s: reading data on socket: error %d %s"),
@@ -3225,13 +3881,22 @@ irc_server_recv_cb (const void *pointer, void *data, int fd)
                 if ((num_read == 0)
                     || ((errno != EAGAIN) && (errno != EWOULDBLOCK)))
                 {
+                    error = errno;
+                    /*
+                     * process messages received before the end of
+                     * connection (for example the reason of an ERROR or a
+                     * KILL), which may close the connection
+                     */
+                    irc_server_msgq_flush_server (server, 0);
+                    if (server->sock == -1)
+                        break;
                     weechat_printf (
                         server->buffer,
                         _("%s%s: reading data on socket: error %d %s"),
                         weechat_prefix ("error"), IRC_PLUGIN_NAME,
-                        errno,
+                        error,
                         (num_read == 0) ? _("(connection closed by peer)") :
-                        strerror (errno));
+                        strerror (error));
                     weechat_printf (
                         server->buffer,
                         _("%s%s: disconnecting from server..."),
@@ -3243,7 +3908,12 @@ irc_server_recv_cb (const void *pointer, void *data, int fd)
     }
 
     if (msgq_flush)
-        irc_server_msgq_flush ();
+    {
+        irc_server_msgq_flush_server (
+            server,
+            weechat_config_integer (irc_config_network_recv_max_messages));
+        irc_server_msgq_schedule ();
+    }
 
     return WEECHAT_RC_OK;
 }
@@ -3416,11 +4086,22 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
         }
         else
         {
+            /* send data not yet sent (socket was full) */
+            if ((ptr_server->sock != -1)
+                && (ptr_server->send_buffer_length > 0))
+            {
+                irc_server_send_buffer_flush (ptr_server);
+            }
+
             if (!ptr_server->is_connected)
                 continue;
 
-            /* send queued messages */
-            irc_server_outqueue_send (ptr_server);
+            /*
+             * send queued messages (if not already scheduled, for example
+             * messages queued before the connection was complete)
+             */
+            if (!ptr_server->hook_timer_anti_flood)
+                irc_server_outqueue_send (ptr_server);
 
             /* check for lag */
             if ((weechat_config_integer (irc_config_network_lag_check) > 0)
@@ -3588,6 +4269,12 @@ irc_server_close_connection (struct t_irc_server *server)
         server->hook_timer_sasl = NULL;
     }
 
+    if (server->hook_timer_anti_flood)
+    {
+        weechat_unhook (server->hook_timer_anti_flood);
+        server->hook_timer_anti_flood = NULL;
+    }
+
     if (server->hook_fd)
     {
         weechat_unhook (server->hook_fd);
@@ -3627,6 +4314,9 @@ irc_server_close_connection (struct t_irc_server *server)
         free (server->unterminated_message);
         server->unterminated_message = NULL;
     }
+    server->recv_buffer_length = 0;
+    irc_server_msgq_free_all (server);
+    server->send_buffer_length = 0;
     for (i = 0; i < IRC_SERVER_NUM_OUTQUEUES_PRIO; i++)
     {
         irc_server_outqueue_free_all (server, i);
@@ -5676,6 +6366,7 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, hook_fd, POINTER, 0, NULL, "hook");
         WEECHAT_HDATA_VAR(struct t_irc_server, hook_timer_connection, POINTER, 0, NULL, "hook");
         WEECHAT_HDATA_VAR(struct t_irc_server, hook_timer_sasl, POINTER, 0, NULL, "hook");
+        WEECHAT_HDATA_VAR(struct t_irc_server, hook_timer_anti_flood, POINTER, 0, NULL, "hook");
         WEECHAT_HDATA_VAR(struct t_irc_server, is_connected, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, ssl_connected, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, disconnected, INTEGER, 0, NULL, NULL);
@@ -5685,6 +6376,11 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, tls_cert_key, OTHER, 0, NULL, NULL);
 #endif /* HAVE_GNUTLS */
         WEECHAT_HDATA_VAR(struct t_irc_server, unterminated_message, STRING, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_buffer_size, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_buffer_length, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_msgq_count, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_msgq_processed, LONG, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_msgq_time, LONG, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, nicks_count, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, nicks_array, STRING, 0, "nicks_count", NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, nick_first_tried, INTEGER, 0, NULL, NULL);
@@ -5726,6 +6422,8 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, last_data_purge, TIME, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, outqueue, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, last_outqueue, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, send_buffer_size, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, send_buffer_length, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, redirects, POINTER, 0, NULL, "irc_redirect");
         WEECHAT_HDATA_VAR(struct t_irc_server, last_redirect, POINTER, 0, NULL, "irc_redirect");
         WEECHAT_HDATA_VAR(struct t_irc_server, notify_list, POINTER, 0, NULL, "irc_notify");
@@ -5738,6 +6436,7 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, buffer_as_string, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, channels, POINTER, 0, NULL, "irc_channel");
         WEECHAT_HDATA_VAR(struct t_irc_server, last_channel, POINTER, 0, NULL, "irc_channel");
+        WEECHAT_HDATA_VAR(struct t_irc_server, nicklist_bulk_channel, POINTER, 0, NULL, "irc_channel");
         WEECHAT_HDATA_VAR(struct t_irc_server, prev_server, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_VAR(struct t_irc_server, next_server, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_LIST(irc_servers, WEECHAT_HDATA_LIST_CHECK_POINTERS);
@@ -5878,6 +6577,12 @@ irc_server_add_to_infolist (struct t_infolist *infolist,
     if (!weechat_infolist_new_var_integer (ptr_item, "anti_flood_prio_low",
                                            IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW)))
         return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "anti_flood_burst",
+                                           IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_BURST)))
+        return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "anti_flood_unit",
+                                           IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_UNIT)))
+        return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "away_check",
                                            IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_AWAY_CHECK)))
         return 0;
@@ -6244,6 +6949,20 @@ irc_server_print_log ()
         else
             weechat_log_printf ("  anti_flood_prio_low. : %d",
                                 weechat_config_integer (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW]));
+        /* anti_flood_burst */
+        if (weechat_config_option_is_null (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST]))
+            weechat_log_printf ("  anti_flood_burst . . : null (%d)",
+                                IRC_SERVER_OPTION_INTEGER(ptr_server, IRC_SERVER_OPTION_ANTI_FLOOD_BURST));
+        else
+            weechat_log_printf ("  anti_flood_burst . . : %d",
+                                weechat_config_integer (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST]));
+        /* anti_flood_unit */
+        if (weechat_config_option_is_null (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_UNIT]))
+            weechat_log_printf ("  anti_flood_unit. . . : null ('%s')",
+                                irc_server_anti_flood_unit_string[IRC_SERVER_OPTION_INTEGER(ptr_server, IRC_SERVER_OPTION_ANTI_FLOOD_UNIT)]);
+        else
+            weechat_log_printf ("  anti_flood_unit. . . : '%s'",
+                                irc_server_anti_flood_unit_string[weechat_config_integer (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_UNIT])]);
         /* away_check */
         if (weechat_config_option_is_null (ptr_server->options[IRC_SERVER_OPTION_AWAY_CHECK]))
             weechat_log_printf ("  away_check . . . . . : null (%d)",
@@ -6298,6 +7017,7 @@ irc_server_print_log ()
         weechat_log_printf ("  hook_fd. . . . . . . : 0x%lx", ptr_server->hook_fd);
         weechat_log_printf ("  hook_timer_connection: 0x%lx", ptr_server->hook_timer_connection);
         weechat_log_printf ("  hook_timer_sasl. . . : 0x%lx", ptr_server->hook_timer_sasl);
+        weechat_log_printf ("  hook_timer_anti_flood: 0x%lx", ptr_server->hook_timer_anti_flood);
         weechat_log_printf ("  is_connected . . . . : %d",    ptr_server->is_connected);
         weechat_log_printf ("  ssl_connected. . . . : %d",    ptr_server->ssl_connected);
         weechat_log_printf ("  disconnected . . . . : %d",    ptr_server->disconnected);
@@ -6305,6 +7025,14 @@ irc_server_print_log ()
         weechat_log_printf ("  gnutls_sess. . . . . : 0x%lx", ptr_server->gnutls_sess);
 #endif /* HAVE_GNUTLS */
         weechat_log_printf ("  unterminated_message : '%s'",  ptr_server->unterminated_message);
+        weechat_log_printf ("  recv_buffer. . . . . : 0x%lx", ptr_server->recv_buffer);
+        weechat_log_printf ("  recv_buffer_size . . : %d",    ptr_server->recv_buffer_size);
+        weechat_log_printf ("  recv_buffer_length . : %d",    ptr_server->recv_buffer_length);
+        weechat_log_printf ("  recv_msgq. . . . . . : 0x%lx", ptr_server->recv_msgq);
+        weechat_log_printf ("  last_recv_msgq . . . : 0x%lx", ptr_server->last_recv_msgq);
+        weechat_log_printf ("  recv_msgq_count. . . : %d",    ptr_server->recv_msgq_count);
+        weechat_log_printf ("  recv_msgq_processed. : %ld",   ptr_server->recv_msgq_processed);
+        weechat_log_printf ("  recv_msgq_time . . . : %ld",   ptr_server->recv_msgq_time);
         weechat_log_printf ("  nicks_count. . . . . : %d",    ptr_server->nicks_count);
         weechat_log_printf ("  nicks_array. . . . . : 0x%lx", ptr_server->nicks_array);
         weechat_log_printf ("  nick_first_tried . . : %d",    ptr_server->nick_first_tried);
@@ -6357,6 +7085,9 @@ irc_server_print_log ()
             weechat_log_printf ("  outqueue[%02d] . . . . : 0x%lx", i, ptr_server->outqueue[i]);
             weechat_log_printf ("  last_outqueue[%02d]. . : 0x%lx", i, ptr_server->last_outqueue[i]);
         }
+        weechat_log_printf ("  send_buffer. . . . . : 0x%lx", ptr_server->send_buffer);
+        weechat_log_printf ("  send_buffer_size . . : %d",    ptr_server->send_buffer_size);
+        weechat_log_printf ("  send_buffer_length . : %d",    ptr_server->send_buffer_length);
         weechat_log_printf ("  redirects. . . . . . : 0x%lx", ptr_server->redirects);
         weechat_log_printf ("  last_redirect. . . . : 0x%lx", ptr_server->last_redirect);
         weechat_log_printf ("  notify_list. . . . . : 0x%lx", ptr_server->notify_list);
@@ -6375,6 +7106,7 @@ irc_server_print_log ()
         weechat_log_printf ("  buffer_as_string . . : 0x%lx", ptr_server->buffer_as_string);
         weechat_log_printf ("  channels . . . . . . : 0x%lx", ptr_server->channels);
         weechat_log_printf ("  last_channel . . . . : 0x%lx", ptr_server->last_channel);
+        weechat_log_printf ("  nicklist_bulk_channel: 0x%lx", ptr_server->nicklist_bulk_channel);
         weechat_log_printf ("  prev_server. . . . . : 0x%lx", ptr_server->prev_server);
         weechat_log_printf ("  next_server. . . . . : 0x%lx", ptr_server->next_server);
 
@@ -42,6 +42,14 @@ enum t_irc_server_sasl_fail
     IRC_SERVER_NUM_SASL_FAIL,
 };
 
+enum t_irc_server_anti_flood_unit
+{
+    IRC_SERVER_ANTI_FLOOD_UNIT_SECONDS = 0,
+    IRC_SERVER_ANTI_FLOOD_UNIT_MILLISECONDS,
+    /* number of anti-flood units */
+    IRC_SERVER_NUM_ANTI_FLOOD_UNIT,
+};
+
 enum t_irc_server_option
 {
     IRC_SERVER_OPTION_ADDRESSES = 0, /* server addresses (IP/name with port) */
@@ -78,6 +86,8 @@ enum t_irc_server_option
     IRC_SERVER_OPTION_CONNECTION_TIMEOUT,   /* timeout for connection        */
     IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH, /* anti-flood (high priority)    */
     IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_LOW,  /* anti-flood (low priority)     */
+    IRC_SERVER_OPTION_ANTI_FLOOD_BURST,     /* anti-flood burst (messages)   */
+    IRC_SERVER_OPTION_ANTI_FLOOD_UNIT,      /* unit of anti-flood delays     */
     IRC_SERVER_OPTION_AWAY_CHECK,           /* delay between away checks     */
     IRC_SERVER_OPTION_AWAY_CHECK_MAX_NICKS, /* max nicks for away check      */
     IRC_SERVER_OPTION_MSG_KICK,             /* default kick message          */
@@ -135,7 +145,10 @@ enum t_irc_server_casemapping
     IRC_SERVER_NUM_CASEMAPPING,
 };
 
-/* output queue of messages to server (for sending slowly to server) */
+/*
+ * output queue of messages to server (for sending slowly to server);
+ * strings are allocated with the structure (only one allocation by message)
+ */
 
 struct t_irc_outqueue
 {
@@ -175,6 +188,7 @@ struct t_irc_server
     struct t_hook *hook_fd;         /* hook for server socket                */
     struct t_hook *hook_timer_connection; /* timer for connection            */
     struct t_hook *hook_timer_sasl; /* timer for SASL authentication         */
+    struct t_hook *hook_timer_anti_flood; /* timer to send queued messages   */
     int is_connected;               /* 1 if WeeChat is connected to server   */
     int ssl_connected;              /* = 1 if connected with SSL             */
     int disconnected;               /* 1 if server has been disconnected     */
@@ -184,6 +198,16 @@ struct t_irc_server
     gnutls_x509_privkey_t tls_cert_key; /* key used if ssl_cert is set       */
 #endif /* HAVE_GNUTLS */
     char *unterminated_message;     /* beginning of a message in input buf   */
+    char *recv_buffer;              /* buffer for data read on socket        */
+    int recv_buffer_size;           /* size of recv buffer                   */
+    int recv_buffer_length;         /* length of data in recv buffer         */
+                                    /* (beginning of unterminated message)   */
+    struct t_irc_message *recv_msgq;         /* received messages (queue)    */
+    struct t_irc_message *last_recv_msgq;    /* last received message        */
+    int recv_msgq_count;            /* number of messages in queue           */
+    long recv_msgq_processed;       /* number of messages processed          */
+    long recv_msgq_time;            /* time spent to process messages        */
+                                    /* (in microseconds)                     */
     int nicks_count;                /* number of nicknames                   */
     char **nicks_array;             /* nicknames (after split)               */
     int nick_first_tried;           /* first nick tried in list of nicks     */
@@ -225,11 +249,16 @@ struct t_irc_server
     time_t lag_last_refresh;        /* last refresh of lag item              */
     regex_t *cmd_list_regexp;       /* compiled Regular Expression for /list */
     time_t last_user_message;       /* time of last user message (anti flood)*/
+    struct timeval anti_flood_time; /* anti-flood: time when all messages    */
+                                    /* sent are "paid" (token bucket)        */
     time_t last_away_check;         /* time of last away check on server     */
     time_t last_data_purge;         /* time of last purge (some hashtables)  */
     struct t_irc_outqueue *outqueue[2];      /* queue for outgoing messages  */
                                              /* with 2 priorities (high/low) */
     struct t_irc_outqueue *last_outqueue[2]; /* last outgoing message        */
+    char *send_buffer;              /* data waiting to be sent to server     */
+    int send_buffer_size;           /* size of send buffer (allocated)       */
+    int send_buffer_length;         /* length of data in send buffer         */
     struct t_irc_redirect *redirects;        /* command redirections         */
     struct t_irc_redirect *last_redirect;    /* last command redirection     */
     struct t_irc_notify *notify_list;        /* list of notify               */
@@ -242,6 +271,8 @@ struct t_irc_server
     char *buffer_as_string;               /* used to return buffer info      */
     struct t_irc_channel *channels;       /* opened channels on server       */
     struct t_irc_channel *last_channel;   /* last opened channel on server   */
+    struct t_irc_channel *nicklist_bulk_channel; /* channel with nicklist   */
+                                          /* in bulk mode (names received)   */
     struct t_irc_server *prev_server;     /* link to previous server         */
     struct t_irc_server *next_server;     /* link to next server             */
 };
@@ -273,8 +304,8 @@ extern struct t_irc_server *irc_servers;
 extern const int gnutls_cert_type_prio[];
 extern const int gnutls_prot_prio[];
 #endif /* HAVE_GNUTLS */
-extern struct t_irc_message *irc_recv_msgq, *irc_msgq_last_msg;
 extern char *irc_server_sasl_fail_string[];
+extern char *irc_server_anti_flood_unit_string[];
 extern char *irc_server_options[][2];
 
 extern int irc_server_valid (struct t_irc_server *server);
@@ -284,6 +315,7 @@ extern int irc_server_search_option (const char *option_name);
 extern int irc_server_search_casemapping (const char *casemapping);
 extern int irc_server_strcasecmp (struct t_irc_server *server,
                                   const char *string1, const char *string2);
+extern void irc_server_tolower (struct t_irc_server *server, char *string);
 extern int irc_server_strncasecmp (struct t_irc_server *server,
                                    const char *string1, const char *string2,
                                    int max);
@@ -336,13 +368,28 @@ extern void irc_server_send_signal (struct t_irc_server *server,
                                     const char *full_message,
                                     const char *tags);
 extern void irc_server_set_send_default_tags (const char *tags);
+extern int irc_server_send_buffer_add (struct t_irc_server *server,
+                                       const char *message, int length);
+extern int irc_server_send_buffer_flush (struct t_irc_server *server);
+extern long long irc_server_anti_flood_wait (struct t_irc_server *server,
+                                            int priority);
+extern void irc_server_anti_flood_sent (struct t_irc_server *server,
+                                        int priority);
+extern void irc_server_outqueue_send (struct t_irc_server *server);
 extern struct t_hashtable *irc_server_sendf (struct t_irc_server *server,
                                              int flags,
                                              const char *tags,
                                              const char *format, ...);
 extern void irc_server_msgq_add_buffer (struct t_irc_server *server,
                                         const char *buffer);
+extern void irc_server_msgq_free_all (struct t_irc_server *server);
+extern void irc_server_msgq_flush_server (struct t_irc_server *server,
+                                          int max_messages);
+extern void irc_server_msgq_schedule ();
 extern void irc_server_msgq_flush ();
+extern void irc_server_recv_buffer_split (struct t_irc_server *server);
+extern void irc_server_recv_buffer_flush (struct t_irc_server *server);
+extern int irc_server_recv_buffer_alloc (struct t_irc_server *server);
 extern void irc_server_set_buffer_title (struct t_irc_server *server);
 extern struct t_gui_buffer *irc_server_create_buffer (struct t_irc_server *server);
 #ifdef HAVE_GNUTLS
@@ -367,6 +414,7 @@ extern void irc_server_remove_away (struct t_irc_server *server);
 extern void irc_server_check_away (struct t_irc_server *server);
 extern void irc_server_switch_address (struct t_irc_server *server,
                                        int connection);
+extern void irc_server_close_connection (struct t_irc_server *server);
 extern void irc_server_disconnect (struct t_irc_server *server,
                                    int switch_address, int reconnect);
 extern void irc_server_disconnect_all ();
@@ -69,7 +69,9 @@ irc_upgrade_save_all_data (struct t_upgrade_file *upgrade_file)
     for (ptr_server = irc_servers; ptr_server;
          ptr_server = ptr_server->next_server)
     {
-        /* save server */
+        /* save server (after processing of pending received messages) */
+        irc_server_recv_buffer_flush (ptr_server);
+        irc_server_msgq_flush_server (ptr_server, 0);
         infolist = weechat_infolist_new ();
         if (!infolist)
             return 0;
@@ -311,6 +313,8 @@ irc_upgrade_set_buffer_callbacks ()
                                                    "localvar_server"));
                     weechat_buffer_set_pointer (ptr_buffer, "nickcmp_callback",
                                                 &irc_buffer_nickcmp_cb);
+                    weechat_buffer_set (ptr_buffer, "nickcmp_case_range",
+                                        "30");
                     if (ptr_server)
                     {
                         weechat_buffer_set_pointer (ptr_buffer,
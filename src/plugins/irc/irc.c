@@ -299,5 +299,7 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     irc_color_end ();
 
+    irc_protocol_end ();
+
     return WEECHAT_RC_OK;
 }
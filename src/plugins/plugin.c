@@ -698,6 +698,7 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->hashtable_dup = &hashtable_dup;
         new_plugin->hashtable_get_integer = &hashtable_get_integer;
         new_plugin->hashtable_get_string = &hashtable_get_string;
+        new_plugin->hashtable_set_arena = &hashtable_set_arena;
         new_plugin->hashtable_set_pointer = &hashtable_set_pointer;
         new_plugin->hashtable_add_to_infolist = &hashtable_add_to_infolist;
         new_plugin->hashtable_add_from_infolist = &hashtable_add_from_infolist;
@@ -774,6 +775,7 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->hook_completion_list_add = &hook_completion_list_add;
         new_plugin->hook_modifier = &hook_modifier;
         new_plugin->hook_modifier_exec = &hook_modifier_exec;
+        new_plugin->hook_modifier_has_hooks = &hook_modifier_has_hooks;
         new_plugin->hook_info = &hook_info;
         new_plugin->hook_info_hashtable = &hook_info_hashtable;
         new_plugin->hook_infolist = &hook_infolist;
@@ -876,6 +878,9 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->hdata_check_pointer = &hdata_check_pointer;
         new_plugin->hdata_move = &hdata_move;
         new_plugin->hdata_search = &hdata_search;
+        new_plugin->hdata_compile_keys = &hdata_compile_keys;
+        new_plugin->hdata_get_compiled_key = &hdata_get_compiled_key;
+        new_plugin->hdata_free_compiled_keys = &hdata_free_compiled_keys;
         new_plugin->hdata_char = &hdata_char;
         new_plugin->hdata_integer = &hdata_integer;
         new_plugin->hdata_long = &hdata_long;
@@ -41,6 +41,10 @@
 #include "../relay-raw.h"
 
 
+struct t_hashtable *relay_weechat_msg_compiled_keys = NULL;
+                                       /* compiled keys for fixed lists     */
+
+
 /*
  * Builds a new message (for sending to client).
  *
@@ -65,6 +69,9 @@ relay_weechat_msg_new (const char *id)
     }
     new_msg->data_alloc = RELAY_WEECHAT_MSG_INITIAL_ALLOC;
     new_msg->data_size = 0;
+    new_msg->data_zlib = NULL;
+    new_msg->data_zlib_size = 0;
+    new_msg->data_zlib_time = 0;
 
     /* add size and compression flag (they will be set later) */
     relay_weechat_msg_add_int (new_msg, 0);
@@ -332,14 +339,15 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
                                   void **path_pointers,
                                   struct t_hdata *hdata,
                                   void *pointer,
-                                  char **list_keys)
+                                  struct t_hdata_keys *keys,
+                                  int num_keys)
 {
     int num_added, i, j, count, count_all, var_type, array_size, max_array_size;
-    int length;
+    int length, index, offset;
     char *pos, *pos2, *str_count, *error, *name;
-    void *sub_pointer;
+    void *sub_pointer, *ptr_value;
     struct t_hdata *sub_hdata;
-    const char *sub_hdata_name;
+    const char *sub_hdata_name, *key_name, *str_array_size;
 
     num_added = 0;
 
@@ -400,7 +408,8 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
                                                                    path_pointers,
                                                                    sub_hdata,
                                                                    sub_pointer,
-                                                                   list_keys);
+                                                                   keys,
+                                                                   num_keys);
                 }
             }
         }
@@ -411,15 +420,59 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
             {
                 relay_weechat_msg_add_pointer (msg, path_pointers[i]);
             }
-            for (i = 0; list_keys[i]; i++)
+            for (i = 0; i < num_keys; i++)
             {
-                var_type = weechat_hdata_get_var_type (hdata, list_keys[i]);
-                if ((var_type >= 0) && (var_type != WEECHAT_HDATA_OTHER))
+                if (!weechat_hdata_get_compiled_key (keys, i, &key_name,
+                                                     &index, &var_type,
+                                                     &offset, &str_array_size)
+                    || (index >= 0) || (var_type == WEECHAT_HDATA_OTHER))
+                {
+                    continue;
+                }
+                if (!str_array_size)
+                {
+                    /* not an array: read value at its offset in object */
+                    ptr_value = pointer + offset;
+                    switch (var_type)
+                    {
+                        case WEECHAT_HDATA_CHAR:
+                            relay_weechat_msg_add_char (msg,
+                                                        *((char *)ptr_value));
+                            break;
+                        case WEECHAT_HDATA_INTEGER:
+                            relay_weechat_msg_add_int (msg,
+                                                       *((int *)ptr_value));
+                            break;
+                        case WEECHAT_HDATA_LONG:
+                            relay_weechat_msg_add_long (msg,
+                                                        *((long *)ptr_value));
+                            break;
+                        case WEECHAT_HDATA_STRING:
+                        case WEECHAT_HDATA_SHARED_STRING:
+                            relay_weechat_msg_add_string (msg,
+                                                          *((char **)ptr_value));
+                            break;
+                        case WEECHAT_HDATA_POINTER:
+                            relay_weechat_msg_add_pointer (msg,
+                                                           *((void **)ptr_value));
+                            break;
+                        case WEECHAT_HDATA_TIME:
+                            relay_weechat_msg_add_time (msg,
+                                                        *((time_t *)ptr_value));
+                            break;
+                        case WEECHAT_HDATA_HASHTABLE:
+                            relay_weechat_msg_add_hashtable (msg,
+                                                             *((struct t_hashtable **)ptr_value));
+                            break;
+                    }
+                }
+                else
                 {
+                    /* array: read each item with index in name */
                     max_array_size = 1;
                     array_size = weechat_hdata_get_var_array_size (hdata,
                                                                    pointer,
-                                                                   list_keys[i]);
+                                                                   key_name);
                     if (array_size >= 0)
                     {
                         switch (var_type)
@@ -450,13 +503,13 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
                         relay_weechat_msg_add_int (msg, array_size);
                         max_array_size = array_size;
                     }
-                    length = 16 + strlen (list_keys[i]) + 1;
+                    length = 16 + strlen (key_name) + 1;
                     name = malloc (length);
                     if (name)
                     {
                         for (j = 0; j < max_array_size; j++)
                         {
-                            snprintf (name, length, "%d|%s", j, list_keys[i]);
+                            snprintf (name, length, "%d|%s", j, key_name);
                             switch (var_type)
                             {
                                 case WEECHAT_HDATA_CHAR:
@@ -533,6 +586,105 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
     return num_added;
 }
 
+/*
+ * Callback called to free compiled keys in hashtable.
+ */
+
+void
+relay_weechat_msg_free_compiled_keys_cb (struct t_hashtable *hashtable,
+                                         const void *key, void *value)
+{
+    struct t_relay_weechat_msg_keys *ptr_keys;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    ptr_keys = (struct t_relay_weechat_msg_keys *)value;
+    if (ptr_keys)
+    {
+        weechat_hdata_free_compiled_keys (ptr_keys->keys);
+        free (ptr_keys);
+    }
+}
+
+/*
+ * Gets compiled keys for a fixed list of keys of an hdata: keys are compiled
+ * on first call and kept until the end of plugin.
+ *
+ * Note: this must be used only for lists of keys set by relay (like the ones
+ * sent with signals "buffer_*") and for hdata of WeeChat core, which are not
+ * freed while relay plugin is loaded.
+ *
+ * Returns pointer to compiled keys, NULL if error.
+ */
+
+struct t_hdata_keys *
+relay_weechat_msg_get_compiled_keys (struct t_hdata *hdata,
+                                     const char *hdata_name,
+                                     const char *keys, int *num_keys)
+{
+    struct t_relay_weechat_msg_keys *ptr_keys;
+    char str_key[1024];
+    int length;
+
+    *num_keys = 0;
+
+    length = snprintf (str_key, sizeof (str_key), "%s:%s", hdata_name, keys);
+    if ((length < 0) || (length >= (int)sizeof (str_key)))
+        return NULL;
+
+    if (!relay_weechat_msg_compiled_keys)
+    {
+        relay_weechat_msg_compiled_keys = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!relay_weechat_msg_compiled_keys)
+            return NULL;
+        weechat_hashtable_set_pointer (relay_weechat_msg_compiled_keys,
+                                       "callback_free_value",
+                                       &relay_weechat_msg_free_compiled_keys_cb);
+    }
+
+    ptr_keys = weechat_hashtable_get (relay_weechat_msg_compiled_keys,
+                                      str_key);
+    if (!ptr_keys)
+    {
+        ptr_keys = malloc (sizeof (*ptr_keys));
+        if (!ptr_keys)
+            return NULL;
+        ptr_keys->keys = weechat_hdata_compile_keys (hdata, keys,
+                                                     &ptr_keys->num_keys);
+        if (!ptr_keys->keys)
+        {
+            free (ptr_keys);
+            return NULL;
+        }
+        weechat_hashtable_set (relay_weechat_msg_compiled_keys,
+                               str_key, ptr_keys);
+    }
+
+    *num_keys = ptr_keys->num_keys;
+
+    return ptr_keys->keys;
+}
+
+/*
+ * Frees all compiled keys kept for fixed lists of keys.
+ */
+
+void
+relay_weechat_msg_free_compiled_keys ()
+{
+    if (relay_weechat_msg_compiled_keys)
+    {
+        weechat_hashtable_free (relay_weechat_msg_compiled_keys);
+        relay_weechat_msg_compiled_keys = NULL;
+    }
+}
+
 /*
  * Adds a hdata to a message.
  *
@@ -543,6 +695,11 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
  * Argument keys is optional: if not NULL, comma-separated list of keys to
  * return for hdata.
  *
+ * If cache_keys is 1, the keys are a fixed list set by relay and their
+ * compiled keys are kept for next messages (see function
+ * relay_weechat_msg_get_compiled_keys), otherwise (for example keys received
+ * from a client) they are compiled for this message only.
+ *
  * Returns:
  *   1: hdata added to message
  *   0: error (hdata NOT added to message)
@@ -550,21 +707,24 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
 
 int
 relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
-                             const char *path, const char *keys)
+                             const char *path, const char *keys,
+                             int cache_keys)
 {
     struct t_hdata *ptr_hdata_head, *ptr_hdata;
-    char *hdata_head, *pos, **list_keys, *keys_types, **list_path;
+    struct t_hdata_keys *compiled_keys, *ptr_compiled_keys;
+    char *hdata_head, *pos, *keys_types, **list_path;
     char *path_returned;
-    const char *hdata_name, *array_size;
+    const char *hdata_name, *key_name, *array_size;
     void *pointer, **path_pointers;
     unsigned long value;
-    int rc, num_keys, num_path, i, type, pos_count, count, rc_sscanf;
+    int rc, num_keys, num_path, i, index, type, pos_count, count, rc_sscanf;
     uint32_t count32;
 
     rc = 0;
 
     hdata_head = NULL;
-    list_keys = NULL;
+    compiled_keys = NULL;
+    ptr_compiled_keys = NULL;
     num_keys = 0;
     keys_types = NULL;
     list_path = NULL;
@@ -632,6 +792,7 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
     if (!path_returned)
         goto end;
     ptr_hdata = ptr_hdata_head;
+    hdata_name = hdata_head;
     strcpy (path_returned, hdata_head);
     for (i = 1; i < num_path; i++)
     {
@@ -650,15 +811,24 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
             pos[0] = '(';
     }
 
-    /* split keys */
+    /*
+     * compile keys: variables are searched only once (and not for each
+     * object sent), and only once for all messages with a fixed list of keys
+     */
     if (!keys)
         keys = weechat_hdata_get_string (ptr_hdata, "var_keys");
-    list_keys = weechat_string_split (keys, ",", NULL,
-                                      WEECHAT_STRING_SPLIT_STRIP_LEFT
-                                      | WEECHAT_STRING_SPLIT_STRIP_RIGHT
-                                      | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
-                                      0, &num_keys);
-    if (!list_keys)
+    if (cache_keys)
+    {
+        ptr_compiled_keys = relay_weechat_msg_get_compiled_keys (
+            ptr_hdata, hdata_name, keys, &num_keys);
+    }
+    else
+    {
+        compiled_keys = weechat_hdata_compile_keys (ptr_hdata, keys,
+                                                    &num_keys);
+        ptr_compiled_keys = compiled_keys;
+    }
+    if (!ptr_compiled_keys || (num_keys == 0))
         goto end;
 
     /* build string with list of keys with types: "key1:type1,key2:type2,..." */
@@ -668,16 +838,14 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
     keys_types[0] = '\0';
     for (i = 0; i < num_keys; i++)
     {
-        type = weechat_hdata_get_var_type (ptr_hdata, list_keys[i]);
-        if ((type >= 0) && (type != WEECHAT_HDATA_OTHER))
+        if (weechat_hdata_get_compiled_key (ptr_compiled_keys, i, &key_name,
+                                            &index, &type, NULL, &array_size)
+            && (index < 0) && (type != WEECHAT_HDATA_OTHER))
         {
             if (keys_types[0])
                 strcat (keys_types, ",");
-            strcat (keys_types, list_keys[i]);
+            strcat (keys_types, key_name);
             strcat (keys_types, ":");
-            array_size = weechat_hdata_get_var_array_size_string (ptr_hdata,
-                                                                  NULL,
-                                                                  list_keys[i]);
             if (array_size)
                 strcat (keys_types, RELAY_WEECHAT_MSG_OBJ_ARRAY);
             else
@@ -731,7 +899,8 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
                                                   path_pointers,
                                                   ptr_hdata_head,
                                                   pointer,
-                                                  list_keys);
+                                                  ptr_compiled_keys,
+                                                  num_keys);
         free (path_pointers);
     }
     count32 = htonl ((uint32_t)count);
@@ -740,8 +909,8 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
     rc = 1;
 
 end:
-    if (list_keys)
-        weechat_string_free_split (list_keys);
+    if (compiled_keys)
+        weechat_hdata_free_compiled_keys (compiled_keys);
     if (keys_types)
         free (keys_types);
     if (list_path)
@@ -1027,19 +1196,171 @@ relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
 }
 
 /*
- * Sends a message.
+ * Compresses a message with zlib.
+ *
+ * The compressed message is computed only once and kept in the message, so
+ * that the same message sent to many clients is compressed only one time.
+ *
+ * Returns:
+ *   1: message compressed (msg->data_zlib is set)
+ *   0: compression failed or useless (compressed message is bigger)
  */
 
-void
-relay_weechat_msg_send (struct t_relay_client *client,
-                        struct t_relay_weechat_msg *msg)
+int
+relay_weechat_msg_compress_zlib (struct t_relay_weechat_msg *msg)
 {
     uint32_t size32;
-    char compression, raw_message[1024];
     int rc;
     Bytef *dest;
     uLongf dest_size;
     struct timeval tv1, tv2;
+
+    if (msg->data_zlib)
+        return 1;
+    if (msg->data_zlib_size < 0)
+        return 0;
+
+    /* compression will be done only once, even if it fails */
+    msg->data_zlib_size = -1;
+
+    dest_size = compressBound (msg->data_size - 5);
+    dest = malloc (dest_size + 5);
+    if (!dest)
+        return 0;
+
+    gettimeofday (&tv1, NULL);
+    rc = compress2 (dest + 5, &dest_size,
+                    (Bytef *)(msg->data + 5), msg->data_size - 5,
+                    weechat_config_integer (relay_config_network_compression_level));
+    gettimeofday (&tv2, NULL);
+    if ((rc != Z_OK) || ((int)dest_size + 5 >= msg->data_size))
+    {
+        free (dest);
+        return 0;
+    }
+
+    /* set size and compression flag */
+    size32 = htonl ((uint32_t)(dest_size + 5));
+    memcpy (dest, &size32, 4);
+    dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
+
+    msg->data_zlib = (char *)dest;
+    msg->data_zlib_size = dest_size + 5;
+    msg->data_zlib_time = weechat_util_timeval_diff (&tv1, &tv2);
+
+    return 1;
+}
+
+/*
+ * Compresses a message with the zlib stream of client (the stream is created
+ * on first call).
+ *
+ * The stream is flushed (Z_SYNC_FLUSH) at the end of each message, so that
+ * the client can decompress the message immediately, with a single zlib
+ * stream for the whole connection: small messages are compressed with the
+ * history of previous messages, which is much better than compressing each
+ * message separately.
+ *
+ * Returns the compressed message, with size and compression flag, NULL if
+ * error (in this case, the zlib compression without stream is used for this
+ * client, for all next messages).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+relay_weechat_msg_compress_zlib_stream (struct t_relay_client *client,
+                                        struct t_relay_weechat_msg *msg,
+                                        int *size, long long *time_diff)
+{
+    z_stream *stream;
+    uint32_t size32;
+    Bytef *dest, *dest2;
+    uLong dest_size;
+    struct timeval tv1, tv2;
+    int rc;
+
+    stream = RELAY_WEECHAT_DATA(client, zlib_stream);
+    if (!stream)
+    {
+        stream = calloc (1, sizeof (*stream));
+        if (!stream)
+            return NULL;
+        if (deflateInit (stream, weechat_config_integer (relay_config_network_compression_level)) != Z_OK)
+        {
+            free (stream);
+            return NULL;
+        }
+        RELAY_WEECHAT_DATA(client, zlib_stream) = stream;
+    }
+
+    gettimeofday (&tv1, NULL);
+
+    dest_size = deflateBound (stream, msg->data_size - 5) + 5 + 16;
+    dest = malloc (dest_size);
+    if (!dest)
+        goto error;
+
+    stream->next_in = (Bytef *)(msg->data + 5);
+    stream->avail_in = msg->data_size - 5;
+    stream->next_out = dest + 5;
+    stream->avail_out = dest_size - 5;
+    while (1)
+    {
+        rc = deflate (stream, Z_SYNC_FLUSH);
+        if ((rc != Z_OK) && (rc != Z_BUF_ERROR))
+            goto error;
+        if (stream->avail_out > 0)
+            break;
+        /* not enough space in output buffer: make it bigger */
+        dest2 = realloc (dest, dest_size * 2);
+        if (!dest2)
+            goto error;
+        dest = dest2;
+        stream->next_out = dest + dest_size;
+        stream->avail_out = dest_size;
+        dest_size *= 2;
+    }
+    dest_size -= stream->avail_out;
+
+    gettimeofday (&tv2, NULL);
+
+    /* set size and compression flag */
+    size32 = htonl ((uint32_t)dest_size);
+    memcpy (dest, &size32, 4);
+    dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM;
+
+    *size = dest_size;
+    *time_diff = weechat_util_timeval_diff (&tv1, &tv2);
+
+    return (char *)dest;
+
+error:
+    /*
+     * the stream is in an unknown state (data may have been sent to the
+     * stream), so it can not be used any more
+     */
+    if (dest)
+        free (dest);
+    relay_weechat_free_zlib_stream (client);
+    RELAY_WEECHAT_DATA(client, compression) = RELAY_WEECHAT_COMPRESSION_ZLIB;
+    return NULL;
+}
+
+/*
+ * Sends a message.
+ *
+ * The message can be sent to many clients (it is not modified, except the
+ * size and compression flag).
+ */
+
+void
+relay_weechat_msg_send (struct t_relay_client *client,
+                        struct t_relay_weechat_msg *msg)
+{
+    uint32_t size32;
+    char compression, raw_message[1024], *dest;
+    int dest_size;
     long long time_diff;
 
     if (weechat_config_integer (relay_config_network_compression_level) > 0)
@@ -1047,41 +1368,46 @@ relay_weechat_msg_send (struct t_relay_client *client,
         switch (RELAY_WEECHAT_DATA(client, compression))
         {
             case RELAY_WEECHAT_COMPRESSION_ZLIB:
-                dest_size = compressBound (msg->data_size - 5);
-                dest = malloc (dest_size + 5);
+                if (relay_weechat_msg_compress_zlib (msg))
+                {
+                    /* display message in raw buffer */
+                    snprintf (raw_message, sizeof (raw_message),
+                              "obj: %d/%d bytes (%d%%, %.2fms), id: %s",
+                              msg->data_zlib_size,
+                              msg->data_size,
+                              100 - ((msg->data_zlib_size * 100) / msg->data_size),
+                              ((float)msg->data_zlib_time) / 1000,
+                              msg->id);
+
+                    /* send compressed data */
+                    relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
+                                       msg->data_zlib, msg->data_zlib_size,
+                                       raw_message);
+                    return;
+                }
+                break;
+            case RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM:
+                dest = relay_weechat_msg_compress_zlib_stream (client, msg,
+                                                               &dest_size,
+                                                               &time_diff);
                 if (dest)
                 {
-                    gettimeofday (&tv1, NULL);
-                    rc = compress2 (dest + 5, &dest_size,
-                                    (Bytef *)(msg->data + 5), msg->data_size - 5,
-                                    weechat_config_integer (relay_config_network_compression_level));
-                    gettimeofday (&tv2, NULL);
-                    time_diff = weechat_util_timeval_diff (&tv1, &tv2);
-                    if ((rc == Z_OK) && ((int)dest_size + 5 < msg->data_size))
-                    {
-                        /* set size and compression flag */
-                        size32 = htonl ((uint32_t)(dest_size + 5));
-                        memcpy (dest, &size32, 4);
-                        dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
-
-                        /* display message in raw buffer */
-                        snprintf (raw_message, sizeof (raw_message),
-                                  "obj: %d/%d bytes (%d%%, %.2fms), id: %s",
-                                  (int)dest_size + 5,
-                                  msg->data_size,
-                                  100 - ((((int)dest_size + 5) * 100) / msg->data_size),
-                                  ((float)time_diff) / 1000,
-                                  msg->id);
-
-                        /* send compressed data */
-                        relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
-                                           (const char *)dest, dest_size + 5,
-                                           raw_message);
-
-                        free (dest);
-                        return;
-                    }
+                    /* display message in raw buffer */
+                    snprintf (raw_message, sizeof (raw_message),
+                              "obj: %d/%d bytes (%d%%, %.2fms, stream), "
+                              "id: %s",
+                              dest_size,
+                              msg->data_size,
+                              100 - ((dest_size * 100) / msg->data_size),
+                              ((float)time_diff) / 1000,
+                              msg->id);
+
+                    /* send compressed data */
+                    relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
+                                       dest, dest_size, raw_message);
+
                     free (dest);
+                    return;
                 }
                 break;
             default:
@@ -1118,6 +1444,8 @@ relay_weechat_msg_free (struct t_relay_weechat_msg *msg)
         free (msg->id);
     if (msg->data)
         free (msg->data);
+    if (msg->data_zlib)
+        free (msg->data_zlib);
 
     free (msg);
 }
@@ -40,12 +40,23 @@ struct t_relay_weechat_nicklist;
 #define RELAY_WEECHAT_MSG_OBJ_INFOLIST  "inl"
 #define RELAY_WEECHAT_MSG_OBJ_ARRAY     "arr"
 
+struct t_relay_weechat_msg_keys
+{
+    struct t_hdata_keys *keys;         /* compiled keys                     */
+    int num_keys;                      /* number of keys                    */
+};
+
 struct t_relay_weechat_msg
 {
     char *id;                          /* message id                        */
     char *data;                        /* binary buffer                     */
     int data_alloc;                    /* currently allocated size          */
     int data_size;                     /* current size of buffer            */
+    char *data_zlib;                   /* message compressed with zlib      */
+                                       /* (computed once, on first send)    */
+    int data_zlib_size;                /* size of compressed message        */
+                                       /* (-1 = compression useless/failed) */
+    long long data_zlib_time;          /* time spent in compression (usec)  */
 };
 
 extern struct t_relay_weechat_msg *relay_weechat_msg_new (const char *id);
@@ -70,8 +81,16 @@ extern void relay_weechat_msg_add_pointer (struct t_relay_weechat_msg *msg,
                                            void *pointer);
 extern void relay_weechat_msg_add_time (struct t_relay_weechat_msg *msg,
                                         time_t time);
+extern struct t_hashtable *relay_weechat_msg_compiled_keys;
+
+extern struct t_hdata_keys *relay_weechat_msg_get_compiled_keys (struct t_hdata *hdata,
+                                                                 const char *hdata_name,
+                                                                 const char *keys,
+                                                                 int *num_keys);
+extern void relay_weechat_msg_free_compiled_keys ();
 extern int relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
-                                        const char *path, const char *keys);
+                                        const char *path, const char *keys,
+                                        int cache_keys);
 extern void relay_weechat_msg_add_infolist (struct t_relay_weechat_msg *msg,
                                             const char *name,
                                             void *pointer,
@@ -79,6 +98,11 @@ extern void relay_weechat_msg_add_infolist (struct t_relay_weechat_msg *msg,
 extern void relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
                                             struct t_gui_buffer *buffer,
                                             struct t_relay_weechat_nicklist *nicklist);
+extern int relay_weechat_msg_compress_zlib (struct t_relay_weechat_msg *msg);
+extern char *relay_weechat_msg_compress_zlib_stream (struct t_relay_client *client,
+                                                    struct t_relay_weechat_msg *msg,
+                                                    int *size,
+                                                    long long *time_diff);
 extern void relay_weechat_msg_send (struct t_relay_client *client,
                                     struct t_relay_weechat_msg *msg);
 extern void relay_weechat_msg_free (struct t_relay_weechat_msg *msg);
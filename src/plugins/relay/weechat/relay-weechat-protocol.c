@@ -164,6 +164,7 @@ relay_weechat_protocol_is_sync (struct t_relay_client *ptr_client,
  * Message looks like:
  *   init password=mypass
  *   init password=mypass,compression=zlib
+ *   init password=mypass,compression=zlib_stream
  *   init password=mypass,compression=off
  */
 
@@ -226,8 +227,31 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(init)
                 else if (strcmp (options[i], "compression") == 0)
                 {
                     compression = relay_weechat_compression_search (pos);
-                    if (compression >= 0)
-                        RELAY_WEECHAT_DATA(client, compression) = compression;
+                    if ((compression >= 0)
+                        && (compression != (int)RELAY_WEECHAT_DATA(client, compression)))
+                    {
+                        /*
+                         * the compression can not be changed once the zlib
+                         * stream is started (the client decompresses all
+                         * messages with the same stream)
+                         */
+                        if (RELAY_WEECHAT_DATA(client, zlib_stream))
+                        {
+                            weechat_printf (NULL,
+                                            _("%s%s: compression can not be "
+                                              "changed for client %s%s%s "
+                                              "(zlib stream already used)"),
+                                            weechat_prefix ("error"),
+                                            RELAY_PLUGIN_NAME,
+                                            RELAY_COLOR_CHAT_CLIENT,
+                                            client->desc,
+                                            RELAY_COLOR_CHAT);
+                        }
+                        else
+                        {
+                            RELAY_WEECHAT_DATA(client, compression) = compression;
+                        }
+                    }
                 }
             }
         }
@@ -267,7 +291,8 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(hdata)
     if (msg)
     {
         if (!relay_weechat_msg_add_hdata (msg, argv[0],
-                                          (argc > 1) ? argv_eol[1] : NULL))
+                                          (argc > 1) ? argv_eol[1] : NULL,
+                                          0))
         {
             relay_weechat_msg_add_type (msg, RELAY_WEECHAT_MSG_OBJ_HDATA);
             relay_weechat_msg_add_string (msg, NULL);  /* h-path */
@@ -471,6 +496,9 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(input)
 
 /*
  * Callback for signals "buffer_*".
+ *
+ * The message is built (and compressed) only once, and sent to all clients
+ * synchronized with the buffer.
  */
 
 int
@@ -479,215 +507,65 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                          const char *type_data,
                                          void *signal_data)
 {
-    struct t_relay_client *ptr_client;
+    struct t_relay_client *ptr_client, *ptr_prev_client;
     struct t_gui_line *ptr_line;
     struct t_hdata *ptr_hdata_line, *ptr_hdata_line_data;
     struct t_gui_line_data *ptr_line_data;
     struct t_gui_buffer *ptr_buffer;
     struct t_relay_weechat_msg *msg;
     char cmd_hdata[64], str_signal[128];
+    const char *keys;
+    int flags, buffer_closing;
 
     /* make C compiler happy */
+    (void) pointer;
     (void) data;
     (void) type_data;
 
-    ptr_client = (struct t_relay_client *)pointer;
-    if (!ptr_client || !relay_client_valid (ptr_client))
-        return WEECHAT_RC_OK;
+    ptr_buffer = NULL;
+    ptr_line_data = NULL;
+    keys = NULL;
 
-    snprintf (str_signal, sizeof (str_signal), "_%s", signal);
+    /* by default, send signal only if sync with flag "buffers" or "buffer" */
+    flags = RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
+        RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER;
+
+    buffer_closing = 0;
 
     if (strcmp (signal, "buffer_opened") == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,short_name,"
-                                             "nicklist,title,local_variables,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        keys = "number,full_name,short_name,nicklist,title,local_variables,"
+            "prev_buffer,next_buffer";
     }
     else if (strcmp (signal, "buffer_type_changed") == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,type");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        keys = "number,full_name,type";
     }
-    else if (strcmp (signal, "buffer_moved") == 0)
-    {
-        ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
-    }
-    else if ((strcmp (signal, "buffer_merged") == 0)
-             || (strcmp (signal, "buffer_unmerged") == 0))
-    {
-        ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
-    }
-    else if ((strcmp (signal, "buffer_hidden") == 0)
+    else if ((strcmp (signal, "buffer_moved") == 0)
+             || (strcmp (signal, "buffer_merged") == 0)
+             || (strcmp (signal, "buffer_unmerged") == 0)
+             || (strcmp (signal, "buffer_hidden") == 0)
              || (strcmp (signal, "buffer_unhidden") == 0))
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        keys = "number,full_name,prev_buffer,next_buffer";
     }
     else if (strcmp (signal, "buffer_renamed") == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,short_name,"
-                                             "local_variables");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        keys = "number,full_name,short_name,local_variables";
     }
     else if (strcmp (signal, "buffer_title_changed") == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,title");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        keys = "number,full_name,title";
     }
     else if (strncmp (signal, "buffer_localvar_", 16) == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name,local_variables");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        keys = "number,full_name,local_variables";
     }
     else if (strcmp (signal, "buffer_cleared") == 0)
     {
@@ -696,20 +574,8 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        flags = RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER;
+        keys = "number,full_name";
     }
     else if (strcmp (signal, "buffer_line_added") == 0)
     {
@@ -735,56 +601,82 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             return WEECHAT_RC_OK;
 
         /* send signal only if sync with flag "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "line_data:0x%lx",
-                          (unsigned long)ptr_line_data);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "buffer,date,date_printed,"
-                                             "displayed,highlight,tags_array,"
-                                             "prefix,message");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
+        flags = RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER;
+        keys = "buffer,date,date_printed,displayed,highlight,tags_array,"
+            "prefix,message";
     }
     else if (strcmp (signal, "buffer_closing") == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
-        if (!ptr_buffer)
-            return WEECHAT_RC_OK;
+        keys = "number,full_name";
+        buffer_closing = 1;
+    }
+
+    if (!ptr_buffer || !keys)
+        return WEECHAT_RC_OK;
+
+    snprintf (str_signal, sizeof (str_signal), "_%s", signal);
+    if (ptr_line_data)
+    {
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "line_data:0x%lx", (unsigned long)ptr_line_data);
+    }
+    else
+    {
+        snprintf (cmd_hdata, sizeof (cmd_hdata),
+                  "buffer:0x%lx", (unsigned long)ptr_buffer);
+    }
+
+    msg = NULL;
+
+    /*
+     * clients are sent the message in the order they connected (the client
+     * can be disconnected while sending, but it is not freed)
+     */
+    ptr_client = last_relay_client;
+    while (ptr_client)
+    {
+        ptr_prev_client = ptr_client->prev_client;
 
-        /* send signal only if sync with flag "buffers" or "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
+        if ((ptr_client->protocol == RELAY_PROTOCOL_WEECHAT)
+            && ptr_client->protocol_data
+            && RELAY_WEECHAT_DATA(ptr_client, signal_buffer))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
+            if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer, flags))
             {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "number,full_name");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
+                /* build the message on first client synchronized */
+                if (!msg)
+                {
+                    msg = relay_weechat_msg_new (str_signal);
+                    if (msg)
+                    {
+                        relay_weechat_msg_add_hdata (msg, cmd_hdata, keys,
+                                                     1);
+                        relay_weechat_signal_buffer_msgs++;
+                    }
+                }
+                if (msg)
+                    relay_weechat_msg_send (ptr_client, msg);
+            }
+
+            if (buffer_closing)
+            {
+                /* remove buffer from hashtables */
+                weechat_hashtable_remove (
+                    RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
+                    weechat_buffer_get_string (ptr_buffer, "full_name"));
+                weechat_hashtable_remove (
+                    RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
+                    ptr_buffer);
             }
         }
 
-        /* remove buffer from hashtables */
-        weechat_hashtable_remove (
-            RELAY_WEECHAT_DATA(ptr_client, buffers_sync),
-            weechat_buffer_get_string (ptr_buffer, "full_name"));
-        weechat_hashtable_remove (
-            RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
-            ptr_buffer);
+        ptr_client = ptr_prev_client;
     }
 
+    if (msg)
+        relay_weechat_msg_free (msg);
+
     return WEECHAT_RC_OK;
 }
 
@@ -900,6 +792,27 @@ relay_weechat_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
                                          RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
         return WEECHAT_RC_OK;
 
+    /*
+     * many changes in nicklist (end of bulk mode): send whole nicklist
+     * (a nicklist without items and count set to 0 is never sent as diff)
+     */
+    if (strcmp (signal, "nicklist_changed") == 0)
+    {
+        ptr_nicklist = relay_weechat_nicklist_new ();
+        if (!ptr_nicklist)
+            return WEECHAT_RC_OK;
+        weechat_hashtable_set (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
+                               ptr_buffer,
+                               ptr_nicklist);
+        if (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist))
+        {
+            weechat_unhook (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist));
+            RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist) = NULL;
+        }
+        relay_weechat_hook_timer_nicklist (ptr_client);
+        return WEECHAT_RC_OK;
+    }
+
     parent_group = weechat_hashtable_get (hashtable, "parent_group");
     group = weechat_hashtable_get (hashtable, "group");
     nick = weechat_hashtable_get (hashtable, "nick");
@@ -29,6 +29,7 @@
 #include <sys/time.h>
 #include <errno.h>
 #include <arpa/inet.h>
+#include <zlib.h>
 
 #include "../../weechat-plugin.h"
 #include "../relay.h"
@@ -41,7 +42,11 @@
 
 
 char *relay_weechat_compression_string[] = /* strings for compressions      */
-{ "off", "zlib" };
+{ "off", "zlib", "zlib_stream" };
+
+struct t_hook *relay_weechat_hook_signal_buffer = NULL; /* signals "buffer_*" */
+int relay_weechat_signal_buffer_clients = 0; /* clients receiving them     */
+unsigned long long relay_weechat_signal_buffer_msgs = 0; /* messages built */
 
 
 /*
@@ -66,6 +71,46 @@ relay_weechat_compression_search (const char *compression)
     return -1;
 }
 
+/*
+ * Frees zlib stream of a client.
+ *
+ * A new stream will be started with next message sent to the client.
+ */
+
+void
+relay_weechat_free_zlib_stream (struct t_relay_client *client)
+{
+    if (!RELAY_WEECHAT_DATA(client, zlib_stream))
+        return;
+
+    deflateEnd (RELAY_WEECHAT_DATA(client, zlib_stream));
+    free (RELAY_WEECHAT_DATA(client, zlib_stream));
+    RELAY_WEECHAT_DATA(client, zlib_stream) = NULL;
+}
+
+/*
+ * Stops sending signals "buffer_*" to a client (the hook is removed if no
+ * more clients need it).
+ */
+
+void
+relay_weechat_unhook_signal_buffer (struct t_relay_client *client)
+{
+    if (!RELAY_WEECHAT_DATA(client, signal_buffer))
+        return;
+
+    RELAY_WEECHAT_DATA(client, signal_buffer) = 0;
+    relay_weechat_signal_buffer_clients--;
+
+    if ((relay_weechat_signal_buffer_clients <= 0)
+        && relay_weechat_hook_signal_buffer)
+    {
+        weechat_unhook (relay_weechat_hook_signal_buffer);
+        relay_weechat_hook_signal_buffer = NULL;
+        relay_weechat_signal_buffer_clients = 0;
+    }
+}
+
 /*
  * Hooks signals for a client.
  */
@@ -73,10 +118,22 @@ relay_weechat_compression_search (const char *compression)
 void
 relay_weechat_hook_signals (struct t_relay_client *client)
 {
-    RELAY_WEECHAT_DATA(client, hook_signal_buffer) =
-        weechat_hook_signal ("buffer_*",
-                             &relay_weechat_protocol_signal_buffer_cb,
-                             client, NULL);
+    /*
+     * signals "buffer_*" are hooked once for all clients: the callback builds
+     * each message only once and sends it to all clients
+     */
+    if (!RELAY_WEECHAT_DATA(client, signal_buffer))
+    {
+        RELAY_WEECHAT_DATA(client, signal_buffer) = 1;
+        relay_weechat_signal_buffer_clients++;
+    }
+    if (!relay_weechat_hook_signal_buffer)
+    {
+        relay_weechat_hook_signal_buffer =
+            weechat_hook_signal ("buffer_*",
+                                 &relay_weechat_protocol_signal_buffer_cb,
+                                 NULL, NULL);
+    }
     RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) =
         weechat_hook_hsignal ("nicklist_*",
                               &relay_weechat_protocol_hsignal_nicklist_cb,
@@ -94,11 +151,7 @@ relay_weechat_hook_signals (struct t_relay_client *client)
 void
 relay_weechat_unhook_signals (struct t_relay_client *client)
 {
-    if (RELAY_WEECHAT_DATA(client, hook_signal_buffer))
-    {
-        weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_buffer));
-        RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
-    }
+    relay_weechat_unhook_signal_buffer (client);
     if (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist))
     {
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
@@ -181,12 +234,13 @@ relay_weechat_alloc (struct t_relay_client *client)
         RELAY_WEECHAT_DATA(client, password_ok) = (password && password[0]) ? 0 : 1;
         RELAY_WEECHAT_DATA(client, totp_ok) = (totp_secret && totp_secret[0]) ? 0 : 1;
         RELAY_WEECHAT_DATA(client, compression) = RELAY_WEECHAT_COMPRESSION_ZLIB;
+        RELAY_WEECHAT_DATA(client, zlib_stream) = NULL;
         RELAY_WEECHAT_DATA(client, buffers_sync) =
             weechat_hashtable_new (32,
                                    WEECHAT_HASHTABLE_STRING,
                                    WEECHAT_HASHTABLE_INTEGER,
                                    NULL, NULL);
-        RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
+        RELAY_WEECHAT_DATA(client, signal_buffer) = 0;
         RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
         RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
         RELAY_WEECHAT_DATA(client, buffers_nicklist) =
@@ -235,6 +289,14 @@ relay_weechat_alloc_with_infolist (struct t_relay_client *client,
             RELAY_WEECHAT_DATA(client, totp_ok) = 1;
         RELAY_WEECHAT_DATA(client, compression) = weechat_infolist_integer (
             infolist, "compression");
+        /*
+         * the zlib stream can not be restored after /upgrade: messages are
+         * now compressed one by one (the client knows the compression used
+         * with the flag in each message)
+         */
+        if (RELAY_WEECHAT_DATA(client, compression) == RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM)
+            RELAY_WEECHAT_DATA(client, compression) = RELAY_WEECHAT_COMPRESSION_ZLIB;
+        RELAY_WEECHAT_DATA(client, zlib_stream) = NULL;
 
         /* sync of buffers */
         RELAY_WEECHAT_DATA(client, buffers_sync) = weechat_hashtable_new (
@@ -256,7 +318,7 @@ relay_weechat_alloc_with_infolist (struct t_relay_client *client,
                                    &value);
             index++;
         }
-        RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
+        RELAY_WEECHAT_DATA(client, signal_buffer) = 0;
         RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
         RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
         RELAY_WEECHAT_DATA(client, buffers_nicklist) =
@@ -271,7 +333,7 @@ relay_weechat_alloc_with_infolist (struct t_relay_client *client,
 
         if (RELAY_CLIENT_HAS_ENDED(client))
         {
-            RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
+            RELAY_WEECHAT_DATA(client, signal_buffer) = 0;
             RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
             RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
         }
@@ -292,10 +354,10 @@ relay_weechat_free (struct t_relay_client *client)
 
     if (client->protocol_data)
     {
+        relay_weechat_free_zlib_stream (client);
         if (RELAY_WEECHAT_DATA(client, buffers_sync))
             weechat_hashtable_free (RELAY_WEECHAT_DATA(client, buffers_sync));
-        if (RELAY_WEECHAT_DATA(client, hook_signal_buffer))
-            weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_buffer));
+        relay_weechat_unhook_signal_buffer (client);
         if (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist))
             weechat_unhook (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
         if (RELAY_WEECHAT_DATA(client, hook_signal_upgrade))
@@ -348,11 +410,12 @@ relay_weechat_print_log (struct t_relay_client *client)
         weechat_log_printf ("    password_ok. . . . . . : %d",   RELAY_WEECHAT_DATA(client, password_ok));
         weechat_log_printf ("    totp_ok. . . . . . . . : %d",   RELAY_WEECHAT_DATA(client, totp_ok));
         weechat_log_printf ("    compression. . . . . . : %d",   RELAY_WEECHAT_DATA(client, compression));
+        weechat_log_printf ("    zlib_stream. . . . . . : 0x%lx", RELAY_WEECHAT_DATA(client, zlib_stream));
         weechat_log_printf ("    buffers_sync . . . . . : 0x%lx (hashtable: '%s')",
                             RELAY_WEECHAT_DATA(client, buffers_sync),
                             weechat_hashtable_get_string (RELAY_WEECHAT_DATA(client, buffers_sync),
                                                           "keys_values"));
-        weechat_log_printf ("    hook_signal_buffer . . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_signal_buffer));
+        weechat_log_printf ("    signal_buffer. . . . . : %d",   RELAY_WEECHAT_DATA(client, signal_buffer));
         weechat_log_printf ("    hook_hsignal_nicklist. : 0x%lx", RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
         weechat_log_printf ("    hook_signal_upgrade. . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
         weechat_log_printf ("    buffers_nicklist . . . : 0x%lx (hashtable: '%s')",
@@ -21,6 +21,7 @@
 #define WEECHAT_PLUGIN_RELAY_WEECHAT_H
 
 struct t_relay_client;
+struct z_stream_s;
 
 #define RELAY_WEECHAT_DATA(client, var)                          \
     (((struct t_relay_weechat_data *)client->protocol_data)->var)
@@ -29,6 +30,7 @@ enum t_relay_weechat_compression
 {
     RELAY_WEECHAT_COMPRESSION_OFF = 0, /* no compression of binary objects  */
     RELAY_WEECHAT_COMPRESSION_ZLIB,    /* zlib compression                  */
+    RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM, /* zlib stream (whole connection)*/
     /* number of compressions */
     RELAY_WEECHAT_NUM_COMPRESSIONS,
 };
@@ -38,18 +40,29 @@ struct t_relay_weechat_data
     int password_ok;                   /* password received and OK?         */
     int totp_ok;                       /* TOTP received and OK?             */
     enum t_relay_weechat_compression compression; /* compression type       */
+    struct z_stream_s *zlib_stream;    /* zlib stream (for compression      */
+                                       /* "zlib_stream"), the compression   */
+                                       /* level is read on stream creation  */
 
     /* sync of buffers */
     struct t_hashtable *buffers_sync;  /* buffers synchronized (events      */
                                        /* received for these buffers)       */
-    struct t_hook *hook_signal_buffer;    /* hook for signals "buffer_*"    */
+    int signal_buffer;                 /* 1 if signals "buffer_*" are sent  */
+                                       /* (hook is shared by all clients)   */
     struct t_hook *hook_hsignal_nicklist; /* hook for hsignals "nicklist_*" */
     struct t_hook *hook_signal_upgrade;   /* hook for signals "upgrade*"    */
     struct t_hashtable *buffers_nicklist; /* send nicklist for these buffers*/
     struct t_hook *hook_timer_nicklist;   /* timer for sending nicklist     */
 };
 
+extern char *relay_weechat_compression_string[];
+extern struct t_hook *relay_weechat_hook_signal_buffer;
+extern int relay_weechat_signal_buffer_clients;
+extern unsigned long long relay_weechat_signal_buffer_msgs;
+
 extern int relay_weechat_compression_search (const char *compression);
+extern void relay_weechat_free_zlib_stream (struct t_relay_client *client);
+extern void relay_weechat_unhook_signal_buffer (struct t_relay_client *client);
 extern void relay_weechat_hook_signals (struct t_relay_client *client);
 extern void relay_weechat_unhook_signals (struct t_relay_client *client);
 extern void relay_weechat_hook_timer_nicklist (struct t_relay_client *client);
@@ -875,6 +875,9 @@ trigger_callback_line_cb (const void *pointer, void *data,
                                        NULL, NULL);
     if (hashtable)
     {
+        /* result is freed by WeeChat right after the callback */
+        weechat_hashtable_set_arena (hashtable, 0);
+
         /* copy updated variables into the result "hashtable" */
         for (ptr_item = weechat_list_get (vars_updated, 0); ptr_item;
              ptr_item = weechat_list_next (ptr_item))
@@ -51,7 +51,8 @@
         WEECHAT_HASHTABLE_POINTER,                              \
         NULL, NULL);                                            \
     if (!pointers)                                              \
-        goto end;
+        goto end;                                               \
+    weechat_hashtable_set_arena (pointers, 0);
 
 #define TRIGGER_CALLBACK_CB_NEW_EXTRA_VARS                      \
     extra_vars = weechat_hashtable_new (                        \
@@ -60,7 +61,8 @@
         WEECHAT_HASHTABLE_STRING,                               \
         NULL, NULL);                                            \
     if (!extra_vars)                                            \
-        goto end;
+        goto end;                                               \
+    weechat_hashtable_set_arena (extra_vars, 0);
 
 #define TRIGGER_CALLBACK_CB_NEW_VARS_UPDATED                    \
     vars_updated = weechat_list_new ();                         \
@@ -55,6 +55,7 @@ struct t_weelist_item;
 struct t_arraylist;
 struct t_hashtable;
 struct t_hdata;
+struct t_hdata_keys;
 struct timeval;
 
 /*
@@ -67,7 +68,7 @@ struct timeval;
  * please change the date with current one; for a second change at same
  * date, increment the 01, otherwise please keep 01.
  */
-#define WEECHAT_PLUGIN_API_VERSION "20190810-01"
+#define WEECHAT_PLUGIN_API_VERSION "20190810-04"
 
 /* macros for defining plugin infos */
 #define WEECHAT_PLUGIN_NAME(__name)                                     \
@@ -476,6 +477,8 @@ struct t_weechat_plugin
                                   const char *property);
     const char *(*hashtable_get_string) (struct t_hashtable *hashtable,
                                          const char *property);
+    int (*hashtable_set_arena) (struct t_hashtable *hashtable,
+                                int block_size);
     void (*hashtable_set_pointer) (struct t_hashtable *hashtable,
                                    const char *property,
                                    void *pointer);
@@ -807,6 +810,7 @@ struct t_weechat_plugin
                                  const char *modifier,
                                  const char *modifier_data,
                                  const char *string);
+    int (*hook_modifier_has_hooks) (const char *modifier);
     struct t_hook *(*hook_info) (struct t_weechat_plugin *plugin,
                                  const char *info_name,
                                  const char *description,
@@ -1089,6 +1093,14 @@ struct t_weechat_plugin
     void *(*hdata_move) (struct t_hdata *hdata, void *pointer, int count);
     void *(*hdata_search) (struct t_hdata *hdata, void *pointer,
                            const char *search, int move);
+    struct t_hdata_keys *(*hdata_compile_keys) (struct t_hdata *hdata,
+                                                const char *keys,
+                                                int *num_keys);
+    int (*hdata_get_compiled_key) (struct t_hdata_keys *keys, int number,
+                                   const char **name, int *index,
+                                   int *type, int *offset,
+                                   const char **array_size);
+    void (*hdata_free_compiled_keys) (struct t_hdata_keys *keys);
     char (*hdata_char) (struct t_hdata *hdata, void *pointer,
                         const char *name);
     int (*hdata_integer) (struct t_hdata *hdata, void *pointer,
@@ -1427,6 +1439,8 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
     (weechat_plugin->hashtable_get_integer)(__hashtable, __property)
 #define weechat_hashtable_get_string(__hashtable, __property)           \
     (weechat_plugin->hashtable_get_string)(__hashtable, __property)
+#define weechat_hashtable_set_arena(__hashtable, __block_size)          \
+    (weechat_plugin->hashtable_set_arena)(__hashtable, __block_size)
 #define weechat_hashtable_set_pointer(__hashtable, __property,          \
                                       __pointer)                        \
     (weechat_plugin->hashtable_set_pointer)(__hashtable, __property,    \
@@ -1722,6 +1736,8 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
                                    __string)                            \
     (weechat_plugin->hook_modifier_exec)(weechat_plugin, __modifier,    \
                                          __modifier_data, __string)
+#define weechat_hook_modifier_has_hooks(__modifier)                     \
+    (weechat_plugin->hook_modifier_has_hooks)(__modifier)
 #define weechat_hook_info(__info_name, __description,                   \
                           __args_description, __callback, __pointer,    \
                           __data)                                       \
@@ -2037,6 +2053,16 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
 #define weechat_hdata_search(__hdata, __pointer, __search, __move)      \
     (weechat_plugin->hdata_search)(__hdata, __pointer, __search,        \
                                    __move)
+#define weechat_hdata_compile_keys(__hdata, __keys, __num_keys)         \
+    (weechat_plugin->hdata_compile_keys)(__hdata, __keys, __num_keys)
+#define weechat_hdata_get_compiled_key(__keys, __number, __name,        \
+                                       __index, __type, __offset,       \
+                                       __array_size)                    \
+    (weechat_plugin->hdata_get_compiled_key)(__keys, __number, __name,  \
+                                             __index, __type, __offset, \
+                                             __array_size)
+#define weechat_hdata_free_compiled_keys(__keys)                        \
+    (weechat_plugin->hdata_free_compiled_keys)(__keys)
 #define weechat_hdata_char(__hdata, __pointer, __name)                  \
     (weechat_plugin->hdata_char)(__hdata, __pointer, __name)
 #define weechat_hdata_integer(__hdata, __pointer, __name)               \
@@ -20,6 +20,9 @@
 #ifndef WEECHAT_TESTS_H
 #define WEECHAT_TESTS_H
 
+/* benchmarks are run only if this environment variable is set */
+#define WEE_TEST_BENCHMARK_ENV "WEECHAT_TESTS_BENCHMARK"
+
 #define WEE_TEST_STR(__result, __test)                                  \
     str = __test;                                                       \
     if (__result == NULL)                                               \
@@ -421,6 +421,12 @@ TEST(CoreEval, EvalExpression)
     WEE_CHECK_EVAL("1", "${window.buffer.number}");
     WEE_CHECK_EVAL("core.weechat", "${buffer.full_name}");
     WEE_CHECK_EVAL("core.weechat", "${window.buffer.full_name}");
+    WEE_CHECK_EVAL("core", "${buffer.local_variables.plugin}");
+    WEE_CHECK_EVAL("weechat", "${window.buffer.local_variables.name}");
+    WEE_CHECK_EVAL("", "${buffer.xxx}");
+    WEE_CHECK_EVAL("", "${buffer.number,full_name}");
+    WEE_CHECK_EVAL("", "${window.buffer.xxx}");
+    WEE_CHECK_EVAL("", "${buffer.,number}");
 
     /* test with another prefix/suffix */
     options = hashtable_new (32,
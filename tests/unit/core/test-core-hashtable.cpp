@@ -23,7 +23,11 @@
 
 extern "C"
 {
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include "tests/tests.h"
 #include "src/core/wee-hashtable.h"
 #include "src/plugins/plugin.h"
 }
@@ -118,8 +122,10 @@ TEST(CoreHashtable, New)
                                &test_hashtable_hash_key_cb,
                                &test_hashtable_keycmp_cb);
     CHECK(hashtable);
+    LONGS_EQUAL(HASHTABLE_ENGINE_CHAINED, hashtable->engine);
     LONGS_EQUAL(32, hashtable->size);
     CHECK(hashtable->htable);
+    POINTERS_EQUAL(NULL, hashtable->entries);
     LONGS_EQUAL(0, hashtable->items_count);
     LONGS_EQUAL(HASHTABLE_STRING, hashtable->type_keys);
     LONGS_EQUAL(HASHTABLE_INTEGER, hashtable->type_values);
@@ -337,6 +343,214 @@ TEST(CoreHashtable, SetGetRemove)
     hashtable_free (hashtable);
 }
 
+/*
+ * Test callback for hashtable map: removes each item with an even value.
+ */
+
+void
+test_hashtable_map_remove_cb (void *data,
+                              struct t_hashtable *hashtable,
+                              const void *key, const void *value)
+{
+    int *count;
+
+    count = (int *)data;
+    (*count)++;
+
+    if (*((int *)value) % 2 == 0)
+        hashtable_remove (hashtable, key);
+}
+
+/*
+ * Tests functions (with engine "open"):
+ *   hashtable_new_with_engine
+ *   hashtable_set
+ *   hashtable_get_item
+ *   hashtable_get
+ *   hashtable_remove
+ *   hashtable_map
+ *   hashtable_dup
+ *   hashtable_remove_all
+ *   hashtable_free
+ */
+
+TEST(CoreHashtable, EngineOpen)
+{
+    struct t_hashtable *hashtable, *hashtable2;
+    struct t_hashtable_item *item;
+    char key[64];
+    const char *long_key = "this key is too long to be stored in entry";
+    int i, count;
+
+    /* invalid engine */
+    POINTERS_EQUAL(NULL,
+                   hashtable_new_with_engine (HASHTABLE_NUM_ENGINES, 32,
+                                              WEECHAT_HASHTABLE_STRING,
+                                              WEECHAT_HASHTABLE_INTEGER,
+                                              NULL, NULL));
+
+    /* size is rounded up to a power of 2 */
+    hashtable = hashtable_new_with_engine (HASHTABLE_ENGINE_OPEN, 20,
+                                           WEECHAT_HASHTABLE_STRING,
+                                           WEECHAT_HASHTABLE_INTEGER,
+                                           NULL, NULL);
+    CHECK(hashtable);
+    LONGS_EQUAL(HASHTABLE_ENGINE_OPEN, hashtable->engine);
+    LONGS_EQUAL(32, hashtable->size);
+    POINTERS_EQUAL(NULL, hashtable->htable);
+    CHECK(hashtable->entries);
+    LONGS_EQUAL(0, hashtable->items_count);
+    STRCMP_EQUAL("open", hashtable_get_string (hashtable, "engine"));
+
+    /* small key is stored in the entry, long key is allocated */
+    item = hashtable_set (hashtable, "test", NULL);
+    CHECK(item);
+    POINTERS_EQUAL(((struct t_hashtable_entry *)item)->key_inline, item->key);
+    LONGS_EQUAL(5, item->key_size);
+    item = hashtable_set (hashtable, long_key, NULL);
+    CHECK(item);
+    CHECK(((struct t_hashtable_entry *)item)->key_inline != item->key);
+    STRCMP_EQUAL(long_key, (const char *)item->key);
+    LONGS_EQUAL(2, hashtable->items_count);
+    hashtable_remove (hashtable, "test");
+    hashtable_remove (hashtable, long_key);
+    LONGS_EQUAL(0, hashtable->items_count);
+    POINTERS_EQUAL(NULL, hashtable_get_item (hashtable, "test", NULL));
+
+    /* add many items: the array of entries is enlarged */
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        CHECK(hashtable_set (hashtable, key, &i));
+    }
+    LONGS_EQUAL(1000, hashtable->items_count);
+    CHECK(hashtable->size >= 1024);
+    CHECK(hashtable->items_count * 100
+          <= hashtable->size * HASHTABLE_OPEN_MAX_LOAD);
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        LONGS_EQUAL(i, *((int *)hashtable_get (hashtable, key)));
+    }
+
+    /* update value of an existing key */
+    i = -1;
+    CHECK(hashtable_set (hashtable, "key10", &i));
+    LONGS_EQUAL(1000, hashtable->items_count);
+    LONGS_EQUAL(-1, *((int *)hashtable_get (hashtable, "key10")));
+    i = 10;
+    CHECK(hashtable_set (hashtable, "key10", &i));
+
+    /* duplicate hashtable */
+    hashtable2 = hashtable_dup (hashtable);
+    CHECK(hashtable2);
+    LONGS_EQUAL(HASHTABLE_ENGINE_OPEN, hashtable2->engine);
+    LONGS_EQUAL(1000, hashtable2->items_count);
+    LONGS_EQUAL(999, *((int *)hashtable_get (hashtable2, "key999")));
+    hashtable_free (hashtable2);
+
+    /* remove items during map: each item is visited once */
+    count = 0;
+    hashtable_map (hashtable, &test_hashtable_map_remove_cb, &count);
+    LONGS_EQUAL(1000, count);
+    LONGS_EQUAL(500, hashtable->items_count);
+    LONGS_EQUAL(0, hashtable->map_running);
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        LONGS_EQUAL((i % 2 == 0) ? 0 : 1, hashtable_has_key (hashtable, key));
+    }
+
+    /* add items again (reuse of deleted entries) */
+    for (i = 0; i < 1000; i += 2)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        CHECK(hashtable_set (hashtable, key, &i));
+    }
+    LONGS_EQUAL(1000, hashtable->items_count);
+    LONGS_EQUAL(500, *((int *)hashtable_get (hashtable, "key500")));
+
+    /* remove all items */
+    hashtable_remove_all (hashtable);
+    LONGS_EQUAL(0, hashtable->items_count);
+    LONGS_EQUAL(0, hashtable->deleted_count);
+    POINTERS_EQUAL(NULL, hashtable_get (hashtable, "key1"));
+
+    hashtable_free (hashtable);
+}
+
+/*
+ * Tests functions:
+ *   hashtable_set_arena
+ */
+
+TEST(CoreHashtable, Arena)
+{
+    struct t_hashtable *hashtable;
+    struct t_hashtable_item *item;
+    char key[64], value[128];
+    int engine, i;
+
+    LONGS_EQUAL(0, hashtable_set_arena (NULL, 0));
+
+    for (engine = 0; engine < HASHTABLE_NUM_ENGINES; engine++)
+    {
+        hashtable = hashtable_new_with_engine (
+            (enum t_hashtable_engine)engine,
+            8,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_STRING,
+            NULL, NULL);
+        CHECK(hashtable);
+
+        /* arena can not be set if hashtable is not empty */
+        CHECK(hashtable_set (hashtable, "key", "value"));
+        LONGS_EQUAL(0, hashtable_set_arena (hashtable, 0));
+        hashtable_remove (hashtable, "key");
+
+        LONGS_EQUAL(1, hashtable_set_arena (hashtable, 256));
+        LONGS_EQUAL(256, hashtable->arena_block_size);
+        POINTERS_EQUAL(NULL, hashtable->arena);
+
+        /* add items: many blocks are allocated */
+        for (i = 0; i < 100; i++)
+        {
+            snprintf (key, sizeof (key), "key%d", i);
+            snprintf (value, sizeof (value), "value of key%d", i);
+            CHECK(hashtable_set (hashtable, key, value));
+        }
+        LONGS_EQUAL(100, hashtable->items_count);
+        CHECK(hashtable->arena);
+        CHECK(hashtable->arena->next_block);
+        STRCMP_EQUAL("value of key42",
+                     (const char *)hashtable_get (hashtable, "key42"));
+
+        /* replace value, remove item */
+        item = hashtable_set (hashtable, "key42", "new value");
+        CHECK(item);
+        STRCMP_EQUAL("new value", (const char *)item->value);
+        hashtable_remove (hashtable, "key43");
+        LONGS_EQUAL(99, hashtable->items_count);
+        POINTERS_EQUAL(NULL, hashtable_get (hashtable, "key43"));
+
+        /* remove all: only one block is kept */
+        hashtable_remove_all (hashtable);
+        LONGS_EQUAL(0, hashtable->items_count);
+        CHECK(hashtable->arena);
+        POINTERS_EQUAL(NULL, hashtable->arena->next_block);
+        LONGS_EQUAL(0, hashtable->arena->used);
+
+        /* value bigger than block size */
+        memset (value, 'a', sizeof (value) - 1);
+        value[sizeof (value) - 1] = '\0';
+        LONGS_EQUAL(1, hashtable_set_arena (hashtable, 16));
+        CHECK(hashtable_set (hashtable, "long", value));
+        STRCMP_EQUAL(value, (const char *)hashtable_get (hashtable, "long"));
+
+        hashtable_free (hashtable);
+    }
+}
+
 /*
  * Tests functions:
  *   hashtable_map
@@ -381,3 +595,132 @@ TEST(CoreHashtable, PrintLog)
 {
     /* TODO: write tests */
 }
+
+#define HASHTABLE_BENCHMARK_MAX_KEYS 10000
+
+char hashtable_benchmark_keys[HASHTABLE_BENCHMARK_MAX_KEYS][16];
+int hashtable_benchmark_map_count = 0;
+
+void
+hashtable_benchmark_map_cb (void *data, struct t_hashtable *hashtable,
+                            const void *key, const void *value)
+{
+    /* make C++ compiler happy */
+    (void) data;
+    (void) hashtable;
+    (void) key;
+    (void) value;
+
+    hashtable_benchmark_map_count++;
+}
+
+/*
+ * Returns monotonic time in nanoseconds.
+ */
+
+long long
+hashtable_benchmark_time ()
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ((long long)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+/*
+ * Runs set/get/map/remove on hashtables with an engine and displays the time
+ * per operation (in nanoseconds).
+ *
+ * The hashtables are created and freed "num_tables" times, with "num_keys"
+ * keys in each hashtable.
+ */
+
+void
+hashtable_benchmark_run (enum t_hashtable_engine engine, int size,
+                         int num_tables, int num_keys)
+{
+    struct t_hashtable *hashtable;
+    long long start, time_set, time_get, time_map, time_remove;
+    double ops;
+    int i, j;
+
+    time_set = 0;
+    time_get = 0;
+    time_map = 0;
+    time_remove = 0;
+
+    for (i = 0; i < num_tables; i++)
+    {
+        hashtable = hashtable_new_with_engine (engine, size,
+                                               WEECHAT_HASHTABLE_STRING,
+                                               WEECHAT_HASHTABLE_STRING,
+                                               NULL, NULL);
+        CHECK(hashtable);
+
+        start = hashtable_benchmark_time ();
+        for (j = 0; j < num_keys; j++)
+        {
+            hashtable_set (hashtable, hashtable_benchmark_keys[j],
+                           HASHTABLE_TEST_VALUE);
+        }
+        time_set += hashtable_benchmark_time () - start;
+
+        start = hashtable_benchmark_time ();
+        for (j = 0; j < num_keys; j++)
+        {
+            (void) hashtable_get (hashtable, hashtable_benchmark_keys[j]);
+        }
+        time_get += hashtable_benchmark_time () - start;
+
+        start = hashtable_benchmark_time ();
+        hashtable_map (hashtable, &hashtable_benchmark_map_cb, NULL);
+        time_map += hashtable_benchmark_time () - start;
+
+        start = hashtable_benchmark_time ();
+        for (j = 0; j < num_keys; j++)
+        {
+            hashtable_remove (hashtable, hashtable_benchmark_keys[j]);
+        }
+        time_remove += hashtable_benchmark_time () - start;
+
+        hashtable_free (hashtable);
+    }
+
+    ops = (double)num_tables * num_keys;
+    printf ("hashtable %-7s (size: %5d, %5d keys): set: %6.1f ns, "
+            "get: %6.1f ns, map: %6.1f ns, remove: %6.1f ns\n",
+            hashtable_engine_string[engine], size, num_keys,
+            time_set / ops, time_get / ops, time_map / ops,
+            time_remove / ops);
+}
+
+/*
+ * Benchmark of hashtables: engine "chained" vs engine "open".
+ */
+
+TEST(CoreHashtable, Benchmark)
+{
+    int i, engine;
+
+    if (!getenv (WEE_TEST_BENCHMARK_ENV))
+        return;
+
+    for (i = 0; i < HASHTABLE_BENCHMARK_MAX_KEYS; i++)
+    {
+        snprintf (hashtable_benchmark_keys[i],
+                  sizeof (hashtable_benchmark_keys[i]), "key%d", i);
+    }
+
+    for (engine = 0; engine < HASHTABLE_NUM_ENGINES; engine++)
+    {
+        /* short-lived hashtable (like the ones sent with hsignals) */
+        hashtable_benchmark_run ((enum t_hashtable_engine)engine,
+                                 32, 100000, 8);
+        /* hashtable with many keys, small size given on creation */
+        hashtable_benchmark_run ((enum t_hashtable_engine)engine,
+                                 32, 10, HASHTABLE_BENCHMARK_MAX_KEYS);
+        /* hashtable with many keys, large size given on creation */
+        hashtable_benchmark_run ((enum t_hashtable_engine)engine,
+                                 16384, 10, HASHTABLE_BENCHMARK_MAX_KEYS);
+    }
+}
@@ -23,7 +23,23 @@
 
 extern "C"
 {
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 #include "src/core/wee-hdata.h"
+#include "src/core/wee-hashtable.h"
+#include "src/plugins/weechat-plugin.h"
+
+struct t_test_hdata
+{
+    int number;
+    char *name;
+    int count;
+    char **words;
+    int values[3];
+};
+
+extern void hdata_free (struct t_hdata *hdata);
 }
 
 TEST_GROUP(CoreHdata)
@@ -81,6 +97,154 @@ TEST(CoreHdata, Move)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hdata_compile_key
+ *   hdata_compile_keys
+ *   hdata_get_compiled_key
+ *   hdata_free_compiled_keys
+ *   hdata_key_get_value
+ */
+
+TEST(CoreHdata, CompileKeys)
+{
+    struct t_hdata *hdata;
+    struct t_hdata_keys *keys, *keys2;
+    struct t_hdata_key key;
+    struct t_test_hdata object;
+    const char *words[] = { "abc", "def" };
+    const char *name, *array_size;
+    int num_keys, index, type, offset;
+
+    hdata = hdata_new (NULL, "test_compile_keys", NULL, NULL, 0, 0,
+                       NULL, NULL);
+    CHECK(hdata);
+    HDATA_VAR(struct t_test_hdata, number, INTEGER, 0, NULL, NULL);
+    HDATA_VAR(struct t_test_hdata, name, STRING, 0, NULL, NULL);
+    HDATA_VAR(struct t_test_hdata, count, INTEGER, 0, NULL, NULL);
+    HDATA_VAR(struct t_test_hdata, words, STRING, 0, "count", NULL);
+    HDATA_VAR(struct t_test_hdata, values, INTEGER, 0, "3", NULL);
+
+    object.number = 42;
+    object.name = (char *)"test";
+    object.count = 2;
+    object.words = (char **)words;
+    object.values[0] = 10;
+    object.values[1] = 11;
+    object.values[2] = 12;
+
+    /* invalid arguments */
+    num_keys = -1;
+    POINTERS_EQUAL(NULL, hdata_compile_keys (NULL, "number", &num_keys));
+    LONGS_EQUAL(0, num_keys);
+    POINTERS_EQUAL(NULL, hdata_compile_keys (hdata, NULL, &num_keys));
+    LONGS_EQUAL(0, num_keys);
+
+    /* empty keys */
+    keys = hdata_compile_keys (hdata, "", &num_keys);
+    CHECK(keys);
+    LONGS_EQUAL(0, num_keys);
+    hdata_free_compiled_keys (keys);
+
+    /* list of keys, with an unknown variable and an index */
+    keys = hdata_compile_keys (hdata, "number,,xxx,name,1|words,values",
+                               &num_keys);
+    CHECK(keys);
+    LONGS_EQUAL(5, num_keys);
+    LONGS_EQUAL(5, keys->num_keys);
+    STRCMP_EQUAL("number", keys->keys[0].name);
+    LONGS_EQUAL(-1, keys->keys[0].index);
+    CHECK(keys->keys[0].var);
+    STRCMP_EQUAL("xxx", keys->keys[1].name);
+    POINTERS_EQUAL(NULL, keys->keys[1].var);
+    STRCMP_EQUAL("words", keys->keys[3].name);
+    LONGS_EQUAL(1, keys->keys[3].index);
+
+    /* same keys: new compiled keys are returned (owned by caller) */
+    keys2 = hdata_compile_keys (hdata, "number,,xxx,name,1|words,values",
+                                NULL);
+    CHECK(keys2);
+    CHECK(keys2 != keys);
+    LONGS_EQUAL(5, keys2->num_keys);
+    POINTERS_EQUAL(keys->keys[0].var, keys2->keys[0].var);
+    hdata_free_compiled_keys (keys2);
+
+    /* info about keys */
+    LONGS_EQUAL(1, hdata_get_compiled_key (keys, 0, &name, &index, &type,
+                                           &offset, &array_size));
+    STRCMP_EQUAL("number", name);
+    LONGS_EQUAL(-1, index);
+    LONGS_EQUAL(WEECHAT_HDATA_INTEGER, type);
+    LONGS_EQUAL(offsetof (struct t_test_hdata, number), offset);
+    POINTERS_EQUAL(NULL, array_size);
+    LONGS_EQUAL(0, hdata_get_compiled_key (keys, 1, &name, &index, &type,
+                                           &offset, &array_size));
+    STRCMP_EQUAL("xxx", name);
+    LONGS_EQUAL(-1, type);
+    LONGS_EQUAL(-1, offset);
+    LONGS_EQUAL(1, hdata_get_compiled_key (keys, 3, &name, &index, NULL,
+                                           NULL, NULL));
+    STRCMP_EQUAL("words", name);
+    LONGS_EQUAL(1, index);
+    LONGS_EQUAL(1, hdata_get_compiled_key (keys, 4, &name, NULL, &type,
+                                           NULL, &array_size));
+    STRCMP_EQUAL("values", name);
+    STRCMP_EQUAL("3", array_size);
+    LONGS_EQUAL(0, hdata_get_compiled_key (keys, 5, &name, NULL, NULL,
+                                           NULL, NULL));
+    LONGS_EQUAL(0, hdata_get_compiled_key (NULL, 0, NULL, NULL, NULL,
+                                           NULL, NULL));
+
+    /* values (same as hdata_integer, hdata_string, ...) */
+    POINTERS_EQUAL(NULL, hdata_key_get_value (&keys->keys[1], &object));
+    LONGS_EQUAL(42, *((int *)hdata_key_get_value (&keys->keys[0], &object)));
+    STRCMP_EQUAL("test",
+                 *((char **)hdata_key_get_value (&keys->keys[2], &object)));
+    STRCMP_EQUAL("def",
+                 *((char **)hdata_key_get_value (&keys->keys[3], &object)));
+    STRCMP_EQUAL(hdata_string (hdata, &object, "1|words"),
+                 *((char **)hdata_key_get_value (&keys->keys[3], &object)));
+    POINTERS_EQUAL(&object.values,
+                   hdata_key_get_value (&keys->keys[4], &object));
+    hdata_free_compiled_keys (keys);
+
+    /* item of an array with fixed size */
+    keys = hdata_compile_keys (hdata, "2|values", &num_keys);
+    CHECK(keys);
+    LONGS_EQUAL(1, num_keys);
+    STRCMP_EQUAL("values", keys->keys[0].name);
+    LONGS_EQUAL(12, *((int *)hdata_key_get_value (&keys->keys[0], &object)));
+    hdata_free_compiled_keys (keys);
+
+    /* a key with a path is not a variable */
+    keys = hdata_compile_keys (hdata, "name.abc,number", &num_keys);
+    CHECK(keys);
+    LONGS_EQUAL(2, num_keys);
+    STRCMP_EQUAL("name.abc", keys->keys[0].name);
+    POINTERS_EQUAL(NULL, keys->keys[0].var);
+    hdata_free_compiled_keys (keys);
+
+    /* free NULL pointer */
+    hdata_free_compiled_keys (NULL);
+
+    /* single key (not allocated) */
+    LONGS_EQUAL(1, hdata_compile_key (hdata, "1|words", &key, &name));
+    STRCMP_EQUAL("words", name);
+    LONGS_EQUAL(1, key.index);
+    STRCMP_EQUAL("def", *((char **)hdata_key_get_value (&key, &object)));
+    LONGS_EQUAL(1, hdata_compile_key (hdata, "number", &key, NULL));
+    LONGS_EQUAL(-1, key.index);
+    LONGS_EQUAL(42, *((int *)hdata_key_get_value (&key, &object)));
+    LONGS_EQUAL(0, hdata_compile_key (hdata, "xxx", &key, &name));
+    STRCMP_EQUAL("xxx", name);
+    POINTERS_EQUAL(NULL, key.var);
+    LONGS_EQUAL(0, hdata_compile_key (NULL, "number", &key, NULL));
+    POINTERS_EQUAL(NULL, key.var);
+
+    hashtable_remove (weechat_hdata, "test_compile_keys");
+    hdata_free (hdata);
+}
+
 /*
  * Tests functions:
  *   hdata_char
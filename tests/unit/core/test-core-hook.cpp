@@ -23,11 +23,24 @@
 
 extern "C"
 {
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "tests/tests.h"
+#include "src/core/wee-hashtable.h"
 #include "src/core/wee-hook.h"
 #include "src/core/wee-string.h"
+#include "src/core/wee-util.h"
 #include "src/gui/gui-buffer.h"
 #include "src/gui/gui-chat.h"
+#include "src/gui/gui-color.h"
 #include "src/gui/gui-line.h"
 #include "src/plugins/plugin.h"
 }
@@ -88,14 +101,337 @@ TEST(CoreHook, Connect)
     /* TODO: write tests */
 }
 
+int test_fd_cb_count = 0;
+
+int
+test_fd_cb (const void *pointer, void *data, int fd)
+{
+    char buf[16];
+    ssize_t num_read;
+
+    /* make C++ compiler happy */
+    (void) pointer;
+    (void) data;
+
+    num_read = read (fd, buf, sizeof (buf));
+    (void) num_read;
+
+    test_fd_cb_count++;
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Tests functions:
  *   hook_fd
+ *   hook_fd_exec
  */
 
 TEST(CoreHook, Fd)
 {
-    /* TODO: write tests */
+    struct t_hook *hook, *hook2;
+    int fds[2];
+    ssize_t num_written;
+
+    LONGS_EQUAL(0, pipe (fds));
+
+    POINTERS_EQUAL(NULL, hook_fd (NULL, -1, 1, 0, 0, &test_fd_cb,
+                                  NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_fd (NULL, fds[0], 1, 0, 0, NULL, NULL, NULL));
+
+    hook = hook_fd (NULL, fds[0], 1, 0, 0, &test_fd_cb, NULL, NULL);
+    CHECK(hook);
+
+    /* same fd can not be hooked twice */
+    POINTERS_EQUAL(NULL, hook_fd (NULL, fds[0], 1, 0, 0, &test_fd_cb,
+                                  NULL, NULL));
+
+    /* data available on fd: callback is called */
+    test_fd_cb_count = 0;
+    num_written = write (fds[1], "a", 1);
+    LONGS_EQUAL(1, num_written);
+    hook_fd_exec ();
+    LONGS_EQUAL(1, test_fd_cb_count);
+
+    /* no callback called after unhook */
+    unhook (hook);
+    num_written = write (fds[1], "a", 1);
+    LONGS_EQUAL(1, num_written);
+    hook2 = hook_fd (NULL, fds[1], 0, 1, 0, &test_fd_cb, NULL, NULL);
+    CHECK(hook2);
+    test_fd_cb_count = 0;
+    hook_fd_exec ();
+    LONGS_EQUAL(1, test_fd_cb_count);
+    unhook (hook2);
+
+    close (fds[0]);
+    close (fds[1]);
+}
+
+int test_fd_file = -1;
+struct t_hook *test_fd_hook_file = NULL;
+
+int
+test_fd_hook_file_cb (const void *pointer, void *data, int fd)
+{
+    /* hook a regular file (can not be watched with epoll) */
+    if (!test_fd_hook_file)
+    {
+        test_fd_hook_file = hook_fd (NULL, test_fd_file, 1, 0, 0,
+                                     &test_fd_cb, NULL, NULL);
+    }
+
+    return test_fd_cb (pointer, data, fd);
+}
+
+/*
+ * Tests functions:
+ *   hook_fd_exec (fd hook added by a callback, with switch to poll backend)
+ */
+
+TEST(CoreHook, FdAddedInCallback)
+{
+    struct t_hook *hook1, *hook2;
+    FILE *file;
+    int fds1[2], fds2[2], old_backend;
+    ssize_t num_written;
+
+    old_backend = hook_fd_backend;
+
+    LONGS_EQUAL(0, pipe (fds1));
+    LONGS_EQUAL(0, pipe (fds2));
+    file = tmpfile ();
+    CHECK(file);
+    test_fd_file = fileno (file);
+    test_fd_hook_file = NULL;
+
+    hook1 = hook_fd (NULL, fds1[0], 1, 0, 0, &test_fd_hook_file_cb,
+                     NULL, NULL);
+    CHECK(hook1);
+    hook2 = hook_fd (NULL, fds2[0], 1, 0, 0, &test_fd_hook_file_cb,
+                     NULL, NULL);
+    CHECK(hook2);
+
+    /* both fds are ready: the first callback hooks the regular file */
+    num_written = write (fds1[1], "a", 1);
+    LONGS_EQUAL(1, num_written);
+    num_written = write (fds2[1], "a", 1);
+    LONGS_EQUAL(1, num_written);
+    test_fd_cb_count = 0;
+    hook_fd_exec ();
+    LONGS_EQUAL(2, test_fd_cb_count);
+    CHECK(test_fd_hook_file);
+    LONGS_EQUAL(HOOK_FD_BACKEND_POLL, hook_fd_backend);
+
+    unhook (test_fd_hook_file);
+    unhook (hook1);
+    unhook (hook2);
+    test_fd_hook_file = NULL;
+
+    /* restore the backend */
+    if (old_backend != HOOK_FD_BACKEND_POLL)
+    {
+        hook_fd_init ();
+        LONGS_EQUAL(old_backend, hook_fd_backend);
+    }
+
+    fclose (file);
+    close (fds1[0]);
+    close (fds1[1]);
+    close (fds2[0]);
+    close (fds2[1]);
+}
+
+/*
+ * Tests functions:
+ *   hook_fd (fd hooked again while it is still in the epoll set)
+ */
+
+TEST(CoreHook, FdAlreadyRegistered)
+{
+    struct t_hook *hook;
+    int fds[2], old_backend;
+    ssize_t num_written;
+
+    old_backend = hook_fd_backend;
+
+    LONGS_EQUAL(0, pipe (fds));
+
+    /* a fd hook in error is not removed from the epoll set on unhook */
+    hook = hook_fd (NULL, fds[0], 1, 0, 0, &test_fd_cb, NULL, NULL);
+    CHECK(hook);
+    HOOK_FD(hook, error) = EIO;
+    unhook (hook);
+
+    /* hook same fd again: the backend is not changed */
+    hook = hook_fd (NULL, fds[0], 1, 0, 0, &test_fd_cb, NULL, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(old_backend, hook_fd_backend);
+
+    num_written = write (fds[1], "a", 1);
+    LONGS_EQUAL(1, num_written);
+    test_fd_cb_count = 0;
+    hook_fd_exec ();
+    LONGS_EQUAL(1, test_fd_cb_count);
+
+    unhook (hook);
+
+    close (fds[0]);
+    close (fds[1]);
+}
+
+int
+test_fd_exception_cb (const void *pointer, void *data, int fd)
+{
+    char buf[16];
+    ssize_t num_read;
+
+    /* make C++ compiler happy */
+    (void) pointer;
+    (void) data;
+
+    num_read = recv (fd, buf, sizeof (buf), MSG_OOB);
+    (void) num_read;
+
+    test_fd_cb_count++;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Tests functions:
+ *   hook_fd_exec (exception: out-of-band data received on a socket)
+ */
+
+TEST(CoreHook, FdException)
+{
+    struct t_hook *hook;
+    struct sockaddr_in addr;
+    socklen_t length;
+    int sock_listen, sock_client, sock_server;
+
+    sock_listen = socket (AF_INET, SOCK_STREAM, 0);
+    CHECK(sock_listen >= 0);
+    memset (&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    LONGS_EQUAL(0, bind (sock_listen, (struct sockaddr *)&addr,
+                         sizeof (addr)));
+    LONGS_EQUAL(0, listen (sock_listen, 1));
+    length = sizeof (addr);
+    LONGS_EQUAL(0, getsockname (sock_listen, (struct sockaddr *)&addr,
+                                &length));
+    sock_client = socket (AF_INET, SOCK_STREAM, 0);
+    CHECK(sock_client >= 0);
+    LONGS_EQUAL(0, connect (sock_client, (struct sockaddr *)&addr,
+                            sizeof (addr)));
+    sock_server = accept (sock_listen, NULL, NULL);
+    CHECK(sock_server >= 0);
+
+    /* watch only exceptions on fd */
+    hook = hook_fd (NULL, sock_server, 0, 0, 1, &test_fd_exception_cb,
+                    NULL, NULL);
+    CHECK(hook);
+
+    LONGS_EQUAL(1, send (sock_client, "!", 1, MSG_OOB));
+    usleep (10000);
+    test_fd_cb_count = 0;
+    hook_fd_exec ();
+    LONGS_EQUAL(1, test_fd_cb_count);
+
+    unhook (hook);
+
+    close (sock_server);
+    close (sock_client);
+    close (sock_listen);
+}
+
+#define TEST_FD_BENCHMARK_PIPES 256
+#define TEST_FD_BENCHMARK_LOOPS 20000
+
+/*
+ * Runs hook_fd_exec with one active fd among many hooked fds and displays
+ * the time per call.
+ */
+
+void
+test_fd_benchmark_run (int fds[][2], int num_pipes)
+{
+    struct timeval tv_start, tv_end;
+    clock_t clock_start, clock_end;
+    long long diff;
+    ssize_t num_written;
+    int i;
+
+    gettimeofday (&tv_start, NULL);
+    clock_start = clock ();
+    for (i = 0; i < TEST_FD_BENCHMARK_LOOPS; i++)
+    {
+        num_written = write (fds[i % num_pipes][1], "a", 1);
+        (void) num_written;
+        hook_fd_exec ();
+    }
+    clock_end = clock ();
+    gettimeofday (&tv_end, NULL);
+
+    diff = util_timeval_diff (&tv_start, &tv_end);
+    printf ("hook_fd_exec (%s, %d fds, 1 ready): %.3f us/call "
+            "(cpu: %.3f us/call)\n",
+            hook_fd_backend_string[hook_fd_backend],
+            num_pipes,
+            (double)diff / TEST_FD_BENCHMARK_LOOPS,
+            ((double)(clock_end - clock_start) * 1000000 / CLOCKS_PER_SEC)
+            / TEST_FD_BENCHMARK_LOOPS);
+}
+
+/*
+ * Benchmark of hook_fd_exec: poll vs epoll backend.
+ */
+
+TEST(CoreHook, FdBenchmark)
+{
+    struct t_hook *hooks[TEST_FD_BENCHMARK_PIPES], *hook_file;
+    FILE *file;
+    int fds[TEST_FD_BENCHMARK_PIPES][2], i, old_backend;
+
+    if (!getenv (WEE_TEST_BENCHMARK_ENV))
+        return;
+
+    old_backend = hook_fd_backend;
+
+    for (i = 0; i < TEST_FD_BENCHMARK_PIPES; i++)
+    {
+        LONGS_EQUAL(0, pipe (fds[i]));
+        hooks[i] = hook_fd (NULL, fds[i][0], 1, 0, 0, &test_fd_cb,
+                            NULL, NULL);
+        CHECK(hooks[i]);
+    }
+
+    /* current backend (epoll if available) */
+    test_fd_benchmark_run (fds, TEST_FD_BENCHMARK_PIPES);
+
+    /* poll backend (a regular file can not be watched with epoll) */
+    file = tmpfile ();
+    CHECK(file);
+    hook_file = hook_fd (NULL, fileno (file), 1, 0, 0, &test_fd_cb,
+                         NULL, NULL);
+    CHECK(hook_file);
+    LONGS_EQUAL(HOOK_FD_BACKEND_POLL, hook_fd_backend);
+    test_fd_benchmark_run (fds, TEST_FD_BENCHMARK_PIPES);
+    unhook (hook_file);
+    fclose (file);
+
+    for (i = 0; i < TEST_FD_BENCHMARK_PIPES; i++)
+    {
+        unhook (hooks[i]);
+        close (fds[i][0]);
+        close (fds[i][1]);
+    }
+
+    /* restore the backend */
+    if (old_backend != HOOK_FD_BACKEND_POLL)
+        hook_fd_init ();
 }
 
 /*
@@ -158,14 +494,96 @@ TEST(CoreHook, Infolist)
     /* TODO: write tests */
 }
 
+char test_line_order[64];
+
+struct t_hashtable *
+test_line_cb (const void *pointer, void *data, struct t_hashtable *line)
+{
+    struct t_hashtable *hashtable;
+    const char *name, *tags;
+    int length;
+
+    /* make C++ compiler happy */
+    (void) data;
+
+    name = (const char *)pointer;
+
+    length = strlen (test_line_order);
+    if (length < (int)sizeof (test_line_order) - 1)
+    {
+        test_line_order[length] = name[0];
+        test_line_order[length + 1] = '\0';
+    }
+
+    /* tag "set_tag9": replace tags of line by "tag9" */
+    tags = (const char *)hashtable_get (line, "tags");
+    if (!tags || !strstr (tags, "set_tag9"))
+        return NULL;
+
+    hashtable = hashtable_new (8,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING,
+                               NULL, NULL);
+    if (hashtable)
+        hashtable_set (hashtable, "tags", "tag9");
+
+    return hashtable;
+}
+
+#define WEE_CHECK_LINE(__order, __buffer, __tags)                       \
+    test_line_order[0] = '\0';                                          \
+    gui_chat_printf_date_tags (__buffer, 0, __tags, "prefix\tmessage");  \
+    STRCMP_EQUAL(__order, test_line_order);
+
 /*
  * Tests functions:
  *   hook_line
+ *   hook_line_exec
  */
 
 TEST(CoreHook, Line)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *test_buffer;
+    struct t_hook *hook1, *hook2, *hook3, *hook4, *hook5;
+
+    test_buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
+                                  NULL, NULL, NULL,
+                                  NULL, NULL, NULL);
+    CHECK(test_buffer);
+
+    hook1 = hook_line (NULL, NULL, NULL, NULL, &test_line_cb, "a", NULL);
+    hook2 = hook_line (NULL, NULL, "core." TEST_BUFFER_NAME, "tag1",
+                       &test_line_cb, "b", NULL);
+    hook3 = hook_line (NULL, NULL, "core.other", NULL,
+                       &test_line_cb, "c", NULL);
+    hook4 = hook_line (NULL, "*", "*", "TAG9", &test_line_cb, "d", NULL);
+    hook5 = hook_line (NULL, "free", NULL, NULL, &test_line_cb, "e", NULL);
+    CHECK(hook1);
+    CHECK(hook2);
+    CHECK(hook3);
+    CHECK(hook4);
+    CHECK(hook5);
+
+    /* twice: the second uses the index */
+    WEE_CHECK_LINE("ab", test_buffer, "tag1");
+    WEE_CHECK_LINE("ab", test_buffer, "tag1");
+    WEE_CHECK_LINE("a", test_buffer, "tag2");
+    WEE_CHECK_LINE("a", NULL, "tag1");
+    WEE_CHECK_LINE("ad", test_buffer, "tag9");
+
+    /* tags updated by a callback: checked by the next hooks */
+    WEE_CHECK_LINE("ad", test_buffer, "tag1,set_tag9");
+
+    unhook (hook1);
+    WEE_CHECK_LINE("b", test_buffer, "tag1");
+
+    unhook (hook2);
+    unhook (hook3);
+    unhook (hook4);
+    unhook (hook5);
+    WEE_CHECK_LINE("", test_buffer, "tag1");
+
+    gui_buffer_close (test_buffer);
 }
 
 char *
@@ -348,18 +766,187 @@ TEST(CoreHook, Modifier)
     POINTERS_EQUAL(NULL, ptr_line->data->prefix);
     STRCMP_EQUAL("message (modified)", ptr_line->data->message);
 
+    unhook (hook);
+
     /* close the test buffer */
     gui_buffer_close (test_buffer);
 }
 
+char *
+test_modifier_add_cb (const void *pointer, void *data,
+                      const char *modifier, const char *modifier_data,
+                      const char *string)
+{
+    char *new_string;
+    int length;
+
+    /* make C++ compiler happy */
+    (void) data;
+    (void) modifier;
+    (void) modifier_data;
+
+    /* add the name of hook (in pointer) at the end of string */
+    length = strlen (string) + 1 + strlen ((const char *)pointer) + 1;
+    new_string = (char *)malloc (length);
+    if (new_string)
+        snprintf (new_string, length, "%s %s", string, (const char *)pointer);
+
+    return new_string;
+}
+
+/*
+ * Tests functions:
+ *   hook_modifier_has_hooks
+ *   hook_modifier_exec
+ */
+
+TEST(CoreHook, ModifierHasHooks)
+{
+    struct t_hook *hook1, *hook2;
+    char *str;
+
+    LONGS_EQUAL(0, hook_modifier_has_hooks (NULL));
+    LONGS_EQUAL(0, hook_modifier_has_hooks (""));
+    LONGS_EQUAL(0, hook_modifier_has_hooks ("test_modifier"));
+
+    /* no hook: string is returned unchanged */
+    str = hook_modifier_exec (NULL, "test_modifier", "data", "string");
+    STRCMP_EQUAL("string", str);
+    free (str);
+
+    hook1 = hook_modifier (NULL, "test_modifier", &test_modifier_add_cb,
+                           "a", NULL);
+    hook2 = hook_modifier (NULL, "2000|TEST_Modifier", &test_modifier_add_cb,
+                           "b", NULL);
+    CHECK(hook1);
+    CHECK(hook2);
+
+    /* name of modifier is case insensitive */
+    LONGS_EQUAL(1, hook_modifier_has_hooks ("test_modifier"));
+    LONGS_EQUAL(1, hook_modifier_has_hooks ("Test_Modifier"));
+    LONGS_EQUAL(0, hook_modifier_has_hooks ("test_modifier2"));
+
+    str = hook_modifier_exec (NULL, "test_modifier", "data", "string");
+    STRCMP_EQUAL("string b a", str);
+    free (str);
+
+    /* modifier still hooked until the last hook is removed */
+    unhook (hook2);
+    LONGS_EQUAL(1, hook_modifier_has_hooks ("test_modifier"));
+    str = hook_modifier_exec (NULL, "test_modifier", "data", "string");
+    STRCMP_EQUAL("string a", str);
+    free (str);
+
+    unhook (hook1);
+    LONGS_EQUAL(0, hook_modifier_has_hooks ("test_modifier"));
+    str = hook_modifier_exec (NULL, "test_modifier", "data", "string");
+    STRCMP_EQUAL("string", str);
+    free (str);
+}
+
+char test_print_order[64];
+char test_print_message[64];
+
+int
+test_print_cb (const void *pointer, void *data,
+               struct t_gui_buffer *buffer, time_t date,
+               int tags_count, const char **tags, int displayed,
+               int highlight, const char *prefix, const char *message)
+{
+    const char *name;
+    int length;
+
+    /* make C++ compiler happy */
+    (void) data;
+    (void) buffer;
+    (void) date;
+    (void) tags_count;
+    (void) tags;
+    (void) displayed;
+    (void) highlight;
+    (void) prefix;
+
+    name = (const char *)pointer;
+
+    length = strlen (test_print_order);
+    if (length < (int)sizeof (test_print_order) - 1)
+    {
+        test_print_order[length] = name[0];
+        test_print_order[length + 1] = '\0';
+    }
+
+    snprintf (test_print_message, sizeof (test_print_message), "%s", message);
+
+    return WEECHAT_RC_OK;
+}
+
+#define WEE_CHECK_PRINT(__order, __buffer, __tags, __message)           \
+    test_print_order[0] = '\0';                                         \
+    gui_chat_printf_date_tags (__buffer, 0, __tags, __message);         \
+    STRCMP_EQUAL(__order, test_print_order);
+
 /*
  * Tests functions:
  *   hook_print
+ *   hook_print_exec
  */
 
 TEST(CoreHook, Print)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *test_buffer;
+    struct t_hook *hook1, *hook2, *hook3, *hook4, *hook5, *hook6;
+    char str_message[128];
+
+    test_buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
+                                  NULL, NULL, NULL,
+                                  NULL, NULL, NULL);
+    CHECK(test_buffer);
+
+    hook1 = hook_print (NULL, NULL, NULL, NULL, 0, &test_print_cb, "a", NULL);
+    hook2 = hook_print (NULL, test_buffer, "tag1", NULL, 0,
+                        &test_print_cb, "b", NULL);
+    hook3 = hook_print (NULL, NULL, "TAG2+tag3,tag4", NULL, 0,
+                        &test_print_cb, "c", NULL);
+    hook4 = hook_print (NULL, NULL, "tag_*", NULL, 0,
+                        &test_print_cb, "d", NULL);
+    hook5 = hook_print (NULL, NULL, "!tag1", NULL, 0,
+                        &test_print_cb, "e", NULL);
+    hook6 = hook_print (NULL, NULL, NULL, "hello", 1,
+                        &test_print_cb, "f", NULL);
+    CHECK(hook1);
+    CHECK(hook2);
+    CHECK(hook3);
+    CHECK(hook4);
+    CHECK(hook5);
+    CHECK(hook6);
+
+    /* hooks by buffer and tags (twice: the second uses the index) */
+    WEE_CHECK_PRINT("ab", test_buffer, "tag1", "message");
+    WEE_CHECK_PRINT("ab", test_buffer, "tag1", "message");
+    WEE_CHECK_PRINT("a", NULL, "tag1", "message");
+    WEE_CHECK_PRINT("ace", test_buffer, "tag2,tag3", "message");
+    WEE_CHECK_PRINT("ae", test_buffer, "tag2", "message");
+    WEE_CHECK_PRINT("ace", test_buffer, "TAG4", "message");
+    WEE_CHECK_PRINT("ade", test_buffer, "tag_x", "message");
+
+    /* hook by message, with colors stripped */
+    snprintf (str_message, sizeof (str_message),
+              "%sHello world", gui_color_get_custom ("red"));
+    WEE_CHECK_PRINT("aef", test_buffer, NULL, str_message);
+    STRCMP_EQUAL("Hello world", test_print_message);
+    WEE_CHECK_PRINT("ae", test_buffer, NULL, "message");
+
+    unhook (hook2);
+    WEE_CHECK_PRINT("a", test_buffer, "tag1", "message");
+
+    unhook (hook1);
+    unhook (hook3);
+    unhook (hook4);
+    unhook (hook5);
+    unhook (hook6);
+    WEE_CHECK_PRINT("", test_buffer, "tag1", "message");
+
+    gui_buffer_close (test_buffer);
 }
 
 /*
@@ -373,14 +960,110 @@ TEST(CoreHook, Process)
     /* TODO: write tests */
 }
 
+char test_signal_order[64];
+struct t_hook *test_signal_hook_unhook = NULL;
+
+int
+test_signal_cb (const void *pointer, void *data, const char *signal,
+                const char *type_data, void *signal_data)
+{
+    const char *name;
+    int length;
+
+    /* make C++ compiler happy */
+    (void) data;
+    (void) signal;
+    (void) type_data;
+    (void) signal_data;
+
+    name = (const char *)pointer;
+
+    length = strlen (test_signal_order);
+    if (length < (int)sizeof (test_signal_order) - 1)
+    {
+        test_signal_order[length] = name[0];
+        test_signal_order[length + 1] = '\0';
+    }
+
+    /* "u": unhook a hook while signal is sent */
+    if ((name[0] == 'u') && test_signal_hook_unhook)
+    {
+        unhook (test_signal_hook_unhook);
+        test_signal_hook_unhook = NULL;
+    }
+
+    /* "!": eat signal */
+    return (name[1] == '!') ? WEECHAT_RC_OK_EAT : WEECHAT_RC_OK;
+}
+
+#define WEE_CHECK_SIGNAL(__order, __rc, __signal)                       \
+    test_signal_order[0] = '\0';                                        \
+    LONGS_EQUAL(__rc, hook_signal_send (__signal,                       \
+                                        WEECHAT_HOOK_SIGNAL_STRING,     \
+                                        NULL));                         \
+    STRCMP_EQUAL(__order, test_signal_order);
+
 /*
  * Tests functions:
  *   hook_signal
+ *   hook_signal_send
  */
 
 TEST(CoreHook, Signal)
 {
-    /* TODO: write tests */
+    struct t_hook *hook1, *hook2, *hook3, *hook4, *hook5, *hook6;
+    int count;
+
+    POINTERS_EQUAL(NULL, hook_signal (NULL, NULL, &test_signal_cb,
+                                      NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_signal (NULL, "", &test_signal_cb,
+                                      NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_signal (NULL, "test_signal", NULL,
+                                      NULL, NULL));
+
+    hook1 = hook_signal (NULL, "test_signal", &test_signal_cb, "a", NULL);
+    hook2 = hook_signal (NULL, "2000|test_*", &test_signal_cb, "b", NULL);
+    hook3 = hook_signal (NULL, "*_other", &test_signal_cb, "c", NULL);
+    hook4 = hook_signal (NULL, "500|*", &test_signal_cb, "d", NULL);
+    CHECK(hook1);
+    CHECK(hook2);
+    CHECK(hook3);
+    CHECK(hook4);
+
+    /* hooks are called by priority (twice: the second uses the index) */
+    WEE_CHECK_SIGNAL("bad", WEECHAT_RC_OK, "test_signal");
+    WEE_CHECK_SIGNAL("bad", WEECHAT_RC_OK, "test_signal");
+    WEE_CHECK_SIGNAL("bcd", WEECHAT_RC_OK, "test_other");
+    WEE_CHECK_SIGNAL("bcd", WEECHAT_RC_OK, "TEST_OTHER");
+    WEE_CHECK_SIGNAL("d", WEECHAT_RC_OK, "xxx");
+
+    /* no signal: no hook called, nothing added in index */
+    count = hook_signal_index->items_count;
+    WEE_CHECK_SIGNAL("", WEECHAT_RC_OK, NULL);
+    LONGS_EQUAL(count, hook_signal_index->items_count);
+
+    /* new hook eating the signal */
+    hook5 = hook_signal (NULL, "1500|test_signal", &test_signal_cb, "e!",
+                         NULL);
+    CHECK(hook5);
+    WEE_CHECK_SIGNAL("be", WEECHAT_RC_OK_EAT, "test_signal");
+    WEE_CHECK_SIGNAL("bcd", WEECHAT_RC_OK, "test_other");
+    unhook (hook5);
+    WEE_CHECK_SIGNAL("bad", WEECHAT_RC_OK, "test_signal");
+
+    /* hook removed while the signal is sent: it is not called */
+    hook6 = hook_signal (NULL, "3000|test_signal", &test_signal_cb, "u",
+                         NULL);
+    CHECK(hook6);
+    test_signal_hook_unhook = hook1;
+    WEE_CHECK_SIGNAL("ubd", WEECHAT_RC_OK, "test_signal");
+    WEE_CHECK_SIGNAL("ubd", WEECHAT_RC_OK, "test_signal");
+
+    unhook (hook2);
+    unhook (hook3);
+    unhook (hook4);
+    unhook (hook6);
+    WEE_CHECK_SIGNAL("", WEECHAT_RC_OK, "test_signal");
 }
 
 /*
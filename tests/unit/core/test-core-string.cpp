@@ -1887,6 +1887,7 @@ TEST(CoreString, Input)
 /*
  * Tests functions:
  *    string_shared_get
+ *    string_shared_get_id
  *    string_shared_free
  */
 
@@ -1894,6 +1895,7 @@ TEST(CoreString, Shared)
 {
     const char *str1, *str2, *str3;
     int count;
+    string_shared_id_t id1, id3;
 
     count = (string_hashtable_shared) ?
         string_hashtable_shared->items_count : 0;
@@ -1918,6 +1920,14 @@ TEST(CoreString, Shared)
 
     LONGS_EQUAL(count + 2, string_hashtable_shared->items_count);
 
+    LONGS_EQUAL(0, string_shared_get_id (NULL));
+    id1 = string_shared_get_id (str1);
+    id3 = string_shared_get_id (str3);
+    CHECK(id1 > 0);
+    CHECK(id3 > 0);
+    CHECK(id1 != id3);
+    LONGS_EQUAL(id1, string_shared_get_id (str2));
+
     string_shared_free (str1);
     LONGS_EQUAL(count + 2, string_hashtable_shared->items_count);
 
@@ -1926,6 +1936,12 @@ TEST(CoreString, Shared)
 
     string_shared_free (str3);
     LONGS_EQUAL(count + 0, string_hashtable_shared->items_count);
+
+    /* id is not reused for a new string */
+    str1 = string_shared_get ("this is a test");
+    CHECK(string_shared_get_id (str1) != id1);
+    CHECK(string_shared_get_id (str1) != id3);
+    string_shared_free (str1);
 }
 
 /*
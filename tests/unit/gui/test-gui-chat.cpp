@@ -0,0 +1,455 @@
+/*
+ * test-gui-chat.cpp - test chat functions
+ *
+ * Copyright (C) 2026 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "tests/tests.h"
+#include "src/core/wee-config.h"
+#include "src/core/wee-config-file.h"
+#include "src/core/wee-debug.h"
+#include "src/core/wee-hashtable.h"
+#include "src/core/wee-hdata.h"
+#include "src/core/wee-util.h"
+#include "src/core/hook/wee-hook-hdata.h"
+#include "src/gui/gui-bar.h"
+#include "src/gui/gui-bar-item.h"
+#include "src/gui/gui-bar-window.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-filter.h"
+#include "src/gui/gui-line.h"
+#include "src/gui/gui-window.h"
+#include "src/plugins/plugin.h"
+
+extern int gui_term_cols, gui_term_lines;
+extern unsigned long long ncurses_fake_cells_written;
+extern void gui_main_refreshes ();
+}
+
+TEST_GROUP(GuiChat)
+{
+    int old_term_cols, old_term_lines;
+    struct t_gui_buffer *old_buffer, *buffer;
+
+    /*
+     * use a 80x25 terminal (the size is 0x0 by default with the fake ncurses
+     * library, so nothing is drawn)
+     */
+    void setup ()
+    {
+        old_term_cols = gui_term_cols;
+        old_term_lines = gui_term_lines;
+        old_buffer = gui_current_window->buffer;
+        gui_term_cols = 80;
+        gui_term_lines = 25;
+        gui_window_refresh_screen (0);
+        buffer = gui_buffer_new (NULL, "test_chat",
+                                 NULL, NULL, NULL, NULL, NULL, NULL);
+        gui_window_switch_to_buffer (gui_current_window, buffer, 1);
+        gui_main_refreshes ();
+    }
+
+    void teardown ()
+    {
+        gui_window_switch_to_buffer (gui_current_window, old_buffer, 1);
+        gui_buffer_close (buffer);
+        gui_term_cols = old_term_cols;
+        gui_term_lines = old_term_lines;
+        gui_window_refresh_screen (0);
+        gui_main_refreshes ();
+    }
+};
+
+/*
+ * Tests functions:
+ *   gui_chat_draw (only new lines drawn)
+ */
+
+TEST(GuiChat, DrawLinesAdded)
+{
+    unsigned long long draws_full, draws_partial, cells;
+    unsigned long long cells_lines_added, cells_full_draw;
+    int i;
+
+    for (i = 0; i < 100; i++)
+    {
+        gui_chat_printf (buffer, "test line %d", i);
+    }
+    gui_main_refreshes ();
+
+    /* new line at end of buffer: only this line is drawn */
+    draws_full = gui_chat_draws_full;
+    draws_partial = gui_chat_draws_partial;
+    cells = ncurses_fake_cells_written;
+    gui_chat_printf (buffer, "new line");
+    gui_main_refreshes ();
+    LONGS_EQUAL(draws_full, gui_chat_draws_full);
+    LONGS_EQUAL(draws_partial + 1, gui_chat_draws_partial);
+    cells_lines_added = ncurses_fake_cells_written - cells;
+
+    /* full draw of chat area */
+    cells = ncurses_fake_cells_written;
+    gui_buffer_ask_chat_refresh (buffer, 1);
+    gui_main_refreshes ();
+    LONGS_EQUAL(draws_full + 1, gui_chat_draws_full);
+    cells_full_draw = ncurses_fake_cells_written - cells;
+
+    CHECK(cells_lines_added > 0);
+    CHECK(cells_lines_added * 5 < cells_full_draw);
+
+    /* line displayed in chat area removed: full draw */
+    draws_full = gui_chat_draws_full;
+    gui_buffer_clear (buffer);
+    gui_main_refreshes ();
+    LONGS_EQUAL(draws_full + 1, gui_chat_draws_full);
+}
+
+/*
+ * Tests functions:
+ *   gui_bar_window_draw (bar window not drawn if content is unchanged)
+ */
+
+TEST(GuiChat, BarWindowDrawSkipped)
+{
+    struct t_gui_bar *ptr_bar;
+    unsigned long long draws_skipped;
+
+    draws_skipped = gui_bar_window_draws_skipped;
+    ptr_bar = gui_bar_search ("title");
+    CHECK(ptr_bar);
+    gui_bar_ask_refresh (ptr_bar);
+    gui_main_refreshes ();
+    CHECK(gui_bar_window_draws_skipped > draws_skipped);
+
+    /* title changed: bar window is drawn */
+    draws_skipped = gui_bar_window_draws_skipped;
+    gui_buffer_set_title (buffer, "new title");
+    gui_main_refreshes ();
+    LONGS_EQUAL(draws_skipped, gui_bar_window_draws_skipped);
+}
+
+/*
+ * Tests functions:
+ *   gui_bar_item_update
+ *   gui_bar_item_process_updates
+ */
+
+TEST(GuiChat, BarItemUpdates)
+{
+    struct t_gui_bar_item *ptr_item;
+    unsigned long long requested, done, builds;
+
+    ptr_item = gui_bar_item_search ("buffer_title");
+    CHECK(ptr_item);
+    LONGS_EQUAL(0, ptr_item->update_pending);
+    requested = ptr_item->updates_requested;
+    done = ptr_item->updates_done;
+    builds = ptr_item->builds;
+
+    /* many updates before refresh: item is built only once */
+    gui_buffer_set_title (buffer, "title 1");
+    gui_buffer_set_title (buffer, "title 2");
+    gui_bar_item_update ("buffer_title");
+    LONGS_EQUAL(1, ptr_item->update_pending);
+    LONGS_EQUAL(requested + 3, ptr_item->updates_requested);
+    LONGS_EQUAL(done, ptr_item->updates_done);
+    LONGS_EQUAL(builds, ptr_item->builds);
+    gui_main_refreshes ();
+    LONGS_EQUAL(0, ptr_item->update_pending);
+    LONGS_EQUAL(done + 1, ptr_item->updates_done);
+    LONGS_EQUAL(builds + 1, ptr_item->builds);
+
+    /* no update pending: item is not built again */
+    gui_main_refreshes ();
+    LONGS_EQUAL(done + 1, ptr_item->updates_done);
+    LONGS_EQUAL(builds + 1, ptr_item->builds);
+}
+
+/*
+ * Tests functions:
+ *   gui_bar_item_process_updates (updates asked during draw of chat area)
+ */
+
+TEST(GuiChat, BarItemUpdatesScroll)
+{
+    struct t_gui_bar_item *ptr_item;
+    unsigned long long done, builds;
+    char scroll[32];
+    int i;
+
+    ptr_item = gui_bar_item_search ("scroll");
+    CHECK(ptr_item);
+
+    for (i = 0; i < 100; i++)
+    {
+        gui_chat_printf_date_tags (buffer, 0, NULL, "line %d", i);
+    }
+    gui_main_refreshes ();
+    LONGS_EQUAL(0, ptr_item->update_pending);
+    LONGS_EQUAL(0, gui_current_window->scroll->scrolling);
+
+    /*
+     * scroll is detected during draw of chat area (signal "window_scrolled"):
+     * item "scroll" is updated in the same refresh of screen
+     */
+    done = ptr_item->updates_done;
+    builds = ptr_item->builds;
+    snprintf (scroll, sizeof (scroll), "-50");
+    gui_window_scroll (gui_current_window, scroll);
+    gui_main_refreshes ();
+    LONGS_EQUAL(1, gui_current_window->scroll->scrolling);
+    LONGS_EQUAL(0, ptr_item->update_pending);
+    CHECK(ptr_item->updates_done > done);
+    CHECK(ptr_item->builds > builds);
+
+    /* back to the end of buffer */
+    done = ptr_item->updates_done;
+    gui_window_scroll_bottom (gui_current_window);
+    gui_main_refreshes ();
+    LONGS_EQUAL(0, gui_current_window->scroll->scrolling);
+    LONGS_EQUAL(0, ptr_item->update_pending);
+    CHECK(ptr_item->updates_done > done);
+}
+
+/*
+ * Tests functions:
+ *   debug_display (counters of bar items)
+ */
+
+TEST(GuiChat, BarItemUpdatesDebug)
+{
+    struct t_gui_bar_item *ptr_item;
+    struct t_gui_buffer *ptr_core_buffer;
+    struct t_gui_line *ptr_line;
+    char expected[256];
+    int found;
+
+    ptr_item = gui_bar_item_search ("buffer_title");
+    CHECK(ptr_item);
+    gui_bar_item_update ("buffer_title");
+    gui_main_refreshes ();
+
+    ptr_core_buffer = gui_buffer_search_main ();
+    CHECK(ptr_core_buffer);
+    debug_display ();
+    snprintf (expected, sizeof (expected),
+              "    buffer_title: %llu, %llu, %llu",
+              ptr_item->updates_requested,
+              ptr_item->updates_done,
+              ptr_item->builds);
+    found = 0;
+    for (ptr_line = ptr_core_buffer->own_lines->last_line; ptr_line;
+         ptr_line = ptr_line->prev_line)
+    {
+        if (!ptr_line->data->message)
+            continue;
+        if (strcmp (ptr_line->data->message, "Display:") == 0)
+            break;
+        if (strcmp (ptr_line->data->message, expected) == 0)
+            found = 1;
+    }
+    CHECK(ptr_line);
+    LONGS_EQUAL(1, found);
+}
+
+/*
+ * Tests functions:
+ *   gui_chat_display_line (layout of message cached in lines)
+ *   gui_line_layout_reset
+ */
+
+TEST(GuiChat, LineLayout)
+{
+    struct t_gui_line *line1;
+    struct t_gui_filter *filter;
+    struct t_hashtable *hashtable;
+    char message[256];
+    int lines_80, align_first;
+    unsigned long long hits, misses;
+
+    memset (message, 'x', sizeof (message) - 1);
+    message[sizeof (message) - 1] = '\0';
+    gui_chat_printf_date_tags (buffer, 0, NULL, "nick\t%s", message);
+    line1 = buffer->own_lines->last_line;
+    gui_main_refreshes ();
+
+    /* layout computed on first display */
+    LONGS_EQUAL(gui_current_window->win_chat_width, line1->data->layout.width);
+    CHECK(line1->data->layout.lines > 3);
+    lines_80 = line1->data->layout.lines;
+
+    /* layout found on next displays */
+    hits = gui_line_layout_hits;
+    misses = gui_line_layout_misses;
+    gui_buffer_ask_chat_refresh (buffer, 2);
+    gui_main_refreshes ();
+    CHECK(gui_line_layout_hits > hits);
+    LONGS_EQUAL(misses, gui_line_layout_misses);
+    LONGS_EQUAL(lines_80, line1->data->layout.lines);
+
+    /* resize of terminal: layout computed again */
+    gui_term_cols = 60;
+    gui_window_refresh_screen (0);
+    gui_main_refreshes ();
+    CHECK(gui_line_layout_misses > misses);
+    LONGS_EQUAL(gui_current_window->win_chat_width, line1->data->layout.width);
+    CHECK(line1->data->layout.lines > lines_80);
+    gui_term_cols = 80;
+    gui_window_refresh_screen (0);
+    gui_main_refreshes ();
+    LONGS_EQUAL(lines_80, line1->data->layout.lines);
+
+    /* line with a longer prefix: alignment changed */
+    align_first = line1->data->layout.align_first;
+    gui_chat_printf_date_tags (buffer, 0, "t1", "long_nick_name\tmessage");
+    gui_main_refreshes ();
+    CHECK(line1->data->layout.align_first > align_first);
+    align_first = line1->data->layout.align_first;
+
+    /* line with longer prefix filtered: alignment changed */
+    misses = gui_line_layout_misses;
+    filter = gui_filter_new (1, "test_layout", "core.test_chat", "t1", "*");
+    CHECK(filter);
+    gui_filter_all_buffers (filter);
+    gui_main_refreshes ();
+    CHECK(gui_line_layout_misses > misses);
+    CHECK(line1->data->layout.align_first < align_first);
+    gui_filter_free (filter);
+    gui_filter_all_buffers (NULL);
+    gui_main_refreshes ();
+    LONGS_EQUAL(align_first, line1->data->layout.align_first);
+
+    /* message of line changed: layout is reset and computed again */
+    hashtable = hashtable_new (8, WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING, NULL, NULL);
+    CHECK(hashtable);
+    hashtable_set (hashtable, "message", "short message");
+    LONGS_EQUAL(1, hdata_update (hook_hdata_get (NULL, "line_data"), line1->data,
+                                 hashtable));
+    hashtable_free (hashtable);
+    LONGS_EQUAL(0, line1->data->layout.width);
+    misses = gui_line_layout_misses;
+    gui_main_refreshes ();
+    CHECK(gui_line_layout_misses > misses);
+    LONGS_EQUAL(1, line1->data->layout.lines);
+}
+
+/*
+ * Tests functions:
+ *   gui_chat_display_line (layout of message with tabs)
+ *   config_change_tab_width
+ */
+
+TEST(GuiChat, LineLayoutTabWidth)
+{
+    struct t_gui_line *line1;
+    char message[128];
+    int i, lines_tab_1;
+
+    /* message with 40 tabs: "\tx\tx\tx..." */
+    for (i = 0; i < 40; i++)
+    {
+        message[i * 2] = '\t';
+        message[(i * 2) + 1] = 'x';
+    }
+    message[80] = '\0';
+    gui_chat_printf_date_tags (buffer, 0, NULL, "nick\t%s", message);
+    line1 = buffer->own_lines->last_line;
+    gui_main_refreshes ();
+    lines_tab_1 = line1->data->layout.lines;
+    CHECK(lines_tab_1 > 0);
+
+    /* larger tab width: layout is computed again */
+    config_file_option_set (config_look_tab_width, "8", 1);
+    gui_main_refreshes ();
+    CHECK(line1->data->layout.lines > lines_tab_1);
+
+    config_file_option_reset (config_look_tab_width, 1);
+    gui_main_refreshes ();
+    LONGS_EQUAL(lines_tab_1, line1->data->layout.lines);
+}
+
+#define GUI_CHAT_BENCHMARK_LINES 2000
+
+/*
+ * Displays a line then refreshes the screen, GUI_CHAT_BENCHMARK_LINES times,
+ * and displays the number of cells written (with the fake ncurses library)
+ * and the time per refresh.
+ *
+ * Argument "redraw" is:
+ *   0: nothing more than the line displayed is redrawn
+ *   1: the whole chat area is redrawn after each line
+ *   2: the whole screen is redrawn after each line
+ */
+
+void
+gui_chat_benchmark_run (struct t_gui_buffer *buffer, int redraw)
+{
+    struct timeval tv_start, tv_end;
+    unsigned long long cells;
+    long long diff;
+    int i;
+
+    cells = ncurses_fake_cells_written;
+    gettimeofday (&tv_start, NULL);
+    for (i = 0; i < GUI_CHAT_BENCHMARK_LINES; i++)
+    {
+        gui_chat_printf_date_tags (buffer, 0, NULL,
+                                   "nick%d\tthis is the message %d",
+                                   i % 10, i);
+        if (redraw == 1)
+            gui_buffer_ask_chat_refresh (buffer, 2);
+        else if (redraw == 2)
+            gui_window_ask_refresh (1);
+        gui_main_refreshes ();
+    }
+    gettimeofday (&tv_end, NULL);
+    diff = util_timeval_diff (&tv_start, &tv_end);
+    cells = ncurses_fake_cells_written - cells;
+
+    printf ("refresh after a new line (%s): %llu cells/refresh, "
+            "%.1f us/refresh\n",
+            (redraw == 0) ? "line only" :
+            ((redraw == 1) ? "chat area" : "screen"),
+            cells / GUI_CHAT_BENCHMARK_LINES,
+            (double)diff / GUI_CHAT_BENCHMARK_LINES);
+}
+
+/*
+ * Benchmark of refreshes: cells written on screen when lines are displayed
+ * in a buffer (only new lines drawn vs full chat area vs full screen).
+ */
+
+TEST(GuiChat, RefreshBenchmark)
+{
+    if (!getenv (WEE_TEST_BENCHMARK_ENV))
+        return;
+
+    gui_chat_benchmark_run (buffer, 0);
+    gui_chat_benchmark_run (buffer, 1);
+    gui_chat_benchmark_run (buffer, 2);
+}
@@ -0,0 +1,259 @@
+/*
+ * test-gui-filter.cpp - test filter functions
+ *
+ * Copyright (C) 2019 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include "src/core/wee-config.h"
+#include "src/core/wee-config-file.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-filter.h"
+#include "src/gui/gui-line.h"
+
+extern int gui_filter_timer_cb (const void *pointer, void *data,
+                                int remaining_calls);
+}
+
+TEST_GROUP(GuiFilter)
+{
+    struct t_gui_buffer *buffer;
+
+    void setup ()
+    {
+        buffer = gui_buffer_new (NULL, "test_filter",
+                                 NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+
+    void teardown ()
+    {
+        gui_filter_free_all ();
+        gui_buffer_close (buffer);
+    }
+
+    /* add lines with tag "t1" (odd lines) or "t2" (even lines) */
+    void add_lines (int count)
+    {
+        int i;
+
+        for (i = 0; i < count; i++)
+        {
+            gui_chat_printf_date_tags (buffer, 0, (i % 2) ? "t1" : "t2",
+                                       "line %d", i);
+        }
+    }
+
+    /* check displayed flag of all lines */
+    void check_lines (int t1_displayed, int t2_displayed)
+    {
+        struct t_gui_line *ptr_line;
+        int hidden;
+
+        hidden = 0;
+        for (ptr_line = buffer->own_lines->first_line; ptr_line;
+             ptr_line = ptr_line->next_line)
+        {
+            if (gui_line_search_tag_starting_with (ptr_line, "t1"))
+                LONGS_EQUAL(t1_displayed, ptr_line->data->displayed);
+            else
+                LONGS_EQUAL(t2_displayed, ptr_line->data->displayed);
+            if (!ptr_line->data->displayed)
+                hidden++;
+        }
+        LONGS_EQUAL(hidden, buffer->own_lines->lines_hidden);
+    }
+};
+
+/*
+ * Tests functions:
+ *   gui_filter_new
+ *   gui_filter_all_buffers
+ *   gui_filter_buffer_check
+ *   gui_filter_global_enable
+ *   gui_filter_global_disable
+ *   gui_filter_free
+ */
+
+TEST(GuiFilter, Mask)
+{
+    struct t_gui_filter *filter1, *filter2;
+    struct t_gui_line *ptr_line;
+
+    add_lines (10);
+    check_lines (1, 1);
+
+    filter1 = gui_filter_new (1, "test1", "core.test_filter", "t1", "*");
+    CHECK(filter1);
+    LONGS_EQUAL(0, filter1->index);
+    gui_filter_all_buffers (filter1);
+    check_lines (0, 1);
+
+    filter2 = gui_filter_new (1, "test2", "core.test_filter", "t2", "*");
+    CHECK(filter2);
+    LONGS_EQUAL(1, filter2->index);
+    gui_filter_all_buffers (filter2);
+    check_lines (0, 0);
+
+    /* bits of matching filters are set in lines */
+    for (ptr_line = buffer->own_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        LONGS_EQUAL(
+            (gui_line_search_tag_starting_with (ptr_line, "t1")) ? 1 : 2,
+            ptr_line->data->filters_matched);
+    }
+
+    /* disable filter: bits are kept in lines */
+    filter1->enabled = 0;
+    gui_filter_all_buffers (filter1);
+    check_lines (1, 0);
+    LONGS_EQUAL(1, buffer->own_lines->last_line->data->filters_matched);
+
+    /* filters disabled globally, then enabled */
+    gui_filter_global_disable ();
+    check_lines (1, 1);
+    gui_filter_global_enable ();
+    check_lines (1, 0);
+
+    /* filters disabled in buffer */
+    buffer->filter = 0;
+    gui_filter_buffer_check (buffer, 0);
+    check_lines (1, 1);
+    buffer->filter = 1;
+    gui_filter_buffer_check (buffer, 0);
+    check_lines (1, 0);
+
+    /* filter enabled again, new line */
+    filter1->enabled = 1;
+    gui_filter_all_buffers (filter1);
+    check_lines (0, 0);
+    add_lines (1);
+    check_lines (0, 0);
+
+    /* free of filter: index is reused */
+    gui_filter_all_buffers (filter2);
+    gui_filter_free (filter2);
+    filter2 = NULL;
+    gui_filter_all_buffers (NULL);
+    check_lines (0, 1);
+    filter2 = gui_filter_new (1, "test3", "core.test_filter", "t1", "*");
+    LONGS_EQUAL(1, filter2->index);
+}
+
+/*
+ * Tests functions:
+ *   gui_filter_buffer_check (filter by batches of lines)
+ *   gui_filter_timer_cb
+ */
+
+TEST(GuiFilter, Batch)
+{
+    struct t_gui_filter *filter;
+    struct t_gui_line *ptr_line;
+    int i, count, displayed;
+
+    /* no limit on number of lines in buffer */
+    config_file_option_set (config_history_max_buffer_lines_number, "0", 0);
+
+    add_lines (GUI_FILTER_BATCH_LINES + 1000);
+
+    filter = gui_filter_new (1, "test1", "core.test_filter", "t1", "*");
+    CHECK(filter);
+    gui_filter_all_buffers (filter);
+
+    /* last lines are filtered, filtering of other lines is pending */
+    CHECK(buffer->own_lines->filter_line);
+    LONGS_EQUAL(1U << filter->index, buffer->own_lines->filter_mask_check);
+    ptr_line = buffer->own_lines->last_line;
+    for (i = 0; i < GUI_FILTER_BATCH_LINES; i++)
+    {
+        displayed = (gui_line_search_tag_starting_with (ptr_line, "t1")) ?
+            0 : 1;
+        LONGS_EQUAL(displayed, ptr_line->data->displayed);
+        ptr_line = ptr_line->prev_line;
+    }
+    POINTERS_EQUAL(ptr_line, buffer->own_lines->filter_line);
+    count = 0;
+    for (; ptr_line; ptr_line = ptr_line->prev_line)
+    {
+        LONGS_EQUAL(1, ptr_line->data->displayed);
+        count++;
+    }
+    LONGS_EQUAL(1000, count);
+    LONGS_EQUAL(GUI_FILTER_BATCH_LINES / 2, buffer->own_lines->lines_hidden);
+
+    /* new filtering while one is pending: merged, restart from last line */
+    filter->enabled = 0;
+    gui_filter_all_buffers (filter);
+    filter->enabled = 1;
+    gui_filter_all_buffers (filter);
+    CHECK(buffer->own_lines->filter_line);
+
+    /* next batch */
+    gui_filter_timer_cb (NULL, NULL, 0);
+    POINTERS_EQUAL(NULL, buffer->own_lines->filter_line);
+    LONGS_EQUAL(0, buffer->own_lines->filter_mask_check);
+    check_lines (0, 1);
+    gui_filter_timer_cb (NULL, NULL, 0);
+
+    config_file_option_reset (config_history_max_buffer_lines_number, 0);
+}
+
+/*
+ * Tests functions:
+ *   gui_filter_buffer_renamed
+ */
+
+TEST(GuiFilter, BufferRenamed)
+{
+    struct t_gui_filter *filter;
+
+    add_lines (10);
+
+    /* filter on another buffer name: no line filtered */
+    filter = gui_filter_new (1, "test1", "core.test_filter2", "t1", "*");
+    CHECK(filter);
+    gui_filter_all_buffers (filter);
+    check_lines (1, 1);
+    LONGS_EQUAL(0, buffer->own_lines->last_line->data->filters_matched);
+
+    /* buffer renamed: the filter now matches the buffer */
+    gui_buffer_set (buffer, "name", "test_filter2");
+    STRCMP_EQUAL("core.test_filter2", buffer->full_name);
+    check_lines (0, 1);
+    LONGS_EQUAL(0, buffer->own_lines->first_line->data->filters_matched);
+    LONGS_EQUAL(1U << filter->index,
+                buffer->own_lines->last_line->data->filters_matched);
+
+    /* bits are used when filters are toggled */
+    gui_filter_global_disable ();
+    check_lines (1, 1);
+    gui_filter_global_enable ();
+    check_lines (0, 1);
+
+    /* buffer renamed again: filter does not match any more */
+    gui_buffer_set (buffer, "name", "test_filter");
+    check_lines (1, 1);
+    gui_filter_global_disable ();
+    gui_filter_global_enable ();
+    check_lines (1, 1);
+}
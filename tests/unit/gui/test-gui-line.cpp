@@ -23,7 +23,12 @@
 
 extern "C"
 {
+#include <string.h>
+#include <time.h>
+#include "src/core/wee-hashtable.h"
 #include "src/core/wee-string.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
 #include "src/gui/gui-line.h"
 }
 
@@ -50,6 +55,8 @@ TEST(GuiLine, LineMatchTags)
     char ***tags_array;
     int tags_count;
 
+    memset (&line_data, 0, sizeof (line_data));
+
     /* line without tags */
     WEE_LINE_MATCH_TAGS(0, NULL, NULL);
     WEE_LINE_MATCH_TAGS(0, NULL, "irc_join");
@@ -78,4 +85,195 @@ TEST(GuiLine, LineMatchTags)
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "nick_test,irc_quit");
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!irc_quit,!irc_302,!irc_notice");
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!irc_quit+!irc_302+!irc_notice");
+
+    /* masks with wildcards, case insensitive comparison */
+    WEE_LINE_MATCH_TAGS(0, "irc_join,nick_test", "nick_abc*");
+    WEE_LINE_MATCH_TAGS(0, "irc_join,nick_test", "!nick_*");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "nick_te*");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "*_join+nick_*");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "NICK_TEST");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!nick_abc*");
+
+    /* same checks again (results are now in cache) */
+    WEE_LINE_MATCH_TAGS(0, "irc_join,nick_test", "nick_abc*");
+    WEE_LINE_MATCH_TAGS(0, "irc_join,nick_test", "!nick_*");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "nick_te*");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "NICK_TEST");
+}
+
+/*
+ * Tests functions:
+ *   gui_line_match_tag
+ */
+
+TEST(GuiLine, LineMatchTag)
+{
+    const char *tag, *tag2, *mask, *mask2, *mask3;
+
+    tag = string_shared_get ("irc_privmsg");
+    tag2 = string_shared_get ("nick_alice");
+    mask = string_shared_get ("irc_*");
+    mask2 = string_shared_get ("!irc_*");
+    mask3 = string_shared_get ("nick_bob");
+
+    LONGS_EQUAL(1, gui_line_match_tag (tag, mask));
+    LONGS_EQUAL(1, gui_line_match_tag (tag, mask2));
+    LONGS_EQUAL(0, gui_line_match_tag (tag, mask3));
+    LONGS_EQUAL(0, gui_line_match_tag (tag2, mask));
+    LONGS_EQUAL(0, gui_line_match_tag (tag2, mask3));
+
+    /* results in cache */
+    CHECK(gui_line_tags_match_cache);
+    CHECK(gui_line_tags_match_cache->items_count >= 5);
+    LONGS_EQUAL(1, gui_line_match_tag (tag, mask));
+    LONGS_EQUAL(1, gui_line_match_tag (tag, mask2));
+    LONGS_EQUAL(0, gui_line_match_tag (tag, mask3));
+    LONGS_EQUAL(0, gui_line_match_tag (tag2, mask));
+    LONGS_EQUAL(0, gui_line_match_tag (tag2, mask3));
+
+    /* a new tag (maybe at same address) must not use results of old tag */
+    string_shared_free (tag2);
+    tag2 = string_shared_get ("irc_notice");
+    LONGS_EQUAL(1, gui_line_match_tag (tag2, mask));
+    LONGS_EQUAL(0, gui_line_match_tag (tag2, mask3));
+
+    string_shared_free (tag);
+    string_shared_free (tag2);
+    string_shared_free (mask);
+    string_shared_free (mask2);
+    string_shared_free (mask3);
+}
+
+/*
+ * Tests functions:
+ *   gui_line_tags_count
+ *   gui_line_tags_split
+ */
+
+TEST(GuiLine, TagsSplit)
+{
+    const char *tags[] = { "a", "irc_privmsg,nick_alice,log1", ",a,,b,",
+                           NULL };
+    char *tags_array[16], **tags_array2, long_tags[1024];
+    int i, j, count, count2;
+
+    LONGS_EQUAL(0, gui_line_tags_count (NULL));
+    LONGS_EQUAL(0, gui_line_tags_count (""));
+
+    /* same result as string_split_shared */
+    for (i = 0; tags[i]; i++)
+    {
+        count = gui_line_tags_count (tags[i]);
+        tags_array2 = string_split_shared (tags[i], ",", NULL, 0, 0, &count2);
+        LONGS_EQUAL(count2, count);
+        LONGS_EQUAL(1, gui_line_tags_split (tags[i], count, tags_array));
+        for (j = 0; j < count; j++)
+        {
+            POINTERS_EQUAL(tags_array2[j], tags_array[j]);
+            string_shared_free (tags_array[j]);
+        }
+        POINTERS_EQUAL(NULL, tags_array[count]);
+        string_free_split_shared (tags_array2);
+    }
+
+    /* tag longer than internal buffer */
+    memset (long_tags, 'x', sizeof (long_tags) - 1);
+    long_tags[sizeof (long_tags) - 1] = '\0';
+    long_tags[1] = ',';
+    LONGS_EQUAL(2, gui_line_tags_count (long_tags));
+    LONGS_EQUAL(1, gui_line_tags_split (long_tags, 2, tags_array));
+    STRCMP_EQUAL("x", tags_array[0]);
+    LONGS_EQUAL(sizeof (long_tags) - 3, strlen (tags_array[1]));
+    POINTERS_EQUAL(NULL, tags_array[2]);
+    string_shared_free (tags_array[0]);
+    string_shared_free (tags_array[1]);
+}
+
+/*
+ * Tests functions:
+ *   gui_line_new (lines allocated in chunks)
+ *   gui_line_free
+ *   gui_line_get_chunk
+ */
+
+TEST(GuiLine, Chunks)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_line *line1, *line2, *line3;
+    struct t_gui_line_chunk *chunk;
+    char big_message[GUI_LINE_CHUNK_SIZE];
+    int i;
+
+    buffer = gui_buffer_new (NULL, "test_line_chunks",
+                             NULL, NULL, NULL, NULL, NULL, NULL);
+    CHECK(buffer);
+    POINTERS_EQUAL(NULL, buffer->own_lines->current_chunk);
+
+    /* line, data, tags, time and message are stored in the same chunk */
+    gui_chat_printf_date_tags (buffer, time (NULL), "tag1,tag2", "line 1");
+    line1 = buffer->own_lines->last_line;
+    CHECK(line1);
+    chunk = gui_line_get_chunk (line1);
+    CHECK(chunk);
+    POINTERS_EQUAL(chunk, buffer->own_lines->current_chunk);
+    POINTERS_EQUAL(GUI_LINE_CHUNK_DATA(chunk), line1);
+    LONGS_EQUAL(1, chunk->lines_count);
+    LONGS_EQUAL(2, line1->data->tags_count);
+    STRCMP_EQUAL("tag1", line1->data->tags_array[0]);
+    STRCMP_EQUAL("tag2", line1->data->tags_array[1]);
+    POINTERS_EQUAL(NULL, line1->data->tags_array[2]);
+    CHECK(gui_line_data_in_chunk (line1->data, line1->data->tags_array));
+    CHECK(line1->data->str_time);
+    CHECK(gui_line_data_in_chunk (line1->data, line1->data->str_time));
+    STRCMP_EQUAL("line 1", line1->data->message);
+    CHECK(gui_line_data_in_chunk (line1->data, line1->data->message));
+
+    /* next lines are in the same chunk */
+    gui_chat_printf_date_tags (buffer, 0, NULL, "line 2");
+    line2 = buffer->own_lines->last_line;
+    POINTERS_EQUAL(chunk, gui_line_get_chunk (line2));
+    POINTERS_EQUAL(NULL, line2->data->tags_array);
+    CHECK((char *)line2 > (char *)line1);
+    gui_chat_printf_date_tags (buffer, 0, NULL, "line 3");
+    line3 = buffer->own_lines->last_line;
+    POINTERS_EQUAL(chunk, gui_line_get_chunk (line3));
+    LONGS_EQUAL(3, chunk->lines_count);
+
+    /* big line: dedicated chunk, freed with the line */
+    memset (big_message, 'x', sizeof (big_message) - 1);
+    big_message[sizeof (big_message) - 1] = '\0';
+    gui_chat_printf_date_tags (buffer, 0, NULL, big_message);
+    CHECK(gui_line_get_chunk (buffer->own_lines->last_line));
+    CHECK(gui_line_get_chunk (buffer->own_lines->last_line) != chunk);
+    POINTERS_EQUAL(chunk, buffer->own_lines->current_chunk);
+    gui_line_free (buffer, buffer->own_lines->last_line);
+    POINTERS_EQUAL(line3, buffer->own_lines->last_line);
+
+    /* free of lines: current chunk is kept */
+    gui_line_free (buffer, line2);
+    LONGS_EQUAL(2, chunk->lines_count);
+    gui_line_free (buffer, line1);
+    gui_line_free (buffer, line3);
+    POINTERS_EQUAL(NULL, buffer->own_lines->first_line);
+    POINTERS_EQUAL(chunk, buffer->own_lines->current_chunk);
+    LONGS_EQUAL(0, chunk->lines_count);
+    LONGS_EQUAL(0, chunk->used);
+
+    /* the empty chunk is reused from the beginning */
+    gui_chat_printf_date_tags (buffer, 0, "tag3", "line 4");
+    line1 = buffer->own_lines->last_line;
+    POINTERS_EQUAL(GUI_LINE_CHUNK_DATA(chunk), line1);
+    LONGS_EQUAL(1, chunk->lines_count);
+
+    /* a new chunk is used when the current one is full */
+    for (i = 0; i < 1000; i++)
+    {
+        gui_chat_printf_date_tags (buffer, 0, "tag3", "line %d", i);
+    }
+    CHECK(buffer->own_lines->current_chunk != chunk);
+    CHECK(chunk->lines_count > 1);
+    CHECK(chunk->used <= chunk->size);
+    POINTERS_EQUAL(chunk, gui_line_get_chunk (line1));
+
+    gui_buffer_close (buffer);
 }
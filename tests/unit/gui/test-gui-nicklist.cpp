@@ -0,0 +1,360 @@
+/*
+ * test-gui-nicklist.cpp - test nicklist functions
+ *
+ * Copyright (C) 2019 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "src/core/wee-config.h"
+#include "src/core/wee-string.h"
+#include "src/gui/gui-bar-item.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-color.h"
+#include "src/gui/gui-nicklist.h"
+#include "src/gui/gui-window.h"
+
+extern void gui_main_refreshes ();
+
+/* compare nicks, ignoring the end of nicks from char "|" */
+int
+test_gui_nicklist_nickcmp_cb (const void *pointer, void *data,
+                              struct t_gui_buffer *buffer,
+                              const char *nick1, const char *nick2)
+{
+    int length1, length2;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) buffer;
+
+    length1 = strcspn (nick1, "|");
+    length2 = strcspn (nick2, "|");
+    if (length1 != length2)
+        return (length1 < length2) ? -1 : 1;
+    return strncmp (nick1, nick2, length1);
+}
+}
+
+TEST_GROUP(GuiNicklist)
+{
+    struct t_gui_buffer *buffer;
+
+    void setup ()
+    {
+        buffer = gui_buffer_new (NULL, "test_nicklist",
+                                 NULL, NULL, NULL, NULL, NULL, NULL);
+        gui_buffer_set (buffer, "nicklist", "1");
+    }
+
+    void teardown ()
+    {
+        gui_buffer_close (buffer);
+    }
+};
+
+/*
+ * Tests functions:
+ *   gui_nicklist_add_nick (bulk mode)
+ *   gui_nicklist_sort_nicks
+ *   gui_nicklist_bulk_end
+ */
+
+TEST(GuiNicklist, BulkMode)
+{
+    struct t_gui_nick_group *group;
+    struct t_gui_nick *ptr_nick;
+    const char *names[] = { "delta", "Alpha", "charlie", "bravo", "echo",
+                            "alpha2", "Bravo2", "a", NULL };
+    const char *sorted[] = { "a", "Alpha", "alpha2", "bravo", "Bravo2",
+                             "charlie", "delta", "echo", NULL };
+    char name[32];
+    int i;
+
+    group = gui_nicklist_add_group (buffer, NULL, "group", NULL, 1);
+    CHECK(group);
+
+    gui_buffer_set (buffer, "nicklist_bulk", "1");
+    LONGS_EQUAL(1, gui_buffer_get_integer (buffer, "nicklist_bulk"));
+
+    /* nicks are added in order, not sorted */
+    for (i = 0; names[i]; i++)
+    {
+        CHECK(gui_nicklist_add_nick (buffer, group, names[i],
+                                     NULL, NULL, NULL, 1));
+    }
+    STRCMP_EQUAL("delta", group->nicks->name);
+    STRCMP_EQUAL("a", group->last_nick->name);
+    LONGS_EQUAL(8, buffer->nicklist_nicks_count);
+
+    /* end of bulk mode: nicks are sorted */
+    gui_buffer_set (buffer, "nicklist_bulk", "0");
+    LONGS_EQUAL(0, gui_buffer_get_integer (buffer, "nicklist_bulk"));
+    ptr_nick = group->nicks;
+    for (i = 0; sorted[i]; i++)
+    {
+        CHECK(ptr_nick);
+        STRCMP_EQUAL(sorted[i], ptr_nick->name);
+        if (i == 0)
+            POINTERS_EQUAL(NULL, ptr_nick->prev_nick);
+        else
+            STRCMP_EQUAL(sorted[i - 1], ptr_nick->prev_nick->name);
+        ptr_nick = ptr_nick->next_nick;
+    }
+    POINTERS_EQUAL(NULL, ptr_nick);
+    STRCMP_EQUAL("echo", group->last_nick->name);
+
+    /* many nicks, added in reverse order */
+    gui_nicklist_remove_all (buffer);
+    gui_buffer_set (buffer, "nicklist_bulk", "1");
+    for (i = 999; i >= 0; i--)
+    {
+        snprintf (name, sizeof (name), "nick%04d", i);
+        CHECK(gui_nicklist_add_nick (buffer, NULL, name,
+                                     NULL, NULL, NULL, 1));
+    }
+    gui_buffer_set (buffer, "nicklist_bulk", "0");
+    LONGS_EQUAL(1000, buffer->nicklist_nicks_count);
+    i = 0;
+    for (ptr_nick = buffer->nicklist_root->nicks; ptr_nick;
+         ptr_nick = ptr_nick->next_nick)
+    {
+        snprintf (name, sizeof (name), "nick%04d", i);
+        STRCMP_EQUAL(name, ptr_nick->name);
+        i++;
+    }
+    LONGS_EQUAL(1000, i);
+    STRCMP_EQUAL("nick0999", buffer->nicklist_root->last_nick->name);
+
+    /* nick added after bulk mode is inserted in sorted list */
+    CHECK(gui_nicklist_add_nick (buffer, NULL, "nick0500a",
+                                 NULL, NULL, NULL, 1));
+    ptr_nick = gui_nicklist_search_nick (buffer, NULL, "nick0500a");
+    CHECK(ptr_nick);
+    STRCMP_EQUAL("nick0500", ptr_nick->prev_nick->name);
+    STRCMP_EQUAL("nick0501", ptr_nick->next_nick->name);
+}
+
+/*
+ * Tests functions:
+ *   gui_nicklist_search_nick
+ *   gui_nicklist_add_nick
+ *   gui_nicklist_remove_nick
+ */
+
+TEST(GuiNicklist, Index)
+{
+    struct t_gui_nick_group *group, *group2;
+    struct t_gui_nick *nick1, *nick2, *ptr_nick;
+    char name[32];
+    int i;
+
+    group = gui_nicklist_add_group (buffer, NULL, "group", NULL, 1);
+    CHECK(group);
+    group2 = gui_nicklist_add_group (buffer, group, "group2", NULL, 1);
+    CHECK(group2);
+
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick"));
+
+    /* search is case sensitive without callback "nickcmp_callback" */
+    nick1 = gui_nicklist_add_nick (buffer, group, "Nick[a]",
+                                   NULL, NULL, NULL, 1);
+    CHECK(nick1);
+    nick2 = gui_nicklist_add_nick (buffer, group2, "nick{a}",
+                                   NULL, NULL, NULL, 1);
+    CHECK(nick2);
+    POINTERS_EQUAL(nick2, nick1->next_nick_index);
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL, "Nick[a]"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, NULL, "nick{a}"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick[a]"));
+    POINTERS_EQUAL(NULL, gui_nicklist_add_nick (buffer, group, "Nick[a]",
+                                                NULL, NULL, NULL, 1));
+
+    /* search in a group and its children */
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, group, "nick{a}"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, group2, "nick{a}"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, group2, "Nick[a]"));
+
+    /* remove nicks with same key in index */
+    gui_nicklist_remove_nick (buffer, nick2);
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick{a}"));
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL, "Nick[a]"));
+    gui_nicklist_remove_nick (buffer, nick1);
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "Nick[a]"));
+
+    /* many nicks, added in random order: nicks are sorted */
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf (name, sizeof (name), "nick%04d", (i * 7919) % 1000);
+        CHECK(gui_nicklist_add_nick (buffer, NULL, name,
+                                     NULL, NULL, NULL, 1));
+    }
+    LONGS_EQUAL(1000, buffer->nicklist_nicks_count);
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "NICK0001"));
+    for (i = 0; i < 1000; i += 2)
+    {
+        snprintf (name, sizeof (name), "nick%04d", i);
+        ptr_nick = gui_nicklist_search_nick (buffer, NULL, name);
+        CHECK(ptr_nick);
+        gui_nicklist_remove_nick (buffer, ptr_nick);
+    }
+    LONGS_EQUAL(500, buffer->nicklist_nicks_count);
+    i = 1;
+    for (ptr_nick = buffer->nicklist_root->nicks; ptr_nick;
+         ptr_nick = ptr_nick->next_nick)
+    {
+        snprintf (name, sizeof (name), "nick%04d", i);
+        STRCMP_EQUAL(name, ptr_nick->name);
+        POINTERS_EQUAL(ptr_nick, gui_nicklist_search_nick (buffer, NULL, name));
+        i += 2;
+    }
+    LONGS_EQUAL(1001, i);
+}
+
+/*
+ * Tests functions:
+ *   gui_nicklist_search_nick (callback "nickcmp_callback" and NULL buffer)
+ *   gui_nicklist_search_nick_in_group
+ */
+
+TEST(GuiNicklist, SearchNickcmp)
+{
+    struct t_gui_nick_group *group, *group2;
+    struct t_gui_nick *nick1, *nick2;
+
+    group = gui_nicklist_add_group (buffer, NULL, "group", NULL, 1);
+    CHECK(group);
+    group2 = gui_nicklist_add_group (buffer, group, "group2", NULL, 1);
+    CHECK(group2);
+    nick1 = gui_nicklist_add_nick (buffer, group, "alice|away",
+                                   NULL, NULL, NULL, 1);
+    CHECK(nick1);
+    nick2 = gui_nicklist_add_nick (buffer, group2, "bob",
+                                   NULL, NULL, NULL, 1);
+    CHECK(nick2);
+
+    /* NULL buffer: search by a walk of the group (case sensitive) */
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (NULL, NULL, "bob"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (NULL, group, "bob"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (NULL, group2, "bob"));
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (NULL, group,
+                                                    "alice|away"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (NULL, group2,
+                                                   "alice|away"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (NULL, group, "BOB"));
+
+    /* custom callback with unknown case range: search by a walk */
+    gui_buffer_set_pointer (buffer, "nickcmp_callback",
+                            (void *)&test_gui_nicklist_nickcmp_cb);
+    LONGS_EQUAL(-1, gui_buffer_get_integer (buffer, "nickcmp_case_range"));
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL, "alice"));
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL,
+                                                    "alice|back"));
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, group, "alice"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, group2, "alice"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, NULL, "bob|x"));
+    POINTERS_EQUAL(NULL, gui_nicklist_add_nick (buffer, NULL, "alice",
+                                                NULL, NULL, NULL, 1));
+
+    /* invalid case range */
+    gui_buffer_set (buffer, "nickcmp_case_range", "31");
+    LONGS_EQUAL(-1, gui_buffer_get_integer (buffer, "nickcmp_case_range"));
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL, "alice"));
+
+    /* case range declared by the buffer: search with the index */
+    gui_buffer_set (buffer, "nickcmp_case_range", "30");
+    LONGS_EQUAL(30, gui_buffer_get_integer (buffer, "nickcmp_case_range"));
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL,
+                                                    "alice|away"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, group, "bob"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "alice"));
+
+    gui_buffer_set (buffer, "nickcmp_case_range", "-1");
+    gui_buffer_set_pointer (buffer, "nickcmp_callback", NULL);
+}
+
+/*
+ * Tests functions:
+ *   gui_bar_item_nicklist_signal_cb
+ *   gui_bar_item_buffer_nicklist_cb
+ */
+
+TEST(GuiNicklist, BarItem)
+{
+    struct t_gui_buffer *old_buffer;
+    struct t_gui_bar_item *ptr_item;
+    unsigned long long requested, done;
+    char expected[1024], *value;
+
+    ptr_item = gui_bar_item_search ("buffer_nicklist");
+    CHECK(ptr_item);
+
+    gui_main_refreshes ();
+    LONGS_EQUAL(0, ptr_item->update_pending);
+    requested = ptr_item->updates_requested;
+
+    /* buffer not displayed: no update of item */
+    CHECK(gui_nicklist_add_nick (buffer, NULL, "alice",
+                                 "bar_fg", "@", "lightgreen", 1));
+    LONGS_EQUAL(0, ptr_item->update_pending);
+    LONGS_EQUAL(requested, ptr_item->updates_requested);
+
+    /* buffer displayed: one update of item for many changes */
+    old_buffer = gui_current_window->buffer;
+    gui_window_switch_to_buffer (gui_current_window, buffer, 1);
+    gui_main_refreshes ();
+    requested = ptr_item->updates_requested;
+    done = ptr_item->updates_done;
+    CHECK(gui_nicklist_add_nick (buffer, NULL, "bob",
+                                 "bar_fg", "@", "lightgreen", 1));
+    LONGS_EQUAL(1, ptr_item->update_pending);
+    CHECK(gui_nicklist_add_nick (buffer, NULL, "carol",
+                                 "weechat.color.nicklist_away", NULL, NULL, 1));
+    LONGS_EQUAL(1, ptr_item->update_pending);
+    LONGS_EQUAL(requested + 2, ptr_item->updates_requested);
+    gui_main_refreshes ();
+    LONGS_EQUAL(0, ptr_item->update_pending);
+    LONGS_EQUAL(done + 1, ptr_item->updates_done);
+
+    /* content of item (same colors for consecutive nicks) */
+    snprintf (expected, sizeof (expected), "%s@%salice\n",
+              gui_color_get_custom ("lightgreen"),
+              gui_color_get_custom ("bar_fg"));
+    snprintf (expected + strlen (expected),
+              sizeof (expected) - strlen (expected), "%s@%sbob\n",
+              gui_color_get_custom ("lightgreen"),
+              gui_color_get_custom ("bar_fg"));
+    snprintf (expected + strlen (expected),
+              sizeof (expected) - strlen (expected), "%scarol",
+              gui_color_get_custom (
+                  gui_color_get_name (
+                      CONFIG_COLOR(config_color_nicklist_away))));
+    value = (ptr_item->build_callback) (NULL, NULL, ptr_item,
+                                        gui_current_window, buffer, NULL);
+    STRCMP_EQUAL(expected, value);
+    free (value);
+
+    gui_window_switch_to_buffer (gui_current_window, old_buffer, 1);
+    gui_main_refreshes ();
+}
@@ -28,9 +28,11 @@ extern "C"
 #include "src/core/wee-config-file.h"
 #include "src/core/wee-hashtable.h"
 #include "src/core/wee-hook.h"
+#include "src/core/wee-string.h"
 #include "src/plugins/irc/irc-config.h"
 #include "src/plugins/irc/irc-message.h"
 #include "src/plugins/irc/irc-server.h"
+#include "src/plugins/plugin.h"
 }
 
 #define NICK_256_WITH_SPACE "nick_xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx" \
@@ -586,6 +588,82 @@ TEST(IrcMessage, GetAddressFromHost)
                  irc_message_get_address_from_host (NICK_256_WITH_SPACE));
 }
 
+/*
+ * Checks that arrays argv/argv_eol built by irc_message_split_args are the
+ * same as the arrays built by string_split.
+ */
+
+void
+test_irc_message_split_args (const char *message, int strip_right_eol)
+{
+    char **argv, **argv_eol, **argv2, **argv_eol2;
+    int i, argc, argc2, rc, flags;
+
+    argv2 = string_split (message, " ", NULL,
+                          WEECHAT_STRING_SPLIT_STRIP_LEFT
+                          | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                          | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                          0, &argc2);
+    flags = WEECHAT_STRING_SPLIT_STRIP_LEFT
+        | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS
+        | WEECHAT_STRING_SPLIT_KEEP_EOL;
+    if (strip_right_eol)
+        flags |= WEECHAT_STRING_SPLIT_STRIP_RIGHT;
+    argv_eol2 = string_split (message, " ", NULL, flags, 0, NULL);
+
+    rc = irc_message_split_args (message, strip_right_eol,
+                                 &argc, &argv, &argv_eol);
+
+    LONGS_EQUAL((argv2) ? 1 : 0, rc);
+    LONGS_EQUAL(argc2, argc);
+    if (argv2)
+    {
+        for (i = 0; i < argc; i++)
+        {
+            STRCMP_EQUAL(argv2[i], argv[i]);
+            STRCMP_EQUAL(argv_eol2[i], argv_eol[i]);
+        }
+        POINTERS_EQUAL(NULL, argv[argc]);
+        POINTERS_EQUAL(NULL, argv_eol[argc]);
+    }
+    else
+    {
+        POINTERS_EQUAL(NULL, argv);
+        POINTERS_EQUAL(NULL, argv_eol);
+    }
+
+    if (argv)
+        free (argv);
+    if (argv_eol)
+        free (argv_eol);
+    string_free_split (argv2);
+    string_free_split (argv_eol2);
+}
+
+/*
+ * Tests functions:
+ *   irc_message_split_args
+ */
+
+TEST(IrcMessage, SplitArgs)
+{
+    const char *messages[] = {
+        NULL, "", " ", "   ", "a", " a", "a ", "  a  ",
+        "PING :server",
+        ":nick!user@host PRIVMSG #weechat :hello!",
+        ":nick!user@host  PRIVMSG   #weechat  :hello   world!   ",
+        ":server 353 nick = #weechat :nick1 nick2 @nick3 +nick4 ",
+        NULL,
+    };
+    int i;
+
+    for (i = 0; i < (int)(sizeof (messages) / sizeof (messages[0])); i++)
+    {
+        test_irc_message_split_args (messages[i], 0);
+        test_irc_message_split_args (messages[i], 1);
+    }
+}
+
 /*
  * Tests functions:
  *   irc_message_replace_vars
@@ -23,7 +23,11 @@
 
 extern "C"
 {
+#include "src/core/wee-hashtable.h"
+#include "src/plugins/irc/irc-server.h"
+#include "src/plugins/irc/irc-channel.h"
 #include "src/plugins/irc/irc-nick.h"
+#include "src/plugins/irc/irc-protocol.h"
 }
 
 TEST_GROUP(IrcNick)
@@ -68,3 +72,104 @@ TEST(IrcNick, IsNick)
     LONGS_EQUAL(1, irc_nick_is_nick ("alice"));
     LONGS_EQUAL(1, irc_nick_is_nick ("very_long_nick_which_is_valid"));
 }
+
+/*
+ * Tests functions:
+ *   irc_nick_new
+ *   irc_nick_change
+ *   irc_nick_free
+ *   irc_nick_search
+ *   irc_nick_index_rebuild
+ */
+
+TEST(IrcNick, Index)
+{
+    struct t_irc_server *server;
+    struct t_irc_channel *channel, *pv;
+    struct t_irc_nick *nick1, *nick2, *nick3;
+
+    server = irc_server_alloc ("test_nick_index");
+    CHECK(server);
+    LONGS_EQUAL(IRC_SERVER_CASEMAPPING_RFC1459, server->casemapping);
+
+    channel = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test",
+                               0, 0);
+    CHECK(channel);
+    CHECK(channel->nicks_index);
+
+    nick1 = irc_nick_new (server, channel, "Alice", NULL, NULL, 0, NULL, NULL);
+    nick2 = irc_nick_new (server, channel, "bob[", NULL, NULL, 0, NULL, NULL);
+    nick3 = irc_nick_new (server, channel, "carol", NULL, NULL, 0, NULL, NULL);
+    CHECK(nick1);
+    CHECK(nick2);
+    CHECK(nick3);
+    LONGS_EQUAL(3, hashtable_get_integer (channel->nicks_index,
+                                          "items_count"));
+
+    /* search with casemapping rfc1459: "[" and "{" are equivalent */
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, NULL));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "unknown"));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "Alice"));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "ALICE"));
+    POINTERS_EQUAL(nick2, irc_nick_search (server, channel, "bob["));
+    POINTERS_EQUAL(nick2, irc_nick_search (server, channel, "BOB{"));
+    POINTERS_EQUAL(nick3, irc_nick_search (server, channel, "Carol"));
+
+    /* change of nick */
+    irc_nick_change (server, channel, nick3, "Dave");
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "carol"));
+    POINTERS_EQUAL(nick3, irc_nick_search (server, channel, "dave"));
+    LONGS_EQUAL(3, hashtable_get_integer (channel->nicks_index,
+                                          "items_count"));
+
+    /* change of case only */
+    irc_nick_change (server, channel, nick3, "DAVE");
+    POINTERS_EQUAL(nick3, irc_nick_search (server, channel, "Dave"));
+    LONGS_EQUAL(3, hashtable_get_integer (channel->nicks_index,
+                                          "items_count"));
+
+    /* casemapping changed by message 005: index is rebuilt */
+    irc_protocol_recv_command (
+        server,
+        ":server 005 alice CASEMAPPING=ascii :are supported by this server",
+        "005", NULL);
+    LONGS_EQUAL(IRC_SERVER_CASEMAPPING_ASCII, server->casemapping);
+    LONGS_EQUAL(3, hashtable_get_integer (channel->nicks_index,
+                                          "items_count"));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "aLiCe"));
+    POINTERS_EQUAL(nick2, irc_nick_search (server, channel, "BOB["));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "bob{"));
+
+    /* back to casemapping rfc1459 */
+    irc_protocol_recv_command (
+        server,
+        ":server 005 alice CASEMAPPING=rfc1459 :are supported by this server",
+        "005", NULL);
+    LONGS_EQUAL(IRC_SERVER_CASEMAPPING_RFC1459, server->casemapping);
+    POINTERS_EQUAL(nick2, irc_nick_search (server, channel, "bob{"));
+
+    /* free of nick */
+    irc_nick_free (server, channel, nick2);
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "bob["));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "alice"));
+    LONGS_EQUAL(2, hashtable_get_integer (channel->nicks_index,
+                                          "items_count"));
+
+    /* free of all nicks */
+    irc_nick_free_all (server, channel);
+    LONGS_EQUAL(0, hashtable_get_integer (channel->nicks_index,
+                                          "items_count"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "alice"));
+
+    /* no index in private buffer, search still works */
+    pv = irc_channel_new (server, IRC_CHANNEL_TYPE_PRIVATE, "Alice", 0, 0);
+    CHECK(pv);
+    POINTERS_EQUAL(NULL, pv->nicks_index);
+    nick1 = irc_nick_new (server, pv, "Alice", NULL, NULL, 0, NULL, NULL);
+    CHECK(nick1);
+    POINTERS_EQUAL(nick1, irc_nick_search (server, pv, "ALICE"));
+    irc_nick_change (server, pv, nick1, "Alice2");
+    POINTERS_EQUAL(nick1, irc_nick_search (server, pv, "alice2"));
+
+    irc_server_free (server);
+}
@@ -23,7 +23,20 @@
 
 extern "C"
 {
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "tests/tests.h"
+#include "src/core/wee-string.h"
+#include "src/core/wee-util.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-line.h"
 #include "src/plugins/irc/irc-protocol.h"
+#include "src/plugins/irc/irc-channel.h"
+#include "src/plugins/irc/irc-nick.h"
+#include "src/plugins/irc/irc-server.h"
 }
 
 TEST_GROUP(IrcProtocol)
@@ -57,3 +70,319 @@ TEST(IrcProtocol, ParseTime)
     LONGS_EQUAL(1547386699, irc_protocol_parse_time ("1547386699.123"));
     LONGS_EQUAL(1547386699, irc_protocol_parse_time ("1547386699"));
 }
+
+/*
+ * Tests functions:
+ *   irc_protocol_search_message
+ */
+
+TEST(IrcProtocol, SearchMessage)
+{
+    struct t_irc_protocol_msg *ptr_msg;
+    int i, count;
+
+    /* invalid or unknown commands */
+    POINTERS_EQUAL(NULL, irc_protocol_search_message (NULL));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message (""));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("unknown"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("priv"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("privmsgs"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("000"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("0001"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("01"));
+
+    /* commands */
+    ptr_msg = irc_protocol_search_message ("privmsg");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("privmsg", ptr_msg->name);
+    POINTERS_EQUAL(ptr_msg, irc_protocol_search_message ("PRIVMSG"));
+    POINTERS_EQUAL(ptr_msg, irc_protocol_search_message ("PrivMsg"));
+    ptr_msg = irc_protocol_search_message ("JOIN");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("join", ptr_msg->name);
+
+    /* numeric commands */
+    ptr_msg = irc_protocol_search_message ("001");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("001", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("353");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("353", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("975");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("975", ptr_msg->name);
+
+    /* hash table is a power of 2, at most half full */
+    count = 0;
+    for (i = 0; irc_protocol_messages[i].name; i++)
+    {
+        if (!isdigit ((unsigned char)irc_protocol_messages[i].name[0]))
+            count++;
+    }
+    CHECK(irc_protocol_messages_hash);
+    CHECK(irc_protocol_messages_hash_size >= (unsigned int)count * 2);
+    LONGS_EQUAL(0, irc_protocol_messages_hash_size
+                & (irc_protocol_messages_hash_size - 1));
+
+    /* all messages are found */
+    for (i = 0; irc_protocol_messages[i].name; i++)
+    {
+        ptr_msg = irc_protocol_search_message (irc_protocol_messages[i].name);
+        CHECK(ptr_msg);
+        STRCMP_EQUAL(irc_protocol_messages[i].name, ptr_msg->name);
+    }
+
+    /* tables are built again after end */
+    irc_protocol_end ();
+    POINTERS_EQUAL(NULL, irc_protocol_messages_hash);
+    ptr_msg = irc_protocol_search_message ("notice");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("notice", ptr_msg->name);
+    CHECK(irc_protocol_messages_hash);
+}
+
+/*
+ * Tests functions:
+ *   irc_protocol_recv_command (numeric command not handled by IRC plugin)
+ */
+
+TEST(IrcProtocol, RecvNumericNotHandled)
+{
+    struct t_irc_server *server;
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_line *ptr_line;
+
+    server = irc_server_alloc ("test_numeric");
+    CHECK(server);
+    irc_server_set_nick (server, "alice");
+    ptr_buffer = (server->buffer) ? server->buffer : gui_buffer_search_main ();
+
+    /* 3 digits: default callback for numeric commands */
+    irc_protocol_recv_command (server, ":server 998 alice :test 3 digits",
+                               "998", NULL);
+    ptr_line = ptr_buffer->own_lines->last_line;
+    CHECK(ptr_line);
+    CHECK(strstr (ptr_line->data->message, "test 3 digits"));
+
+    /* more than 3 digits: default callback for numeric commands too */
+    irc_protocol_recv_command (server, ":server 1234 alice :test 4 digits",
+                               "1234", NULL);
+    ptr_line = ptr_buffer->own_lines->last_line;
+    CHECK(ptr_line);
+    CHECK(strstr (ptr_line->data->message, "test 4 digits"));
+    CHECK(ptr_line->prev_line);
+    POINTERS_EQUAL(NULL, strstr (ptr_line->prev_line->data->message,
+                                 "not found"));
+
+    irc_server_free (server);
+}
+
+/*
+ * Tests functions:
+ *   irc_channel_nicklist_bulk_start
+ *   irc_channel_nicklist_bulk_end
+ *   irc_protocol_cb_353 (bulk mode in nicklist, for each server)
+ */
+
+TEST(IrcProtocol, NamesNicklistBulk)
+{
+    struct t_irc_server *server, *server2;
+    struct t_irc_channel *channel;
+
+    server = irc_server_alloc ("test_names_bulk");
+    CHECK(server);
+    irc_server_set_nick (server, "alice");
+
+    channel = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test",
+                               0, 0);
+    CHECK(channel);
+    CHECK(channel->buffer);
+    CHECK(irc_nick_new (server, channel, "alice", NULL, NULL, 0,
+                        NULL, NULL));
+
+    /* bulk mode from first 353 until 366 */
+    irc_protocol_recv_command (server, ":server 353 alice = #test :bob carol",
+                               "353", NULL);
+    POINTERS_EQUAL(channel, server->nicklist_bulk_channel);
+    LONGS_EQUAL(1, gui_buffer_get_integer (channel->buffer, "nicklist_bulk"));
+    irc_protocol_recv_command (server, ":server 353 alice = #test :dave",
+                               "353", NULL);
+    POINTERS_EQUAL(channel, server->nicklist_bulk_channel);
+    irc_protocol_recv_command (server,
+                               ":server 366 alice #test :End of /NAMES list.",
+                               "366", NULL);
+    POINTERS_EQUAL(NULL, server->nicklist_bulk_channel);
+    LONGS_EQUAL(0, gui_buffer_get_integer (channel->buffer, "nicklist_bulk"));
+    LONGS_EQUAL(4, gui_buffer_get_integer (channel->buffer, "nicklist_nicks_count"));
+
+    /* bulk mode ended by first message which is not a 353 */
+    irc_protocol_recv_command (server, ":server 353 alice = #test :eve",
+                               "353", NULL);
+    LONGS_EQUAL(1, gui_buffer_get_integer (channel->buffer, "nicklist_bulk"));
+    irc_protocol_recv_command (server, ":bob!user@host PRIVMSG #test :hi",
+                               "PRIVMSG", NULL);
+    POINTERS_EQUAL(NULL, server->nicklist_bulk_channel);
+    LONGS_EQUAL(0, gui_buffer_get_integer (channel->buffer, "nicklist_bulk"));
+    LONGS_EQUAL(5, gui_buffer_get_integer (channel->buffer, "nicklist_nicks_count"));
+
+    /* bulk mode not ended by a message from another server */
+    server2 = irc_server_alloc ("test_names_bulk2");
+    CHECK(server2);
+    irc_protocol_recv_command (server, ":server 353 alice = #test :frank",
+                               "353", NULL);
+    POINTERS_EQUAL(channel, server->nicklist_bulk_channel);
+    irc_protocol_recv_command (server2, ":server2 NOTICE alice :hello",
+                               "NOTICE", NULL);
+    POINTERS_EQUAL(channel, server->nicklist_bulk_channel);
+    LONGS_EQUAL(1, gui_buffer_get_integer (channel->buffer, "nicklist_bulk"));
+    irc_protocol_recv_command (server,
+                               ":server 366 alice #test :End of /NAMES list.",
+                               "366", NULL);
+    POINTERS_EQUAL(NULL, server->nicklist_bulk_channel);
+    LONGS_EQUAL(0, gui_buffer_get_integer (channel->buffer, "nicklist_bulk"));
+    LONGS_EQUAL(6, gui_buffer_get_integer (channel->buffer, "nicklist_nicks_count"));
+    irc_server_free (server2);
+
+    /* bulk mode ended by part of channel */
+    irc_protocol_recv_command (server, ":server 353 alice = #test :grace",
+                               "353", NULL);
+    LONGS_EQUAL(1, gui_buffer_get_integer (channel->buffer, "nicklist_bulk"));
+    irc_nick_free_all (server, channel);
+    POINTERS_EQUAL(NULL, server->nicklist_bulk_channel);
+    LONGS_EQUAL(0, gui_buffer_get_integer (channel->buffer, "nicklist_bulk"));
+    LONGS_EQUAL(0, gui_buffer_get_integer (channel->buffer, "nicklist_nicks_count"));
+
+    /* bulk mode ended when the channel is freed */
+    CHECK(irc_nick_new (server, channel, "alice", NULL, NULL, 0,
+                        NULL, NULL));
+    irc_protocol_recv_command (server, ":server 353 alice = #test :bob",
+                               "353", NULL);
+    POINTERS_EQUAL(channel, server->nicklist_bulk_channel);
+    irc_channel_free (server, channel);
+    POINTERS_EQUAL(NULL, server->nicklist_bulk_channel);
+
+    irc_server_free (server);
+}
+
+#define TEST_PROTOCOL_BENCHMARK_LOOPS 2000
+
+const char *test_protocol_benchmark_stream[][2] = {
+    { ":bob!user@host PRIVMSG #test :hello everybody", "PRIVMSG" },
+    { ":carol!user@host PRIVMSG #test :hi bob", "PRIVMSG" },
+    { ":dave!user@host JOIN #test", "JOIN" },
+    { ":bob!user@host PRIVMSG #test :how are you?", "PRIVMSG" },
+    { ":eve!user@host NOTICE #test :notice to channel", "NOTICE" },
+    { ":dave!user@host PART #test :bye", "PART" },
+    { ":carol!user@host PRIVMSG #test :fine, thanks", "PRIVMSG" },
+    { ":server 332 alice #test :topic of channel", "332" },
+    { ":frank!user@host JOIN #test", "JOIN" },
+    { ":bob!user@host MODE #test +v frank", "MODE" },
+    { ":frank!user@host QUIT :quit message", "QUIT" },
+    { ":carol!user@host PRIVMSG #test :\001ACTION waves\001", "PRIVMSG" },
+    { "PING :server", "PING" },
+    { ":server 005 alice NETWORK=test :are supported", "005" },
+    { NULL, NULL },
+};
+
+/*
+ * Searches for an IRC message with a linear search (as it was done before
+ * the dispatch tables), for comparison in benchmark.
+ */
+
+struct t_irc_protocol_msg *
+test_protocol_search_message_linear (const char *command)
+{
+    int i;
+
+    for (i = 0; irc_protocol_messages[i].name; i++)
+    {
+        if (string_strcasecmp (irc_protocol_messages[i].name, command) == 0)
+            return &irc_protocol_messages[i];
+    }
+    return NULL;
+}
+
+/*
+ * Benchmark of irc_protocol_recv_command with a stream of messages received
+ * on a channel (and of the search of messages, with dispatch tables vs
+ * linear search).
+ */
+
+TEST(IrcProtocol, RecvCommandBenchmark)
+{
+    struct t_irc_server *server;
+    struct t_irc_channel *channel;
+    struct timeval tv_start, tv_end;
+    long long diff;
+    int i, j, count;
+
+    if (!getenv (WEE_TEST_BENCHMARK_ENV))
+        return;
+
+    server = irc_server_alloc ("test_benchmark");
+    CHECK(server);
+    irc_server_set_nick (server, "alice");
+    channel = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test",
+                               0, 0);
+    CHECK(channel);
+    irc_protocol_recv_command (server,
+                               ":server 353 alice = #test :alice bob carol eve",
+                               "353", NULL);
+    irc_protocol_recv_command (server,
+                               ":server 366 alice #test :End of /NAMES list.",
+                               "366", NULL);
+
+    /* search of messages only */
+    gettimeofday (&tv_start, NULL);
+    count = 0;
+    for (i = 0; i < TEST_PROTOCOL_BENCHMARK_LOOPS * 100; i++)
+    {
+        for (j = 0; test_protocol_benchmark_stream[j][0]; j++)
+        {
+            if (irc_protocol_search_message (test_protocol_benchmark_stream[j][1]))
+                count++;
+        }
+    }
+    gettimeofday (&tv_end, NULL);
+    diff = util_timeval_diff (&tv_start, &tv_end);
+    printf ("irc_protocol_search_message (dispatch tables): "
+            "%.0f messages/s\n",
+            (diff > 0) ? (double)count * 1000000 / diff : 0);
+
+    gettimeofday (&tv_start, NULL);
+    count = 0;
+    for (i = 0; i < TEST_PROTOCOL_BENCHMARK_LOOPS * 100; i++)
+    {
+        for (j = 0; test_protocol_benchmark_stream[j][0]; j++)
+        {
+            if (test_protocol_search_message_linear (test_protocol_benchmark_stream[j][1]))
+                count++;
+        }
+    }
+    gettimeofday (&tv_end, NULL);
+    diff = util_timeval_diff (&tv_start, &tv_end);
+    printf ("irc_protocol_search_message (linear search): "
+            "%.0f messages/s\n",
+            (diff > 0) ? (double)count * 1000000 / diff : 0);
+
+    /* full processing of messages received */
+    gettimeofday (&tv_start, NULL);
+    count = 0;
+    for (i = 0; i < TEST_PROTOCOL_BENCHMARK_LOOPS; i++)
+    {
+        for (j = 0; test_protocol_benchmark_stream[j][0]; j++)
+        {
+            irc_protocol_recv_command (server,
+                                       test_protocol_benchmark_stream[j][0],
+                                       test_protocol_benchmark_stream[j][1],
+                                       NULL);
+            count++;
+        }
+    }
+    gettimeofday (&tv_end, NULL);
+    diff = util_timeval_diff (&tv_start, &tv_end);
+    printf ("irc_protocol_recv_command: %.0f lines/s\n",
+            (diff > 0) ? (double)count * 1000000 / diff : 0);
+
+    irc_server_free (server);
+}
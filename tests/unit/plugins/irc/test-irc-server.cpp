@@ -0,0 +1,351 @@
+/*
+ * test-irc-server.cpp - test IRC server functions
+ *
+ * Copyright (C) 2026 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "src/core/wee-config-file.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-line.h"
+#include "src/plugins/irc/irc-server.h"
+}
+
+#define WEE_RECV_DATA(__server, __data)                                 \
+    memcpy (__server->recv_buffer + __server->recv_buffer_length,       \
+            __data, strlen (__data));                                   \
+    __server->recv_buffer_length += strlen (__data);                    \
+    irc_server_recv_buffer_split (__server);
+
+TEST_GROUP(IrcServer)
+{
+};
+
+/*
+ * Tests functions:
+ *   irc_server_recv_buffer_split
+ *   irc_server_recv_buffer_flush
+ */
+
+TEST(IrcServer, RecvBuffer)
+{
+    struct t_irc_server *server;
+    struct t_irc_message *ptr_msg;
+
+    server = irc_server_alloc ("test_recv");
+    CHECK(server);
+
+    LONGS_EQUAL(1, irc_server_recv_buffer_alloc (server));
+    CHECK(server->recv_buffer);
+    CHECK(server->recv_buffer_size >= 4096);
+    LONGS_EQUAL(0, server->recv_buffer_length);
+
+    /* complete messages, the last one is unterminated */
+    WEE_RECV_DATA(server, "PING :1\r\n:n!u@h PRIVMSG #c :a\rb\n\r\n:n!u@h PRI");
+    LONGS_EQUAL(10, server->recv_buffer_length);
+    MEMCMP_EQUAL(":n!u@h PRI", server->recv_buffer, 10);
+    LONGS_EQUAL(2, server->recv_msgq_count);
+    ptr_msg = server->recv_msgq;
+    CHECK(ptr_msg);
+    POINTERS_EQUAL(server, ptr_msg->server);
+    STRCMP_EQUAL("PING :1", ptr_msg->data);
+    ptr_msg = ptr_msg->next_message;
+    CHECK(ptr_msg);
+    STRCMP_EQUAL(":n!u@h PRIVMSG #c :ab", ptr_msg->data);
+    POINTERS_EQUAL(NULL, ptr_msg->next_message);
+    POINTERS_EQUAL(ptr_msg, server->last_recv_msgq);
+
+    /* end of unterminated message */
+    WEE_RECV_DATA(server, "VMSG #c :test\r");
+    LONGS_EQUAL(24, server->recv_buffer_length);
+    WEE_RECV_DATA(server, "\n");
+    LONGS_EQUAL(0, server->recv_buffer_length);
+    STRCMP_EQUAL(":n!u@h PRIVMSG #c :test", server->last_recv_msgq->data);
+
+    /* flush of beginning of a message (buffer full or upgrade) */
+    WEE_RECV_DATA(server, "PING :a\r");
+    irc_server_recv_buffer_flush (server);
+    LONGS_EQUAL(0, server->recv_buffer_length);
+    STRCMP_EQUAL("PING :a", server->unterminated_message);
+    WEE_RECV_DATA(server, "bc\r\n");
+    STRCMP_EQUAL("PING :abc", server->last_recv_msgq->data);
+    POINTERS_EQUAL(NULL, server->unterminated_message);
+    LONGS_EQUAL(4, server->recv_msgq_count);
+
+    irc_server_free (server);
+}
+
+/*
+ * Tests functions:
+ *   irc_server_msgq_flush_server
+ *   irc_server_msgq_free_all
+ */
+
+TEST(IrcServer, MsgqFlushServer)
+{
+    struct t_irc_server *server;
+    char buffer[128];
+
+    server = irc_server_alloc ("test_msgq");
+    CHECK(server);
+
+    LONGS_EQUAL(0, server->recv_msgq_count);
+    LONGS_EQUAL(0, server->recv_msgq_processed);
+
+    /* messages are dropped by flush: the server is not connected */
+    strcpy (buffer, "PING :1\r\nPING :2\r\nPING :3\r\n");
+    irc_server_msgq_add_buffer (server, buffer);
+    strcpy (buffer, "PING :4\r\nPING :5\r\n");
+    irc_server_msgq_add_buffer (server, buffer);
+    LONGS_EQUAL(5, server->recv_msgq_count);
+
+    /* process at most 2 messages */
+    irc_server_msgq_flush_server (server, 2);
+    LONGS_EQUAL(3, server->recv_msgq_count);
+    LONGS_EQUAL(2, server->recv_msgq_processed);
+    STRCMP_EQUAL("PING :3", server->recv_msgq->data);
+    STRCMP_EQUAL("PING :5", server->last_recv_msgq->data);
+
+    /* process all messages */
+    irc_server_msgq_flush_server (server, 0);
+    LONGS_EQUAL(0, server->recv_msgq_count);
+    LONGS_EQUAL(5, server->recv_msgq_processed);
+    POINTERS_EQUAL(NULL, server->recv_msgq);
+    POINTERS_EQUAL(NULL, server->last_recv_msgq);
+
+    /* free messages not processed */
+    strcpy (buffer, "PING :6\r\nPING :7\r\n");
+    irc_server_msgq_add_buffer (server, buffer);
+    LONGS_EQUAL(2, server->recv_msgq_count);
+    irc_server_msgq_free_all (server);
+    LONGS_EQUAL(0, server->recv_msgq_count);
+    LONGS_EQUAL(5, server->recv_msgq_processed);
+    POINTERS_EQUAL(NULL, server->recv_msgq);
+    POINTERS_EQUAL(NULL, server->last_recv_msgq);
+
+    irc_server_free (server);
+}
+
+/*
+ * Counts lines containing a string in a buffer.
+ */
+
+int
+test_irc_server_count_lines (struct t_gui_buffer *buffer, const char *string)
+{
+    struct t_gui_line *ptr_line;
+    int count;
+
+    count = 0;
+    for (ptr_line = buffer->own_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        if (ptr_line->data->message
+            && strstr (ptr_line->data->message, string))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/*
+ * Tests functions:
+ *   irc_server_close_connection (messages in queue are dropped)
+ *   irc_server_recv_cb (messages in queue are processed on end of connection)
+ */
+
+TEST(IrcServer, MsgqEndOfConnection)
+{
+    struct t_irc_server *server;
+    struct t_gui_buffer *ptr_buffer;
+    char buffer[128];
+    int sockets[2], disconnected, errors;
+
+    server = irc_server_alloc ("test_msgq_close");
+    CHECK(server);
+    ptr_buffer = irc_server_create_buffer (server);
+    CHECK(ptr_buffer);
+
+    /* connection closed: messages are dropped */
+    LONGS_EQUAL(0, socketpair (AF_UNIX, SOCK_STREAM, 0, sockets));
+    server->sock = sockets[0];
+    strcpy (buffer, "PING :1\r\nPING :2\r\n");
+    irc_server_msgq_add_buffer (server, buffer);
+    LONGS_EQUAL(2, server->recv_msgq_count);
+    irc_server_close_connection (server);
+    LONGS_EQUAL(-1, server->sock);
+    LONGS_EQUAL(0, server->recv_msgq_count);
+    LONGS_EQUAL(0, server->recv_msgq_processed);
+    POINTERS_EQUAL(NULL, server->recv_msgq);
+    close (sockets[1]);
+
+    /* end of connection: messages are processed before disconnection */
+    disconnected = test_irc_server_count_lines (ptr_buffer,
+                                                "disconnected from server");
+    errors = test_irc_server_count_lines (ptr_buffer, "reading data on socket");
+    LONGS_EQUAL(0, socketpair (AF_UNIX, SOCK_STREAM, 0, sockets));
+    server->sock = sockets[0];
+    strcpy (buffer, "PING :1\r\nPING :2\r\nPING :3\r\n");
+    irc_server_msgq_add_buffer (server, buffer);
+    LONGS_EQUAL(0, shutdown (sockets[1], SHUT_WR));
+    irc_server_recv_cb (server, NULL, sockets[0]);
+    LONGS_EQUAL(-1, server->sock);
+    LONGS_EQUAL(0, server->recv_msgq_count);
+    LONGS_EQUAL(3, server->recv_msgq_processed);
+    POINTERS_EQUAL(NULL, server->recv_msgq);
+    LONGS_EQUAL(errors + 1,
+                test_irc_server_count_lines (ptr_buffer,
+                                             "reading data on socket"));
+    LONGS_EQUAL(disconnected + 1,
+                test_irc_server_count_lines (ptr_buffer,
+                                             "disconnected from server"));
+    close (sockets[1]);
+
+    /* end of connection: connection closed by a message (ERROR) */
+    disconnected = test_irc_server_count_lines (ptr_buffer,
+                                                "disconnected from server");
+    errors = test_irc_server_count_lines (ptr_buffer, "reading data on socket");
+    LONGS_EQUAL(0, socketpair (AF_UNIX, SOCK_STREAM, 0, sockets));
+    server->sock = sockets[0];
+    strcpy (buffer, "PING :4\r\nERROR :Closing Link: test\r\nPING :5\r\n");
+    irc_server_msgq_add_buffer (server, buffer);
+    LONGS_EQUAL(0, shutdown (sockets[1], SHUT_WR));
+    irc_server_recv_cb (server, NULL, sockets[0]);
+    LONGS_EQUAL(-1, server->sock);
+    LONGS_EQUAL(0, server->recv_msgq_count);
+    LONGS_EQUAL(5, server->recv_msgq_processed);
+    POINTERS_EQUAL(NULL, server->recv_msgq);
+    LONGS_EQUAL(errors,
+                test_irc_server_count_lines (ptr_buffer,
+                                             "reading data on socket"));
+    LONGS_EQUAL(disconnected + 1,
+                test_irc_server_count_lines (ptr_buffer,
+                                             "disconnected from server"));
+    close (sockets[1]);
+
+    irc_server_free (server);
+}
+
+/*
+ * Tests functions:
+ *   irc_server_send_buffer_add
+ *   irc_server_send_buffer_flush
+ */
+
+TEST(IrcServer, SendBuffer)
+{
+    struct t_irc_server *server;
+    char message[8192];
+
+    server = irc_server_alloc ("test_send");
+    CHECK(server);
+
+    POINTERS_EQUAL(NULL, server->send_buffer);
+    LONGS_EQUAL(0, server->send_buffer_length);
+
+    LONGS_EQUAL(1, irc_server_send_buffer_add (server, "PING :1", 7));
+    LONGS_EQUAL(1, irc_server_send_buffer_add (server, "PRIVMSG #c :test", 16));
+    LONGS_EQUAL(27, server->send_buffer_length);
+    MEMCMP_EQUAL("PING :1\r\nPRIVMSG #c :test\r\n", server->send_buffer, 27);
+
+    /* buffer is enlarged for a long message */
+    memset (message, 'a', sizeof (message));
+    LONGS_EQUAL(1, irc_server_send_buffer_add (server, message,
+                                               sizeof (message)));
+    LONGS_EQUAL(27 + 8192 + 2, server->send_buffer_length);
+    CHECK(server->send_buffer_size >= server->send_buffer_length);
+    MEMCMP_EQUAL("\r\n",
+                 server->send_buffer + server->send_buffer_length - 2, 2);
+
+    /* error when sending (server not connected): data is discarded */
+    LONGS_EQUAL(0, irc_server_send_buffer_flush (server));
+    LONGS_EQUAL(0, server->send_buffer_length);
+
+    /* nothing to send */
+    LONGS_EQUAL(1, irc_server_send_buffer_flush (server));
+
+    irc_server_free (server);
+}
+
+/*
+ * Tests functions:
+ *   irc_server_anti_flood_wait
+ *   irc_server_anti_flood_sent
+ */
+
+TEST(IrcServer, AntiFlood)
+{
+    struct t_irc_server *server;
+    int i;
+
+    server = irc_server_alloc ("test_anti_flood");
+    CHECK(server);
+
+    /* default: burst of 5 messages, 2 seconds between messages */
+    for (i = 0; i < 5; i++)
+    {
+        LONGS_EQUAL(0, irc_server_anti_flood_wait (server, 0));
+        irc_server_anti_flood_sent (server, 0);
+    }
+
+    /* burst exhausted: wait about 2000 ms (for both priorities) */
+    CHECK(irc_server_anti_flood_wait (server, 0) > 1900LL);
+    CHECK(irc_server_anti_flood_wait (server, 0) <= 2000LL);
+    CHECK(irc_server_anti_flood_wait (server, 1) > 1900LL);
+
+    /* 1.5 seconds later: wait about 500 ms */
+    server->anti_flood_time.tv_sec -= 2;
+    server->anti_flood_time.tv_usec += 500000;
+    if (server->anti_flood_time.tv_usec >= 1000000)
+    {
+        server->anti_flood_time.tv_sec++;
+        server->anti_flood_time.tv_usec -= 1000000;
+    }
+    CHECK(irc_server_anti_flood_wait (server, 0) > 400LL);
+    CHECK(irc_server_anti_flood_wait (server, 0) <= 500LL);
+
+    /* anti-flood time too far in future (clock changed): reset */
+    server->anti_flood_time.tv_sec += 3600;
+    LONGS_EQUAL(0, irc_server_anti_flood_wait (server, 0));
+
+    /* delays in milliseconds: burst of 2 messages, 250 ms between messages */
+    config_file_option_set (
+        server->options[IRC_SERVER_OPTION_ANTI_FLOOD_UNIT], "milliseconds", 1);
+    config_file_option_set (
+        server->options[IRC_SERVER_OPTION_ANTI_FLOOD_PRIO_HIGH], "250", 1);
+    config_file_option_set (
+        server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST], "2", 1);
+    server->anti_flood_time.tv_sec = 0;
+    server->anti_flood_time.tv_usec = 0;
+    for (i = 0; i < 2; i++)
+    {
+        LONGS_EQUAL(0, irc_server_anti_flood_wait (server, 0));
+        irc_server_anti_flood_sent (server, 0);
+    }
+    CHECK(irc_server_anti_flood_wait (server, 0) > 200LL);
+    CHECK(irc_server_anti_flood_wait (server, 0) <= 250LL);
+
+    irc_server_free (server);
+}
@@ -0,0 +1,333 @@
+/*
+ * test-relay-weechat-msg.cpp - test messages of relay (weechat protocol)
+ *
+ * Copyright (C) 2019 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <zlib.h>
+#include "tests/tests.h"
+#include "src/core/wee-hdata.h"
+#include "src/core/wee-util.h"
+#include "src/core/hook/wee-hook-hdata.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-line.h"
+#include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/relay-client.h"
+#include "src/plugins/relay/weechat/relay-weechat.h"
+#include "src/plugins/relay/weechat/relay-weechat-msg.h"
+}
+
+#define RELAY_TEST_NUM_LINES 500
+#define RELAY_TEST_BENCHMARK_LOOPS 20
+
+#define RELAY_TEST_KEYS_LINE_DATA                                       \
+    "buffer,date,date_printed,displayed,highlight,tags_array,prefix,"   \
+    "message"
+
+TEST_GROUP(RelayWeechatMsg)
+{
+};
+
+/*
+ * Creates a buffer with lines like the ones received on an IRC channel.
+ */
+
+struct t_gui_buffer *
+test_relay_weechat_msg_create_buffer ()
+{
+    const char *words[] = { "hello", "world", "is", "the", "build", "ok",
+                            "I", "think", "so", "weechat", "relay", "yes",
+                            "https://weechat.org/", "test", "a", "lol" };
+    struct t_gui_buffer *buffer;
+    char nick[32], tags[128], message[512];
+    int i, j;
+
+    buffer = gui_buffer_new (NULL, "test_relay",
+                             NULL, NULL, NULL, NULL, NULL, NULL);
+    if (!buffer)
+        return NULL;
+
+    for (i = 0; i < RELAY_TEST_NUM_LINES; i++)
+    {
+        snprintf (nick, sizeof (nick), "nick%d", (i * 7) % 13);
+        snprintf (tags, sizeof (tags),
+                  "irc_privmsg,notify_message,prefix_nick_%d,nick_%s,"
+                  "host_%s@example.com,log1",
+                  (i * 3) % 5, nick, nick);
+        message[0] = '\0';
+        for (j = 0; j < 3 + (i % 11); j++)
+        {
+            if (j > 0)
+                strcat (message, " ");
+            strcat (message, words[(i * 5 + j * 3) % 16]);
+        }
+        gui_chat_printf_date_tags (buffer, 0, tags, "%s\t%s", nick, message);
+    }
+
+    return buffer;
+}
+
+/*
+ * Tests functions:
+ *   relay_weechat_msg_get_compiled_keys
+ *   relay_weechat_msg_free_compiled_keys
+ */
+
+TEST(RelayWeechatMsg, CompiledKeys)
+{
+    struct t_hdata *hdata_buffer, *hdata_line_data;
+    struct t_hdata_keys *keys, *keys2;
+    int num_keys;
+
+    hdata_buffer = hook_hdata_get (NULL, "buffer");
+    CHECK(hdata_buffer);
+    hdata_line_data = hook_hdata_get (NULL, "line_data");
+    CHECK(hdata_line_data);
+
+    /* keys compiled on first call, then the same compiled keys are used */
+    keys = relay_weechat_msg_get_compiled_keys (hdata_buffer, "buffer",
+                                                "number,full_name",
+                                                &num_keys);
+    CHECK(keys);
+    LONGS_EQUAL(2, num_keys);
+    num_keys = 0;
+    POINTERS_EQUAL(keys,
+                   relay_weechat_msg_get_compiled_keys (hdata_buffer, "buffer",
+                                                        "number,full_name",
+                                                        &num_keys));
+    LONGS_EQUAL(2, num_keys);
+
+    /* other keys or other hdata: other compiled keys */
+    keys2 = relay_weechat_msg_get_compiled_keys (hdata_buffer, "buffer",
+                                                 "number,full_name,title",
+                                                 &num_keys);
+    CHECK(keys2);
+    CHECK(keys2 != keys);
+    LONGS_EQUAL(3, num_keys);
+    keys2 = relay_weechat_msg_get_compiled_keys (hdata_line_data, "line_data",
+                                                 "number,full_name",
+                                                 &num_keys);
+    CHECK(keys2);
+    CHECK(keys2 != keys);
+    LONGS_EQUAL(2, num_keys);
+
+    relay_weechat_msg_free_compiled_keys ();
+    POINTERS_EQUAL(NULL, relay_weechat_msg_compiled_keys);
+}
+
+/*
+ * Tests functions:
+ *   relay_weechat_msg_compress_zlib
+ *   relay_weechat_msg_compress_zlib_stream
+ *
+ * Replays the messages sent to a client synchronized with a buffer (one
+ * message "_buffer_line_added" for each line) and compares the size of
+ * messages with each compression.
+ */
+
+TEST(RelayWeechatMsg, CompressZlibStream)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_line *ptr_line;
+    struct t_relay_client client;
+    struct t_relay_weechat_data data;
+    struct t_relay_weechat_msg *msg;
+    z_stream stream;
+    char path[64], *dest;
+    unsigned char output[16384];
+    int count, size;
+    long long time_diff, bytes_zlib, bytes_stream;
+
+    buffer = test_relay_weechat_msg_create_buffer ();
+    CHECK(buffer);
+
+    memset (&client, 0, sizeof (client));
+    memset (&data, 0, sizeof (data));
+    client.protocol_data = &data;
+    data.compression = RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM;
+
+    memset (&stream, 0, sizeof (stream));
+    LONGS_EQUAL(Z_OK, inflateInit (&stream));
+
+    count = 0;
+    bytes_zlib = 0;
+    bytes_stream = 0;
+    for (ptr_line = buffer->own_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        msg = relay_weechat_msg_new ("_buffer_line_added");
+        CHECK(msg);
+        snprintf (path, sizeof (path),
+                  "line_data:0x%lx", (unsigned long)ptr_line->data);
+        LONGS_EQUAL(1, relay_weechat_msg_add_hdata (
+                        msg, path, RELAY_TEST_KEYS_LINE_DATA, 1));
+
+        /* compression of each message */
+        relay_weechat_msg_compress_zlib (msg);
+        bytes_zlib += (msg->data_zlib) ? msg->data_zlib_size : msg->data_size;
+
+        /* compression with a zlib stream */
+        dest = relay_weechat_msg_compress_zlib_stream (&client, msg, &size,
+                                                       &time_diff);
+        CHECK(dest);
+        CHECK(data.zlib_stream);
+        BYTES_EQUAL(RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM, dest[4]);
+        bytes_stream += size;
+
+        /* the message can be decompressed immediately by the client */
+        stream.next_in = (Bytef *)(dest + 5);
+        stream.avail_in = size - 5;
+        stream.next_out = output;
+        stream.avail_out = sizeof (output);
+        LONGS_EQUAL(Z_OK, inflate (&stream, Z_SYNC_FLUSH));
+        LONGS_EQUAL(0, stream.avail_in);
+        LONGS_EQUAL(msg->data_size - 5, sizeof (output) - stream.avail_out);
+        MEMCMP_EQUAL(msg->data + 5, output, msg->data_size - 5);
+
+        free (dest);
+        relay_weechat_msg_free (msg);
+        count++;
+    }
+
+    LONGS_EQUAL(RELAY_TEST_NUM_LINES, count);
+
+    /* the stream compresses small messages much better */
+    CHECK(bytes_stream * 2 < bytes_zlib);
+
+    relay_weechat_free_zlib_stream (&client);
+    POINTERS_EQUAL(NULL, data.zlib_stream);
+
+    inflateEnd (&stream);
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Replays the messages sent to a client synchronized with a buffer (one
+ * message "_buffer_line_added" for each line) with a compression and displays
+ * the size and time (build and compression) per message.
+ */
+
+void
+test_relay_weechat_msg_benchmark_run (struct t_gui_buffer *buffer,
+                                      enum t_relay_weechat_compression compression)
+{
+    struct t_gui_line *ptr_line;
+    struct t_relay_client client;
+    struct t_relay_weechat_data data;
+    struct t_relay_weechat_msg *msg;
+    struct timeval tv_start, tv_end;
+    clock_t clock_start, clock_end;
+    char path[64], *dest;
+    int i, count, size;
+    long long diff, time_diff, bytes_raw, bytes;
+
+    memset (&client, 0, sizeof (client));
+    memset (&data, 0, sizeof (data));
+    client.protocol_data = &data;
+    data.compression = compression;
+
+    count = 0;
+    bytes_raw = 0;
+    bytes = 0;
+
+    gettimeofday (&tv_start, NULL);
+    clock_start = clock ();
+    for (i = 0; i < RELAY_TEST_BENCHMARK_LOOPS; i++)
+    {
+        for (ptr_line = buffer->own_lines->first_line; ptr_line;
+             ptr_line = ptr_line->next_line)
+        {
+            msg = relay_weechat_msg_new ("_buffer_line_added");
+            snprintf (path, sizeof (path),
+                      "line_data:0x%lx", (unsigned long)ptr_line->data);
+            relay_weechat_msg_add_hdata (msg, path, RELAY_TEST_KEYS_LINE_DATA,
+                                         1);
+            bytes_raw += msg->data_size;
+            switch (compression)
+            {
+                case RELAY_WEECHAT_COMPRESSION_ZLIB:
+                    relay_weechat_msg_compress_zlib (msg);
+                    bytes += (msg->data_zlib) ?
+                        msg->data_zlib_size : msg->data_size;
+                    break;
+                case RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM:
+                    dest = relay_weechat_msg_compress_zlib_stream (
+                        &client, msg, &size, &time_diff);
+                    bytes += size;
+                    free (dest);
+                    break;
+                default:
+                    bytes += msg->data_size;
+                    break;
+            }
+            relay_weechat_msg_free (msg);
+            count++;
+        }
+    }
+    clock_end = clock ();
+    gettimeofday (&tv_end, NULL);
+
+    relay_weechat_free_zlib_stream (&client);
+
+    diff = util_timeval_diff (&tv_start, &tv_end);
+    printf ("relay message \"_buffer_line_added\" (%s): "
+            "%.1f bytes/msg (%.1f bytes without compression), "
+            "%.3f us/msg (cpu: %.3f us/msg)\n",
+            relay_weechat_compression_string[compression],
+            (double)bytes / count,
+            (double)bytes_raw / count,
+            (double)diff / count,
+            ((double)(clock_end - clock_start) * 1000000 / CLOCKS_PER_SEC)
+            / count);
+}
+
+/*
+ * Benchmark of messages sent to synchronized clients: size and time per
+ * message for each compression (off, zlib, zlib_stream).
+ */
+
+TEST(RelayWeechatMsg, CompressBenchmark)
+{
+    struct t_gui_buffer *buffer;
+    int compression;
+
+    if (!getenv (WEE_TEST_BENCHMARK_ENV))
+        return;
+
+    buffer = test_relay_weechat_msg_create_buffer ();
+    CHECK(buffer);
+
+    for (compression = 0; compression < RELAY_WEECHAT_NUM_COMPRESSIONS;
+         compression++)
+    {
+        test_relay_weechat_msg_benchmark_run (
+            buffer, (enum t_relay_weechat_compression)compression);
+    }
+
+    gui_buffer_close (buffer);
+}
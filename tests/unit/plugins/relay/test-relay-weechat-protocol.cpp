@@ -0,0 +1,377 @@
+/*
+ * test-relay-weechat-protocol.cpp - test protocol of relay (weechat protocol)
+ *
+ * Copyright (C) 2019 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <zlib.h>
+#include "src/core/wee-hashtable.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-line.h"
+#include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/relay-client.h"
+#include "src/plugins/relay/weechat/relay-weechat.h"
+#include "src/plugins/relay/weechat/relay-weechat-msg.h"
+#include "src/plugins/relay/weechat/relay-weechat-protocol.h"
+
+extern int relay_weechat_protocol_cb_init (struct t_relay_client *client,
+                                           const char *id,
+                                           const char *command,
+                                           int argc,
+                                           char **argv,
+                                           char **argv_eol);
+}
+
+#define RELAY_TEST_NUM_CLIENTS 4
+
+TEST_GROUP(RelayWeechatProtocol)
+{
+    struct t_relay_client clients[RELAY_TEST_NUM_CLIENTS];
+    int sockets[RELAY_TEST_NUM_CLIENTS][2];
+    struct t_relay_client *old_relay_clients, *old_last_relay_client;
+    z_stream stream;
+
+    /*
+     * clients (connected in this order):
+     *   0: no compression, sync of all buffers (flags "buffer" + "buffers")
+     *   1: zlib, sync of buffer "core.test_relay1" only
+     *   2: zlib_stream, sync of all buffers (flag "buffer")
+     *   3: zlib, sync of all buffers (flag "buffers" only: no lines)
+     */
+    void setup ()
+    {
+        int i, flags;
+
+        old_relay_clients = relay_clients;
+        old_last_relay_client = last_relay_client;
+        relay_clients = NULL;
+        last_relay_client = NULL;
+
+        for (i = 0; i < RELAY_TEST_NUM_CLIENTS; i++)
+        {
+            LONGS_EQUAL(0, socketpair (AF_UNIX, SOCK_STREAM, 0, sockets[i]));
+            memset (&clients[i], 0, sizeof (clients[i]));
+            clients[i].id = i + 1;
+            clients[i].sock = sockets[i][0];
+            clients[i].protocol = RELAY_PROTOCOL_WEECHAT;
+            clients[i].status = RELAY_STATUS_CONNECTED;
+            clients[i].send_data_type = RELAY_CLIENT_DATA_BINARY;
+            clients[i].prev_client = last_relay_client;
+            clients[i].next_client = NULL;
+            if (last_relay_client)
+                last_relay_client->next_client = &clients[i];
+            else
+                relay_clients = &clients[i];
+            last_relay_client = &clients[i];
+            relay_weechat_alloc (&clients[i]);
+            CHECK(clients[i].protocol_data);
+        }
+
+        RELAY_WEECHAT_DATA((&clients[0]), compression) = RELAY_WEECHAT_COMPRESSION_OFF;
+        flags = RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER | RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS;
+        hashtable_set (RELAY_WEECHAT_DATA((&clients[0]), buffers_sync), "*", &flags);
+
+        RELAY_WEECHAT_DATA((&clients[1]), compression) = RELAY_WEECHAT_COMPRESSION_ZLIB;
+        flags = RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER;
+        hashtable_set (RELAY_WEECHAT_DATA((&clients[1]), buffers_sync),
+                       "core.test_relay1", &flags);
+
+        RELAY_WEECHAT_DATA((&clients[2]), compression) = RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM;
+        flags = RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER;
+        hashtable_set (RELAY_WEECHAT_DATA((&clients[2]), buffers_sync), "*", &flags);
+
+        RELAY_WEECHAT_DATA((&clients[3]), compression) = RELAY_WEECHAT_COMPRESSION_ZLIB;
+        flags = RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS;
+        hashtable_set (RELAY_WEECHAT_DATA((&clients[3]), buffers_sync), "*", &flags);
+
+        memset (&stream, 0, sizeof (stream));
+        LONGS_EQUAL(Z_OK, inflateInit (&stream));
+    }
+
+    void teardown ()
+    {
+        int i;
+
+        for (i = 0; i < RELAY_TEST_NUM_CLIENTS; i++)
+        {
+            relay_weechat_free (&clients[i]);
+            close (sockets[i][0]);
+            close (sockets[i][1]);
+        }
+        relay_clients = old_relay_clients;
+        last_relay_client = old_last_relay_client;
+
+        inflateEnd (&stream);
+    }
+
+    /*
+     * Reads the message received by a client and decompresses it.
+     *
+     * Returns the size of message (without size and compression flag),
+     * -1 if no message was received.
+     */
+
+    int read_message (int client, unsigned char *output, int output_size)
+    {
+        unsigned char data[65536];
+        uint32_t size32;
+        uLongf dest_size;
+        int size;
+
+        /* read exactly one message (size is in the first 4 bytes) */
+        if (recv (sockets[client][1], data, 4, MSG_DONTWAIT | MSG_PEEK) != 4)
+            return -1;
+        memcpy (&size32, data, 4);
+        size = ntohl (size32);
+        if ((size < 5) || (size > (int)sizeof (data)))
+            return -1;
+        if (recv (sockets[client][1], data, size, MSG_DONTWAIT) != size)
+            return -1;
+
+        switch (data[4])
+        {
+            case RELAY_WEECHAT_COMPRESSION_OFF:
+                memcpy (output, data + 5, size - 5);
+                return size - 5;
+            case RELAY_WEECHAT_COMPRESSION_ZLIB:
+                dest_size = output_size;
+                if (uncompress (output, &dest_size,
+                                data + 5, size - 5) != Z_OK)
+                    return -1;
+                return dest_size;
+            case RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM:
+                stream.next_in = data + 5;
+                stream.avail_in = size - 5;
+                stream.next_out = output;
+                stream.avail_out = output_size;
+                if (inflate (&stream, Z_SYNC_FLUSH) != Z_OK)
+                    return -1;
+                return output_size - stream.avail_out;
+        }
+        return -1;
+    }
+
+    /*
+     * Checks the message received by a client (NULL if the client must not
+     * receive any message).
+     */
+
+    void check_message (int client, int compression,
+                        struct t_relay_weechat_msg *expected)
+    {
+        unsigned char data[65536], output[65536];
+        int size;
+
+        if (!expected)
+        {
+            LONGS_EQUAL(-1, recv (sockets[client][1], data, sizeof (data),
+                                  MSG_DONTWAIT));
+            return;
+        }
+
+        /* check compression flag without reading the message */
+        LONGS_EQUAL(5, recv (sockets[client][1], data, 5,
+                             MSG_DONTWAIT | MSG_PEEK));
+        BYTES_EQUAL(compression, data[4]);
+
+        size = read_message (client, output, sizeof (output));
+        LONGS_EQUAL(expected->data_size - 5, size);
+        MEMCMP_EQUAL(expected->data + 5, output, size);
+    }
+};
+
+/*
+ * Tests functions:
+ *   relay_weechat_hook_signals
+ *   relay_weechat_unhook_signal_buffer
+ *   relay_weechat_protocol_signal_buffer_cb
+ *   relay_weechat_msg_send
+ */
+
+TEST(RelayWeechatProtocol, SignalBuffer)
+{
+    struct t_gui_buffer *buffer1, *buffer2;
+    struct t_relay_weechat_msg *expected;
+    unsigned long long msgs;
+    unsigned char output[65536];
+    char path[64];
+    const char *keys_line = "buffer,date,date_printed,displayed,highlight,"
+        "tags_array,prefix,message";
+    int i;
+
+    buffer1 = gui_buffer_new (NULL, "test_relay1",
+                              NULL, NULL, NULL, NULL, NULL, NULL);
+    CHECK(buffer1);
+    buffer2 = gui_buffer_new (NULL, "test_relay2",
+                              NULL, NULL, NULL, NULL, NULL, NULL);
+    CHECK(buffer2);
+
+    /* messages "_buffer_opened" are ignored */
+    for (i = 0; i < RELAY_TEST_NUM_CLIENTS; i++)
+    {
+        while (read_message (i, output, sizeof (output)) >= 0)
+        {
+        }
+    }
+
+    /* a single hook for all clients */
+    CHECK(relay_weechat_hook_signal_buffer);
+    LONGS_EQUAL(RELAY_TEST_NUM_CLIENTS, relay_weechat_signal_buffer_clients);
+
+    /* line in buffer 1: message built once, sent to clients 0, 1 and 2 */
+    msgs = relay_weechat_signal_buffer_msgs;
+    gui_chat_printf_date_tags (buffer1, 0, "tag1,tag2", "nick\thello world");
+    LONGS_EQUAL(msgs + 1, relay_weechat_signal_buffer_msgs);
+    expected = relay_weechat_msg_new ("_buffer_line_added");
+    CHECK(expected);
+    snprintf (path, sizeof (path), "line_data:0x%lx",
+              (unsigned long)buffer1->own_lines->last_line->data);
+    LONGS_EQUAL(1, relay_weechat_msg_add_hdata (expected, path, keys_line,
+                                                0));
+    check_message (0, RELAY_WEECHAT_COMPRESSION_OFF, expected);
+    check_message (1, RELAY_WEECHAT_COMPRESSION_ZLIB, expected);
+    check_message (2, RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM, expected);
+    check_message (3, 0, NULL);
+    relay_weechat_msg_free (expected);
+
+    /* line in buffer 2: message built once, sent to clients 0 and 2 */
+    msgs = relay_weechat_signal_buffer_msgs;
+    gui_chat_printf_date_tags (buffer2, 0, NULL, "nick2\tsecond line");
+    LONGS_EQUAL(msgs + 1, relay_weechat_signal_buffer_msgs);
+    expected = relay_weechat_msg_new ("_buffer_line_added");
+    CHECK(expected);
+    snprintf (path, sizeof (path), "line_data:0x%lx",
+              (unsigned long)buffer2->own_lines->last_line->data);
+    LONGS_EQUAL(1, relay_weechat_msg_add_hdata (expected, path, keys_line,
+                                                0));
+    check_message (0, RELAY_WEECHAT_COMPRESSION_OFF, expected);
+    check_message (1, 0, NULL);
+    check_message (2, RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM, expected);
+    check_message (3, 0, NULL);
+    relay_weechat_msg_free (expected);
+
+    /* title of buffer 2: message built once, sent to all clients but 1 */
+    msgs = relay_weechat_signal_buffer_msgs;
+    gui_buffer_set (buffer2, "title", "new title");
+    LONGS_EQUAL(msgs + 1, relay_weechat_signal_buffer_msgs);
+    expected = relay_weechat_msg_new ("_buffer_title_changed");
+    CHECK(expected);
+    snprintf (path, sizeof (path), "buffer:0x%lx", (unsigned long)buffer2);
+    LONGS_EQUAL(1, relay_weechat_msg_add_hdata (expected, path,
+                                                "number,full_name,title", 0));
+    check_message (0, RELAY_WEECHAT_COMPRESSION_OFF, expected);
+    check_message (1, 0, NULL);
+    check_message (2, RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM, expected);
+    check_message (3, RELAY_WEECHAT_COMPRESSION_ZLIB, expected);
+    relay_weechat_msg_free (expected);
+
+    /* no client synchronized: message is not built */
+    hashtable_remove_all (RELAY_WEECHAT_DATA((&clients[0]), buffers_sync));
+    hashtable_remove_all (RELAY_WEECHAT_DATA((&clients[2]), buffers_sync));
+    msgs = relay_weechat_signal_buffer_msgs;
+    gui_chat_printf_date_tags (buffer2, 0, NULL, "nick2\tthird line");
+    LONGS_EQUAL(msgs, relay_weechat_signal_buffer_msgs);
+    for (i = 0; i < RELAY_TEST_NUM_CLIENTS; i++)
+    {
+        check_message (i, 0, NULL);
+    }
+
+    /* hook is removed with the last client */
+    for (i = 0; i < RELAY_TEST_NUM_CLIENTS - 1; i++)
+    {
+        relay_weechat_unhook_signal_buffer (&clients[i]);
+        CHECK(relay_weechat_hook_signal_buffer);
+    }
+    relay_weechat_unhook_signal_buffer (&clients[RELAY_TEST_NUM_CLIENTS - 1]);
+    POINTERS_EQUAL(NULL, relay_weechat_hook_signal_buffer);
+    LONGS_EQUAL(0, relay_weechat_signal_buffer_clients);
+
+    gui_buffer_close (buffer1);
+    gui_buffer_close (buffer2);
+}
+
+/*
+ * Tests functions:
+ *   relay_weechat_protocol_cb_init (option "compression")
+ */
+
+TEST(RelayWeechatProtocol, InitCompression)
+{
+    struct t_relay_client *client;
+    struct t_relay_weechat_msg *msg;
+    struct z_stream_s *zlib_stream;
+    unsigned char output[65536];
+    char option[64], *argv[2];
+
+    client = &clients[2];
+    argv[0] = option;
+    argv[1] = NULL;
+
+    /* no sync of buffers: only messages sent by the test are received */
+    hashtable_remove_all (RELAY_WEECHAT_DATA(client, buffers_sync));
+
+    /* compression can be changed before any message is sent */
+    snprintf (option, sizeof (option), "compression=zlib");
+    relay_weechat_protocol_cb_init (client, NULL, "init", 1, argv, argv);
+    LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_ZLIB,
+                RELAY_WEECHAT_DATA(client, compression));
+    snprintf (option, sizeof (option), "compression=zlib_stream");
+    relay_weechat_protocol_cb_init (client, NULL, "init", 1, argv, argv);
+    LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM,
+                RELAY_WEECHAT_DATA(client, compression));
+    POINTERS_EQUAL(NULL, RELAY_WEECHAT_DATA(client, zlib_stream));
+
+    /* first message: the zlib stream is started */
+    msg = relay_weechat_msg_new ("test");
+    CHECK(msg);
+    relay_weechat_msg_add_string (msg, "first message");
+    relay_weechat_msg_send (client, msg);
+    zlib_stream = RELAY_WEECHAT_DATA(client, zlib_stream);
+    CHECK(zlib_stream);
+    check_message (2, RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM, msg);
+    relay_weechat_msg_free (msg);
+
+    /* compression can not be changed anymore, the stream is kept */
+    snprintf (option, sizeof (option), "compression=off");
+    relay_weechat_protocol_cb_init (client, NULL, "init", 1, argv, argv);
+    LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM,
+                RELAY_WEECHAT_DATA(client, compression));
+    POINTERS_EQUAL(zlib_stream, RELAY_WEECHAT_DATA(client, zlib_stream));
+    snprintf (option, sizeof (option), "compression=zlib_stream");
+    relay_weechat_protocol_cb_init (client, NULL, "init", 1, argv, argv);
+    POINTERS_EQUAL(zlib_stream, RELAY_WEECHAT_DATA(client, zlib_stream));
+
+    /* next message is decompressed with the same stream */
+    msg = relay_weechat_msg_new ("test");
+    CHECK(msg);
+    relay_weechat_msg_add_string (msg, "second message");
+    relay_weechat_msg_send (client, msg);
+    check_message (2, RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM, msg);
+    relay_weechat_msg_free (msg);
+    LONGS_EQUAL(-1, read_message (2, output, sizeof (output)));
+}